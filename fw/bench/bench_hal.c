@@ -0,0 +1,49 @@
+/* HAL stubs for benchmark image, GPIO access is implemented as in ST HAL. */
+
+#include "stm32f1xx_hal.h"
+
+GPIO_TypeDef bench_gpio[3];
+
+void HAL_GPIO_Init(GPIO_TypeDef *GPIOx, GPIO_InitTypeDef *GPIO_Init) {
+	if (GPIO_Init->Pull == GPIO_PULLUP)
+		GPIOx->IDR |= GPIO_Init->Pin;
+}
+
+void HAL_GPIO_DeInit(GPIO_TypeDef *GPIOx, uint32_t GPIO_Pin) {
+}
+
+GPIO_PinState HAL_GPIO_ReadPin(GPIO_TypeDef *GPIOx, uint16_t GPIO_Pin) {
+	return ((GPIOx->IDR & GPIO_Pin) != 0) ? GPIO_PIN_SET : GPIO_PIN_RESET;
+}
+
+void HAL_GPIO_WritePin(GPIO_TypeDef *GPIOx, uint16_t GPIO_Pin, GPIO_PinState PinState) {
+	if (PinState != GPIO_PIN_RESET)
+		GPIOx->BSRR = GPIO_Pin;
+	else
+		GPIOx->BSRR = (uint32_t)GPIO_Pin << 16u;
+}
+
+void HAL_GPIO_TogglePin(GPIO_TypeDef *GPIOx, uint16_t GPIO_Pin) {
+	uint32_t odr = GPIOx->ODR;
+	GPIOx->BSRR = ((odr & GPIO_Pin) << 16u) | (~odr & GPIO_Pin);
+}
+
+uint32_t HAL_GetTick(void) {
+	return 0;
+}
+
+// Image is linked without libc, gcc could emit calls of these
+void *memcpy(void *dest, const void *src, size_t n) {
+	uint8_t *d = dest;
+	const uint8_t *s = src;
+	while (n--)
+		*d++ = *s++;
+	return dest;
+}
+
+void *memset(void *s, int c, size_t n) {
+	uint8_t *p = s;
+	while (n--)
+		*p++ = (uint8_t)c;
+	return s;
+}
@@ -0,0 +1,452 @@
+/* Benchmark of selected firmware routines.
+ *
+ * Image runs either in QEMU (mps2-an385 machine, Cortex-M3) or on DC-01 board
+ * (BENCH_DWT defined). Each case runs its routine BENCH_ITERATIONS times,
+ * loop with setup only is subtracted, result per single call is printed via
+ * semihosting as a line ‹name› ‹value›.
+ *
+ * QEMU does not model cycles. When run with ‘-icount shift=0’, virtual clock
+ * advances 1 ns per instruction and SysTick counts at 25 MHz, so one SysTick
+ * tick is 40 instructions; the value is thus number of executed instructions.
+ * On the board, DWT cycle counter is used and the value is number of cycles
+ * (including flash wait states).
+ */
+
+#include <stdint.h>
+#include "stm32f1xx_hal.h"
+#include "main.h"
+#include "gpio.h"
+#include "debounce.h"
+#include "dc_frame.h"
+#include "selftest.h"
+#include "leds.h"
+#include "dccdec.h"
+#include "edges.h"
+#include "dccwave.h"
+#include "events.h"
+#include "dc01_proto.h"
+
+#define BENCH_ITERATIONS 1000
+
+#ifdef BENCH_DWT
+#define DEMCR (*(volatile uint32_t*)0xE000EDFC)
+#define DWT_CTRL (*(volatile uint32_t*)0xE0001000)
+#define DWT_CYCCNT (*(volatile uint32_t*)0xE0001004)
+#define BENCH_COUNTER_MASK 0xFFFFFFFF
+#define BENCH_COUNTER_SCALE 1
+#else
+#define SYST_CSR (*(volatile uint32_t*)0xE000E010)
+#define SYST_RVR (*(volatile uint32_t*)0xE000E014)
+#define SYST_CVR (*(volatile uint32_t*)0xE000E018)
+#define BENCH_COUNTER_MASK 0x00FFFFFF
+#define BENCH_COUNTER_SCALE 40 // instructions per SysTick tick (25 MHz, 1 ns per instruction)
+#endif
+
+#define SYS_WRITE0 0x04
+#define SYS_EXIT 0x18
+#define ADP_STOPPED_APPLICATION_EXIT 0x20026
+#define ADP_STOPPED_RUNTIME_ERROR 0x20023
+
+typedef struct {
+	const char *name;
+	void (*setup)(void);
+	void (*run)(void); // setup + measured routine
+} BenchCase;
+
+extern uint32_t _sidata, _sdata, _edata, _sbss, _ebss, _estack;
+
+void Reset_Handler(void);
+void Fault_Handler(void);
+int main(void);
+
+__attribute__((section(".isr_vector"), used))
+const void *bench_vectors[] = {
+	&_estack,
+	Reset_Handler,
+	Fault_Handler, // NMI
+	Fault_Handler, // HardFault
+	Fault_Handler, // MemManage
+	Fault_Handler, // BusFault
+	Fault_Handler, // UsageFault
+};
+
+volatile Warnings warnings;
+static size_t frames_received;
+
+/* Semihosting --------------------------------------------------------------*/
+
+static int semihosting(int op, const void *arg) {
+	register int r0 __asm__("r0") = op;
+	register const void *r1 __asm__("r1") = arg;
+	__asm__ volatile ("bkpt 0xAB" : "+r"(r0) : "r"(r1) : "memory");
+	return r0;
+}
+
+static void bench_print(const char *str) {
+	semihosting(SYS_WRITE0, str);
+}
+
+static void bench_exit(uint32_t reason) {
+	semihosting(SYS_EXIT, (const void*)reason);
+	while (true);
+}
+
+static void bench_print_result(const char *name, uint32_t tenths) {
+	char buf[16];
+	size_t i = sizeof(buf);
+
+	buf[--i] = '\0';
+	buf[--i] = '\n';
+	buf[--i] = '0' + (tenths % 10);
+	buf[--i] = '.';
+	tenths /= 10;
+	do {
+		buf[--i] = '0' + (tenths % 10);
+		tenths /= 10;
+	} while (tenths > 0);
+	buf[--i] = ' ';
+
+	bench_print(name);
+	bench_print(&buf[i]);
+}
+
+/* Startup ------------------------------------------------------------------*/
+
+void Reset_Handler(void) {
+	uint32_t *src = &_sidata;
+	for (uint32_t *dst = &_sdata; dst < &_edata; dst++, src++)
+		*dst = *src;
+	for (uint32_t *dst = &_sbss; dst < &_ebss; dst++)
+		*dst = 0;
+	main();
+	bench_exit(ADP_STOPPED_APPLICATION_EXIT);
+}
+
+void Fault_Handler(void) {
+	bench_print("fault\n");
+	bench_exit(ADP_STOPPED_RUNTIME_ERROR);
+}
+
+/* Counter ------------------------------------------------------------------*/
+
+static void counter_init(void) {
+#ifdef BENCH_DWT
+	DEMCR |= 1 << 24; // TRCENA
+	DWT_CYCCNT = 0;
+	DWT_CTRL |= 1; // CYCCNTENA
+#else
+	SYST_RVR = BENCH_COUNTER_MASK;
+	SYST_CVR = 0;
+	SYST_CSR = 0x5; // enable, processor clock, no interrupt
+#endif
+}
+
+static inline uint32_t counter(void) {
+#ifdef BENCH_DWT
+	return DWT_CYCCNT;
+#else
+	return BENCH_COUNTER_MASK - SYST_CVR; // SysTick counts down
+#endif
+}
+
+static uint32_t measure(void (*fn)(void)) {
+	uint32_t start = counter();
+	for (size_t i = 0; i < BENCH_ITERATIONS; i++)
+		fn();
+	return (counter() - start) & BENCH_COUNTER_MASK;
+}
+
+/* Stubs of main.c ----------------------------------------------------------*/
+
+static bool dcc[DCCDEC_COUNT]; // presence of DCC at inputs
+
+bool dcc_at_least_one(void) {
+	return (dcc[DCCDEC_DCC1]) || (dcc[DCCDEC_DCC2]);
+}
+
+bool dcc_just_single(void) {
+	return (dcc[DCCDEC_DCC1]) ^ (dcc[DCCDEC_DCC2]);
+}
+
+bool dcc_both(void) {
+	return (dcc[DCCDEC_DCC1]) || (dcc[DCCDEC_DCC2]);
+}
+
+void set_relays(bool relay1, bool relay2) {
+	// DCC at DCC1 side, DCC2 side follows relays immediately
+	dcc[DCCDEC_DCC2] = relay1 && relay2;
+	gpio_pin_write(pin_led_go, relay1 && relay2);
+	gpio_pin_write(pin_led_stop, !(relay1 && relay2));
+}
+
+void debounce_on_fall(PinDef pin) {}
+void debounce_on_raise(PinDef pin) {}
+void brtest_finished(void) {}
+void brtest_failed(void) {}
+void brtest_changed(void) {}
+
+/* Cases --------------------------------------------------------------------*/
+
+static void nothing(void) {}
+
+static void debounce_stable(void) {
+	debounce_update();
+}
+
+static const uint8_t frames[] = {
+	DC_FRAME_MAGIC1, DC_FRAME_MAGIC2, 2, DC_CMD_PM_SET_STATE, 1,
+	DC_FRAME_MAGIC1, DC_FRAME_MAGIC2, 4, DC_CMD_PM_LEASE, 0x09, 0xC4, 0x01,
+	DC_FRAME_MAGIC1, DC_FRAME_MAGIC2, 1, DC_CMD_PM_INFO_REQ,
+	DC_FRAME_MAGIC1, DC_FRAME_MAGIC2, 2, DC_CMD_PM_SET_STATE, // unfinished
+};
+static uint8_t frame_buf[sizeof(frames)];
+static size_t frame_buf_size;
+
+static void frame_received(uint8_t command_code, uint8_t *data, size_t data_size) {
+	frames_received++;
+}
+
+static void frames_setup(void) {
+	for (size_t i = 0; i < sizeof(frames); i++)
+		frame_buf[i] = frames[i];
+	frame_buf_size = sizeof(frames);
+}
+
+static void frames_parse(void) {
+	frames_setup();
+	dc_frame_parse(frame_buf, &frame_buf_size, frame_received);
+}
+
+static void brtest_setup(void) {
+	brtest_init();
+	set_relays(false, false);
+	dcc[DCCDEC_DCC1] = true;
+	brtest_start();
+}
+
+static void brtest_full(void) {
+	brtest_setup();
+	while (brtest_running())
+		brtest_update();
+}
+
+static void brtest_idle(void) {
+	brtest_update();
+}
+
+static void leds_blinking_setup(void) {
+	led_activate(pin_led_red, 1000000, 0);
+	led_activate(pin_led_yellow, 1000000, 0);
+	led_activate(pin_led_green, 1000000, 0);
+	led_activate(pin_led_blue, 1000000, 0);
+}
+
+static void leds_blinking(void) {
+	leds_blinking_setup();
+	leds_update_1ms();
+}
+
+static void leds_idle(void) {
+	leds_update_1ms();
+}
+
+static void led_activate_first(void) {
+	leds_init();
+	led_activate(pin_led_blue, 50, 50);
+}
+
+static void led_activate_active(void) {
+	led_activate(pin_led_blue, 50, 50);
+}
+
+// Idle packet (0xFF 0x00 0xFF), 14 preamble bits, as half-periods in us
+#define DCC_ONE_US 58
+#define DCC_ZERO_US 100
+#define DCC_MAX_HALVES 128
+static uint16_t dcc_halves[DCC_MAX_HALVES];
+static size_t dcc_halves_count;
+static DccDecoder bench_dccdec;
+static uint16_t dcc_time;
+static EdgeRing bench_edges;
+static DccDecoder bench_edges_dccdec;
+static DccWave bench_dccwave;
+static bool dcc_low;
+
+static void dcc_bit(bool one) {
+	dcc_halves[dcc_halves_count++] = one ? DCC_ONE_US : DCC_ZERO_US;
+	dcc_halves[dcc_halves_count++] = one ? DCC_ONE_US : DCC_ZERO_US;
+}
+
+static void dcc_build_idle(void) {
+	static const uint8_t packet[] = {0xFF, 0x00, 0xFF};
+	dcc_halves_count = 0;
+	for (size_t i = 0; i < 14; i++)
+		dcc_bit(true);
+	dcc_bit(false);
+	for (size_t i = 0; i < sizeof(packet); i++) {
+		for (int bit = 7; bit >= 0; bit--)
+			dcc_bit((packet[i] >> bit) & 1);
+		dcc_bit(i == sizeof(packet)-1);
+	}
+}
+
+static void dccdec_setup(void) {
+	for (size_t i = 0; i < dcc_halves_count; i++)
+		dcc_time += dcc_halves[i];
+}
+
+static void dccdec_packet(void) {
+	for (size_t i = 0; i < dcc_halves_count; i++) {
+		dcc_time += dcc_halves[i];
+		dccdec_edge(&bench_dccdec, dcc_time);
+	}
+}
+
+static void dcc_edges_packet(void) {
+	// Whole path of an edge: TIM3 interrupt pushes it, main loop processes it
+	for (size_t i = 0; i < dcc_halves_count; i++) {
+		dcc_time += dcc_halves[i];
+		dcc_low = !dcc_low;
+		edges_push(&bench_edges, dcc_time, dcc_low);
+
+		Edge edge;
+		while (edges_pop(&bench_edges, &edge)) {
+			dccdec_edge(&bench_edges_dccdec, edge.timestamp);
+			dccwave_edge(&bench_dccwave, &edge);
+		}
+	}
+}
+
+// Single edges through the path of dcc_edges_process (main.c), own state
+static EdgeRing edge_ring;
+static DccDecoder edge_dccdec[DCCDEC_COUNT];
+static DccWave edge_dccwave[DCCDEC_COUNT];
+static uint16_t edge_time;
+static bool edge_low;
+static size_t edge_half; // index to dcc_halves
+
+static void dcc_edge(void) {
+	// Cost per edge: TIM3 interrupt pushes it, main loop processes it (DCC1)
+	edge_time += dcc_halves[edge_half];
+	edge_half = (edge_half+1) % dcc_halves_count;
+	edge_low = !edge_low;
+	edges_push(&edge_ring, edge_time, edge_low);
+
+	Edge edge;
+	while (edges_pop(&edge_ring, &edge)) {
+		if (edge.flags & EDGE_GAP)
+			dccdec_resync(&edge_dccdec[DCCDEC_DCC1]);
+		dccdec_edge(&edge_dccdec[DCCDEC_DCC1], edge.timestamp);
+		dccwave_edge(&edge_dccwave[DCCDEC_DCC1], &edge);
+	}
+}
+
+static void dcc_update_1ms(void) {
+	// Cost per 1 ms: main loop on irDccUpdate, DCC1 with signal, DCC2 without
+	for (size_t i = 0; i < DCCDEC_COUNT; i++) {
+		dccdec_update_1ms(&edge_dccdec[i]);
+		dccwave_update_1ms(&edge_dccwave[i]);
+	}
+}
+
+static Events bench_events;
+static size_t events_taken;
+
+static void events_set_take(void) {
+	// Interrupt sets, main loop takes (bit-band access on Cortex-M3)
+	events_set(&bench_events, 3);
+	if (events_take(&bench_events, 3))
+		events_taken++;
+}
+
+// Largest report, codecs generated from doc/protocol.json
+static const Dc01DccWaveReport wave_report = {
+	.input = 1, .present = true, .frequency = 4200, .low_permille = 480, .cutout_us = 464,
+	.cutouts = 123456, .losses = 3, .lost_ms = 0x01020304, .loss_ms = 250, .edge_overruns = 0xFFFFFFFF,
+	.half_periods = {0, 1, 2, 0x80000000, 4, 5, 6, 7},
+};
+static uint8_t wave_buf[DC01_DCC_WAVE_REPORT_SIZE];
+static Dc01DccWaveReport wave_decoded;
+static size_t wave_encoded_size;
+
+static void proto_encode_dcc_wave(void) {
+	wave_encoded_size = dc01_encode_dcc_wave_report(wave_buf, &wave_report);
+}
+
+static void proto_decode_dcc_wave(void) {
+	dc01_decode_dcc_wave_report(wave_buf, wave_encoded_size, &wave_decoded);
+}
+
+static bool dcc_wave_roundtrip_ok(void) {
+	const Dc01DccWaveReport *a = &wave_report, *b = &wave_decoded;
+	if ((wave_encoded_size != DC01_DCC_WAVE_REPORT_SIZE) || (a->input != b->input) || (a->present != b->present) ||
+	    (a->frequency != b->frequency) || (a->low_permille != b->low_permille) || (a->cutout_us != b->cutout_us) ||
+	    (a->cutouts != b->cutouts) || (a->losses != b->losses) || (a->lost_ms != b->lost_ms) ||
+	    (a->loss_ms != b->loss_ms) || (a->edge_overruns != b->edge_overruns))
+		return false;
+	for (size_t i = 0; i < DCCWAVE_BINS; i++)
+		if (a->half_periods[i] != b->half_periods[i])
+			return false;
+	// MSB first on the wire
+	return (wave_buf[16] == 0x01) && (wave_buf[19] == 0x04);
+}
+
+static const BenchCase cases[] = {
+	{"debounce_update_stable", nothing, debounce_stable},
+	{"dc_frame_parse_3", frames_setup, frames_parse},
+	{"brtest_update_idle", nothing, brtest_idle},
+	{"brtest_full_run", brtest_setup, brtest_full},
+	{"leds_update_1ms_idle", nothing, leds_idle},
+	{"leds_update_1ms_all_on", leds_blinking_setup, leds_blinking},
+	{"led_activate_off", leds_init, led_activate_first},
+	{"led_activate_on", nothing, led_activate_active},
+	{"dccdec_idle_packet", dccdec_setup, dccdec_packet},
+	{"dcc_edges_idle_packet", dccdec_setup, dcc_edges_packet},
+	{"dcc_edge", nothing, dcc_edge},
+	{"dcc_update_1ms", nothing, dcc_update_1ms},
+	{"events_set_take", nothing, events_set_take},
+	{"proto_encode_dcc_wave", nothing, proto_encode_dcc_wave},
+	{"proto_decode_dcc_wave", nothing, proto_decode_dcc_wave},
+};
+
+int main(void) {
+	gpio_init();
+	debounce_init();
+	brtest_init();
+	leds_init();
+	dccdec_init(&bench_dccdec);
+	edges_init(&bench_edges);
+	dccdec_init(&bench_edges_dccdec);
+	dccwave_init(&bench_dccwave);
+	edges_init(&edge_ring);
+	for (size_t i = 0; i < DCCDEC_COUNT; i++) {
+		dccdec_init(&edge_dccdec[i]);
+		dccwave_init(&edge_dccwave[i]);
+	}
+	dcc_build_idle();
+	counter_init();
+
+	for (size_t i = 0; i < sizeof(cases)/sizeof(cases[0]); i++) {
+		uint32_t base = measure(cases[i].setup);
+		uint32_t total = measure(cases[i].run);
+		uint32_t ticks = (total > base) ? total-base : 0;
+		bench_print_result(cases[i].name, (uint32_t)(((uint64_t)ticks*BENCH_COUNTER_SCALE*10) / BENCH_ITERATIONS));
+	}
+
+	if (frames_received != 3*BENCH_ITERATIONS)
+		bench_exit(ADP_STOPPED_RUNTIME_ERROR);
+	if ((bench_dccdec.stats.packets != BENCH_ITERATIONS) || (bench_dccdec.stats.bit_errors > 0))
+		bench_exit(ADP_STOPPED_RUNTIME_ERROR);
+	if ((bench_edges_dccdec.stats.packets != BENCH_ITERATIONS) || (bench_edges.lost > 0) ||
+	    (bench_dccwave.stats.halves[DCCWAVE_BIN_ONE] + bench_dccwave.stats.halves[DCCWAVE_BIN_ZERO] !=
+	     BENCH_ITERATIONS*dcc_halves_count - 1)) // the first edge only synchronizes
+		bench_exit(ADP_STOPPED_RUNTIME_ERROR);
+	if ((edge_dccdec[DCCDEC_DCC1].stats.packets < BENCH_ITERATIONS/dcc_halves_count - 1) ||
+	    (edge_dccdec[DCCDEC_DCC1].stats.bit_errors > 0) || (edge_ring.lost > 0))
+		bench_exit(ADP_STOPPED_RUNTIME_ERROR);
+	if ((events_taken != BENCH_ITERATIONS) || (bench_events != 0))
+		bench_exit(ADP_STOPPED_RUNTIME_ERROR);
+	if (!dcc_wave_roundtrip_ok())
+		bench_exit(ADP_STOPPED_RUNTIME_ERROR);
+	return 0;
+}
@@ -0,0 +1,74 @@
+#!/usr/bin/env python3
+"""
+Compares benchmark results with baseline. Both files contain lines
+‹routine› ‹instructions per call›, lines starting with '#' are comments.
+Fails if any routine got slower by more than tolerance, or has no baseline
+(a check against missing baseline would pass vacuously).
+"""
+
+import argparse
+import sys
+from typing import Dict, List
+
+HEADER = [
+    '# Instructions per call of firmware routines executed in QEMU (mps2-an385,',
+    '# -icount shift=0), see bench_main.c. Regenerate by ‹make -C bench update›',
+    '# when a change in performance is intended.',
+]
+
+
+def read_results(path: str) -> Dict[str, float]:
+    result = {}
+    with open(path) as f:
+        for line in f:
+            line = line.strip()
+            if not line or line.startswith('#'):
+                continue
+            name, value = line.split()
+            result[name] = float(value)
+    return result
+
+
+def compare(baseline: Dict[str, float], results: Dict[str, float], tolerance: float) -> List[str]:
+    failed = []
+    for name, value in results.items():
+        if name not in baseline:
+            print(f'{name:24} {value:10.1f}  no baseline')
+            failed.append(name)
+            continue
+        base = baseline[name]
+        diff = 100*(value-base)/base if base > 0 else 0.0
+        status = ''
+        if diff > tolerance:
+            status = 'SLOWER'
+            failed.append(name)
+        elif diff < -tolerance:
+            status = 'faster'
+        print(f'{name:24} {value:10.1f} {base:10.1f} {diff:+7.1f} % {status}')
+    for name in baseline.keys() - results.keys():
+        print(f'{name:24} missing in results')
+        failed.append(name)
+    return failed
+
+
+if __name__ == '__main__':
+    parser = argparse.ArgumentParser(description=__doc__)
+    parser.add_argument('baseline')
+    parser.add_argument('results')
+    parser.add_argument('--tolerance', type=float, default=2.0, help='percent')
+    parser.add_argument('--update', action='store_true', help='store results as new baseline')
+    args = parser.parse_args()
+
+    results = read_results(args.results)
+    if args.update:
+        with open(args.baseline, 'w') as f:
+            f.write('\n'.join(HEADER + [f'{name} {value:.1f}' for name, value in results.items()]) + '\n')
+        sys.exit(0)
+
+    baseline = read_results(args.baseline)
+    if not baseline:
+        sys.exit(f'{args.baseline} is empty, store baseline by ‹make -C bench update› first')
+    failed = compare(baseline, results, args.tolerance)
+    if failed:
+        print(f'Regression (or no baseline) in: {", ".join(failed)}')
+        sys.exit(1)
@@ -0,0 +1,39 @@
+/* Backup domain: reset cause & cache of Big Relay Test result.
+ *
+ * Backup registers and RTC counter survive system resets (IWDG, NRST pin,
+ * software reset), so the last successful Big Relay Test is stored there
+ * with RTC timestamp. After such reset, a pass which is still recent (see
+ * BRTEST_NOTEST_MAX_TIME) is honoured instead of running the test again.
+ *
+ * RTC is clocked by LSI (no LSE crystal on board), which stops without VDD:
+ * the cache is dropped at power-on reset. Prescaler assumes the slowest LSI
+ * (30 kHz), so RTC second is never longer than real one and age of the
+ * pass is never underestimated.
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Cause of the last reset (flags, more could be set)
+#define RESET_POWER 0x01 // power-on/power-down reset
+#define RESET_PIN 0x02
+#define RESET_IWDG 0x04
+#define RESET_SOFTWARE 0x08
+#define RESET_WWDG 0x10
+#define RESET_LOW_POWER 0x20
+
+#define BACKUP_RTC_PRESCALER 30000 // LSI 30–60 kHz
+
+extern uint8_t backup_reset_cause; // RESET_*
+extern bool backup_rtc_started; // RTC (re)started at this boot: backup registers were lost
+
+void backup_init(void); // call before IWDG init, takes & clears reset flags
+uint32_t backup_rtc_s(void); // seconds since RTC start (LSI accuracy)
+uint16_t backup_resets(void); // since power-on
+
+// Cache of Big Relay Test result
+bool backup_brt_age(uint32_t *age_s); // false when no pass is cached
+void backup_brt_passed(void);
+void backup_brt_forget(void);
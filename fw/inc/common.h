@@ -3,4 +3,4 @@
 #pragma once
 
 #define FW_VER_MAJOR 0x01
-#define FW_VER_MINOR 0x00
+#define FW_VER_MINOR 0x02
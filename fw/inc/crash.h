@@ -0,0 +1,72 @@
+/* Post-mortem crash record.
+ *
+ * Fault handlers & error_handler store the cause, stacked registers, fault
+ * status registers, mode, Big Relay Test state and a short trail of recent
+ * events to RAM section .noinit, which the startup code does not touch, so
+ * the record survives the IWDG reset which follows. At boot, the record is
+ * taken (validated by magic & checksum, garbage after power-on is ignored)
+ * and kept for reporting to PC until the next reset.
+ *
+ * Normal path only pushes a trail entry on rare events (mode & relays
+ * change, BRT progress, received command). Pushing is not atomic: an entry
+ * pushed by interrupt in the middle of a push by main loop could be lost.
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+typedef enum {
+	crashNone = 0,
+	crashError = 1, // error_handler
+	crashNmi = 2,
+	crashHardFault = 3,
+	crashMemManage = 4,
+	crashBusFault = 5,
+	crashUsageFault = 6,
+} CrashCause;
+
+typedef enum {
+	trailMode = 1, // value: DCmode
+	trailRelays = 2, // value: both relays on
+	trailBrt = 3, // value: BRTestState << 4 | BRTestStep
+	trailCommand = 4, // value: command code received from PC
+	trailTimeout = 5, // DCC cut by heartbeat/lease timeout
+	trailPcDied = 6, // PC closed the port (DTR cleared)
+} CrashTrailEvent;
+
+#define CRASH_TRAIL_SIZE 16 // power of 2
+
+typedef struct {
+	uint16_t entries[CRASH_TRAIL_SIZE]; // event << 8 | value
+	uint8_t pos; // next entry
+} CrashTrail;
+
+typedef struct {
+	uint32_t magic;
+	uint8_t cause; // CrashCause
+	uint8_t dcmode;
+	uint8_t brt_state;
+	uint8_t brt_step;
+	uint32_t uptime_ms;
+	uint32_t frame[8]; // stacked r0, r1, r2, r3, r12, lr, pc, xPSR (error_handler: pc = caller, others 0)
+	uint32_t cfsr, hfsr, mmfar, bfar;
+	uint16_t trail[CRASH_TRAIL_SIZE]; // oldest first, 0 = empty
+	uint32_t check;
+} CrashRecord;
+
+extern CrashTrail crash_trail_ring; // .noinit
+extern CrashRecord crash_last; // taken at boot, cause == crashNone when there was no crash
+
+void crash_init(void); // call first in init
+void crash_record(CrashCause cause, const uint32_t *frame, uint32_t caller); // IRQs must be disabled
+
+static inline void crash_trail(CrashTrailEvent event, uint8_t value) {
+	uint16_t entry = (event << 8) | value;
+	uint8_t pos = crash_trail_ring.pos;
+	if (crash_trail_ring.entries[(pos-1) & (CRASH_TRAIL_SIZE-1)] == entry)
+		return; // repeated (e.g. heartbeat) would flush the trail
+	crash_trail_ring.entries[pos & (CRASH_TRAIL_SIZE-1)] = entry;
+	crash_trail_ring.pos = pos+1;
+}
@@ -0,0 +1,495 @@
+/* DC-01 ↔ PC protocol: command codes, messages & their packed encoding.
+ *
+ * Generated by sw/dc01_protogen.py from doc/protocol.json, do not edit.
+ * Encoders write message to ‹buf› & return number of bytes written,
+ * decoders return false when ‹data› are too short (longer are accepted).
+ * Multi-byte values are MSB first. Messages without data have no struct.
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define DC_CMD_PM_INFO_REQ 0x10
+#define DC_CMD_PM_SET_STATE 0x11
+#define DC_CMD_PM_PING 0x02
+#define DC_CMD_PM_LEASE 0x20
+#define DC_CMD_PM_SCOPE 0x21
+#define DC_CMD_PM_DCC_STATS 0x22
+#define DC_CMD_PM_DCC_WAVE 0x23
+#define DC_CMD_PM_BOOT_INFO 0x24
+#define DC_CMD_PM_CRASH 0x25
+#define DC_CMD_PM_HB_STATS 0x26
+
+#define DC_CMD_MP_INFO 0x10
+#define DC_CMD_MP_STATE 0x11
+#define DC_CMD_MP_BRSTATE 0x12
+#define DC_CMD_MP_LEASE 0x20
+#define DC_CMD_MP_SCOPE 0x21
+#define DC_CMD_MP_DCC_STATS 0x22
+#define DC_CMD_MP_DCC_WAVE 0x23
+#define DC_CMD_MP_BOOT_INFO 0x24
+#define DC_CMD_MP_CRASH 0x25
+#define DC_CMD_MP_HB_STATS 0x26
+
+#define DC01_INFO_REQUEST_SIZE 0
+#define DC01_SET_STATE_REQUEST_SIZE 1
+#define DC01_PING_REQUEST_SIZE 0
+#define DC01_LEASE_REQUEST_SIZE 3
+#define DC01_SCOPE_REQUEST_SIZE 1
+#define DC01_DCC_STATS_REQUEST_SIZE 0
+#define DC01_DCC_WAVE_REQUEST_SIZE 1
+#define DC01_BOOT_INFO_REQUEST_SIZE 0
+#define DC01_CRASH_REQUEST_SIZE 0
+#define DC01_HB_STATS_REQUEST_SIZE 1
+#define DC01_INFO_REPORT_SIZE 2
+#define DC01_STATE_REPORT_SIZE 3
+#define DC01_BRT_REPORT_SIZE 3
+#define DC01_LEASE_REPORT_SIZE 3
+#define DC01_SCOPE_REPORT_SIZE 60
+#define DC01_DCC_STATS_REPORT_SIZE 29
+#define DC01_DCC_WAVE_REPORT_SIZE 60
+#define DC01_BOOT_INFO_REPORT_SIZE 14
+#define DC01_CRASH_REPORT_SIZE 88
+#define DC01_HB_STATS_REPORT_SIZE 70
+
+static inline void dc01_put_u16(uint8_t *buf, uint16_t value) {
+	buf[0] = value >> 8;
+	buf[1] = value & 0xFF;
+}
+
+static inline void dc01_put_u32(uint8_t *buf, uint32_t value) {
+	buf[0] = value >> 24;
+	buf[1] = (value >> 16) & 0xFF;
+	buf[2] = (value >> 8) & 0xFF;
+	buf[3] = value & 0xFF;
+}
+
+static inline uint16_t dc01_get_u16(const uint8_t *buf) {
+	return (buf[0] << 8) | buf[1];
+}
+
+static inline uint32_t dc01_get_u32(const uint8_t *buf) {
+	return ((uint32_t)buf[0] << 24) | ((uint32_t)buf[1] << 16) | (buf[2] << 8) | buf[3];
+}
+
+typedef struct {
+	uint16_t rate; // valid packets in last second
+	uint32_t packets; // counters wrap around (32 bits)
+	uint32_t bit_errors;
+	uint32_t checksum_errors;
+} Dc01DccInputStats;
+
+// DC_CMD_PM_SET_STATE
+typedef struct {
+	bool on;
+} Dc01SetStateRequest;
+
+static inline size_t dc01_encode_set_state_request(uint8_t *buf, const Dc01SetStateRequest *msg) {
+	buf[0] = (msg->on ? 0x01 : 0);
+	return DC01_SET_STATE_REQUEST_SIZE;
+}
+
+static inline bool dc01_decode_set_state_request(const uint8_t *data, size_t size, Dc01SetStateRequest *msg) {
+	if (size < DC01_SET_STATE_REQUEST_SIZE)
+		return false;
+	msg->on = (data[0] & 0x01) != 0;
+	return true;
+}
+
+// DC_CMD_PM_LEASE
+typedef struct {
+	uint16_t duration_ms; // 0 = revoke
+	uint8_t seq;
+} Dc01LeaseRequest;
+
+static inline size_t dc01_encode_lease_request(uint8_t *buf, const Dc01LeaseRequest *msg) {
+	dc01_put_u16(&buf[0], msg->duration_ms);
+	buf[2] = msg->seq;
+	return DC01_LEASE_REQUEST_SIZE;
+}
+
+static inline bool dc01_decode_lease_request(const uint8_t *data, size_t size, Dc01LeaseRequest *msg) {
+	if (size < DC01_LEASE_REQUEST_SIZE)
+		return false;
+	msg->duration_ms = dc01_get_u16(&data[0]);
+	msg->seq = data[2];
+	return true;
+}
+
+// DC_CMD_PM_SCOPE
+typedef struct {
+	bool run;
+	bool relays;
+} Dc01ScopeRequest;
+
+static inline size_t dc01_encode_scope_request(uint8_t *buf, const Dc01ScopeRequest *msg) {
+	buf[0] = (msg->run ? 0x01 : 0) | (msg->relays ? 0x02 : 0);
+	return DC01_SCOPE_REQUEST_SIZE;
+}
+
+static inline bool dc01_decode_scope_request(const uint8_t *data, size_t size, Dc01ScopeRequest *msg) {
+	if (size < DC01_SCOPE_REQUEST_SIZE)
+		return false;
+	msg->run = (data[0] & 0x01) != 0;
+	msg->relays = (data[0] & 0x02) != 0;
+	return true;
+}
+
+// DC_CMD_PM_DCC_WAVE
+typedef struct {
+	uint8_t input; // 0 = DCC1, 1 = DCC2
+} Dc01DccWaveRequest;
+
+static inline size_t dc01_encode_dcc_wave_request(uint8_t *buf, const Dc01DccWaveRequest *msg) {
+	buf[0] = msg->input;
+	return DC01_DCC_WAVE_REQUEST_SIZE;
+}
+
+static inline bool dc01_decode_dcc_wave_request(const uint8_t *data, size_t size, Dc01DccWaveRequest *msg) {
+	if (size < DC01_DCC_WAVE_REQUEST_SIZE)
+		return false;
+	msg->input = data[0];
+	return true;
+}
+
+// DC_CMD_PM_HB_STATS
+typedef struct {
+	bool reset; // reset statistics once reported
+} Dc01HbStatsRequest;
+
+static inline size_t dc01_encode_hb_stats_request(uint8_t *buf, const Dc01HbStatsRequest *msg) {
+	buf[0] = (msg->reset ? 0x01 : 0);
+	return DC01_HB_STATS_REQUEST_SIZE;
+}
+
+static inline bool dc01_decode_hb_stats_request(const uint8_t *data, size_t size, Dc01HbStatsRequest *msg) {
+	if (size < DC01_HB_STATS_REQUEST_SIZE)
+		return false;
+	msg->reset = (data[0] & 0x01) != 0;
+	return true;
+}
+
+// DC_CMD_MP_INFO
+typedef struct {
+	uint8_t fw_major;
+	uint8_t fw_minor;
+} Dc01InfoReport;
+
+static inline size_t dc01_encode_info_report(uint8_t *buf, const Dc01InfoReport *msg) {
+	buf[0] = msg->fw_major;
+	buf[1] = msg->fw_minor;
+	return DC01_INFO_REPORT_SIZE;
+}
+
+static inline bool dc01_decode_info_report(const uint8_t *data, size_t size, Dc01InfoReport *msg) {
+	if (size < DC01_INFO_REPORT_SIZE)
+		return false;
+	msg->fw_major = data[0];
+	msg->fw_minor = data[1];
+	return true;
+}
+
+// DC_CMD_MP_STATE
+typedef struct {
+	uint8_t mode; // see operation.md
+	bool dcc_connected;
+	bool dcc_at_least_one;
+	uint8_t failure_code;
+	uint8_t warnings;
+} Dc01StateReport;
+
+static inline size_t dc01_encode_state_report(uint8_t *buf, const Dc01StateReport *msg) {
+	buf[0] = ((msg->mode & 0x07) << 4) | (msg->dcc_connected ? 0x01 : 0) | (msg->dcc_at_least_one ? 0x02 : 0);
+	buf[1] = msg->failure_code;
+	buf[2] = msg->warnings;
+	return DC01_STATE_REPORT_SIZE;
+}
+
+static inline bool dc01_decode_state_report(const uint8_t *data, size_t size, Dc01StateReport *msg) {
+	if (size < DC01_STATE_REPORT_SIZE)
+		return false;
+	msg->mode = (data[0] >> 4) & 0x07;
+	msg->dcc_connected = (data[0] & 0x01) != 0;
+	msg->dcc_at_least_one = (data[0] & 0x02) != 0;
+	msg->failure_code = data[1];
+	msg->warnings = data[2];
+	return true;
+}
+
+// DC_CMD_MP_BRSTATE
+typedef struct {
+	uint8_t state;
+	uint8_t step;
+	uint8_t error;
+} Dc01BrtReport;
+
+static inline size_t dc01_encode_brt_report(uint8_t *buf, const Dc01BrtReport *msg) {
+	buf[0] = msg->state;
+	buf[1] = msg->step;
+	buf[2] = msg->error;
+	return DC01_BRT_REPORT_SIZE;
+}
+
+static inline bool dc01_decode_brt_report(const uint8_t *data, size_t size, Dc01BrtReport *msg) {
+	if (size < DC01_BRT_REPORT_SIZE)
+		return false;
+	msg->state = data[0];
+	msg->step = data[1];
+	msg->error = data[2];
+	return true;
+}
+
+// DC_CMD_MP_LEASE
+typedef struct {
+	uint16_t granted_ms; // 0 = revoked
+	uint8_t seq;
+} Dc01LeaseReport;
+
+static inline size_t dc01_encode_lease_report(uint8_t *buf, const Dc01LeaseReport *msg) {
+	dc01_put_u16(&buf[0], msg->granted_ms);
+	buf[2] = msg->seq;
+	return DC01_LEASE_REPORT_SIZE;
+}
+
+static inline bool dc01_decode_lease_report(const uint8_t *data, size_t size, Dc01LeaseReport *msg) {
+	if (size < DC01_LEASE_REPORT_SIZE)
+		return false;
+	msg->granted_ms = dc01_get_u16(&data[0]);
+	msg->seq = data[2];
+	return true;
+}
+
+// DC_CMD_MP_SCOPE
+typedef struct {
+	uint16_t seq;
+	uint8_t flags;
+	uint8_t dropped; // packets dropped by DC-01 just before this one
+	uint8_t samples[56]; // packed, 2 or 4 bits per sample
+} Dc01ScopeReport;
+
+static inline size_t dc01_encode_scope_report(uint8_t *buf, const Dc01ScopeReport *msg) {
+	dc01_put_u16(&buf[0], msg->seq);
+	buf[2] = msg->flags;
+	buf[3] = msg->dropped;
+	for (size_t i = 0; i < 56; i++)
+		buf[4+i] = msg->samples[i];
+	return DC01_SCOPE_REPORT_SIZE;
+}
+
+static inline bool dc01_decode_scope_report(const uint8_t *data, size_t size, Dc01ScopeReport *msg) {
+	if (size < DC01_SCOPE_REPORT_SIZE)
+		return false;
+	msg->seq = dc01_get_u16(&data[0]);
+	msg->flags = data[2];
+	msg->dropped = data[3];
+	for (size_t i = 0; i < 56; i++)
+		msg->samples[i] = data[4+i];
+	return true;
+}
+
+// DC_CMD_MP_DCC_STATS
+typedef struct {
+	bool present[2]; // DCC1, DCC2
+	bool require_packets;
+	Dc01DccInputStats inputs[2];
+} Dc01DccStatsReport;
+
+static inline size_t dc01_encode_dcc_stats_report(uint8_t *buf, const Dc01DccStatsReport *msg) {
+	buf[0] = (msg->present[0] ? 0x01 : 0) | (msg->present[1] ? 0x02 : 0) | (msg->require_packets ? 0x80 : 0);
+	for (size_t i = 0; i < 2; i++) {
+		dc01_put_u16(&buf[1+14*i+0], msg->inputs[i].rate);
+		dc01_put_u32(&buf[1+14*i+2], msg->inputs[i].packets);
+		dc01_put_u32(&buf[1+14*i+6], msg->inputs[i].bit_errors);
+		dc01_put_u32(&buf[1+14*i+10], msg->inputs[i].checksum_errors);
+	}
+	return DC01_DCC_STATS_REPORT_SIZE;
+}
+
+static inline bool dc01_decode_dcc_stats_report(const uint8_t *data, size_t size, Dc01DccStatsReport *msg) {
+	if (size < DC01_DCC_STATS_REPORT_SIZE)
+		return false;
+	msg->present[0] = (data[0] & 0x01) != 0;
+	msg->present[1] = (data[0] & 0x02) != 0;
+	msg->require_packets = (data[0] & 0x80) != 0;
+	for (size_t i = 0; i < 2; i++) {
+		msg->inputs[i].rate = dc01_get_u16(&data[1+14*i+0]);
+		msg->inputs[i].packets = dc01_get_u32(&data[1+14*i+2]);
+		msg->inputs[i].bit_errors = dc01_get_u32(&data[1+14*i+6]);
+		msg->inputs[i].checksum_errors = dc01_get_u32(&data[1+14*i+10]);
+	}
+	return true;
+}
+
+// DC_CMD_MP_DCC_WAVE
+typedef struct {
+	uint8_t input; // 0 = DCC1, 1 = DCC2
+	bool present; // edges are coming
+	uint16_t frequency; // falling edges in last second [Hz]
+	uint16_t low_permille;
+	uint16_t cutout_us; // last RailCom cutout
+	uint32_t cutouts; // counters wrap around (32 bits)
+	uint32_t losses;
+	uint32_t lost_ms;
+	uint32_t loss_ms; // current or last loss
+	uint32_t edge_overruns;
+	uint32_t half_periods[8]; // histogram of half-periods, bins in protocol.md
+} Dc01DccWaveReport;
+
+static inline size_t dc01_encode_dcc_wave_report(uint8_t *buf, const Dc01DccWaveReport *msg) {
+	buf[0] = msg->input;
+	buf[1] = (msg->present ? 0x01 : 0);
+	dc01_put_u16(&buf[2], msg->frequency);
+	dc01_put_u16(&buf[4], msg->low_permille);
+	dc01_put_u16(&buf[6], msg->cutout_us);
+	dc01_put_u32(&buf[8], msg->cutouts);
+	dc01_put_u32(&buf[12], msg->losses);
+	dc01_put_u32(&buf[16], msg->lost_ms);
+	dc01_put_u32(&buf[20], msg->loss_ms);
+	dc01_put_u32(&buf[24], msg->edge_overruns);
+	for (size_t i = 0; i < 8; i++)
+		dc01_put_u32(&buf[28+4*i], msg->half_periods[i]);
+	return DC01_DCC_WAVE_REPORT_SIZE;
+}
+
+static inline bool dc01_decode_dcc_wave_report(const uint8_t *data, size_t size, Dc01DccWaveReport *msg) {
+	if (size < DC01_DCC_WAVE_REPORT_SIZE)
+		return false;
+	msg->input = data[0];
+	msg->present = (data[1] & 0x01) != 0;
+	msg->frequency = dc01_get_u16(&data[2]);
+	msg->low_permille = dc01_get_u16(&data[4]);
+	msg->cutout_us = dc01_get_u16(&data[6]);
+	msg->cutouts = dc01_get_u32(&data[8]);
+	msg->losses = dc01_get_u32(&data[12]);
+	msg->lost_ms = dc01_get_u32(&data[16]);
+	msg->loss_ms = dc01_get_u32(&data[20]);
+	msg->edge_overruns = dc01_get_u32(&data[24]);
+	for (size_t i = 0; i < 8; i++)
+		msg->half_periods[i] = dc01_get_u32(&data[28+4*i]);
+	return true;
+}
+
+// DC_CMD_MP_BOOT_INFO
+typedef struct {
+	uint8_t reset_cause; // flags, see protocol.md
+	bool brt_honoured; // cached Big Relay Test pass honoured at boot
+	bool rtc_started; // backup domain was lost
+	uint16_t resets; // since power-on
+	uint16_t ready_ms;
+	uint32_t dcc_on_ms; // 0 = DCC not yet on
+	uint32_t brt_age_s; // 0xFFFFFFFF = no pass cached
+} Dc01BootInfoReport;
+
+static inline size_t dc01_encode_boot_info_report(uint8_t *buf, const Dc01BootInfoReport *msg) {
+	buf[0] = msg->reset_cause;
+	buf[1] = (msg->brt_honoured ? 0x01 : 0) | (msg->rtc_started ? 0x02 : 0);
+	dc01_put_u16(&buf[2], msg->resets);
+	dc01_put_u16(&buf[4], msg->ready_ms);
+	dc01_put_u32(&buf[6], msg->dcc_on_ms);
+	dc01_put_u32(&buf[10], msg->brt_age_s);
+	return DC01_BOOT_INFO_REPORT_SIZE;
+}
+
+static inline bool dc01_decode_boot_info_report(const uint8_t *data, size_t size, Dc01BootInfoReport *msg) {
+	if (size < DC01_BOOT_INFO_REPORT_SIZE)
+		return false;
+	msg->reset_cause = data[0];
+	msg->brt_honoured = (data[1] & 0x01) != 0;
+	msg->rtc_started = (data[1] & 0x02) != 0;
+	msg->resets = dc01_get_u16(&data[2]);
+	msg->ready_ms = dc01_get_u16(&data[4]);
+	msg->dcc_on_ms = dc01_get_u32(&data[6]);
+	msg->brt_age_s = dc01_get_u32(&data[10]);
+	return true;
+}
+
+// DC_CMD_MP_CRASH
+typedef struct {
+	uint8_t cause; // 0 = no crash before the last reset
+	uint8_t dcmode;
+	uint8_t brt_state;
+	uint8_t brt_step;
+	uint32_t uptime_ms;
+	uint32_t frame[8]; // stacked r0, r1, r2, r3, r12, lr, pc, xPSR
+	uint32_t cfsr;
+	uint32_t hfsr;
+	uint32_t mmfar;
+	uint32_t bfar;
+	uint16_t trail[16]; // event << 8 | value, oldest first, 0 = empty
+} Dc01CrashReport;
+
+static inline size_t dc01_encode_crash_report(uint8_t *buf, const Dc01CrashReport *msg) {
+	buf[0] = msg->cause;
+	buf[1] = msg->dcmode;
+	buf[2] = msg->brt_state;
+	buf[3] = msg->brt_step;
+	dc01_put_u32(&buf[4], msg->uptime_ms);
+	for (size_t i = 0; i < 8; i++)
+		dc01_put_u32(&buf[8+4*i], msg->frame[i]);
+	dc01_put_u32(&buf[40], msg->cfsr);
+	dc01_put_u32(&buf[44], msg->hfsr);
+	dc01_put_u32(&buf[48], msg->mmfar);
+	dc01_put_u32(&buf[52], msg->bfar);
+	for (size_t i = 0; i < 16; i++)
+		dc01_put_u16(&buf[56+2*i], msg->trail[i]);
+	return DC01_CRASH_REPORT_SIZE;
+}
+
+static inline bool dc01_decode_crash_report(const uint8_t *data, size_t size, Dc01CrashReport *msg) {
+	if (size < DC01_CRASH_REPORT_SIZE)
+		return false;
+	msg->cause = data[0];
+	msg->dcmode = data[1];
+	msg->brt_state = data[2];
+	msg->brt_step = data[3];
+	msg->uptime_ms = dc01_get_u32(&data[4]);
+	for (size_t i = 0; i < 8; i++)
+		msg->frame[i] = dc01_get_u32(&data[8+4*i]);
+	msg->cfsr = dc01_get_u32(&data[40]);
+	msg->hfsr = dc01_get_u32(&data[44]);
+	msg->mmfar = dc01_get_u32(&data[48]);
+	msg->bfar = dc01_get_u32(&data[52]);
+	for (size_t i = 0; i < 16; i++)
+		msg->trail[i] = dc01_get_u16(&data[56+2*i]);
+	return true;
+}
+
+// DC_CMD_MP_HB_STATS
+typedef struct {
+	uint32_t heartbeats;
+	uint32_t worst_gap_ms;
+	uint16_t min_margin_ms; // 0 = timed out, 0xFFFF = no gap yet
+	uint32_t warnings; // timeout warnings raised
+	uint32_t timeouts;
+	uint32_t period_ms; // since reset of statistics
+	uint32_t gaps[12]; // histogram of heartbeat gaps, bins in protocol.md
+} Dc01HbStatsReport;
+
+static inline size_t dc01_encode_hb_stats_report(uint8_t *buf, const Dc01HbStatsReport *msg) {
+	dc01_put_u32(&buf[0], msg->heartbeats);
+	dc01_put_u32(&buf[4], msg->worst_gap_ms);
+	dc01_put_u16(&buf[8], msg->min_margin_ms);
+	dc01_put_u32(&buf[10], msg->warnings);
+	dc01_put_u32(&buf[14], msg->timeouts);
+	dc01_put_u32(&buf[18], msg->period_ms);
+	for (size_t i = 0; i < 12; i++)
+		dc01_put_u32(&buf[22+4*i], msg->gaps[i]);
+	return DC01_HB_STATS_REPORT_SIZE;
+}
+
+static inline bool dc01_decode_hb_stats_report(const uint8_t *data, size_t size, Dc01HbStatsReport *msg) {
+	if (size < DC01_HB_STATS_REPORT_SIZE)
+		return false;
+	msg->heartbeats = dc01_get_u32(&data[0]);
+	msg->worst_gap_ms = dc01_get_u32(&data[4]);
+	msg->min_margin_ms = dc01_get_u16(&data[8]);
+	msg->warnings = dc01_get_u32(&data[10]);
+	msg->timeouts = dc01_get_u32(&data[14]);
+	msg->period_ms = dc01_get_u32(&data[18]);
+	for (size_t i = 0; i < 12; i++)
+		msg->gaps[i] = dc01_get_u32(&data[22+4*i]);
+	return true;
+}
@@ -0,0 +1,23 @@
+/* Parsing of packets PC → DC-01 (see doc/protocol.md).
+ *
+ * Parser works on a plain buffer and reports packets via callback, it has no
+ * dependency on USB, so it could be benchmarked off-target (bench/).
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define DC_FRAME_MAGIC1 0x37
+#define DC_FRAME_MAGIC2 0xE2
+#define DC_FRAME_HEADER_SIZE 3 // magic + length
+#define DC_FRAME_MAX_LENGTH 123 // command code + data
+
+typedef void (*DcFrameHandler)(uint8_t command_code, uint8_t *data, size_t data_size);
+
+// Calls ‹handler› for each complete packet in buf[0:*size] & moves the last
+// unfinished packet to the beginning of ‹buf› (*size is updated). Returns
+// false on invalid data; whole buffer is dropped (*size = 0) in such case.
+bool dc_frame_parse(uint8_t *buf, size_t *size, DcFrameHandler handler);
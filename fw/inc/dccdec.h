@@ -0,0 +1,66 @@
+/* DCC packet decoder (NMRA S-9.1, S-9.2).
+ *
+ * Decoder is fed by timestamps of edges of DCC input (timer input capture,
+ * 1 us resolution). Half-periods are classified as '1' (52–64 us) or '0'
+ * (90–10000 us) halves, packets (preamble of at least 10 '1' bits, bytes
+ * separated by '0' bits, '1' end bit) are assembled and their checksum
+ * (XOR of all bytes) is checked. Only statistics are kept, packets are not
+ * interpreted.
+ *
+ * All functions except dccdec_present are expected to be called from the
+ * same context (main loop, edges are buffered by edges.h).
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define DCCDEC_ONE_MIN_US 52
+#define DCCDEC_ONE_MAX_US 64
+#define DCCDEC_ZERO_MIN_US 90
+#define DCCDEC_ZERO_MAX_US 10000
+#define DCCDEC_PREAMBLE_HALVES 20 // 10 '1' bits
+#define DCCDEC_MAX_PACKET_SIZE 6 // including checksum byte
+#define DCCDEC_MIN_PACKET_SIZE 3
+#define DCCDEC_LOST_MS 20 // no edge for this time → signal lost
+#define DCCDEC_PRESENT_MS 100 // valid packet within this time → DCC present
+
+typedef enum {
+	dccdsLost = 0,
+	dccdsPreamble = 1,
+	dccdsStartBit = 2,
+	dccdsData = 3,
+} DccDecState;
+
+typedef struct {
+	uint32_t packets; // valid packets
+	uint32_t bit_errors; // half-period out of spec, halves of bit differ, too long packet
+	uint32_t checksum_errors;
+	uint16_t rate; // valid packets in last second
+} DccDecStats;
+
+typedef struct {
+	DccDecState state;
+	uint16_t last_edge; // timestamp [us]
+	uint8_t preamble; // number of consecutive '1' halves
+	bool packet_end; // previous half ended packet, RailCom cutout could follow
+	bool half; // first half of bit received
+	bool first_half_one;
+	uint8_t bits; // bits of current byte received; 8 = separator/end bit expected
+	uint8_t byte;
+	uint8_t size;
+	uint8_t packet[DCCDEC_MAX_PACKET_SIZE];
+	uint16_t ms_since_edge;
+	uint16_t ms_since_packet;
+	uint16_t ms_rate;
+	uint32_t packets_rate_start;
+	DccDecStats stats;
+} DccDecoder;
+
+void dccdec_init(DccDecoder *dec);
+void dccdec_edge(DccDecoder *dec, uint16_t timestamp_us);
+void dccdec_resync(DccDecoder *dec); // edges were lost
+void dccdec_update_1ms(DccDecoder *dec);
+bool dccdec_present(const DccDecoder *dec); // valid packet received recently
@@ -0,0 +1,62 @@
+/* DCC waveform quality metrics.
+ *
+ * Metrics are computed from timestamped edges of DCC input (edges.h):
+ * frequency & ratio of low level over last second, histogram of
+ * half-periods, RailCom cutouts and signal losses. They help to spot
+ * degrading boosters or wiring before DCC decoding fails.
+ *
+ * Input is pulled up and low when current flows through it, so RailCom
+ * cutout (no current) is a long high half-period.
+ *
+ * dccwave_edge & dccwave_update_1ms are expected to be called from the same
+ * context (main loop).
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "edges.h"
+
+#define DCCWAVE_CUTOUT_MIN_US 380 // NMRA S-9.3.2: cutout ends 454–488 us after end bit,
+#define DCCWAVE_CUTOUT_MAX_US 560 // input follows it within end bit's halves
+#define DCCWAVE_LOST_MS 20 // no edge for this time → signal lost (as DCCDEC_LOST_MS)
+
+// Half-period histogram bins (NMRA S-9.1: decoder accepts '1' 52–64 us &
+// '0' 90–10000 us, command station sends '1' 55–61 us & '0' 95–9900 us)
+#define DCCWAVE_BIN_SHORT 0 // < 52 us
+#define DCCWAVE_BIN_ONE_SHORT 1 // 52–54 us
+#define DCCWAVE_BIN_ONE 2 // 55–61 us
+#define DCCWAVE_BIN_ONE_LONG 3 // 62–64 us
+#define DCCWAVE_BIN_INVALID 4 // 65–89 us
+#define DCCWAVE_BIN_ZERO_SHORT 5 // 90–94 us
+#define DCCWAVE_BIN_ZERO 6 // 95–9900 us
+#define DCCWAVE_BIN_LONG 7 // > 9900 us
+#define DCCWAVE_BINS 8
+
+typedef struct {
+	uint16_t frequency; // falling edges in last second [Hz]
+	uint16_t low_permille; // input was low for this part of last second [‰]
+	uint16_t cutout_us; // length of last RailCom cutout
+	uint32_t cutouts;
+	uint32_t losses; // signal was lost after it had been present
+	uint32_t lost_ms; // total time of losses
+	uint32_t loss_ms; // length of current (or last) loss
+	uint32_t halves[DCCWAVE_BINS]; // histogram of half-periods
+} DccWaveStats;
+
+typedef struct {
+	bool present; // edges are coming
+	bool synced; // last_edge is valid
+	uint16_t last_edge; // timestamp [us]
+	uint16_t ms_since_edge;
+	uint16_t ms_window;
+	uint16_t window_falling;
+	uint32_t window_low_us;
+	uint32_t window_us;
+	DccWaveStats stats;
+} DccWave;
+
+void dccwave_init(DccWave *wave);
+void dccwave_edge(DccWave *wave, const Edge *edge);
+void dccwave_update_1ms(DccWave *wave);
@@ -1,4 +1,5 @@
-/* Inputs debouncing. */
+/* Inputs debouncing (buttons). Presence of DCC is detected from edges
+ * captured by TIM3 (dccwave.h), DCC inputs are not polled. */
 
 #pragma once
 
@@ -15,20 +16,21 @@ typedef struct {
 	bool state;
 } DebouncePin;
 
-#define DEBOUNCED_COUNT 5
+#define DEBOUNCED_COUNT 3
 
 extern DebouncePin debounced[DEBOUNCED_COUNT];
 
 #define DEB_BTN_GO 0
 #define DEB_BTN_STOP 1
 #define DEB_BTN_OVERRIDE 2
-#define DEB_DCC1 3
-#define DEB_DCC2 4
 
 void debounce_on_fall(PinDef pin);
 void debounce_on_raise(PinDef pin);
 
 void debounce_init();
 
-// This function should be called each 100 us
+// Updates after debounce_init until state of all inputs is valid
+#define DEBOUNCE_SETTLE_UPDATES 10
+
+// This function should be called each 1 ms
 void debounce_update();
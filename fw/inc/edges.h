@@ -0,0 +1,42 @@
+/* Ring buffers of timestamped edges of DCC inputs.
+ *
+ * Edges are pushed by timer input capture interrupt and processed (DCC
+ * decoder, waveform metrics) in the main loop, so the interrupt stays short.
+ * There is a single producer (interrupt, writes head) and a single consumer
+ * (main loop, writes tail). When the ring is full or the timer reports
+ * overcapture, edges are lost and the next pushed edge is marked by EDGE_GAP,
+ * so consumers resynchronize instead of measuring a bogus half-period.
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#define EDGES_RING_SIZE 64 // power of 2 (≤ 256), ~3.7 ms of '1' bits
+
+// Edge flags
+#define EDGE_LOW 0x01 // falling edge: input is low after it
+#define EDGE_GAP 0x02 // edges were lost before this one
+
+typedef struct {
+	uint16_t timestamp; // [us]
+	uint8_t flags;
+} Edge;
+
+typedef struct {
+	volatile Edge buf[EDGES_RING_SIZE];
+	volatile uint8_t head; // written by interrupt only
+	volatile uint8_t tail; // written by main loop only
+	bool gap;
+	volatile uint32_t lost; // number of events edges were lost at (ring full, overcapture)
+} EdgeRing;
+
+void edges_init(EdgeRing *ring);
+
+// Call from interrupt
+void edges_push(EdgeRing *ring, uint16_t timestamp_us, bool low);
+void edges_lost(EdgeRing *ring); // edge missed by hardware
+
+// Call from main loop
+bool edges_pop(EdgeRing *ring, Edge *edge); // returns false when empty
@@ -0,0 +1,94 @@
+/* Event flags set by interrupts & taken by main loop.
+ *
+ * Flags are bits of a 32-bit word in SRAM accessed through Cortex-M3
+ * bit-band alias: each bit has its own word address and a write to it is
+ * a single atomic bus transaction. Setting a flag in an interrupt thus never
+ * races with clearing another flag in main loop (read-modify-write of
+ * a bitfield union would store the flag set in between back as cleared).
+ *
+ * events_take tests & clears a flag. It is meant for single consumer (main
+ * loop): the flag set by an interrupt between the test & the clear is
+ * coalesced with the event being taken, which is handled after the take, so
+ * no event is lost. Consumer must handle the event after taking it, not
+ * before (and set it again when it could not be handled now).
+ *
+ * Host builds of modules (no bit-band) use atomic builtins instead.
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+typedef volatile uint32_t Events; // must be placed in SRAM (bit-band region)
+
+#define EVENTS_SRAM_BASE 0x20000000
+#define EVENTS_BITBAND_BASE 0x22000000
+
+#define EVENT_BIT(event) (1UL << (event))
+
+#ifdef __ARM_ARCH_7M__
+
+static inline volatile uint32_t* events_alias(Events *events, uint8_t event) {
+	return (volatile uint32_t*)(EVENTS_BITBAND_BASE + (((uint32_t)events - EVENTS_SRAM_BASE) << 5) + (event << 2));
+}
+
+static inline void events_set(Events *events, uint8_t event) {
+	*events_alias(events, event) = 1;
+}
+
+static inline void events_clear(Events *events, uint8_t event) {
+	*events_alias(events, event) = 0;
+}
+
+static inline bool events_take(Events *events, uint8_t event) {
+	volatile uint32_t *alias = events_alias(events, event);
+	if (!*alias)
+		return false;
+	*alias = 0;
+	return true;
+}
+
+// Sleeps until any of flags in ‹mask› is set, returns these flags (not taken).
+static inline uint32_t events_wait_any(Events *events, uint32_t mask) {
+	while (true) {
+		// Interrupts are masked between the test & WFI, so the event cannot come
+		// unnoticed in between; pending interrupt wakes up WFI even when masked.
+		__asm__ volatile ("cpsid i" ::: "memory");
+		uint32_t pending = *events & mask;
+		if (pending == 0)
+			__asm__ volatile ("wfi");
+		__asm__ volatile ("cpsie i" ::: "memory");
+		if (pending != 0)
+			return pending;
+	}
+}
+
+#else
+
+static inline void events_set(Events *events, uint8_t event) {
+	__atomic_fetch_or(events, EVENT_BIT(event), __ATOMIC_SEQ_CST);
+}
+
+static inline void events_clear(Events *events, uint8_t event) {
+	__atomic_fetch_and(events, ~EVENT_BIT(event), __ATOMIC_SEQ_CST);
+}
+
+static inline bool events_take(Events *events, uint8_t event) {
+	if (!(*events & EVENT_BIT(event)))
+		return false;
+	events_clear(events, event);
+	return true;
+}
+
+static inline uint32_t events_wait_any(Events *events, uint32_t mask) {
+	uint32_t pending;
+	while ((pending = *events & mask) == 0);
+	return pending;
+}
+
+#endif
+
+static inline bool events_test(const Events *events, uint8_t event) {
+	return (*events & EVENT_BIT(event)) != 0;
+}
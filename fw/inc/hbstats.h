@@ -0,0 +1,38 @@
+/* Heartbeat statistics.
+ *
+ * Inter-arrival times of heartbeats from PC (SET_STATE 1 or granted lease)
+ * are collected to a histogram with log2 bins, together with the worst gap,
+ * the least margin left to DCC-on timeout and counters of timeout warnings
+ * & timeouts. PC load & timeouts of a layout can be tuned against data
+ * measured by DC-01 itself.
+ *
+ * Gap after heartbeat was stopped (SET_STATE 0, revoked lease, PC closed
+ * the port) is not measured. All functions are called from USB & TIM4
+ * interrupts, which have the same priority (no preemption).
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#define HBSTATS_BINS 12 // < 8, 8–15, 16–31, …, 4096–8191, >= 8192 ms
+#define HBSTATS_BIN0_MS 8
+#define HBSTATS_NO_MARGIN 0xFFFF
+
+typedef struct {
+	uint32_t heartbeats;
+	uint32_t worst_gap_ms;
+	uint16_t min_margin_ms; // least time left to timeout at heartbeat (0 = timed out), HBSTATS_NO_MARGIN = none
+	uint32_t warnings; // timeout warnings raised
+	uint32_t timeouts; // DCC cut by timeout
+	uint32_t since_ms; // tick of reset
+	uint32_t gaps[HBSTATS_BINS];
+} HbStats;
+
+extern HbStats hbstats;
+
+void hbstats_reset(uint32_t now_ms);
+void hbstats_heartbeat(uint32_t now_ms, uint32_t timer_ms, uint32_t timeout_ms); // before DCC-on timer is renewed
+void hbstats_stop(void);
+uint8_t hbstats_bin(uint32_t gap_ms);
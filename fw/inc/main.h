@@ -32,6 +32,19 @@ extern volatile Warnings warnings;
 #define DCCON_WARNING_MS 500
 #define DCCON_TIMEOUT_MS 2000
 
+// Lease requested by PC is clamped to this range
+#define LEASE_MIN_MS 200
+#define LEASE_MAX_MS 5000
+
+// DCC decoders of inputs (dccdec.h)
+#define DCCDEC_DCC1 0
+#define DCCDEC_DCC2 1
+#define DCCDEC_COUNT 2
+
+// Input is considered DCC only when valid DCC packets are decoded,
+// otherwise any edges at input are considered DCC.
+#define DCC_REQUIRE_PACKETS false
+
 #define BRTEST_NOTEST_MAX_TIME (10) // seconds
 #define ALERT_TIME (1000) // milliseconds
 
@@ -41,6 +54,7 @@ void appl_set_relays(bool state);
 bool is_dcc_connected(void);
 bool is_dcc_pc_alive(void);
 
+bool dcc_present(size_t input); // DCCDEC_DCC1/2
 bool dcc_at_least_one(void);
 bool dcc_just_single(void);
 bool dcc_both(void);
@@ -0,0 +1,34 @@
+/* DCC "scope": raw samples of DCC inputs streamed to PC.
+ *
+ * scope_sample is called from TIM2 interrupt (each 100 us) and packs raw
+ * levels of DCC1 & DCC2 inputs (optionally with relay states) into a packet
+ * buffer. There are two buffers: interrupt fills one of them while the other
+ * one waits for USB. When the main loop does not manage to send the packet
+ * before the next one is filled, the new packet is dropped, but its sequence
+ * number is consumed, so PC detects the loss.
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "gpio.h"
+
+#define SCOPE_SAMPLE_PERIOD_US 100
+#define SCOPE_HEADER_SIZE 4 // sequence number (2 B), flags, dropped packets
+#define SCOPE_SAMPLES_SIZE 56 // whole packet fits to single 64-byte USB packet
+#define SCOPE_PACKET_SIZE (SCOPE_HEADER_SIZE+SCOPE_SAMPLES_SIZE)
+
+// Flags
+#define SCOPE_RUN 0x01
+#define SCOPE_RELAYS 0x02 // 4 bits per sample (DCC1, DCC2, relay1, relay2), 2 bits otherwise
+
+void scope_start(uint8_t flags);
+void scope_stop(void);
+bool scope_running(void);
+
+void scope_sample(bool relay1, bool relay2); // call from TIM2 interrupt
+
+bool scope_ready(void);
+const uint8_t *scope_packet(void); // valid when scope_ready()
+void scope_sent(void);
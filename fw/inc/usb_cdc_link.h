@@ -4,6 +4,8 @@
 
 #include "stm32.h"
 #include "usb.h"
+#include "usb_cdc.h"
+#include "dc01_proto.h"
 
 #define CDC_EP0_SIZE 0x08
 #define CDC_MAIN_RXD_EP 0x01
@@ -14,7 +16,8 @@
 #define CDC_DEBUG_NTF_EP 0x85
 
 #define CDC_DATA_SZ 0x40
-#define CDC_NTF_SZ 0x08
+#define CDC_NTF_SZ 0x10 // SERIAL_STATE notification has 10 bytes
+#define CDC_MAIN_NTF_INTERVAL 0x01 // ms, polling of main notification endpoint by host
 #define CDC_DC_BUF_SIZE 0x80
 
 typedef union {
@@ -29,6 +32,7 @@ typedef union {
 } CdcTxData;
 
 extern CdcTxData cdc_tx;
+
 extern volatile bool cdc_dtr_ready; // if computer reads data
 
 // Events:
@@ -40,17 +44,17 @@ bool cdc_is_debug_ep_enabled();
 bool cdc_main_can_send(void);
 bool cdc_main_send_copy(uint8_t command_code, uint8_t *data, size_t datasize);
 bool cdc_main_send_nocopy(uint8_t command_code, size_t datasize);
+void cdc_main_serial_state(uint16_t state); // CDC_STATE_* bits, sent on change only
 void cdc_main_died(void);
 
 int cdc_debug_send(uint8_t *data, size_t datasize);
 
-#define DC_CMD_PM_INFO_REQ 0x10
-#define DC_CMD_PM_SET_STATE 0x11
-#define DC_CMD_PM_PING 0x02
+// Serial state of main interface (host sees it as modem lines), see doc/protocol.md
+#define CDC_STATE_DCC_CONNECTED USB_CDC_STATE_RX_CARRIER // DCD
+#define CDC_STATE_OK USB_CDC_STATE_TX_CARRIER // DSR: mode is not mFailure
+#define CDC_STATE_TIMEOUT_WARNING USB_CDC_STATE_RING // RI: heartbeat/lease is about to expire
 
-#define DC_CMD_MP_INFO 0x10
-#define DC_CMD_MP_STATE 0x11
-#define DC_CMD_MP_BRSTATE 0x12
+// Command codes & message codecs: dc01_proto.h (generated from doc/protocol.json)
 
 #define DC_ERROR_NO_RESPONSE 0x01
 #define DC_ERROR_FULL_BUFFER 0x02
@@ -0,0 +1,121 @@
+/* Backup domain implementation
+ * See backup.h for more information.
+ */
+
+#include "backup.h"
+#include "stm32.h"
+#include "stm32f1xx_hal.h"
+
+// Backup registers (16 bits each)
+#define BKP_LAYOUT BKP->DR1 // BKP_MAGIC when registers below are valid
+#define BKP_RESETS BKP->DR2 // resets since power-on
+#define BKP_BRT_FLAG BKP->DR3 // BKP_BRT_PASSED when BKP_BRT_TIME_* is valid
+#define BKP_BRT_TIME_HIGH BKP->DR4 // RTC of the last successful BRT
+#define BKP_BRT_TIME_LOW BKP->DR5
+
+#define BKP_MAGIC 0xDC01
+#define BKP_BRT_PASSED 0xB27A
+
+uint8_t backup_reset_cause;
+bool backup_rtc_started;
+
+/* Private function prototypes -----------------------------------------------*/
+
+static uint8_t _reset_cause(void);
+static void _rtc_start(void);
+
+/* Code ----------------------------------------------------------------------*/
+
+void backup_init(void) {
+	__HAL_RCC_BKP_CLK_ENABLE(); // PWR clock is enabled by clock_init
+	HAL_PWR_EnableBkUpAccess();
+	backup_reset_cause = _reset_cause();
+
+	__HAL_RCC_LSI_ENABLE(); // IWDG would enable it later anyway
+	_WBS(RCC->CSR, RCC_CSR_LSIRDY);
+
+	backup_rtc_started = ((BKP_LAYOUT != BKP_MAGIC) || (!(RCC->BDCR & RCC_BDCR_RTCEN)) ||
+	                      ((RCC->BDCR & RCC_BDCR_RTCSEL) != RCC_BDCR_RTCSEL_LSI));
+	if (backup_rtc_started) {
+		_rtc_start();
+	} else if (backup_reset_cause & RESET_POWER) {
+		// VBAT kept registers, but LSI (RTC) stopped meanwhile
+		BKP_BRT_FLAG = 0;
+		BKP_RESETS = 0;
+	} else {
+		BKP_RESETS++;
+	}
+
+	// Counter registers are valid after synchronization with RTC clock
+	_BCL(RTC->CRL, RTC_CRL_RSF);
+	_WBS(RTC->CRL, RTC_CRL_RSF);
+}
+
+uint8_t _reset_cause(void) {
+	uint32_t csr = RCC->CSR;
+	_BST(RCC->CSR, RCC_CSR_RMVF);
+	return ((csr & RCC_CSR_PORRSTF) ? RESET_POWER : 0) |
+	       ((csr & RCC_CSR_PINRSTF) ? RESET_PIN : 0) |
+	       ((csr & RCC_CSR_IWDGRSTF) ? RESET_IWDG : 0) |
+	       ((csr & RCC_CSR_SFTRSTF) ? RESET_SOFTWARE : 0) |
+	       ((csr & RCC_CSR_WWDGRSTF) ? RESET_WWDG : 0) |
+	       ((csr & RCC_CSR_LPWRRSTF) ? RESET_LOW_POWER : 0);
+}
+
+void _rtc_start(void) {
+	// RTC clock source could be changed only after reset of backup domain
+	__HAL_RCC_BACKUPRESET_FORCE();
+	__HAL_RCC_BACKUPRESET_RELEASE();
+	_BST(RCC->BDCR, RCC_BDCR_RTCSEL_LSI | RCC_BDCR_RTCEN);
+
+	_WBS(RTC->CRL, RTC_CRL_RTOFF);
+	_BST(RTC->CRL, RTC_CRL_CNF);
+	RTC->PRLH = 0;
+	RTC->PRLL = BACKUP_RTC_PRESCALER-1;
+	RTC->CNTH = 0;
+	RTC->CNTL = 0;
+	_BCL(RTC->CRL, RTC_CRL_CNF);
+	_WBS(RTC->CRL, RTC_CRL_RTOFF);
+
+	BKP_RESETS = 0;
+	BKP_BRT_FLAG = 0;
+	BKP_LAYOUT = BKP_MAGIC;
+}
+
+uint32_t backup_rtc_s(void) {
+	uint16_t high = RTC->CNTH;
+	uint16_t low = RTC->CNTL;
+	if (RTC->CNTH != high) { // low half wrapped meanwhile
+		high = RTC->CNTH;
+		low = RTC->CNTL;
+	}
+	return ((uint32_t)high << 16) | low;
+}
+
+uint16_t backup_resets(void) {
+	return BKP_RESETS;
+}
+
+bool backup_brt_age(uint32_t *age_s) {
+	if (BKP_BRT_FLAG != BKP_BRT_PASSED)
+		return false;
+	uint32_t passed = ((uint32_t)BKP_BRT_TIME_HIGH << 16) | BKP_BRT_TIME_LOW;
+	uint32_t now = backup_rtc_s();
+	if (now < passed)
+		return false;
+	*age_s = now - passed;
+	return true;
+}
+
+void backup_brt_passed(void) {
+	// Flag is written last, reset in the middle leaves the cache invalid
+	uint32_t now = backup_rtc_s();
+	BKP_BRT_FLAG = 0;
+	BKP_BRT_TIME_HIGH = now >> 16;
+	BKP_BRT_TIME_LOW = now & 0xFFFF;
+	BKP_BRT_FLAG = BKP_BRT_PASSED;
+}
+
+void backup_brt_forget(void) {
+	BKP_BRT_FLAG = 0;
+}
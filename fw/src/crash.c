@@ -0,0 +1,71 @@
+/* Post-mortem crash record implementation
+ * See crash.h for more information.
+ */
+
+#include <stddef.h>
+#include <string.h>
+#include "crash.h"
+#include "main.h"
+#include "selftest.h"
+
+#define CRASH_MAGIC 0xDC01C4A5
+#define RAM_START 0x20000000
+
+extern uint32_t _estack; // end of RAM (linker script)
+
+CrashTrail crash_trail_ring __attribute__((section(".noinit")));
+static CrashRecord _record __attribute__((section(".noinit")));
+CrashRecord crash_last;
+
+_Static_assert(offsetof(CrashRecord, check) % sizeof(uint32_t) == 0, "checksum covers whole words");
+
+/* Private function prototypes -----------------------------------------------*/
+
+static uint32_t _checksum(const CrashRecord *record);
+
+/* Code ----------------------------------------------------------------------*/
+
+void crash_init(void) {
+	if ((_record.magic == CRASH_MAGIC) && (_record.check == _checksum(&_record)))
+		crash_last = _record;
+	else
+		crash_last.cause = crashNone;
+	_record.magic = 0;
+	memset(&crash_trail_ring, 0, sizeof(crash_trail_ring));
+}
+
+void crash_record(CrashCause cause, const uint32_t *frame, uint32_t caller) {
+	_record.cause = cause;
+	_record.dcmode = dcmode;
+	_record.brt_state = brTestState;
+	_record.brt_step = brTestStep;
+	_record.uptime_ms = HAL_GetTick();
+
+	// Corrupted stack pointer (e.g. stack overflow) must not fault again
+	bool frame_valid = ((uint32_t)frame >= RAM_START) &&
+	                   ((uint32_t)frame <= (uint32_t)&_estack - sizeof(_record.frame));
+	for (size_t i = 0; i < 8; i++)
+		_record.frame[i] = frame_valid ? frame[i] : 0;
+	if (!frame)
+		_record.frame[6] = caller;
+
+	_record.cfsr = SCB->CFSR;
+	_record.hfsr = SCB->HFSR;
+	_record.mmfar = SCB->MMFAR;
+	_record.bfar = SCB->BFAR;
+
+	uint8_t pos = crash_trail_ring.pos;
+	for (size_t i = 0; i < CRASH_TRAIL_SIZE; i++)
+		_record.trail[i] = crash_trail_ring.entries[(pos+i) & (CRASH_TRAIL_SIZE-1)];
+
+	_record.magic = CRASH_MAGIC;
+	_record.check = _checksum(&_record);
+}
+
+uint32_t _checksum(const CrashRecord *record) {
+	const uint32_t *words = (const uint32_t*)record;
+	uint32_t sum = 0;
+	for (size_t i = 0; i < offsetof(CrashRecord, check)/sizeof(uint32_t); i++)
+		sum = ((sum << 5) | (sum >> 27)) ^ words[i];
+	return ~sum;
+}
@@ -0,0 +1,24 @@
+#include "dc_frame.h"
+
+bool dc_frame_parse(uint8_t *buf, size_t *size, DcFrameHandler handler) {
+	size_t begin = 0;
+
+	while (*size-begin >= DC_FRAME_HEADER_SIZE) {
+		size_t length = buf[begin+2];
+		if ((buf[begin] != DC_FRAME_MAGIC1) || (buf[begin+1] != DC_FRAME_MAGIC2) ||
+		    (length == 0) || (length > DC_FRAME_MAX_LENGTH)) { // invalid data
+			*size = 0;
+			return false;
+		}
+		if (*size-begin < length+DC_FRAME_HEADER_SIZE)
+			break; // unfinished packet
+		handler(buf[begin+3], &buf[begin+4], length-1);
+		begin += length+DC_FRAME_HEADER_SIZE;
+	}
+
+	// move last unfinished packet to begin of buffer
+	for (size_t i = 0; i < *size-begin; i++)
+		buf[i] = buf[i+begin];
+	*size -= begin;
+	return true;
+}
@@ -0,0 +1,172 @@
+/* DCC packet decoder implementation
+ * See dccdec.h for more information.
+ */
+
+#include "dccdec.h"
+
+/* Private function prototypes -----------------------------------------------*/
+
+static void _dccdec_half(DccDecoder *dec, uint16_t half_us);
+static void _dccdec_bit(DccDecoder *dec, bool bit);
+static void _dccdec_error(DccDecoder *dec);
+static void _dccdec_packet_end(DccDecoder *dec);
+
+/* Code ----------------------------------------------------------------------*/
+
+void dccdec_init(DccDecoder *dec) {
+	dec->state = dccdsLost;
+	dec->ms_since_edge = DCCDEC_LOST_MS;
+	dec->ms_since_packet = DCCDEC_PRESENT_MS;
+	dec->ms_rate = 0;
+	dec->packets_rate_start = 0;
+	dec->stats.packets = 0;
+	dec->stats.bit_errors = 0;
+	dec->stats.checksum_errors = 0;
+	dec->stats.rate = 0;
+}
+
+void dccdec_edge(DccDecoder *dec, uint16_t timestamp_us) {
+	uint16_t half_us = timestamp_us - dec->last_edge; // 16-bit timer wraps
+	dec->last_edge = timestamp_us;
+	dec->ms_since_edge = 0;
+
+	if (dec->state == dccdsLost) {
+		// first edge after signal loss, no half-period to measure
+		dec->state = dccdsPreamble;
+		dec->preamble = 0;
+		dec->packet_end = false;
+		return;
+	}
+	_dccdec_half(dec, half_us);
+}
+
+void dccdec_resync(DccDecoder *dec) {
+	dec->state = dccdsLost; // next edge only synchronizes
+}
+
+void dccdec_update_1ms(DccDecoder *dec) {
+	if (dec->ms_since_edge < DCCDEC_LOST_MS) {
+		dec->ms_since_edge++;
+		if (dec->ms_since_edge == DCCDEC_LOST_MS)
+			dec->state = dccdsLost; // timer would wrap, last_edge is useless
+	}
+	if (dec->ms_since_packet < DCCDEC_PRESENT_MS)
+		dec->ms_since_packet++;
+
+	dec->ms_rate++;
+	if (dec->ms_rate >= 1000) {
+		dec->stats.rate = dec->stats.packets - dec->packets_rate_start;
+		dec->packets_rate_start = dec->stats.packets;
+		dec->ms_rate = 0;
+	}
+}
+
+bool dccdec_present(const DccDecoder *dec) {
+	return dec->ms_since_packet < DCCDEC_PRESENT_MS;
+}
+
+void _dccdec_half(DccDecoder *dec, uint16_t half_us) {
+	bool one;
+	bool packet_end = dec->packet_end;
+	dec->packet_end = false;
+
+	if ((half_us >= DCCDEC_ONE_MIN_US) && (half_us <= DCCDEC_ONE_MAX_US))
+		one = true;
+	else if ((half_us >= DCCDEC_ZERO_MIN_US) && (half_us <= DCCDEC_ZERO_MAX_US))
+		one = false;
+	else if (packet_end) {
+		dec->preamble = 0; // start of RailCom cutout, not an error
+		return;
+	} else {
+		_dccdec_error(dec);
+		return;
+	}
+
+	switch (dec->state) {
+	case dccdsPreamble:
+		if (one) {
+			if (dec->preamble < 0xFF)
+				dec->preamble++;
+		} else if (dec->preamble >= DCCDEC_PREAMBLE_HALVES) {
+			dec->state = dccdsStartBit;
+		} else {
+			dec->preamble = 0; // middle of packet, wait for next preamble
+		}
+		break;
+
+	case dccdsStartBit:
+		if (one) {
+			_dccdec_error(dec);
+		} else {
+			dec->state = dccdsData;
+			dec->half = false;
+			dec->bits = 0;
+			dec->byte = 0;
+			dec->size = 0;
+		}
+		break;
+
+	case dccdsData:
+		if (!dec->half) {
+			dec->first_half_one = one;
+			dec->half = true;
+		} else if (one != dec->first_half_one) {
+			_dccdec_error(dec);
+		} else {
+			dec->half = false;
+			_dccdec_bit(dec, one);
+		}
+		break;
+
+	default:
+		break;
+	}
+}
+
+void _dccdec_bit(DccDecoder *dec, bool bit) {
+	if (dec->bits < 8) {
+		dec->byte = (dec->byte << 1) | bit;
+		dec->bits++;
+		if (dec->bits < 8)
+			return;
+		if (dec->size >= DCCDEC_MAX_PACKET_SIZE) {
+			_dccdec_error(dec);
+			return;
+		}
+		dec->packet[dec->size++] = dec->byte;
+		return;
+	}
+
+	if (bit) {
+		_dccdec_packet_end(dec);
+	} else { // data byte start bit
+		dec->bits = 0;
+		dec->byte = 0;
+	}
+}
+
+void _dccdec_packet_end(DccDecoder *dec) {
+	uint8_t xor = 0;
+	for (size_t i = 0; i < dec->size; i++)
+		xor ^= dec->packet[i];
+
+	if (dec->size < DCCDEC_MIN_PACKET_SIZE) {
+		dec->stats.bit_errors++;
+	} else if (xor != 0) {
+		dec->stats.checksum_errors++;
+	} else {
+		dec->stats.packets++;
+		dec->ms_since_packet = 0;
+	}
+
+	// packet end bit could be the first bit of next preamble
+	dec->state = dccdsPreamble;
+	dec->preamble = 2;
+	dec->packet_end = true;
+}
+
+void _dccdec_error(DccDecoder *dec) {
+	dec->stats.bit_errors++;
+	dec->state = dccdsPreamble;
+	dec->preamble = 0;
+}
@@ -0,0 +1,99 @@
+/* DCC waveform quality metrics implementation
+ * See dccwave.h for more information.
+ */
+
+#include <stddef.h>
+#include "dccwave.h"
+
+// Upper bounds (exclusive) of histogram bins, the last bin is unbounded
+static const uint16_t _bin_bounds[DCCWAVE_BINS-1] = {52, 55, 62, 65, 90, 95, 9901};
+
+/* Private function prototypes -----------------------------------------------*/
+
+static void _dccwave_half(DccWave *wave, uint16_t half_us, bool low);
+static void _dccwave_window_reset(DccWave *wave);
+
+/* Code ----------------------------------------------------------------------*/
+
+void dccwave_init(DccWave *wave) {
+	wave->present = false;
+	wave->synced = false;
+	wave->ms_since_edge = DCCWAVE_LOST_MS;
+	wave->ms_window = 0;
+	_dccwave_window_reset(wave);
+
+	wave->stats.frequency = 0;
+	wave->stats.low_permille = 0;
+	wave->stats.cutout_us = 0;
+	wave->stats.cutouts = 0;
+	wave->stats.losses = 0;
+	wave->stats.lost_ms = 0;
+	wave->stats.loss_ms = 0;
+	for (size_t i = 0; i < DCCWAVE_BINS; i++)
+		wave->stats.halves[i] = 0;
+}
+
+void dccwave_edge(DccWave *wave, const Edge *edge) {
+	uint16_t half_us = edge->timestamp - wave->last_edge; // 16-bit timer wraps
+	bool low = edge->flags & EDGE_LOW;
+
+	if ((wave->synced) && (!(edge->flags & EDGE_GAP)))
+		_dccwave_half(wave, half_us, !low); // level before this edge
+	if (low)
+		wave->window_falling++;
+
+	wave->last_edge = edge->timestamp;
+	wave->synced = true;
+	wave->present = true;
+	wave->ms_since_edge = 0;
+}
+
+void dccwave_update_1ms(DccWave *wave) {
+	if (wave->ms_since_edge < DCCWAVE_LOST_MS) {
+		wave->ms_since_edge++;
+		if (wave->ms_since_edge == DCCWAVE_LOST_MS) {
+			wave->synced = false; // timer would wrap, last_edge is useless
+			if (wave->present) {
+				wave->present = false;
+				wave->stats.losses++;
+				wave->stats.loss_ms = DCCWAVE_LOST_MS;
+				wave->stats.lost_ms += DCCWAVE_LOST_MS;
+			}
+		}
+	} else if (wave->stats.losses > 0) {
+		// signal absent since reset is not a loss
+		wave->stats.loss_ms++;
+		wave->stats.lost_ms++;
+	}
+
+	wave->ms_window++;
+	if (wave->ms_window >= 1000) {
+		wave->stats.frequency = wave->window_falling;
+		wave->stats.low_permille = (wave->window_us > 0) ?
+			(wave->window_low_us * 1000) / wave->window_us : 0;
+		_dccwave_window_reset(wave);
+		wave->ms_window = 0;
+	}
+}
+
+void _dccwave_half(DccWave *wave, uint16_t half_us, bool low) {
+	size_t bin = 0;
+	while ((bin < DCCWAVE_BINS-1) && (half_us >= _bin_bounds[bin]))
+		bin++;
+	wave->stats.halves[bin]++;
+
+	wave->window_us += half_us;
+	if (low)
+		wave->window_low_us += half_us;
+
+	if ((!low) && (half_us >= DCCWAVE_CUTOUT_MIN_US) && (half_us <= DCCWAVE_CUTOUT_MAX_US)) {
+		wave->stats.cutouts++;
+		wave->stats.cutout_us = half_us;
+	}
+}
+
+void _dccwave_window_reset(DccWave *wave) {
+	wave->window_falling = 0;
+	wave->window_low_us = 0;
+	wave->window_us = 0;
+}
@@ -1,16 +1,14 @@
 #include <stddef.h>
 #include "debounce.h"
 
-#define BTN_DEBOUNCE_THRESHOLD 100 // 10 ms
-#define DCC_DEBOUNCE_THRESHOLD 10 // 1 ms
-#define DCC_DEBOUNCE_LIMIT 20 // 2 ms
+#define BTN_DEBOUNCE_THRESHOLD 10 // 10 ms
+
+_Static_assert(DEBOUNCE_SETTLE_UPDATES >= BTN_DEBOUNCE_THRESHOLD, "debounce settle time");
 
 DebouncePin debounced[DEBOUNCED_COUNT] = {
 	{.pin=&pin_btn_go, .threshold_raise=BTN_DEBOUNCE_THRESHOLD, .threshold_fall=0, .limit=BTN_DEBOUNCE_THRESHOLD},
 	{.pin=&pin_btn_stop, .threshold_raise=BTN_DEBOUNCE_THRESHOLD, .threshold_fall=0, .limit=BTN_DEBOUNCE_THRESHOLD},
 	{.pin=&pin_btn_override, .threshold_raise=BTN_DEBOUNCE_THRESHOLD, .threshold_fall=0, .limit=BTN_DEBOUNCE_THRESHOLD},
-	{.pin=&pin_dcc1, .threshold_raise=DCC_DEBOUNCE_THRESHOLD, .threshold_fall=0, .limit=DCC_DEBOUNCE_LIMIT},
-	{.pin=&pin_dcc2, .threshold_raise=DCC_DEBOUNCE_THRESHOLD, .threshold_fall=0, .limit=DCC_DEBOUNCE_LIMIT},
 };
 
 void debounce_init() {
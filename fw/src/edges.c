@@ -0,0 +1,45 @@
+/* Ring buffers of edges implementation
+ * See edges.h for more information.
+ */
+
+#include "edges.h"
+
+/* Code ----------------------------------------------------------------------*/
+
+void edges_init(EdgeRing *ring) {
+	ring->head = 0;
+	ring->tail = 0;
+	ring->gap = false;
+	ring->lost = 0;
+}
+
+void edges_push(EdgeRing *ring, uint16_t timestamp_us, bool low) {
+	uint8_t head = ring->head;
+	if ((uint8_t)(head - ring->tail) >= EDGES_RING_SIZE) {
+		edges_lost(ring); // main loop does not keep up
+		return;
+	}
+
+	volatile Edge *edge = &ring->buf[head % EDGES_RING_SIZE];
+	edge->timestamp = timestamp_us;
+	edge->flags = (low ? EDGE_LOW : 0) | (ring->gap ? EDGE_GAP : 0);
+	ring->gap = false;
+	ring->head = head+1; // publish after the edge is written
+}
+
+void edges_lost(EdgeRing *ring) {
+	if (!ring->gap)
+		ring->lost++;
+	ring->gap = true;
+}
+
+bool edges_pop(EdgeRing *ring, Edge *edge) {
+	uint8_t tail = ring->tail;
+	if (tail == ring->head)
+		return false;
+
+	edge->timestamp = ring->buf[tail % EDGES_RING_SIZE].timestamp;
+	edge->flags = ring->buf[tail % EDGES_RING_SIZE].flags;
+	ring->tail = tail+1; // release after the edge is read
+	return true;
+}
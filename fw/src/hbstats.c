@@ -0,0 +1,47 @@
+/* Heartbeat statistics implementation
+ * See hbstats.h for more information.
+ */
+
+#include <string.h>
+#include "hbstats.h"
+
+HbStats hbstats;
+static bool _running; // previous heartbeat is valid
+static uint32_t _last_ms;
+
+/* Code ----------------------------------------------------------------------*/
+
+void hbstats_reset(uint32_t now_ms) {
+	memset(&hbstats, 0, sizeof(hbstats));
+	hbstats.min_margin_ms = HBSTATS_NO_MARGIN;
+	hbstats.since_ms = now_ms;
+}
+
+void hbstats_heartbeat(uint32_t now_ms, uint32_t timer_ms, uint32_t timeout_ms) {
+	hbstats.heartbeats++;
+	if (_running) {
+		uint32_t gap_ms = now_ms - _last_ms;
+		hbstats.gaps[hbstats_bin(gap_ms)]++;
+		if (gap_ms > hbstats.worst_gap_ms)
+			hbstats.worst_gap_ms = gap_ms;
+
+		// DCC-on timer stops at timeout
+		uint32_t margin_ms = (timer_ms < timeout_ms) ? timeout_ms - timer_ms : 0;
+		if (margin_ms < hbstats.min_margin_ms)
+			hbstats.min_margin_ms = margin_ms;
+	}
+	_running = true;
+	_last_ms = now_ms;
+}
+
+void hbstats_stop(void) {
+	_running = false;
+}
+
+uint8_t hbstats_bin(uint32_t gap_ms) {
+	if (gap_ms < HBSTATS_BIN0_MS)
+		return 0;
+	// bin n: 2^(n+2) .. 2^(n+3)-1 ms
+	uint8_t bin = 31 - __builtin_clz(gap_ms) - 2;
+	return (bin < HBSTATS_BINS) ? bin : HBSTATS_BINS-1;
+}
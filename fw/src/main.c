@@ -19,24 +19,36 @@
 #include "leds.h"
 #include "debounce.h"
 #include "selftest.h"
+#include "scope.h"
+#include "dccdec.h"
+#include "edges.h"
+#include "dccwave.h"
+#include "events.h"
+#include "backup.h"
+#include "crash.h"
+#include "hbstats.h"
 
 /* Private variables ---------------------------------------------------------*/
 
 UART_HandleTypeDef h_uart_debug;
 TIM_HandleTypeDef h_tim2;
 TIM_HandleTypeDef h_tim3;
+TIM_HandleTypeDef h_tim4;
 IWDG_HandleTypeDef h_iwdg;
 
-typedef union {
-	size_t all;
-	struct {
-		bool info: 1;
-		bool state: 1;
-		bool brtsState: 1;
-	} sep;
+typedef enum {
+	txInfo = 0,
+	txState = 1,
+	txBrtsState = 2,
+	txLease = 3,
+	txDccStats = 4,
+	txDccWave = 5, // + input
+	txBootInfo = 7,
+	txCrash = 8,
+	txHbStats = 9,
 } DeviceUsbTxReq;
 
-volatile DeviceUsbTxReq device_usb_tx_req;
+Events device_usb_tx_req; // events.h, flags set from interrupts too
 
 volatile DCmode dcmode;
 volatile Warnings warnings;
@@ -44,24 +56,43 @@ volatile bool _relay1;
 volatile bool _relay2;
 uint8_t failure_code;
 volatile uint32_t dccon_timer_ms;
+volatile uint32_t dccon_timeout_ms; // DCCON_TIMEOUT_MS or lease granted to PC
+volatile uint32_t dccon_warning_ms;
+uint16_t lease_granted_ms;
+uint8_t lease_seq;
+Dc01HbStatsReport hb_stats_report; // taken by USB interrupt, sent by main loop
+volatile bool hb_stats_pending; // hb_stats_report taken & not sent yet, further requests are ignored
 bool brtest_request; // brtest_ready & brtest_request → start brtest
 volatile uint32_t brtest_timer;
 volatile uint32_t alert_timer;
-
-typedef union {
-	size_t all;
-	struct {
-		bool debounce_update: 1;
-		bool leds_update: 1;
-		bool brtest_update: 1;
-	} sep;
+EdgeRing edges[DCCDEC_COUNT];
+DccDecoder dccdec[DCCDEC_COUNT];
+DccWave dccwave[DCCDEC_COUNT];
+
+typedef struct {
+	uint16_t samples; // debounce updates since init
+	bool ready; // inputs debounced, mode set
+	uint16_t ready_ms; // HAL ticks (since clock init)
+	uint32_t dcc_on_ms; // first time DCC connected to stay (after BRT), 0 = not yet
+	bool brt_honoured; // recent BRT pass cached in backup domain
+} Boot;
+
+Boot boot;
+
+typedef enum {
+	irDebounceUpdate = 0,
+	irLedsUpdate = 1,
+	irBrtestUpdate = 2,
+	irDccUpdate = 3,
 } InterruptReq;
 
-volatile InterruptReq interrupt_req;
+Events interrupt_req; // events.h
 
 /* Private function prototypes -----------------------------------------------*/
 
 static void error_handler();
+static void halt(CrashCause cause, const uint32_t *frame, uint32_t caller) __attribute__((noreturn));
+void fault_handler(const uint32_t *frame, CrashCause cause) __attribute__((used, noreturn));
 static void init(void);
 static bool clock_init(void);
 static bool debug_uart_init(void);
@@ -69,7 +100,14 @@ static inline void poll_usb_tx_flags(void);
 static bool iwdg_init(void);
 static void state_leds_update(void);
 static void dcc_on_timeout(void);
+static void dccon_renew(uint32_t timeout_ms, uint32_t warning_ms);
+static void dccon_stop(void);
+static void hb_stats_take(bool reset);
+static void pc_set_state(bool state);
 static bool _brtest_is_time(void);
+static void dcc_edges_process(void);
+static inline uint16_t serial_state(void);
+static void boot_sampled(void);
 
 /* Code ----------------------------------------------------------------------*/
 
@@ -77,44 +115,73 @@ int main(void) {
 	init();
 
 	while (true) {
-		if (interrupt_req.sep.debounce_update) {
+		// Event is taken before it is handled, so the one coming meanwhile is not lost
+		if (events_take(&interrupt_req, irDebounceUpdate)) {
 			debounce_update();
-			interrupt_req.sep.debounce_update = false;
+			if (!boot.ready)
+				boot_sampled();
 		}
-		if (interrupt_req.sep.leds_update) {
+		if (events_take(&interrupt_req, irLedsUpdate))
 			state_leds_update();
-			interrupt_req.sep.leds_update = false;
-		}
-		if (interrupt_req.sep.brtest_update) {
+		if (events_take(&interrupt_req, irBrtestUpdate))
 			brtest_update();
-			interrupt_req.sep.brtest_update = false;
+		dcc_edges_process();
+		if (events_take(&interrupt_req, irDccUpdate)) {
+			for (size_t i = 0; i < DCCDEC_COUNT; i++) {
+				dccdec_update_1ms(&dccdec[i]);
+				dccwave_update_1ms(&dccwave[i]);
+			}
 		}
 		if ((brtest_request) && (brtest_ready())) {
 			brtest_start();
 		}
 		poll_usb_tx_flags();
 
-		warnings.sep.timeout = ((dccon_timer_ms >= DCCON_WARNING_MS) &&
-		                        (dccon_timer_ms < DCCON_TIMEOUT_MS));
+		if ((boot.dcc_on_ms == 0) && (is_dcc_connected()) && (!brtest_running()) && (!brtest_request))
+			boot.dcc_on_ms = HAL_GetTick(); // reported by BOOT_INFO
+
+		warnings.sep.timeout = ((dccon_timer_ms >= dccon_warning_ms) &&
+		                        (dccon_timer_ms < dccon_timeout_ms));
+		cdc_main_serial_state(serial_state());
 	}
 }
 
 void init(void) {
 	h_iwdg.Instance = NULL;
+	crash_init();
 
 	if (!clock_init())
 		error_handler();
 	HAL_Init();
+	backup_init();
 	gpio_init();
 	leds_init();
 	debounce_init();
+	for (size_t i = 0; i < DCCDEC_COUNT; i++) {
+		edges_init(&edges[i]);
+		dccdec_init(&dccdec[i]);
+		dccwave_init(&dccwave[i]);
+	}
 
-	interrupt_req.all = 0;
-	device_usb_tx_req.all = 0;
+	interrupt_req = 0;
+	device_usb_tx_req = 0;
 	brtest_request = false;
 	brtest_timer = BRTEST_NOTEST_MAX_TIME;
+	boot = (Boot){0};
+	uint32_t brt_age;
+	if ((backup_brt_age(&brt_age)) && (brt_age < BRTEST_NOTEST_MAX_TIME)) {
+		// Reset shortly after a pass (e.g. IWDG) → do not test again when enabling
+		brtest_timer = brt_age;
+		boot.brt_honoured = true;
+	}
 	alert_timer = ALERT_TIME;
-	dccon_timer_ms = DCCON_TIMEOUT_MS;
+	dccon_timeout_ms = DCCON_TIMEOUT_MS;
+	dccon_warning_ms = DCCON_WARNING_MS;
+	dccon_timer_ms = dccon_timeout_ms;
+	hbstats_reset(HAL_GetTick());
+	hb_stats_pending = false;
+	lease_granted_ms = 0;
+	lease_seq = 0;
 	_relay1 = _relay2 = false;
 
 	dcmode = mInitializing;
@@ -136,11 +203,14 @@ void init(void) {
 	cdc_init();
 	debug_uart_init();
 	__HAL_AFIO_REMAP_SWJ_NOJTAG();
+	// Inputs are debounced by main loop, USB enumerates meanwhile, see boot_sampled
+}
 
-	for (size_t i = 0; i < 200; i++) { // time must be enough for debounce
-		debounce_update(); // read DCC state
-		HAL_Delay(1); // this time does not corespond with main loop's debounce_update period!
-	}
+void boot_sampled(void) {
+	if (++boot.samples < DEBOUNCE_SETTLE_UPDATES)
+		return;
+	boot.ready = true;
+	boot.ready_ms = HAL_GetTick();
 
 	if (dcmode == mInitializing) // if debounce_update did not change mode to mOverride
 		set_mode(mNormalOp);
@@ -190,6 +260,7 @@ bool clock_init(void) {
 	__HAL_RCC_PWR_CLK_ENABLE();
 	__HAL_RCC_TIM2_CLK_ENABLE();
 	__HAL_RCC_TIM3_CLK_ENABLE();
+	__HAL_RCC_TIM4_CLK_ENABLE();
 
 	// Timer 2 @ 100 us
 	TIM_ClockConfigTypeDef sClockSourceConfig = {0};
@@ -216,27 +287,53 @@ bool clock_init(void) {
 	HAL_NVIC_SetPriority(TIM2_IRQn, 8, 0);
 	HAL_NVIC_EnableIRQ(TIM2_IRQn);
 
-	// Timer 3 @ 1 ms
+	// Timer 3: free-running @ 1 MHz, input capture of DCC1 (PB0 = CH3) & DCC2 (PB1 = CH4)
+	TIM_IC_InitTypeDef sICConfig = {0};
+
 	h_tim3.Instance = TIM3;
-	h_tim3.Init.Prescaler = 128;
+	h_tim3.Init.Prescaler = 47;
 	h_tim3.Init.CounterMode = TIM_COUNTERMODE_UP;
-	h_tim3.Init.Period = 372;
+	h_tim3.Init.Period = 0xFFFF;
 	h_tim3.Init.ClockDivision = TIM_CLOCKDIVISION_DIV1;
 	h_tim3.Init.AutoReloadPreload = TIM_AUTORELOAD_PRELOAD_DISABLE;
-	if (HAL_TIM_Base_Init(&h_tim3) != HAL_OK)
+	if (HAL_TIM_IC_Init(&h_tim3) != HAL_OK)
+		return false;
+
+	sICConfig.ICPolarity = TIM_ICPOLARITY_FALLING;
+	sICConfig.ICSelection = TIM_ICSELECTION_DIRECTTI;
+	sICConfig.ICPrescaler = TIM_ICPSC_DIV1;
+	sICConfig.ICFilter = 0x3; // 8 samples @ 48 MHz
+	if (HAL_TIM_IC_ConfigChannel(&h_tim3, &sICConfig, TIM_CHANNEL_3) != HAL_OK)
+		return false;
+	if (HAL_TIM_IC_ConfigChannel(&h_tim3, &sICConfig, TIM_CHANNEL_4) != HAL_OK)
+		return false;
+	HAL_TIM_IC_Start_IT(&h_tim3, TIM_CHANNEL_3);
+	HAL_TIM_IC_Start_IT(&h_tim3, TIM_CHANNEL_4);
+
+	HAL_NVIC_SetPriority(TIM3_IRQn, 8, 0);
+	HAL_NVIC_EnableIRQ(TIM3_IRQn);
+
+	// Timer 4 @ 1 ms
+	h_tim4.Instance = TIM4;
+	h_tim4.Init.Prescaler = 128;
+	h_tim4.Init.CounterMode = TIM_COUNTERMODE_UP;
+	h_tim4.Init.Period = 372;
+	h_tim4.Init.ClockDivision = TIM_CLOCKDIVISION_DIV1;
+	h_tim4.Init.AutoReloadPreload = TIM_AUTORELOAD_PRELOAD_DISABLE;
+	if (HAL_TIM_Base_Init(&h_tim4) != HAL_OK)
 		return false;
-	HAL_TIM_Base_Start_IT(&h_tim3);
+	HAL_TIM_Base_Start_IT(&h_tim4);
 
 	sClockSourceConfig.ClockSource = TIM_CLOCKSOURCE_INTERNAL;
-	if (HAL_TIM_ConfigClockSource(&h_tim3, &sClockSourceConfig) != HAL_OK)
+	if (HAL_TIM_ConfigClockSource(&h_tim4, &sClockSourceConfig) != HAL_OK)
 		return false;
 	sMasterConfig.MasterOutputTrigger = TIM_TRGO_RESET;
 	sMasterConfig.MasterSlaveMode = TIM_MASTERSLAVEMODE_DISABLE;
-	if (HAL_TIMEx_MasterConfigSynchronization(&h_tim3, &sMasterConfig) != HAL_OK)
+	if (HAL_TIMEx_MasterConfigSynchronization(&h_tim4, &sMasterConfig) != HAL_OK)
 		return false;
 
-	HAL_NVIC_SetPriority(TIM3_IRQn, 8, 0);
-	HAL_NVIC_EnableIRQ(TIM3_IRQn);
+	HAL_NVIC_SetPriority(TIM4_IRQn, 8, 0);
+	HAL_NVIC_EnableIRQ(TIM4_IRQn);
 
 	return true;
 }
@@ -268,10 +365,20 @@ void HAL_TIM_PeriodElapsedCallback(TIM_HandleTypeDef *htim) {
 }
 
 void error_handler(void) {
+	halt(crashError, NULL, (uint32_t)__builtin_return_address(0));
+}
+
+void fault_handler(const uint32_t *frame, CrashCause cause) {
+	halt(cause, frame, 0);
+}
+
+void halt(CrashCause cause, const uint32_t *frame, uint32_t caller) {
+	// Outputs are safe first, IWDG resets MCU then, crash record is reported after reset
 	__disable_irq();
 	gpio_pin_write(pin_out_on, false);
 	gpio_pin_write(pin_out_alert, false);
 	gpio_pin_write(pin_led_red, true);
+	crash_record(cause, frame, caller);
 	while (true);
 }
 
@@ -289,26 +396,27 @@ void assert_failed(uint8_t *file, uint32_t line) {
 
 /* Interrupt handlers --------------------------------------------------------*/
 
-// This function handles Non maskable interrupt.
-void NMI_Handler(void) {
-	error_handler();
-}
-
-void HardFault_Handler(void) {
-	error_handler();
-}
-
-void MemManage_Handler(void) {
-	error_handler();
-}
-
-void BusFault_Handler(void) {
-	error_handler();
-}
+// Fault handlers pass the stacked exception frame (MSP or PSP by EXC_RETURN) to fault_handler.
+// Only basic asm is safe in naked functions, so cause is passed as a literal ‹n›.
+#define FAULT_HANDLER(name, cause, n) \
+	_Static_assert((cause) == (n), #name ": cause literal differs from CrashCause"); \
+	__attribute__((naked)) void name(void) { \
+		__asm__ volatile ( \
+			"tst lr, #4\n" \
+			"ite eq\n" \
+			"mrseq r0, msp\n" \
+			"mrsne r0, psp\n" \
+			"movs r1, #" #n "\n" \
+			"b fault_handler\n" \
+		); \
+	}
 
-void UsageFault_Handler(void) {
-	error_handler();
-}
+// This function handles Non maskable interrupt.
+FAULT_HANDLER(NMI_Handler, crashNmi, 2)
+FAULT_HANDLER(HardFault_Handler, crashHardFault, 3)
+FAULT_HANDLER(MemManage_Handler, crashMemManage, 4)
+FAULT_HANDLER(BusFault_Handler, crashBusFault, 5)
+FAULT_HANDLER(UsageFault_Handler, crashUsageFault, 6)
 
 void SVC_Handler(void) {}
 
@@ -330,35 +438,60 @@ void TIM2_IRQHandler(void) {
 	if (_relay2)
 		gpio_pin_toggle(pin_relay2);
 
-	interrupt_req.sep.debounce_update = true;
+	scope_sample(_relay1, _relay2);
 	HAL_TIM_IRQHandler(&h_tim2);
 }
 
 void TIM3_IRQHandler(void) {
-	// Timer 3 @ 1 ms (1 kHz)
+	// Timer 3: input capture of DCC edges
+	// STM32F1 cannot capture both edges → polarity is switched after each edge.
+	// Reading CCRx clears CCxIF. Edges are only buffered, main loop processes them.
+
+	uint32_t sr = TIM3->SR;
+	if (sr & TIM_SR_CC3IF) {
+		edges_push(&edges[DCCDEC_DCC1], TIM3->CCR3, TIM3->CCER & TIM_CCER_CC3P);
+		TIM3->CCER ^= TIM_CCER_CC3P;
+	}
+	if (sr & TIM_SR_CC4IF) {
+		edges_push(&edges[DCCDEC_DCC2], TIM3->CCR4, TIM3->CCER & TIM_CCER_CC4P);
+		TIM3->CCER ^= TIM_CCER_CC4P;
+	}
+	if (sr & (TIM_SR_CC3OF | TIM_SR_CC4OF)) { // edge missed → polarity is wrong, consumers resync
+		if (sr & TIM_SR_CC3OF)
+			edges_lost(&edges[DCCDEC_DCC1]);
+		if (sr & TIM_SR_CC4OF)
+			edges_lost(&edges[DCCDEC_DCC2]);
+		TIM3->SR = ~(sr & (TIM_SR_CC3OF | TIM_SR_CC4OF));
+	}
+}
+
+void TIM4_IRQHandler(void) {
+	// Timer 4 @ 1 ms (1 kHz)
 	// General-purpose timer
 
 	static volatile size_t counter_500ms = 0;
 	static volatile bool counter_1s = false;
 	counter_500ms++;
 	if ((counter_500ms%100) == 0) {
-		interrupt_req.sep.brtest_update = true;
+		events_set(&interrupt_req, irBrtestUpdate);
 	}
 	if (counter_500ms >= 500) {
-		device_usb_tx_req.sep.state = true;
-		interrupt_req.sep.leds_update = true;
+		events_set(&device_usb_tx_req, txState);
+		events_set(&interrupt_req, irLedsUpdate);
 		counter_500ms = 0;
 		counter_1s = !counter_1s;
 		if ((!counter_1s) && (brtest_timer < BRTEST_NOTEST_MAX_TIME))
 			brtest_timer++;
 	}
 
-	if (dccon_timer_ms < DCCON_TIMEOUT_MS) {
+	if (dccon_timer_ms < dccon_timeout_ms) {
 		dccon_timer_ms++;
-		if ((dcmode == mNormalOp) && (dccon_timer_ms == DCCON_WARNING_MS)) {
+		if ((dcmode == mNormalOp) && (dccon_timer_ms == dccon_warning_ms)) {
 			gpio_pin_write(pin_led_yellow, true);
+			hbstats.warnings++;
 		}
-		if ((dcmode == mNormalOp) && (dccon_timer_ms == DCCON_TIMEOUT_MS)) {
+		if ((dcmode == mNormalOp) && (dccon_timer_ms == dccon_timeout_ms)) {
+			hbstats.timeouts++;
 			dcc_on_timeout();
 			gpio_pin_write(pin_led_yellow, false);
 		}
@@ -371,69 +504,269 @@ void TIM3_IRQHandler(void) {
 	}
 
 	leds_update_1ms();
+	events_set(&interrupt_req, irDebounceUpdate);
+	events_set(&interrupt_req, irDccUpdate);
 
 	if (h_iwdg.Instance != NULL)
 		HAL_IWDG_Refresh(&h_iwdg);
-	HAL_TIM_IRQHandler(&h_tim3);
+	HAL_TIM_IRQHandler(&h_tim4);
 }
 
 /* USB -----------------------------------------------------------------------*/
 
+// Buffers of modules must match messages of protocol schema (doc/protocol.json)
+_Static_assert(SCOPE_PACKET_SIZE == DC01_SCOPE_REPORT_SIZE, "scope packet size");
+_Static_assert(DCCWAVE_BINS == sizeof(((Dc01DccWaveReport*)0)->half_periods)/sizeof(uint32_t), "DCC wave bins");
+_Static_assert(DCCDEC_COUNT == sizeof(((Dc01DccStatsReport*)0)->inputs)/sizeof(Dc01DccInputStats), "DCC inputs");
+_Static_assert(CRASH_TRAIL_SIZE == sizeof(((Dc01CrashReport*)0)->trail)/sizeof(uint16_t), "crash trail");
+_Static_assert(HBSTATS_BINS == sizeof(((Dc01HbStatsReport*)0)->gaps)/sizeof(uint32_t), "heartbeat gap bins");
+
 void cdc_main_received(uint8_t command_code, uint8_t *data, size_t data_size) {
-	if ((command_code == DC_CMD_PM_SET_STATE) && (data_size >= 1)) {
-		bool state = (data[0] & 1);
-		if (state) {
-			dccon_timer_ms = 0;
-			gpio_pin_write(pin_led_yellow, false);
+	Dc01SetStateRequest set_state;
+	Dc01LeaseRequest lease;
+	Dc01ScopeRequest scope;
+	Dc01DccWaveRequest dcc_wave;
+	Dc01HbStatsRequest hb_stats;
+
+	crash_trail(trailCommand, command_code);
+	if ((command_code == DC_CMD_PM_SET_STATE) && (dc01_decode_set_state_request(data, data_size, &set_state))) {
+		bool state = set_state.on;
+		if (state)
+			dccon_renew(DCCON_TIMEOUT_MS, DCCON_WARNING_MS);
+		else
+			dccon_stop();
+		pc_set_state(state);
+
+	} else if ((command_code == DC_CMD_PM_LEASE) && (dc01_decode_lease_request(data, data_size, &lease))) {
+		uint32_t lease_ms = lease.duration_ms;
+		if (lease_ms > 0) {
+			if (lease_ms < LEASE_MIN_MS)
+				lease_ms = LEASE_MIN_MS;
+			if (lease_ms > LEASE_MAX_MS)
+				lease_ms = LEASE_MAX_MS;
+			dccon_renew(lease_ms, lease_ms - lease_ms/4);
 		} else {
-			dccon_timer_ms = DCCON_TIMEOUT_MS;
+			dccon_stop(); // revoke
 		}
-		if (dcmode == mNormalOp) {
-			// request could be potentially waiting for a long time - up to DCC occurence on input
-			if ((state) && (!is_dcc_connected()) && (!brtest_running()) && (_brtest_is_time()))
-				brtest_request = true;
-			if (!state) // cancel pending request
-				brtest_request = false;
-			if ((!brtest_running()) || (!state))
-				appl_set_relays(state);
+		lease_granted_ms = lease_ms;
+		lease_seq = lease.seq;
+		events_set(&device_usb_tx_req, txLease);
+		pc_set_state(lease_ms > 0);
+
+	} else if ((command_code == DC_CMD_PM_SCOPE) && (dc01_decode_scope_request(data, data_size, &scope))) {
+		scope_start((scope.run ? SCOPE_RUN : 0) | (scope.relays ? SCOPE_RELAYS : 0));
+
+	} else if (command_code == DC_CMD_PM_DCC_STATS) {
+		events_set(&device_usb_tx_req, txDccStats);
+
+	} else if ((command_code == DC_CMD_PM_DCC_WAVE) && (dc01_decode_dcc_wave_request(data, data_size, &dcc_wave)) &&
+	           (dcc_wave.input < DCCDEC_COUNT)) {
+		events_set(&device_usb_tx_req, txDccWave + dcc_wave.input);
+
+	} else if (command_code == DC_CMD_PM_BOOT_INFO) {
+		events_set(&device_usb_tx_req, txBootInfo);
+
+	} else if (command_code == DC_CMD_PM_CRASH) {
+		events_set(&device_usb_tx_req, txCrash);
+
+	} else if ((command_code == DC_CMD_PM_HB_STATS) && (dc01_decode_hb_stats_request(data, data_size, &hb_stats))) {
+		if (!hb_stats_pending) {
+			// report is not overwritten while main loop may be encoding it
+			hb_stats_take(hb_stats.reset);
+			hb_stats_pending = true;
+			events_set(&device_usb_tx_req, txHbStats);
 		}
+
 	} else if (command_code == DC_CMD_PM_INFO_REQ) {
-		device_usb_tx_req.sep.info = true;
+		events_set(&device_usb_tx_req, txInfo);
 	}
 }
 
-void poll_usb_tx_flags(void) {
-	if (!cdc_dtr_ready)
-		device_usb_tx_req.all = 0;  // computer does not listen → ignore all flags
-	if (!cdc_main_can_send())
-		return; // USB busy → wait for next poll
+void dccon_renew(uint32_t timeout_ms, uint32_t warning_ms) {
+	// Called from USB ISR, TIM4 ISR has the same priority → no preemption
+	hbstats_heartbeat(HAL_GetTick(), dccon_timer_ms, dccon_timeout_ms);
+	dccon_timeout_ms = timeout_ms;
+	dccon_warning_ms = warning_ms;
+	dccon_timer_ms = 0;
+	gpio_pin_write(pin_led_yellow, false);
+}
+
+void dccon_stop(void) {
+	dccon_timer_ms = dccon_timeout_ms;
+	hbstats_stop();
+}
 
-	if (device_usb_tx_req.sep.info) {
-		cdc_tx.separate.data[0] = FW_VER_MAJOR;
-		cdc_tx.separate.data[1] = FW_VER_MINOR;
+void hb_stats_take(bool reset) {
+	// Called from USB ISR: statistics are not updated meanwhile (see dccon_renew)
+	hb_stats_report = (Dc01HbStatsReport){
+		.heartbeats = hbstats.heartbeats,
+		.worst_gap_ms = hbstats.worst_gap_ms,
+		.min_margin_ms = hbstats.min_margin_ms,
+		.warnings = hbstats.warnings,
+		.timeouts = hbstats.timeouts,
+		.period_ms = HAL_GetTick() - hbstats.since_ms,
+	};
+	for (size_t i = 0; i < HBSTATS_BINS; i++)
+		hb_stats_report.gaps[i] = hbstats.gaps[i];
+	if (reset)
+		hbstats_reset(HAL_GetTick());
+}
 
-		if (cdc_main_send_nocopy(DC_CMD_MP_INFO, 2))
-			device_usb_tx_req.sep.info = false;
+void pc_set_state(bool state) {
+	if (dcmode != mNormalOp)
+		return;
+	// request could be potentially waiting for a long time - up to DCC occurence on input
+	if ((state) && (!is_dcc_connected()) && (!brtest_running()) && (_brtest_is_time()))
+		brtest_request = true;
+	if (!state) // cancel pending request
+		brtest_request = false;
+	if ((!brtest_running()) || (!state))
+		appl_set_relays(state);
+}
 
-	} else if (device_usb_tx_req.sep.state) {
-		cdc_tx.separate.data[0] = ((dcmode & 0x07) << 4) | (is_dcc_connected()) | ((dcc_at_least_one() & 1) << 1);
-		cdc_tx.separate.data[1] = failure_code;
-		cdc_tx.separate.data[2] = warnings.all;
+void poll_usb_tx_flags(void) {
+	if (!cdc_dtr_ready) {
+		device_usb_tx_req = 0;  // computer does not listen → ignore all flags
+		hb_stats_pending = false; // report dropped with its flag, next request takes new one
+		if (scope_running())
+			scope_stop();
+	}
+	if (!cdc_main_can_send())
+		return; // USB busy → wait for next poll
 
-		if (cdc_main_send_nocopy(DC_CMD_MP_STATE, 3))
-			device_usb_tx_req.sep.state = false;
+	// Flag is taken before the report is built, so a change meanwhile requests
+	// the next report. Flag is set again when USB refuses the report.
+	uint8_t *data = cdc_tx.separate.data;
+	if (events_take(&device_usb_tx_req, txInfo)) {
+		Dc01InfoReport report = { .fw_major = FW_VER_MAJOR, .fw_minor = FW_VER_MINOR };
+
+		if (!cdc_main_send_nocopy(DC_CMD_MP_INFO, dc01_encode_info_report(data, &report)))
+			events_set(&device_usb_tx_req, txInfo);
+
+	} else if (events_take(&device_usb_tx_req, txLease)) {
+		Dc01LeaseReport report = { .granted_ms = lease_granted_ms, .seq = lease_seq };
+
+		if (!cdc_main_send_nocopy(DC_CMD_MP_LEASE, dc01_encode_lease_report(data, &report)))
+			events_set(&device_usb_tx_req, txLease);
+
+	} else if (events_take(&device_usb_tx_req, txState)) {
+		Dc01StateReport report = {
+			.mode = dcmode,
+			.dcc_connected = is_dcc_connected(),
+			.dcc_at_least_one = dcc_at_least_one(),
+			.failure_code = failure_code,
+			.warnings = warnings.all,
+		};
+
+		if (!cdc_main_send_nocopy(DC_CMD_MP_STATE, dc01_encode_state_report(data, &report)))
+			events_set(&device_usb_tx_req, txState);
+
+	} else if (events_take(&device_usb_tx_req, txBrtsState)) {
+		Dc01BrtReport report = { .state = brTestState, .step = brTestStep, .error = brTestError };
+
+		if (!cdc_main_send_nocopy(DC_CMD_MP_BRSTATE, dc01_encode_brt_report(data, &report)))
+			events_set(&device_usb_tx_req, txBrtsState);
+
+	} else if (events_take(&device_usb_tx_req, txDccStats)) {
+		Dc01DccStatsReport report = { .require_packets = DCC_REQUIRE_PACKETS };
+		for (size_t i = 0; i < DCCDEC_COUNT; i++) {
+			const DccDecStats *stats = &dccdec[i].stats;
+			report.present[i] = dcc_present(i);
+			report.inputs[i] = (Dc01DccInputStats){
+				.rate = stats->rate,
+				.packets = stats->packets,
+				.bit_errors = stats->bit_errors,
+				.checksum_errors = stats->checksum_errors,
+			};
+		}
 
-	} else if (device_usb_tx_req.sep.brtsState) {
-		cdc_tx.separate.data[0] = brTestState;
-		cdc_tx.separate.data[1] = brTestStep;
-		cdc_tx.separate.data[2] = brTestError;
+		if (!cdc_main_send_nocopy(DC_CMD_MP_DCC_STATS, dc01_encode_dcc_stats_report(data, &report)))
+			events_set(&device_usb_tx_req, txDccStats);
+
+	} else if ((events_test(&device_usb_tx_req, txDccWave + DCCDEC_DCC1)) ||
+	           (events_test(&device_usb_tx_req, txDccWave + DCCDEC_DCC2))) {
+		size_t input = events_test(&device_usb_tx_req, txDccWave + DCCDEC_DCC1) ? DCCDEC_DCC1 : DCCDEC_DCC2;
+		events_clear(&device_usb_tx_req, txDccWave + input);
+		const DccWaveStats *stats = &dccwave[input].stats;
+		Dc01DccWaveReport report = {
+			.input = input,
+			.present = dccwave[input].present,
+			.frequency = stats->frequency,
+			.low_permille = stats->low_permille,
+			.cutout_us = stats->cutout_us,
+			.cutouts = stats->cutouts,
+			.losses = stats->losses,
+			.lost_ms = stats->lost_ms,
+			.loss_ms = stats->loss_ms,
+			.edge_overruns = edges[input].lost,
+		};
+		for (size_t i = 0; i < DCCWAVE_BINS; i++)
+			report.half_periods[i] = stats->halves[i];
+
+		if (!cdc_main_send_nocopy(DC_CMD_MP_DCC_WAVE, dc01_encode_dcc_wave_report(data, &report)))
+			events_set(&device_usb_tx_req, txDccWave + input);
+
+	} else if (events_take(&device_usb_tx_req, txBootInfo)) {
+		uint32_t brt_age;
+		Dc01BootInfoReport report = {
+			.reset_cause = backup_reset_cause,
+			.brt_honoured = boot.brt_honoured,
+			.rtc_started = backup_rtc_started,
+			.resets = backup_resets(),
+			.ready_ms = boot.ready_ms,
+			.dcc_on_ms = boot.dcc_on_ms,
+			.brt_age_s = backup_brt_age(&brt_age) ? brt_age : 0xFFFFFFFF,
+		};
+
+		if (!cdc_main_send_nocopy(DC_CMD_MP_BOOT_INFO, dc01_encode_boot_info_report(data, &report)))
+			events_set(&device_usb_tx_req, txBootInfo);
+
+	} else if (events_take(&device_usb_tx_req, txCrash)) {
+		const CrashRecord *crash = &crash_last;
+		Dc01CrashReport report = {
+			.cause = crash->cause,
+			.dcmode = crash->dcmode,
+			.brt_state = crash->brt_state,
+			.brt_step = crash->brt_step,
+			.uptime_ms = crash->uptime_ms,
+			.cfsr = crash->cfsr,
+			.hfsr = crash->hfsr,
+			.mmfar = crash->mmfar,
+			.bfar = crash->bfar,
+		};
+		for (size_t i = 0; i < 8; i++)
+			report.frame[i] = crash->frame[i];
+		for (size_t i = 0; i < CRASH_TRAIL_SIZE; i++)
+			report.trail[i] = crash->trail[i];
+
+		if (!cdc_main_send_nocopy(DC_CMD_MP_CRASH, dc01_encode_crash_report(data, &report)))
+			events_set(&device_usb_tx_req, txCrash);
+
+	} else if (events_take(&device_usb_tx_req, txHbStats)) {
+		if (cdc_main_send_nocopy(DC_CMD_MP_HB_STATS, dc01_encode_hb_stats_report(data, &hb_stats_report)))
+			hb_stats_pending = false;
+		else
+			events_set(&device_usb_tx_req, txHbStats);
 
-		if (cdc_main_send_nocopy(DC_CMD_MP_BRSTATE, 3))
-			device_usb_tx_req.sep.brtsState = false;
+	} else if (scope_ready()) {
+		// lowest priority: reports above are rare, stream fills the rest
+		if (cdc_main_send_copy(DC_CMD_MP_SCOPE, (uint8_t*)scope_packet(), SCOPE_PACKET_SIZE))
+			scope_sent();
 	}
 }
 
+uint16_t serial_state(void) {
+	// Urgent state for host over notification endpoint, reports follow over bulk
+	return (is_dcc_connected() ? CDC_STATE_DCC_CONNECTED : 0) |
+	       ((dcmode != mFailure) ? CDC_STATE_OK : 0) |
+	       (warnings.sep.timeout ? CDC_STATE_TIMEOUT_WARNING : 0);
+}
+
 void cdc_main_died() {
+	crash_trail(trailPcDied, 0);
+	hbstats_stop();
+	events_clear(&device_usb_tx_req, txHbStats); // nobody waits for the report
+	hb_stats_pending = false;
 	if (dcmode == mNormalOp)
 		dcc_on_timeout();
 }
@@ -470,7 +803,8 @@ void set_mode(DCmode mode) {
 		return;
 	DCmode previous = dcmode;
 	dcmode = mode;
-	device_usb_tx_req.sep.state = true;
+	crash_trail(trailMode, mode);
+	events_set(&device_usb_tx_req, txState);
 
 	if (brtest_running()) {
 		brtest_interrupt();
@@ -505,21 +839,28 @@ void set_mode(DCmode mode) {
 	}
 }
 
+bool dcc_present(size_t input) {
+	// Edges captured by TIM3 are coming (no polling of the input), valid packets only if required
+	return (dccwave[input].present) && ((!DCC_REQUIRE_PACKETS) || (dccdec_present(&dccdec[input])));
+}
+
 bool dcc_at_least_one() {
-	return (!debounced[DEB_DCC1].state) || (!debounced[DEB_DCC2].state);
+	return (dcc_present(DCCDEC_DCC1)) || (dcc_present(DCCDEC_DCC2));
 }
 
 bool dcc_just_single(void) {
-	return (debounced[DEB_DCC1].state) ^ (debounced[DEB_DCC2].state);
+	return (dcc_present(DCCDEC_DCC1)) ^ (dcc_present(DCCDEC_DCC2));
 }
 
 bool dcc_both(void) {
-	return (!debounced[DEB_DCC1].state) || (!debounced[DEB_DCC2].state);
+	return (dcc_present(DCCDEC_DCC1)) || (dcc_present(DCCDEC_DCC2));
 }
 
 void set_relays(bool relay1, bool relay2) {
-	if ((relay1 && relay2) != (_relay1 && _relay2))
-		device_usb_tx_req.sep.state = true;
+	if ((relay1 && relay2) != (_relay1 && _relay2)) {
+		events_set(&device_usb_tx_req, txState);
+		crash_trail(trailRelays, relay1 && relay2);
+	}
 	_relay1 = relay1;
 	_relay2 = relay2;
 	gpio_pin_write(pin_led_go, relay1 && relay2);
@@ -567,16 +908,18 @@ void state_leds_update(void) {
 }
 
 bool is_dcc_pc_alive() {
-	return dccon_timer_ms < DCCON_TIMEOUT_MS;
+	return dccon_timer_ms < dccon_timeout_ms;
 }
 
 void dcc_on_timeout(void) {
+	crash_trail(trailTimeout, 0);
 	appl_set_relays(false);
 	brtest_request = false;
 }
 
 void brtest_finished(void) {
-	device_usb_tx_req.sep.brtsState = true;
+	events_set(&device_usb_tx_req, txBrtsState);
+	backup_brt_passed();
 	brtest_request = false;
 	brtest_timer = 0;
 
@@ -589,14 +932,31 @@ void brtest_finished(void) {
 }
 
 void brtest_failed(void) {
-	device_usb_tx_req.sep.brtsState = true;
+	events_set(&device_usb_tx_req, txBrtsState);
+	backup_brt_forget();
 	set_mode(mFailure);
 }
 
 void brtest_changed(void) {
-	device_usb_tx_req.sep.brtsState = true;
+	events_set(&device_usb_tx_req, txBrtsState);
+	crash_trail(trailBrt, (brTestState << 4) | brTestStep);
 }
 
 bool _brtest_is_time(void) {
 	return brtest_timer >= BRTEST_NOTEST_MAX_TIME;
 }
+
+/* DCC inputs ----------------------------------------------------------------*/
+
+void dcc_edges_process(void) {
+	// Edges buffered by TIM3 interrupt → DCC decoders & waveform metrics
+	for (size_t i = 0; i < DCCDEC_COUNT; i++) {
+		Edge edge;
+		while (edges_pop(&edges[i], &edge)) {
+			if (edge.flags & EDGE_GAP)
+				dccdec_resync(&dccdec[i]);
+			dccdec_edge(&dccdec[i], edge.timestamp);
+			dccwave_edge(&dccwave[i], &edge);
+		}
+	}
+}
@@ -0,0 +1,94 @@
+/* DCC scope implementation
+ * See scope.h for more information.
+ */
+
+#include "scope.h"
+
+/* Private variables ---------------------------------------------------------*/
+
+static uint8_t buffers[2][SCOPE_PACKET_SIZE];
+static volatile size_t filling; // buffer being filled by interrupt
+static volatile bool ready; // buffer filling^1 waits for USB
+static volatile bool running;
+static uint8_t flags;
+static size_t sample_shift; // log2(samples per byte)
+static size_t samples_per_packet;
+static size_t sample_pos;
+static uint16_t seq;
+static uint8_t dropped;
+
+/* Code ----------------------------------------------------------------------*/
+
+void scope_start(uint8_t new_flags) {
+	// Called from USB ISR, TIM2 ISR has the same priority → no preemption
+	running = false;
+	flags = new_flags & (SCOPE_RUN | SCOPE_RELAYS);
+	sample_shift = (flags & SCOPE_RELAYS) ? 1 : 2;
+	samples_per_packet = SCOPE_SAMPLES_SIZE << sample_shift;
+	sample_pos = 0;
+	seq = 0;
+	dropped = 0;
+	filling = 0;
+	ready = false;
+	running = (flags & SCOPE_RUN);
+}
+
+void scope_stop(void) {
+	running = false;
+	ready = false;
+}
+
+bool scope_running(void) {
+	return running;
+}
+
+void scope_sample(bool relay1, bool relay2) {
+	if (!running)
+		return;
+
+	uint8_t sample = ((pin_dcc1.port->IDR & pin_dcc1.pin) ? 0x1 : 0) |
+	                 ((pin_dcc2.port->IDR & pin_dcc2.pin) ? 0x2 : 0);
+	if (flags & SCOPE_RELAYS)
+		sample |= (relay1 ? 0x4 : 0) | (relay2 ? 0x8 : 0);
+
+	uint8_t *samples = &buffers[filling][SCOPE_HEADER_SIZE];
+	size_t byte = sample_pos >> sample_shift;
+	size_t shift = (sample_pos & ((1 << sample_shift)-1)) << (3-sample_shift);
+	if (shift == 0)
+		samples[byte] = sample;
+	else
+		samples[byte] |= sample << shift;
+
+	sample_pos++;
+	if (sample_pos < samples_per_packet)
+		return;
+
+	sample_pos = 0;
+	if (ready) {
+		// previous packet not sent yet → drop this one
+		if (dropped < 0xFF)
+			dropped++;
+	} else {
+		uint8_t *header = buffers[filling];
+		header[0] = seq >> 8;
+		header[1] = seq & 0xFF;
+		header[2] = flags;
+		header[3] = dropped;
+		dropped = 0;
+		filling ^= 1;
+		ready = true;
+	}
+	seq++;
+}
+
+bool scope_ready(void) {
+	return ready;
+}
+
+const uint8_t *scope_packet(void) {
+	return buffers[filling^1];
+}
+
+void scope_sent(void) {
+	ready = false;
+}
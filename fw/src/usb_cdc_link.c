@@ -4,14 +4,17 @@
 #include <string.h>
 #include "usb_cdc_link.h"
 #include "usb_cdc.h"
+#include "dc_frame.h"
 #include "gpio.h"
 #include "leds.h"
 
 static void main_cdc_rx(usbd_device *dev, uint8_t event, uint8_t ep);
 static void main_cdc_tx(usbd_device *dev, uint8_t event, uint8_t ep);
+static void main_cdc_ntf(usbd_device *dev, uint8_t event, uint8_t ep);
+static void ntf_send(void);
 
 struct {
-	uint32_t pos;
+	size_t pos;
 	uint8_t fifo[CDC_DC_BUF_SIZE];
 } rx;
 
@@ -23,6 +26,17 @@ struct {
 
 CdcTxData cdc_tx;
 
+#define NTF_SERIAL_STATE_SIZE 10 // header + 16-bit state
+#define NTF_STATE_NONE 0xFFFF // nothing sent since configuration
+
+struct {
+	uint16_t state; // requested by application
+	uint16_t sent; // last state written to the endpoint
+	bool configured;
+	volatile bool sending; // cleared by USB interrupt
+	uint8_t packet[NTF_SERIAL_STATE_SIZE];
+} ntf;
+
 bool _cdc_main_send(uint8_t command_code, uint8_t *data, size_t datasize, bool copy);
 
 
@@ -170,7 +184,7 @@ static struct cdc_config config_desc = {
 		.bFunctionLength = sizeof(struct usb_cdc_acm_desc),
 		.bDescriptorType = USB_DTYPE_CS_INTERFACE,
 		.bDescriptorSubType = USB_DTYPE_CDC_ACM,
-		.bmCapabilities = 0,
+		.bmCapabilities = USB_CDC_CAP_LINE, // line coding, control line state & SERIAL_STATE notification
 	},
 	.main_cdc_union = {
 		.bFunctionLength = sizeof(struct usb_cdc_union_desc),
@@ -185,7 +199,7 @@ static struct cdc_config config_desc = {
 		.bEndpointAddress = CDC_MAIN_NTF_EP,
 		.bmAttributes = USB_EPTYPE_INTERRUPT,
 		.wMaxPacketSize = CDC_NTF_SZ,
-		.bInterval = 0xFF,
+		.bInterval = CDC_MAIN_NTF_INTERVAL,
 	},
 	.main_data = {
 		.bLength = sizeof(struct usb_interface_descriptor),
@@ -413,6 +427,7 @@ static usbd_respond cdc_setconf(usbd_device* dev, uint8_t cfg) {
 	switch (cfg) {
 	case 0:
 		/* deconfiguring device */
+		ntf.configured = false;
 		usbd_ep_deconfig(dev, CDC_MAIN_NTF_EP);
 		usbd_ep_deconfig(dev, CDC_MAIN_TXD_EP);
 		usbd_ep_deconfig(dev, CDC_MAIN_RXD_EP);
@@ -436,6 +451,12 @@ static usbd_respond cdc_setconf(usbd_device* dev, uint8_t cfg) {
 
 		usbd_reg_endpoint(dev, CDC_MAIN_RXD_EP, main_cdc_rx);
 		usbd_reg_endpoint(dev, CDC_MAIN_TXD_EP, main_cdc_tx);
+		usbd_reg_endpoint(dev, CDC_MAIN_NTF_EP, main_cdc_ntf);
+
+		// Host learns current state as soon as it polls the endpoint
+		ntf.sent = NTF_STATE_NONE;
+		ntf.sending = false;
+		ntf.configured = true;
 
 		return usbd_ack;
 	default:
@@ -448,6 +469,8 @@ void cdc_init() {
 
 	rx.pos = 0;
 	tx.sending = false;
+	ntf.configured = false;
+	ntf.state = 0;
 
 	uint32_t uid[3];
 	uid[0] = HAL_GetUIDw0();
@@ -515,31 +538,7 @@ static void main_cdc_rx(usbd_device *dev, uint8_t event, uint8_t ep) {
 	last_time = HAL_GetTick();
 
 	rx.pos += usbd_ep_read(dev, ep, &rx.fifo[rx.pos], CDC_DATA_SZ);
-
-	if (rx.pos >= 3) {
-		size_t msg_begin_pos = 0;
-		size_t msg_length;
-		do {
-			if ((rx.fifo[msg_begin_pos] != 0x37) || (rx.fifo[msg_begin_pos+1] != 0xE2)) {
-				rx.pos = 0;
-				return;
-			}
-			msg_length = rx.fifo[msg_begin_pos+2];
-			if (msg_length > 123) { // invalid data
-				rx.pos = 0;
-				return;
-			}
-			if (rx.pos-msg_begin_pos >= msg_length+3) {
-				cdc_main_received(rx.fifo[msg_begin_pos+3], &rx.fifo[msg_begin_pos+4], msg_length-1);
-				msg_begin_pos += msg_length+3;
-			}
-		} while (rx.pos-msg_begin_pos >= msg_length+3);
-
-		// move last unfinished message to begin of buffer
-		for (size_t i = 0; i < rx.pos-msg_begin_pos; i++)
-			rx.fifo[i] = rx.fifo[i+msg_begin_pos];
-		rx.pos = rx.pos-msg_begin_pos;
-	}
+	dc_frame_parse(rx.fifo, &rx.pos, cdc_main_received);
 }
 
 
@@ -595,6 +594,46 @@ bool cdc_main_send_nocopy(uint8_t command_code, size_t datasize) {
 	return _cdc_main_send(command_code, NULL, datasize, false);
 }
 
+/* Serial state notification -------------------------------------------------*/
+/* Urgent state is signalled to host by CDC SERIAL_STATE notification over
+ * the interrupt endpoint, independently of packets on bulk endpoint. Only
+ * the latest state matters: state changed while a notification is in flight
+ * is sent by the next call after its completion. */
+
+void cdc_main_serial_state(uint16_t state) {
+	ntf.state = state;
+	ntf_send();
+}
+
+static void ntf_send(void) {
+	if ((!ntf.configured) || (ntf.sending) || (ntf.state == ntf.sent))
+		return;
+
+	uint16_t state = ntf.state;
+	ntf.packet[0] = USB_REQ_DEVTOHOST | USB_REQ_CLASS | USB_REQ_INTERFACE; // bmRequestType
+	ntf.packet[1] = USB_CDC_NTF_SERIAL_STATE;
+	ntf.packet[2] = 0; // wValue
+	ntf.packet[3] = 0;
+	ntf.packet[4] = INTERFACE_MAIN_COMM; // wIndex
+	ntf.packet[5] = 0;
+	ntf.packet[6] = 2; // wLength
+	ntf.packet[7] = 0;
+	ntf.packet[8] = state & 0xFF;
+	ntf.packet[9] = state >> 8;
+
+	ntf.sending = true;
+	if (usbd_ep_write(&udev, CDC_MAIN_NTF_EP, ntf.packet, NTF_SERIAL_STATE_SIZE) != NTF_SERIAL_STATE_SIZE) {
+		ntf.sending = false; // endpoint busy, retried by next call
+		return;
+	}
+	ntf.sent = state;
+}
+
+static void main_cdc_ntf(usbd_device *dev, uint8_t event, uint8_t ep) {
+	if (event == usbd_evt_eptx)
+		ntf.sending = false; // not resent from interrupt, main loop calls cdc_main_serial_state
+}
+
 /* Debug CDC -----------------------------------------------------------------*/
 
 int cdc_debug_send(uint8_t *data, size_t datasize) {
@@ -0,0 +1,30 @@
+/* Minimal host test helpers: failed checks are reported & counted, test
+ * exits with non-zero status when any check failed.
+ */
+
+#pragma once
+
+#include <stdio.h>
+#include <stdlib.h>
+
+static int test_failures;
+
+#define CHECK(cond) do { \
+	if (!(cond)) { \
+		fprintf(stderr, "%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #cond); \
+		test_failures++; \
+	} \
+} while (0)
+
+#define CHECK_EQ(actual, expected) do { \
+	long long _a = (actual), _e = (expected); \
+	if (_a != _e) { \
+		fprintf(stderr, "%s:%d: %s == %lld, expected %lld\n", __FILE__, __LINE__, #actual, _a, _e); \
+		test_failures++; \
+	} \
+} while (0)
+
+static inline int test_result(const char *name) {
+	printf("%s: %s\n", name, test_failures ? "FAILED" : "ok");
+	return test_failures ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,276 @@
+/* Host test of DCC packet decoder (dccdec.c).
+ * Edges are generated from half-periods, timestamps start just below
+ * 16-bit wrap of the input capture timer.
+ */
+
+#include <stdint.h>
+#include <string.h>
+#include "dccdec.h"
+#include "test.h"
+
+#define ONE_US 58
+#define ZERO_US 100
+#define CUTOUT_US 460 // RailCom cutout seen by decoder as one long half
+
+static DccDecoder dec;
+static uint16_t t;
+
+/* Private function prototypes -----------------------------------------------*/
+
+static void _reset(void);
+static void _half(uint16_t half_us);
+static void _bit(bool bit);
+static void _preamble(size_t bits);
+static void _packet(const uint8_t *bytes, size_t size, size_t preamble);
+static void _idle(size_t preamble);
+static void _ms(size_t ms);
+
+static void _test_idle(void);
+static void _test_cutout(void);
+static void _test_preamble(void);
+static void _test_bit_errors(void);
+static void _test_checksum(void);
+static void _test_packet_size(void);
+static void _test_resync(void);
+static void _test_lost_present_rate(void);
+
+/* Code ----------------------------------------------------------------------*/
+
+int main(void) {
+	_test_idle();
+	_test_cutout();
+	_test_preamble();
+	_test_bit_errors();
+	_test_checksum();
+	_test_packet_size();
+	_test_resync();
+	_test_lost_present_rate();
+	return test_result("test_dccdec");
+}
+
+void _reset(void) {
+	memset(&dec, 0xA5, sizeof(dec)); // dccdec_init must not depend on zeroed memory
+	dccdec_init(&dec);
+	t = 65500;
+	dccdec_edge(&dec, t); // synchronizing edge
+}
+
+void _half(uint16_t half_us) {
+	t += half_us;
+	dccdec_edge(&dec, t);
+}
+
+void _bit(bool bit) {
+	_half(bit ? ONE_US : ZERO_US);
+	_half(bit ? ONE_US : ZERO_US);
+}
+
+void _preamble(size_t bits) {
+	for (size_t i = 0; i < bits; i++)
+		_bit(1);
+}
+
+void _packet(const uint8_t *bytes, size_t size, size_t preamble) {
+	_preamble(preamble);
+	for (size_t i = 0; i < size; i++) {
+		_bit(0);
+		for (int b = 7; b >= 0; b--)
+			_bit((bytes[i] >> b) & 1);
+	}
+	_bit(1);
+}
+
+void _idle(size_t preamble) {
+	static const uint8_t idle[] = {0xFF, 0x00, 0xFF};
+	_packet(idle, sizeof(idle), preamble);
+}
+
+void _ms(size_t ms) {
+	for (size_t i = 0; i < ms; i++)
+		dccdec_update_1ms(&dec);
+}
+
+void _test_idle(void) {
+	_reset();
+	for (size_t i = 0; i < 100; i++)
+		_idle(14);
+	CHECK_EQ(dec.stats.packets, 100);
+	CHECK_EQ(dec.stats.bit_errors, 0);
+	CHECK_EQ(dec.stats.checksum_errors, 0);
+	CHECK(dccdec_present(&dec));
+
+	// minimal preamble after end bit of previous packet
+	_idle(10);
+	_idle(9); // end bit of previous packet completes the preamble
+	CHECK_EQ(dec.stats.packets, 102);
+	CHECK_EQ(dec.stats.bit_errors, 0);
+}
+
+void _test_cutout(void) {
+	_reset();
+	for (size_t i = 0; i < 100; i++) {
+		_idle(14);
+		_half(CUTOUT_US);
+	}
+	CHECK_EQ(dec.stats.packets, 100);
+	CHECK_EQ(dec.stats.bit_errors, 0);
+
+	// out-of-spec half right after packet end starts the cutout too
+	_reset();
+	for (size_t i = 0; i < 100; i++) {
+		_idle(14);
+		_half(20);
+		_half(CUTOUT_US);
+	}
+	CHECK_EQ(dec.stats.packets, 100);
+	CHECK_EQ(dec.stats.bit_errors, 0);
+
+	// but not in the middle of packet
+	_idle(14);
+	_half(ONE_US);
+	_half(20);
+	CHECK_EQ(dec.stats.bit_errors, 1);
+}
+
+void _test_preamble(void) {
+	// short preamble: packet is skipped, not counted as error
+	_reset();
+	_idle(9);
+	CHECK_EQ(dec.stats.packets, 0);
+	CHECK_EQ(dec.stats.bit_errors, 0);
+	CHECK_EQ(dec.stats.checksum_errors, 0);
+	_idle(14);
+	CHECK_EQ(dec.stats.packets, 1);
+
+	// preamble of 10 bits from lost signal
+	_reset();
+	_idle(10);
+	CHECK_EQ(dec.stats.packets, 1);
+
+	// '1' start bit: one half of start bit is '1'
+	_reset();
+	_preamble(14);
+	_half(ZERO_US);
+	_half(ONE_US);
+	CHECK_EQ(dec.stats.bit_errors, 1);
+	_idle(14);
+	CHECK_EQ(dec.stats.packets, 1);
+}
+
+void _test_bit_errors(void) {
+	// half between '1' and '0' ranges
+	_reset();
+	_preamble(14);
+	_bit(0);
+	_bit(1);
+	_half(75);
+	CHECK_EQ(dec.stats.bit_errors, 1);
+	_idle(14);
+	CHECK_EQ(dec.stats.packets, 1);
+
+	// too short & too long halves
+	_reset();
+	_preamble(14);
+	_bit(0);
+	_half(40);
+	_preamble(14);
+	_bit(0);
+	_half(20000);
+	CHECK_EQ(dec.stats.bit_errors, 2);
+
+	// halves of bit differ
+	_reset();
+	_preamble(14);
+	_bit(0);
+	_half(ONE_US);
+	_half(ZERO_US);
+	CHECK_EQ(dec.stats.bit_errors, 1);
+	_idle(14);
+	CHECK_EQ(dec.stats.packets, 1);
+	CHECK_EQ(dec.stats.checksum_errors, 0);
+}
+
+void _test_checksum(void) {
+	static const uint8_t bad[] = {0x03, 0x3F, 0x10, 0x2D}; // correct checksum 0x2C
+	static const uint8_t good[] = {0x03, 0x3F, 0x10, 0x2C};
+
+	_reset();
+	_packet(bad, sizeof(bad), 14);
+	CHECK_EQ(dec.stats.checksum_errors, 1);
+	CHECK_EQ(dec.stats.packets, 0);
+	CHECK_EQ(dec.stats.bit_errors, 0);
+	CHECK(!dccdec_present(&dec));
+	_packet(good, sizeof(good), 14);
+	CHECK_EQ(dec.stats.checksum_errors, 1);
+	CHECK_EQ(dec.stats.packets, 1);
+}
+
+void _test_packet_size(void) {
+	static const uint8_t shortp[] = {0x03, 0x03};
+	static const uint8_t longest[] = {0x01, 0x02, 0x04, 0x08, 0x10, 0x1F};
+	static const uint8_t longp[] = {0x01, 0x02, 0x04, 0x08, 0x10, 0x20, 0x3F};
+
+	_reset();
+	_packet(shortp, sizeof(shortp), 14);
+	CHECK_EQ(dec.stats.bit_errors, 1);
+	CHECK_EQ(dec.stats.packets, 0);
+
+	_packet(longest, sizeof(longest), 14);
+	CHECK_EQ(dec.stats.bit_errors, 1);
+	CHECK_EQ(dec.stats.packets, 1);
+
+	_packet(longp, sizeof(longp), 14);
+	CHECK_EQ(dec.stats.bit_errors, 2);
+	CHECK_EQ(dec.stats.packets, 1);
+	CHECK_EQ(dec.stats.checksum_errors, 0);
+}
+
+void _test_resync(void) {
+	// edges lost in the middle of packet: half across the gap is not measured
+	_reset();
+	_preamble(14);
+	_bit(0);
+	_bit(1);
+	dccdec_resync(&dec);
+	CHECK_EQ(dec.state, dccdsLost);
+	_half(75); // would be bit error
+	CHECK_EQ(dec.stats.bit_errors, 0);
+	CHECK_EQ(dec.state, dccdsPreamble);
+	_bit(0); // rest of interrupted packet
+	_bit(1);
+	_idle(14);
+	CHECK_EQ(dec.stats.bit_errors, 0);
+	CHECK_EQ(dec.stats.packets, 1);
+}
+
+void _test_lost_present_rate(void) {
+	_reset();
+	_idle(14);
+	CHECK(dccdec_present(&dec));
+
+	// no edge for DCCDEC_LOST_MS: next edge only synchronizes
+	_ms(DCCDEC_LOST_MS-1);
+	CHECK(dec.state != dccdsLost);
+	_ms(1);
+	CHECK_EQ(dec.state, dccdsLost);
+	_half(75);
+	CHECK_EQ(dec.stats.bit_errors, 0);
+	CHECK(dccdec_present(&dec));
+	_ms(DCCDEC_PRESENT_MS - DCCDEC_LOST_MS);
+	CHECK(!dccdec_present(&dec));
+
+	// rate: packets within last whole second
+	_reset();
+	_ms(999);
+	CHECK_EQ(dec.stats.rate, 0);
+	for (size_t i = 0; i < 150; i++)
+		_idle(14);
+	_ms(1);
+	CHECK_EQ(dec.stats.rate, 150);
+	for (size_t i = 0; i < 20; i++)
+		_idle(14);
+	_ms(1000);
+	CHECK_EQ(dec.stats.rate, 20);
+	_ms(1000);
+	CHECK_EQ(dec.stats.rate, 0);
+}
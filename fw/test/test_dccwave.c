@@ -0,0 +1,326 @@
+/* Host test of edge rings (edges.c) & DCC waveform metrics (dccwave.c),
+ * including DCC decoder fed from a ring which lost edges (as by
+ * dcc_edges_process in main.c).
+ */
+
+#include <stdint.h>
+#include <string.h>
+#include "dccdec.h"
+#include "dccwave.h"
+#include "edges.h"
+#include "test.h"
+
+#define ONE_US 58
+#define ZERO_US 100
+#define CUTOUT_US 460
+
+static EdgeRing ring;
+static DccWave wave;
+static DccDecoder dec;
+static uint16_t t;
+static bool low; // input level after the last edge
+
+/* Private function prototypes -----------------------------------------------*/
+
+static void _reset(void);
+static void _process(void);
+static void _edge(uint16_t half_us, bool low_after);
+static void _half(uint16_t half_us);
+static void _bit(bool bit);
+static void _idle(void);
+static void _ms(size_t ms);
+static uint32_t _halves(void);
+
+static void _test_ring(void);
+static void _test_bins(void);
+static void _test_cutout(void);
+static void _test_gap(void);
+static void _test_window(void);
+static void _test_losses(void);
+static void _test_decoder_resync(void);
+
+/* Code ----------------------------------------------------------------------*/
+
+int main(void) {
+	_test_ring();
+	_test_bins();
+	_test_cutout();
+	_test_gap();
+	_test_window();
+	_test_losses();
+	_test_decoder_resync();
+	return test_result("test_dccwave");
+}
+
+void _reset(void) {
+	edges_init(&ring);
+	dccwave_init(&wave);
+	dccdec_init(&dec);
+	t = 65000;
+	low = false;
+	_edge(0, true); // synchronizing edge
+}
+
+// As dcc_edges_process in main.c
+void _process(void) {
+	Edge edge;
+	while (edges_pop(&ring, &edge)) {
+		if (edge.flags & EDGE_GAP)
+			dccdec_resync(&dec);
+		dccdec_edge(&dec, edge.timestamp);
+		dccwave_edge(&wave, &edge);
+	}
+}
+
+// Edge pushed by interrupt, main loop processes it immediately
+void _edge(uint16_t half_us, bool low_after) {
+	t += half_us;
+	low = low_after;
+	edges_push(&ring, t, low);
+	_process();
+}
+
+void _half(uint16_t half_us) {
+	_edge(half_us, !low);
+}
+
+void _bit(bool bit) {
+	_half(bit ? ONE_US : ZERO_US);
+	_half(bit ? ONE_US : ZERO_US);
+}
+
+void _idle(void) {
+	static const uint8_t idle[] = {0xFF, 0x00, 0xFF};
+	for (size_t i = 0; i < 14; i++)
+		_bit(1);
+	for (size_t i = 0; i < sizeof(idle); i++) {
+		_bit(0);
+		for (int b = 7; b >= 0; b--)
+			_bit((idle[i] >> b) & 1);
+	}
+	_bit(1);
+}
+
+void _ms(size_t ms) {
+	for (size_t i = 0; i < ms; i++) {
+		dccwave_update_1ms(&wave);
+		dccdec_update_1ms(&dec);
+	}
+}
+
+uint32_t _halves(void) {
+	uint32_t sum = 0;
+	for (size_t i = 0; i < DCCWAVE_BINS; i++)
+		sum += wave.stats.halves[i];
+	return sum;
+}
+
+void _test_ring(void) {
+	Edge edge;
+
+	edges_init(&ring);
+	CHECK(!edges_pop(&ring, &edge));
+
+	// full ring: further edges are lost, counted once per gap
+	for (size_t i = 0; i < EDGES_RING_SIZE+10; i++)
+		edges_push(&ring, i, i & 1);
+	CHECK_EQ(ring.lost, 1);
+	for (size_t i = 0; i < EDGES_RING_SIZE; i++) {
+		CHECK(edges_pop(&ring, &edge));
+		CHECK_EQ(edge.timestamp, i);
+		CHECK_EQ(edge.flags, (i & 1) ? EDGE_LOW : 0);
+	}
+	CHECK(!edges_pop(&ring, &edge));
+
+	// next edge is marked, the one after it is not
+	edges_push(&ring, 1000, true);
+	edges_push(&ring, 1058, false);
+	CHECK(edges_pop(&ring, &edge));
+	CHECK_EQ(edge.flags, EDGE_LOW | EDGE_GAP);
+	CHECK(edges_pop(&ring, &edge));
+	CHECK_EQ(edge.flags, 0);
+
+	// overcapture
+	edges_lost(&ring);
+	edges_lost(&ring);
+	edges_push(&ring, 2000, false);
+	CHECK_EQ(ring.lost, 2);
+	CHECK(edges_pop(&ring, &edge));
+	CHECK_EQ(edge.flags, EDGE_GAP);
+
+	// indexes wrap
+	for (size_t i = 0; i < 1000; i++) {
+		edges_push(&ring, i, false);
+		CHECK(edges_pop(&ring, &edge));
+		CHECK_EQ(edge.timestamp, i);
+	}
+	CHECK(!edges_pop(&ring, &edge));
+	CHECK_EQ(ring.lost, 2);
+}
+
+void _test_bins(void) {
+	static const struct {
+		uint16_t half_us;
+		uint8_t bin;
+	} halves[] = {
+		{51, DCCWAVE_BIN_SHORT},
+		{52, DCCWAVE_BIN_ONE_SHORT}, {54, DCCWAVE_BIN_ONE_SHORT},
+		{55, DCCWAVE_BIN_ONE}, {61, DCCWAVE_BIN_ONE},
+		{62, DCCWAVE_BIN_ONE_LONG}, {64, DCCWAVE_BIN_ONE_LONG},
+		{65, DCCWAVE_BIN_INVALID}, {89, DCCWAVE_BIN_INVALID},
+		{90, DCCWAVE_BIN_ZERO_SHORT}, {94, DCCWAVE_BIN_ZERO_SHORT},
+		{95, DCCWAVE_BIN_ZERO}, {9900, DCCWAVE_BIN_ZERO},
+		{9901, DCCWAVE_BIN_LONG}, {30000, DCCWAVE_BIN_LONG},
+	};
+
+	_reset();
+	CHECK_EQ(_halves(), 0); // first edge only synchronizes
+	for (size_t i = 0; i < sizeof(halves)/sizeof(halves[0]); i++) {
+		uint32_t before = wave.stats.halves[halves[i].bin];
+		_half(halves[i].half_us);
+		CHECK_EQ(wave.stats.halves[halves[i].bin], before+1);
+		CHECK_EQ(_halves(), i+1);
+	}
+}
+
+void _test_cutout(void) {
+	_reset(); // input is low
+	_edge(ONE_US, false);
+	_edge(CUTOUT_US, true); // high half
+	CHECK_EQ(wave.stats.cutouts, 1);
+	CHECK_EQ(wave.stats.cutout_us, CUTOUT_US);
+
+	_edge(CUTOUT_US+1, false); // low half is not a cutout
+	CHECK_EQ(wave.stats.cutouts, 1);
+
+	_edge(DCCWAVE_CUTOUT_MIN_US-1, true);
+	_edge(ONE_US, false);
+	_edge(DCCWAVE_CUTOUT_MAX_US+1, true);
+	CHECK_EQ(wave.stats.cutouts, 1);
+
+	_edge(ONE_US, false);
+	_edge(DCCWAVE_CUTOUT_MIN_US, true);
+	_edge(ONE_US, false);
+	_edge(DCCWAVE_CUTOUT_MAX_US, true);
+	CHECK_EQ(wave.stats.cutouts, 3);
+	CHECK_EQ(wave.stats.cutout_us, DCCWAVE_CUTOUT_MAX_US);
+
+	// cutouts between packets are tolerated by decoder
+	for (size_t i = 0; i < 50; i++) {
+		_idle(); // end bit finishes high
+		_edge(CUTOUT_US, true);
+	}
+	CHECK_EQ(wave.stats.cutouts, 53);
+	CHECK_EQ(dec.stats.packets, 50);
+	CHECK_EQ(dec.stats.bit_errors, 0);
+}
+
+void _test_gap(void) {
+	_reset();
+	_half(ONE_US);
+	edges_lost(&ring);
+	_half(75); // would be invalid half
+	CHECK_EQ(_halves(), 1);
+	CHECK_EQ(wave.stats.halves[DCCWAVE_BIN_INVALID], 0);
+	_half(ONE_US);
+	CHECK_EQ(_halves(), 2);
+	CHECK_EQ(dec.stats.bit_errors, 0);
+}
+
+void _test_window(void) {
+	_reset();
+	dccwave_init(&wave); // window starts with unsynchronized input
+
+	// 5 kHz, low for 60 %
+	for (size_t ms = 0; ms < 1000; ms++) {
+		for (size_t i = 0; i < 5; i++) {
+			_edge(80, true);
+			_edge(120, false);
+		}
+		_ms(1);
+	}
+	CHECK_EQ(wave.stats.frequency, 5000);
+	CHECK_EQ(wave.stats.low_permille, 600);
+
+	// idle packets: equal halves
+	for (size_t ms = 0; ms < 1000; ms++) {
+		for (size_t i = 0; i < 5; i++) {
+			_half(100);
+			_half(100);
+		}
+		_ms(1);
+	}
+	CHECK_EQ(wave.stats.frequency, 5000);
+	CHECK_EQ(wave.stats.low_permille, 500);
+
+	// no edges
+	_ms(1000);
+	CHECK_EQ(wave.stats.frequency, 0);
+	CHECK_EQ(wave.stats.low_permille, 0);
+}
+
+void _test_losses(void) {
+	_reset();
+	dccwave_init(&wave); // signal absent since reset is not a loss
+	_ms(100);
+	CHECK_EQ(wave.stats.losses, 0);
+	CHECK_EQ(wave.stats.lost_ms, 0);
+
+	_half(ONE_US);
+	CHECK(wave.present);
+	_ms(DCCWAVE_LOST_MS-1);
+	CHECK(wave.present);
+	CHECK_EQ(wave.stats.losses, 0);
+	_ms(1);
+	CHECK(!wave.present);
+	CHECK_EQ(wave.stats.losses, 1);
+	CHECK_EQ(wave.stats.loss_ms, DCCWAVE_LOST_MS);
+	_ms(10);
+	CHECK_EQ(wave.stats.loss_ms, DCCWAVE_LOST_MS+10);
+	CHECK_EQ(wave.stats.lost_ms, DCCWAVE_LOST_MS+10);
+
+	// half across the loss is not measured
+	uint32_t halves = _halves();
+	_half(ONE_US);
+	CHECK(wave.present);
+	CHECK_EQ(_halves(), halves);
+	_half(ONE_US);
+	CHECK_EQ(_halves(), halves+1);
+
+	_ms(DCCWAVE_LOST_MS+5);
+	CHECK_EQ(wave.stats.losses, 2);
+	CHECK_EQ(wave.stats.loss_ms, DCCWAVE_LOST_MS+5);
+	CHECK_EQ(wave.stats.lost_ms, 2*DCCWAVE_LOST_MS+15);
+}
+
+void _test_decoder_resync(void) {
+	// Main loop stalls, ring overflows at different positions within packets;
+	// decoder must resynchronize without bit or checksum errors.
+	for (size_t stall = 0; stall < 80; stall++) {
+		_reset();
+		for (size_t i = 0; i < 5; i++) {
+			_idle();
+			_edge(CUTOUT_US, true);
+		}
+		for (size_t i = 0; i < stall; i++)
+			_bit(1);
+
+		uint8_t head = ring.head;
+		for (size_t i = 0; i < EDGES_RING_SIZE+7; i++) { // no processing
+			t += ONE_US;
+			low = !low;
+			edges_push(&ring, t, low);
+		}
+		CHECK_EQ((uint8_t)(ring.head - head), EDGES_RING_SIZE);
+		CHECK_EQ(ring.lost, 1);
+
+		for (size_t i = 0; i < 5; i++) {
+			_idle();
+			_edge(CUTOUT_US, true);
+		}
+		CHECK_EQ(dec.stats.bit_errors, 0);
+		CHECK_EQ(dec.stats.checksum_errors, 0);
+		CHECK(dec.stats.packets >= 9);
+		CHECK_EQ(wave.stats.halves[DCCWAVE_BIN_INVALID], 0);
+	}
+}
@@ -0,0 +1,135 @@
+/* Stress test of event flags (events.h, host variant).
+ *
+ * Interval timer signal plays the interrupt: it sets events while the main
+ * loop takes them, polling by events_take or sleeping in events_wait_any.
+ * Each event is set again only after its previous set was taken, so a set
+ * cleared without being taken (e.g. by read-modify-write of another flag)
+ * stops the event & is reported as lost.
+ */
+
+#include <signal.h>
+#include <stdint.h>
+#include <string.h>
+#include <sys/time.h>
+#include "events.h"
+#include "test.h"
+
+#define EVENTS 16
+#define EVENT_TICK 30 // set by every "interrupt", wait-any returns even when events are lost
+#define EVENT_MAIN 31 // set & cleared by main loop only
+#define SETS 1100000 // per test
+#define TIMER_US 20
+#define STALL_S 2 // no event set for this time → events were lost
+
+static Events events;
+static volatile uint32_t sets[EVENTS]; // written by "interrupt" only
+static volatile uint32_t taken[EVENTS]; // written by main loop only
+static volatile uint32_t total_sets;
+
+/* Private function prototypes -----------------------------------------------*/
+
+static void _interrupt(int sig);
+static void _timer(uint32_t interval_us);
+static void _run(const char *name, bool wait_any);
+static bool _stalled(void);
+
+/* Code ----------------------------------------------------------------------*/
+
+int main(void) {
+	struct sigaction sa;
+	memset(&sa, 0, sizeof(sa));
+	sa.sa_handler = _interrupt;
+	sa.sa_flags = SA_RESTART;
+	sigaction(SIGALRM, &sa, NULL);
+
+	_run("take", false);
+	_run("wait-any", true);
+	return test_result("test_events");
+}
+
+void _run(const char *name, bool wait_any) {
+	const uint32_t mask = EVENT_BIT(EVENTS) - 1;
+	uint32_t wakeups = 0;
+	events = 0;
+	total_sets = 0;
+	for (size_t e = 0; e < EVENTS; e++)
+		sets[e] = taken[e] = 0;
+	_timer(TIMER_US);
+
+	if (wait_any)
+		events_set(&events, EVENT_MAIN); // not in the mask, must not wake up
+	while ((total_sets < SETS) && (!_stalled())) {
+		if (wait_any) {
+			uint32_t pending = events_wait_any(&events, mask | EVENT_BIT(EVENT_TICK));
+			wakeups++;
+			CHECK(pending != 0);
+			CHECK((pending & ~(mask | EVENT_BIT(EVENT_TICK))) == 0);
+			events_take(&events, EVENT_TICK);
+			for (uint8_t e = 0; e < EVENTS; e++)
+				if ((pending & EVENT_BIT(e)) && (events_take(&events, e)))
+					taken[e]++;
+		} else {
+			for (uint8_t e = 0; e < EVENTS; e++)
+				if (events_take(&events, e))
+					taken[e]++;
+			// read-modify-write of the word would store flags set meanwhile as cleared
+			events_set(&events, EVENT_MAIN);
+			events_clear(&events, EVENT_MAIN);
+		}
+	}
+	_timer(0);
+
+	for (uint8_t e = 0; e < EVENTS; e++)
+		if (events_take(&events, e))
+			taken[e]++;
+	events_clear(&events, EVENT_TICK);
+	events_clear(&events, EVENT_MAIN);
+
+	uint32_t lost = 0;
+	for (size_t e = 0; e < EVENTS; e++)
+		lost += sets[e] - taken[e];
+	printf("test_events: %s: %u sets, %u lost", name, total_sets, lost);
+	if (wait_any)
+		printf(", %u wake-ups", wakeups);
+	printf("\n");
+	CHECK(total_sets >= SETS);
+	CHECK_EQ(lost, 0);
+	CHECK_EQ(events, 0);
+}
+
+// Called by main loop from time to time
+bool _stalled(void) {
+	static uint32_t calls, last_sets;
+	static time_t last_set_s;
+	if ((++calls % 4096) != 0)
+		return false;
+
+	struct timeval now;
+	gettimeofday(&now, NULL);
+	if ((total_sets != last_sets) || (last_set_s == 0)) {
+		last_sets = total_sets;
+		last_set_s = now.tv_sec;
+		return false;
+	}
+	return now.tv_sec - last_set_s > STALL_S;
+}
+
+void _interrupt(int sig) {
+	(void)sig;
+	for (uint8_t e = 0; e < EVENTS; e++) {
+		if (sets[e] != taken[e])
+			continue; // previous set not taken yet
+		sets[e]++;
+		total_sets++;
+		events_set(&events, e);
+	}
+	events_set(&events, EVENT_TICK);
+}
+
+void _timer(uint32_t interval_us) {
+	struct itimerval timer = {
+		.it_interval = {.tv_sec = 0, .tv_usec = interval_us},
+		.it_value = {.tv_sec = 0, .tv_usec = interval_us},
+	};
+	setitimer(ITIMER_REAL, &timer, NULL);
+}
@@ -0,0 +1,707 @@
+/* Host test of protocol codecs (dc01_proto.h): each message is decoded
+ * from a test pattern & its complement, values are checked against the
+ * schema layout (offsets, MSB first, bits) & the message is encoded back
+ * to the pattern (unused bits cleared), nothing is written behind it.
+ *
+ * Generated by sw/dc01_protogen.py from doc/protocol.json, do not edit.
+ */
+
+#include <string.h>
+#include "dc01_proto.h"
+#include "test.h"
+
+/* Private function prototypes -----------------------------------------------*/
+
+static void _test_set_state_request(void);
+static void _test_lease_request(void);
+static void _test_scope_request(void);
+static void _test_dcc_wave_request(void);
+static void _test_hb_stats_request(void);
+static void _test_info_report(void);
+static void _test_state_report(void);
+static void _test_brt_report(void);
+static void _test_lease_report(void);
+static void _test_scope_report(void);
+static void _test_dcc_stats_report(void);
+static void _test_dcc_wave_report(void);
+static void _test_boot_info_report(void);
+static void _test_crash_report(void);
+static void _test_hb_stats_report(void);
+
+/* Code ----------------------------------------------------------------------*/
+
+int main(void) {
+	_test_set_state_request();
+	_test_lease_request();
+	_test_scope_request();
+	_test_dcc_wave_request();
+	_test_hb_stats_request();
+	_test_info_report();
+	_test_state_report();
+	_test_brt_report();
+	_test_lease_report();
+	_test_scope_report();
+	_test_dcc_stats_report();
+	_test_dcc_wave_report();
+	_test_boot_info_report();
+	_test_crash_report();
+	_test_hb_stats_report();
+	return test_result("test_proto");
+}
+
+void _test_set_state_request(void) {
+	static const uint8_t data[2][DC01_SET_STATE_REQUEST_SIZE+1] = {
+		{0x22, 0x5D},
+		{0xDD, 0xA2},
+	};
+	static const uint8_t encoded[2][DC01_SET_STATE_REQUEST_SIZE] = {
+		{0x00},
+		{0x01},
+	};
+	Dc01SetStateRequest msg;
+	uint8_t buf[DC01_SET_STATE_REQUEST_SIZE+1];
+
+	for (size_t p = 0; p < 2; p++) {
+		CHECK(!dc01_decode_set_state_request(data[p], DC01_SET_STATE_REQUEST_SIZE-1, &msg));
+		memset(&msg, 0, sizeof(msg));
+		CHECK(dc01_decode_set_state_request(data[p], sizeof(data[p]), &msg));
+		if (p == 0) {
+			CHECK_EQ(msg.on, 0);
+		} else {
+			CHECK_EQ(msg.on, 1);
+		}
+
+		memset(buf, 0xA5, sizeof(buf));
+		CHECK_EQ(dc01_encode_set_state_request(buf, &msg), DC01_SET_STATE_REQUEST_SIZE);
+		CHECK(memcmp(buf, encoded[p], DC01_SET_STATE_REQUEST_SIZE) == 0);
+		CHECK_EQ(buf[DC01_SET_STATE_REQUEST_SIZE], 0xA5);
+	}
+}
+
+void _test_lease_request(void) {
+	static const uint8_t data[2][DC01_LEASE_REQUEST_SIZE+1] = {
+		{0x31, 0x6C, 0xA7, 0xE2},
+		{0xCE, 0x93, 0x58, 0x1D},
+	};
+	Dc01LeaseRequest msg;
+	uint8_t buf[DC01_LEASE_REQUEST_SIZE+1];
+
+	for (size_t p = 0; p < 2; p++) {
+		CHECK(!dc01_decode_lease_request(data[p], DC01_LEASE_REQUEST_SIZE-1, &msg));
+		memset(&msg, 0, sizeof(msg));
+		CHECK(dc01_decode_lease_request(data[p], sizeof(data[p]), &msg));
+		if (p == 0) {
+			CHECK_EQ(msg.duration_ms, 0x316C);
+			CHECK_EQ(msg.seq, 0xA7);
+		} else {
+			CHECK_EQ(msg.duration_ms, 0xCE93);
+			CHECK_EQ(msg.seq, 0x58);
+		}
+
+		memset(buf, 0xA5, sizeof(buf));
+		CHECK_EQ(dc01_encode_lease_request(buf, &msg), DC01_LEASE_REQUEST_SIZE);
+		CHECK(memcmp(buf, data[p], DC01_LEASE_REQUEST_SIZE) == 0);
+		CHECK_EQ(buf[DC01_LEASE_REQUEST_SIZE], 0xA5);
+	}
+}
+
+void _test_scope_request(void) {
+	static const uint8_t data[2][DC01_SCOPE_REQUEST_SIZE+1] = {
+		{0x32, 0x6D},
+		{0xCD, 0x92},
+	};
+	static const uint8_t encoded[2][DC01_SCOPE_REQUEST_SIZE] = {
+		{0x02},
+		{0x01},
+	};
+	Dc01ScopeRequest msg;
+	uint8_t buf[DC01_SCOPE_REQUEST_SIZE+1];
+
+	for (size_t p = 0; p < 2; p++) {
+		CHECK(!dc01_decode_scope_request(data[p], DC01_SCOPE_REQUEST_SIZE-1, &msg));
+		memset(&msg, 0, sizeof(msg));
+		CHECK(dc01_decode_scope_request(data[p], sizeof(data[p]), &msg));
+		if (p == 0) {
+			CHECK_EQ(msg.run, 0);
+			CHECK_EQ(msg.relays, 1);
+		} else {
+			CHECK_EQ(msg.run, 1);
+			CHECK_EQ(msg.relays, 0);
+		}
+
+		memset(buf, 0xA5, sizeof(buf));
+		CHECK_EQ(dc01_encode_scope_request(buf, &msg), DC01_SCOPE_REQUEST_SIZE);
+		CHECK(memcmp(buf, encoded[p], DC01_SCOPE_REQUEST_SIZE) == 0);
+		CHECK_EQ(buf[DC01_SCOPE_REQUEST_SIZE], 0xA5);
+	}
+}
+
+void _test_dcc_wave_request(void) {
+	static const uint8_t data[2][DC01_DCC_WAVE_REQUEST_SIZE+1] = {
+		{0x34, 0x6F},
+		{0xCB, 0x90},
+	};
+	Dc01DccWaveRequest msg;
+	uint8_t buf[DC01_DCC_WAVE_REQUEST_SIZE+1];
+
+	for (size_t p = 0; p < 2; p++) {
+		CHECK(!dc01_decode_dcc_wave_request(data[p], DC01_DCC_WAVE_REQUEST_SIZE-1, &msg));
+		memset(&msg, 0, sizeof(msg));
+		CHECK(dc01_decode_dcc_wave_request(data[p], sizeof(data[p]), &msg));
+		if (p == 0) {
+			CHECK_EQ(msg.input, 0x34);
+		} else {
+			CHECK_EQ(msg.input, 0xCB);
+		}
+
+		memset(buf, 0xA5, sizeof(buf));
+		CHECK_EQ(dc01_encode_dcc_wave_request(buf, &msg), DC01_DCC_WAVE_REQUEST_SIZE);
+		CHECK(memcmp(buf, data[p], DC01_DCC_WAVE_REQUEST_SIZE) == 0);
+		CHECK_EQ(buf[DC01_DCC_WAVE_REQUEST_SIZE], 0xA5);
+	}
+}
+
+void _test_hb_stats_request(void) {
+	static const uint8_t data[2][DC01_HB_STATS_REQUEST_SIZE+1] = {
+		{0x37, 0x72},
+		{0xC8, 0x8D},
+	};
+	static const uint8_t encoded[2][DC01_HB_STATS_REQUEST_SIZE] = {
+		{0x01},
+		{0x00},
+	};
+	Dc01HbStatsRequest msg;
+	uint8_t buf[DC01_HB_STATS_REQUEST_SIZE+1];
+
+	for (size_t p = 0; p < 2; p++) {
+		CHECK(!dc01_decode_hb_stats_request(data[p], DC01_HB_STATS_REQUEST_SIZE-1, &msg));
+		memset(&msg, 0, sizeof(msg));
+		CHECK(dc01_decode_hb_stats_request(data[p], sizeof(data[p]), &msg));
+		if (p == 0) {
+			CHECK_EQ(msg.reset, 1);
+		} else {
+			CHECK_EQ(msg.reset, 0);
+		}
+
+		memset(buf, 0xA5, sizeof(buf));
+		CHECK_EQ(dc01_encode_hb_stats_request(buf, &msg), DC01_HB_STATS_REQUEST_SIZE);
+		CHECK(memcmp(buf, encoded[p], DC01_HB_STATS_REQUEST_SIZE) == 0);
+		CHECK_EQ(buf[DC01_HB_STATS_REQUEST_SIZE], 0xA5);
+	}
+}
+
+void _test_info_report(void) {
+	static const uint8_t data[2][DC01_INFO_REPORT_SIZE+1] = {
+		{0xA1, 0xDC, 0x17},
+		{0x5E, 0x23, 0xE8},
+	};
+	Dc01InfoReport msg;
+	uint8_t buf[DC01_INFO_REPORT_SIZE+1];
+
+	for (size_t p = 0; p < 2; p++) {
+		CHECK(!dc01_decode_info_report(data[p], DC01_INFO_REPORT_SIZE-1, &msg));
+		memset(&msg, 0, sizeof(msg));
+		CHECK(dc01_decode_info_report(data[p], sizeof(data[p]), &msg));
+		if (p == 0) {
+			CHECK_EQ(msg.fw_major, 0xA1);
+			CHECK_EQ(msg.fw_minor, 0xDC);
+		} else {
+			CHECK_EQ(msg.fw_major, 0x5E);
+			CHECK_EQ(msg.fw_minor, 0x23);
+		}
+
+		memset(buf, 0xA5, sizeof(buf));
+		CHECK_EQ(dc01_encode_info_report(buf, &msg), DC01_INFO_REPORT_SIZE);
+		CHECK(memcmp(buf, data[p], DC01_INFO_REPORT_SIZE) == 0);
+		CHECK_EQ(buf[DC01_INFO_REPORT_SIZE], 0xA5);
+	}
+}
+
+void _test_state_report(void) {
+	static const uint8_t data[2][DC01_STATE_REPORT_SIZE+1] = {
+		{0xA2, 0xDD, 0x18, 0x53},
+		{0x5D, 0x22, 0xE7, 0xAC},
+	};
+	static const uint8_t encoded[2][DC01_STATE_REPORT_SIZE] = {
+		{0x22, 0xDD, 0x18},
+		{0x51, 0x22, 0xE7},
+	};
+	Dc01StateReport msg;
+	uint8_t buf[DC01_STATE_REPORT_SIZE+1];
+
+	for (size_t p = 0; p < 2; p++) {
+		CHECK(!dc01_decode_state_report(data[p], DC01_STATE_REPORT_SIZE-1, &msg));
+		memset(&msg, 0, sizeof(msg));
+		CHECK(dc01_decode_state_report(data[p], sizeof(data[p]), &msg));
+		if (p == 0) {
+			CHECK_EQ(msg.mode, 2);
+			CHECK_EQ(msg.dcc_connected, 0);
+			CHECK_EQ(msg.dcc_at_least_one, 1);
+			CHECK_EQ(msg.failure_code, 0xDD);
+			CHECK_EQ(msg.warnings, 0x18);
+		} else {
+			CHECK_EQ(msg.mode, 5);
+			CHECK_EQ(msg.dcc_connected, 1);
+			CHECK_EQ(msg.dcc_at_least_one, 0);
+			CHECK_EQ(msg.failure_code, 0x22);
+			CHECK_EQ(msg.warnings, 0xE7);
+		}
+
+		memset(buf, 0xA5, sizeof(buf));
+		CHECK_EQ(dc01_encode_state_report(buf, &msg), DC01_STATE_REPORT_SIZE);
+		CHECK(memcmp(buf, encoded[p], DC01_STATE_REPORT_SIZE) == 0);
+		CHECK_EQ(buf[DC01_STATE_REPORT_SIZE], 0xA5);
+	}
+}
+
+void _test_brt_report(void) {
+	static const uint8_t data[2][DC01_BRT_REPORT_SIZE+1] = {
+		{0xA3, 0xDE, 0x19, 0x54},
+		{0x5C, 0x21, 0xE6, 0xAB},
+	};
+	Dc01BrtReport msg;
+	uint8_t buf[DC01_BRT_REPORT_SIZE+1];
+
+	for (size_t p = 0; p < 2; p++) {
+		CHECK(!dc01_decode_brt_report(data[p], DC01_BRT_REPORT_SIZE-1, &msg));
+		memset(&msg, 0, sizeof(msg));
+		CHECK(dc01_decode_brt_report(data[p], sizeof(data[p]), &msg));
+		if (p == 0) {
+			CHECK_EQ(msg.state, 0xA3);
+			CHECK_EQ(msg.step, 0xDE);
+			CHECK_EQ(msg.error, 0x19);
+		} else {
+			CHECK_EQ(msg.state, 0x5C);
+			CHECK_EQ(msg.step, 0x21);
+			CHECK_EQ(msg.error, 0xE6);
+		}
+
+		memset(buf, 0xA5, sizeof(buf));
+		CHECK_EQ(dc01_encode_brt_report(buf, &msg), DC01_BRT_REPORT_SIZE);
+		CHECK(memcmp(buf, data[p], DC01_BRT_REPORT_SIZE) == 0);
+		CHECK_EQ(buf[DC01_BRT_REPORT_SIZE], 0xA5);
+	}
+}
+
+void _test_lease_report(void) {
+	static const uint8_t data[2][DC01_LEASE_REPORT_SIZE+1] = {
+		{0xB1, 0xEC, 0x27, 0x62},
+		{0x4E, 0x13, 0xD8, 0x9D},
+	};
+	Dc01LeaseReport msg;
+	uint8_t buf[DC01_LEASE_REPORT_SIZE+1];
+
+	for (size_t p = 0; p < 2; p++) {
+		CHECK(!dc01_decode_lease_report(data[p], DC01_LEASE_REPORT_SIZE-1, &msg));
+		memset(&msg, 0, sizeof(msg));
+		CHECK(dc01_decode_lease_report(data[p], sizeof(data[p]), &msg));
+		if (p == 0) {
+			CHECK_EQ(msg.granted_ms, 0xB1EC);
+			CHECK_EQ(msg.seq, 0x27);
+		} else {
+			CHECK_EQ(msg.granted_ms, 0x4E13);
+			CHECK_EQ(msg.seq, 0xD8);
+		}
+
+		memset(buf, 0xA5, sizeof(buf));
+		CHECK_EQ(dc01_encode_lease_report(buf, &msg), DC01_LEASE_REPORT_SIZE);
+		CHECK(memcmp(buf, data[p], DC01_LEASE_REPORT_SIZE) == 0);
+		CHECK_EQ(buf[DC01_LEASE_REPORT_SIZE], 0xA5);
+	}
+}
+
+void _test_scope_report(void) {
+	static const uint8_t data[2][DC01_SCOPE_REPORT_SIZE+1] = {
+		{0xB2, 0xED, 0x28, 0x63, 0x9E, 0xD9, 0x14, 0x4F, 0x8A, 0xC5, 0x00, 0x3B,
+		 0x76, 0xB1, 0xEC, 0x27, 0x62, 0x9D, 0xD8, 0x13, 0x4E, 0x89, 0xC4, 0xFF,
+		 0x3A, 0x75, 0xB0, 0xEB, 0x26, 0x61, 0x9C, 0xD7, 0x12, 0x4D, 0x88, 0xC3,
+		 0xFE, 0x39, 0x74, 0xAF, 0xEA, 0x25, 0x60, 0x9B, 0xD6, 0x11, 0x4C, 0x87,
+		 0xC2, 0xFD, 0x38, 0x73, 0xAE, 0xE9, 0x24, 0x5F, 0x9A, 0xD5, 0x10, 0x4B,
+		 0x86},
+		{0x4D, 0x12, 0xD7, 0x9C, 0x61, 0x26, 0xEB, 0xB0, 0x75, 0x3A, 0xFF, 0xC4,
+		 0x89, 0x4E, 0x13, 0xD8, 0x9D, 0x62, 0x27, 0xEC, 0xB1, 0x76, 0x3B, 0x00,
+		 0xC5, 0x8A, 0x4F, 0x14, 0xD9, 0x9E, 0x63, 0x28, 0xED, 0xB2, 0x77, 0x3C,
+		 0x01, 0xC6, 0x8B, 0x50, 0x15, 0xDA, 0x9F, 0x64, 0x29, 0xEE, 0xB3, 0x78,
+		 0x3D, 0x02, 0xC7, 0x8C, 0x51, 0x16, 0xDB, 0xA0, 0x65, 0x2A, 0xEF, 0xB4,
+		 0x79},
+	};
+	Dc01ScopeReport msg;
+	uint8_t buf[DC01_SCOPE_REPORT_SIZE+1];
+
+	for (size_t p = 0; p < 2; p++) {
+		CHECK(!dc01_decode_scope_report(data[p], DC01_SCOPE_REPORT_SIZE-1, &msg));
+		memset(&msg, 0, sizeof(msg));
+		CHECK(dc01_decode_scope_report(data[p], sizeof(data[p]), &msg));
+		if (p == 0) {
+			CHECK_EQ(msg.seq, 0xB2ED);
+			CHECK_EQ(msg.flags, 0x28);
+			CHECK_EQ(msg.dropped, 0x63);
+			CHECK(memcmp(msg.samples, &data[0][4], 56) == 0);
+		} else {
+			CHECK_EQ(msg.seq, 0x4D12);
+			CHECK_EQ(msg.flags, 0xD7);
+			CHECK_EQ(msg.dropped, 0x9C);
+			CHECK(memcmp(msg.samples, &data[1][4], 56) == 0);
+		}
+
+		memset(buf, 0xA5, sizeof(buf));
+		CHECK_EQ(dc01_encode_scope_report(buf, &msg), DC01_SCOPE_REPORT_SIZE);
+		CHECK(memcmp(buf, data[p], DC01_SCOPE_REPORT_SIZE) == 0);
+		CHECK_EQ(buf[DC01_SCOPE_REPORT_SIZE], 0xA5);
+	}
+}
+
+void _test_dcc_stats_report(void) {
+	static const uint8_t data[2][DC01_DCC_STATS_REPORT_SIZE+1] = {
+		{0xB3, 0xEE, 0x29, 0x64, 0x9F, 0xDA, 0x15, 0x50, 0x8B, 0xC6, 0x01, 0x3C,
+		 0x77, 0xB2, 0xED, 0x28, 0x63, 0x9E, 0xD9, 0x14, 0x4F, 0x8A, 0xC5, 0x00,
+		 0x3B, 0x76, 0xB1, 0xEC, 0x27, 0x62},
+		{0x4C, 0x11, 0xD6, 0x9B, 0x60, 0x25, 0xEA, 0xAF, 0x74, 0x39, 0xFE, 0xC3,
+		 0x88, 0x4D, 0x12, 0xD7, 0x9C, 0x61, 0x26, 0xEB, 0xB0, 0x75, 0x3A, 0xFF,
+		 0xC4, 0x89, 0x4E, 0x13, 0xD8, 0x9D},
+	};
+	static const uint8_t encoded[2][DC01_DCC_STATS_REPORT_SIZE] = {
+		{0x83, 0xEE, 0x29, 0x64, 0x9F, 0xDA, 0x15, 0x50, 0x8B, 0xC6, 0x01, 0x3C,
+		 0x77, 0xB2, 0xED, 0x28, 0x63, 0x9E, 0xD9, 0x14, 0x4F, 0x8A, 0xC5, 0x00,
+		 0x3B, 0x76, 0xB1, 0xEC, 0x27},
+		{0x00, 0x11, 0xD6, 0x9B, 0x60, 0x25, 0xEA, 0xAF, 0x74, 0x39, 0xFE, 0xC3,
+		 0x88, 0x4D, 0x12, 0xD7, 0x9C, 0x61, 0x26, 0xEB, 0xB0, 0x75, 0x3A, 0xFF,
+		 0xC4, 0x89, 0x4E, 0x13, 0xD8},
+	};
+	Dc01DccStatsReport msg;
+	uint8_t buf[DC01_DCC_STATS_REPORT_SIZE+1];
+
+	for (size_t p = 0; p < 2; p++) {
+		CHECK(!dc01_decode_dcc_stats_report(data[p], DC01_DCC_STATS_REPORT_SIZE-1, &msg));
+		memset(&msg, 0, sizeof(msg));
+		CHECK(dc01_decode_dcc_stats_report(data[p], sizeof(data[p]), &msg));
+		if (p == 0) {
+			CHECK_EQ(msg.present[0], 1);
+			CHECK_EQ(msg.present[1], 1);
+			CHECK_EQ(msg.require_packets, 1);
+			CHECK_EQ(msg.inputs[0].rate, 0xEE29);
+			CHECK_EQ(msg.inputs[0].packets, 0x649FDA15);
+			CHECK_EQ(msg.inputs[0].bit_errors, 0x508BC601);
+			CHECK_EQ(msg.inputs[0].checksum_errors, 0x3C77B2ED);
+			CHECK_EQ(msg.inputs[1].rate, 0x2863);
+			CHECK_EQ(msg.inputs[1].packets, 0x9ED9144F);
+			CHECK_EQ(msg.inputs[1].bit_errors, 0x8AC5003B);
+			CHECK_EQ(msg.inputs[1].checksum_errors, 0x76B1EC27);
+		} else {
+			CHECK_EQ(msg.present[0], 0);
+			CHECK_EQ(msg.present[1], 0);
+			CHECK_EQ(msg.require_packets, 0);
+			CHECK_EQ(msg.inputs[0].rate, 0x11D6);
+			CHECK_EQ(msg.inputs[0].packets, 0x9B6025EA);
+			CHECK_EQ(msg.inputs[0].bit_errors, 0xAF7439FE);
+			CHECK_EQ(msg.inputs[0].checksum_errors, 0xC3884D12);
+			CHECK_EQ(msg.inputs[1].rate, 0xD79C);
+			CHECK_EQ(msg.inputs[1].packets, 0x6126EBB0);
+			CHECK_EQ(msg.inputs[1].bit_errors, 0x753AFFC4);
+			CHECK_EQ(msg.inputs[1].checksum_errors, 0x894E13D8);
+		}
+
+		memset(buf, 0xA5, sizeof(buf));
+		CHECK_EQ(dc01_encode_dcc_stats_report(buf, &msg), DC01_DCC_STATS_REPORT_SIZE);
+		CHECK(memcmp(buf, encoded[p], DC01_DCC_STATS_REPORT_SIZE) == 0);
+		CHECK_EQ(buf[DC01_DCC_STATS_REPORT_SIZE], 0xA5);
+	}
+}
+
+void _test_dcc_wave_report(void) {
+	static const uint8_t data[2][DC01_DCC_WAVE_REPORT_SIZE+1] = {
+		{0xB4, 0xEF, 0x2A, 0x65, 0xA0, 0xDB, 0x16, 0x51, 0x8C, 0xC7, 0x02, 0x3D,
+		 0x78, 0xB3, 0xEE, 0x29, 0x64, 0x9F, 0xDA, 0x15, 0x50, 0x8B, 0xC6, 0x01,
+		 0x3C, 0x77, 0xB2, 0xED, 0x28, 0x63, 0x9E, 0xD9, 0x14, 0x4F, 0x8A, 0xC5,
+		 0x00, 0x3B, 0x76, 0xB1, 0xEC, 0x27, 0x62, 0x9D, 0xD8, 0x13, 0x4E, 0x89,
+		 0xC4, 0xFF, 0x3A, 0x75, 0xB0, 0xEB, 0x26, 0x61, 0x9C, 0xD7, 0x12, 0x4D,
+		 0x88},
+		{0x4B, 0x10, 0xD5, 0x9A, 0x5F, 0x24, 0xE9, 0xAE, 0x73, 0x38, 0xFD, 0xC2,
+		 0x87, 0x4C, 0x11, 0xD6, 0x9B, 0x60, 0x25, 0xEA, 0xAF, 0x74, 0x39, 0xFE,
+		 0xC3, 0x88, 0x4D, 0x12, 0xD7, 0x9C, 0x61, 0x26, 0xEB, 0xB0, 0x75, 0x3A,
+		 0xFF, 0xC4, 0x89, 0x4E, 0x13, 0xD8, 0x9D, 0x62, 0x27, 0xEC, 0xB1, 0x76,
+		 0x3B, 0x00, 0xC5, 0x8A, 0x4F, 0x14, 0xD9, 0x9E, 0x63, 0x28, 0xED, 0xB2,
+		 0x77},
+	};
+	static const uint8_t encoded[2][DC01_DCC_WAVE_REPORT_SIZE] = {
+		{0xB4, 0x01, 0x2A, 0x65, 0xA0, 0xDB, 0x16, 0x51, 0x8C, 0xC7, 0x02, 0x3D,
+		 0x78, 0xB3, 0xEE, 0x29, 0x64, 0x9F, 0xDA, 0x15, 0x50, 0x8B, 0xC6, 0x01,
+		 0x3C, 0x77, 0xB2, 0xED, 0x28, 0x63, 0x9E, 0xD9, 0x14, 0x4F, 0x8A, 0xC5,
+		 0x00, 0x3B, 0x76, 0xB1, 0xEC, 0x27, 0x62, 0x9D, 0xD8, 0x13, 0x4E, 0x89,
+		 0xC4, 0xFF, 0x3A, 0x75, 0xB0, 0xEB, 0x26, 0x61, 0x9C, 0xD7, 0x12, 0x4D},
+		{0x4B, 0x00, 0xD5, 0x9A, 0x5F, 0x24, 0xE9, 0xAE, 0x73, 0x38, 0xFD, 0xC2,
+		 0x87, 0x4C, 0x11, 0xD6, 0x9B, 0x60, 0x25, 0xEA, 0xAF, 0x74, 0x39, 0xFE,
+		 0xC3, 0x88, 0x4D, 0x12, 0xD7, 0x9C, 0x61, 0x26, 0xEB, 0xB0, 0x75, 0x3A,
+		 0xFF, 0xC4, 0x89, 0x4E, 0x13, 0xD8, 0x9D, 0x62, 0x27, 0xEC, 0xB1, 0x76,
+		 0x3B, 0x00, 0xC5, 0x8A, 0x4F, 0x14, 0xD9, 0x9E, 0x63, 0x28, 0xED, 0xB2},
+	};
+	Dc01DccWaveReport msg;
+	uint8_t buf[DC01_DCC_WAVE_REPORT_SIZE+1];
+
+	for (size_t p = 0; p < 2; p++) {
+		CHECK(!dc01_decode_dcc_wave_report(data[p], DC01_DCC_WAVE_REPORT_SIZE-1, &msg));
+		memset(&msg, 0, sizeof(msg));
+		CHECK(dc01_decode_dcc_wave_report(data[p], sizeof(data[p]), &msg));
+		if (p == 0) {
+			CHECK_EQ(msg.input, 0xB4);
+			CHECK_EQ(msg.present, 1);
+			CHECK_EQ(msg.frequency, 0x2A65);
+			CHECK_EQ(msg.low_permille, 0xA0DB);
+			CHECK_EQ(msg.cutout_us, 0x1651);
+			CHECK_EQ(msg.cutouts, 0x8CC7023D);
+			CHECK_EQ(msg.losses, 0x78B3EE29);
+			CHECK_EQ(msg.lost_ms, 0x649FDA15);
+			CHECK_EQ(msg.loss_ms, 0x508BC601);
+			CHECK_EQ(msg.edge_overruns, 0x3C77B2ED);
+			CHECK_EQ(msg.half_periods[0], 0x28639ED9);
+			CHECK_EQ(msg.half_periods[1], 0x144F8AC5);
+			CHECK_EQ(msg.half_periods[2], 0x003B76B1);
+			CHECK_EQ(msg.half_periods[3], 0xEC27629D);
+			CHECK_EQ(msg.half_periods[4], 0xD8134E89);
+			CHECK_EQ(msg.half_periods[5], 0xC4FF3A75);
+			CHECK_EQ(msg.half_periods[6], 0xB0EB2661);
+			CHECK_EQ(msg.half_periods[7], 0x9CD7124D);
+		} else {
+			CHECK_EQ(msg.input, 0x4B);
+			CHECK_EQ(msg.present, 0);
+			CHECK_EQ(msg.frequency, 0xD59A);
+			CHECK_EQ(msg.low_permille, 0x5F24);
+			CHECK_EQ(msg.cutout_us, 0xE9AE);
+			CHECK_EQ(msg.cutouts, 0x7338FDC2);
+			CHECK_EQ(msg.losses, 0x874C11D6);
+			CHECK_EQ(msg.lost_ms, 0x9B6025EA);
+			CHECK_EQ(msg.loss_ms, 0xAF7439FE);
+			CHECK_EQ(msg.edge_overruns, 0xC3884D12);
+			CHECK_EQ(msg.half_periods[0], 0xD79C6126);
+			CHECK_EQ(msg.half_periods[1], 0xEBB0753A);
+			CHECK_EQ(msg.half_periods[2], 0xFFC4894E);
+			CHECK_EQ(msg.half_periods[3], 0x13D89D62);
+			CHECK_EQ(msg.half_periods[4], 0x27ECB176);
+			CHECK_EQ(msg.half_periods[5], 0x3B00C58A);
+			CHECK_EQ(msg.half_periods[6], 0x4F14D99E);
+			CHECK_EQ(msg.half_periods[7], 0x6328EDB2);
+		}
+
+		memset(buf, 0xA5, sizeof(buf));
+		CHECK_EQ(dc01_encode_dcc_wave_report(buf, &msg), DC01_DCC_WAVE_REPORT_SIZE);
+		CHECK(memcmp(buf, encoded[p], DC01_DCC_WAVE_REPORT_SIZE) == 0);
+		CHECK_EQ(buf[DC01_DCC_WAVE_REPORT_SIZE], 0xA5);
+	}
+}
+
+void _test_boot_info_report(void) {
+	static const uint8_t data[2][DC01_BOOT_INFO_REPORT_SIZE+1] = {
+		{0xB5, 0xF0, 0x2B, 0x66, 0xA1, 0xDC, 0x17, 0x52, 0x8D, 0xC8, 0x03, 0x3E,
+		 0x79, 0xB4, 0xEF},
+		{0x4A, 0x0F, 0xD4, 0x99, 0x5E, 0x23, 0xE8, 0xAD, 0x72, 0x37, 0xFC, 0xC1,
+		 0x86, 0x4B, 0x10},
+	};
+	static const uint8_t encoded[2][DC01_BOOT_INFO_REPORT_SIZE] = {
+		{0xB5, 0x00, 0x2B, 0x66, 0xA1, 0xDC, 0x17, 0x52, 0x8D, 0xC8, 0x03, 0x3E,
+		 0x79, 0xB4},
+		{0x4A, 0x03, 0xD4, 0x99, 0x5E, 0x23, 0xE8, 0xAD, 0x72, 0x37, 0xFC, 0xC1,
+		 0x86, 0x4B},
+	};
+	Dc01BootInfoReport msg;
+	uint8_t buf[DC01_BOOT_INFO_REPORT_SIZE+1];
+
+	for (size_t p = 0; p < 2; p++) {
+		CHECK(!dc01_decode_boot_info_report(data[p], DC01_BOOT_INFO_REPORT_SIZE-1, &msg));
+		memset(&msg, 0, sizeof(msg));
+		CHECK(dc01_decode_boot_info_report(data[p], sizeof(data[p]), &msg));
+		if (p == 0) {
+			CHECK_EQ(msg.reset_cause, 0xB5);
+			CHECK_EQ(msg.brt_honoured, 0);
+			CHECK_EQ(msg.rtc_started, 0);
+			CHECK_EQ(msg.resets, 0x2B66);
+			CHECK_EQ(msg.ready_ms, 0xA1DC);
+			CHECK_EQ(msg.dcc_on_ms, 0x17528DC8);
+			CHECK_EQ(msg.brt_age_s, 0x033E79B4);
+		} else {
+			CHECK_EQ(msg.reset_cause, 0x4A);
+			CHECK_EQ(msg.brt_honoured, 1);
+			CHECK_EQ(msg.rtc_started, 1);
+			CHECK_EQ(msg.resets, 0xD499);
+			CHECK_EQ(msg.ready_ms, 0x5E23);
+			CHECK_EQ(msg.dcc_on_ms, 0xE8AD7237);
+			CHECK_EQ(msg.brt_age_s, 0xFCC1864B);
+		}
+
+		memset(buf, 0xA5, sizeof(buf));
+		CHECK_EQ(dc01_encode_boot_info_report(buf, &msg), DC01_BOOT_INFO_REPORT_SIZE);
+		CHECK(memcmp(buf, encoded[p], DC01_BOOT_INFO_REPORT_SIZE) == 0);
+		CHECK_EQ(buf[DC01_BOOT_INFO_REPORT_SIZE], 0xA5);
+	}
+}
+
+void _test_crash_report(void) {
+	static const uint8_t data[2][DC01_CRASH_REPORT_SIZE+1] = {
+		{0xB6, 0xF1, 0x2C, 0x67, 0xA2, 0xDD, 0x18, 0x53, 0x8E, 0xC9, 0x04, 0x3F,
+		 0x7A, 0xB5, 0xF0, 0x2B, 0x66, 0xA1, 0xDC, 0x17, 0x52, 0x8D, 0xC8, 0x03,
+		 0x3E, 0x79, 0xB4, 0xEF, 0x2A, 0x65, 0xA0, 0xDB, 0x16, 0x51, 0x8C, 0xC7,
+		 0x02, 0x3D, 0x78, 0xB3, 0xEE, 0x29, 0x64, 0x9F, 0xDA, 0x15, 0x50, 0x8B,
+		 0xC6, 0x01, 0x3C, 0x77, 0xB2, 0xED, 0x28, 0x63, 0x9E, 0xD9, 0x14, 0x4F,
+		 0x8A, 0xC5, 0x00, 0x3B, 0x76, 0xB1, 0xEC, 0x27, 0x62, 0x9D, 0xD8, 0x13,
+		 0x4E, 0x89, 0xC4, 0xFF, 0x3A, 0x75, 0xB0, 0xEB, 0x26, 0x61, 0x9C, 0xD7,
+		 0x12, 0x4D, 0x88, 0xC3, 0xFE},
+		{0x49, 0x0E, 0xD3, 0x98, 0x5D, 0x22, 0xE7, 0xAC, 0x71, 0x36, 0xFB, 0xC0,
+		 0x85, 0x4A, 0x0F, 0xD4, 0x99, 0x5E, 0x23, 0xE8, 0xAD, 0x72, 0x37, 0xFC,
+		 0xC1, 0x86, 0x4B, 0x10, 0xD5, 0x9A, 0x5F, 0x24, 0xE9, 0xAE, 0x73, 0x38,
+		 0xFD, 0xC2, 0x87, 0x4C, 0x11, 0xD6, 0x9B, 0x60, 0x25, 0xEA, 0xAF, 0x74,
+		 0x39, 0xFE, 0xC3, 0x88, 0x4D, 0x12, 0xD7, 0x9C, 0x61, 0x26, 0xEB, 0xB0,
+		 0x75, 0x3A, 0xFF, 0xC4, 0x89, 0x4E, 0x13, 0xD8, 0x9D, 0x62, 0x27, 0xEC,
+		 0xB1, 0x76, 0x3B, 0x00, 0xC5, 0x8A, 0x4F, 0x14, 0xD9, 0x9E, 0x63, 0x28,
+		 0xED, 0xB2, 0x77, 0x3C, 0x01},
+	};
+	Dc01CrashReport msg;
+	uint8_t buf[DC01_CRASH_REPORT_SIZE+1];
+
+	for (size_t p = 0; p < 2; p++) {
+		CHECK(!dc01_decode_crash_report(data[p], DC01_CRASH_REPORT_SIZE-1, &msg));
+		memset(&msg, 0, sizeof(msg));
+		CHECK(dc01_decode_crash_report(data[p], sizeof(data[p]), &msg));
+		if (p == 0) {
+			CHECK_EQ(msg.cause, 0xB6);
+			CHECK_EQ(msg.dcmode, 0xF1);
+			CHECK_EQ(msg.brt_state, 0x2C);
+			CHECK_EQ(msg.brt_step, 0x67);
+			CHECK_EQ(msg.uptime_ms, 0xA2DD1853);
+			CHECK_EQ(msg.frame[0], 0x8EC9043F);
+			CHECK_EQ(msg.frame[1], 0x7AB5F02B);
+			CHECK_EQ(msg.frame[2], 0x66A1DC17);
+			CHECK_EQ(msg.frame[3], 0x528DC803);
+			CHECK_EQ(msg.frame[4], 0x3E79B4EF);
+			CHECK_EQ(msg.frame[5], 0x2A65A0DB);
+			CHECK_EQ(msg.frame[6], 0x16518CC7);
+			CHECK_EQ(msg.frame[7], 0x023D78B3);
+			CHECK_EQ(msg.cfsr, 0xEE29649F);
+			CHECK_EQ(msg.hfsr, 0xDA15508B);
+			CHECK_EQ(msg.mmfar, 0xC6013C77);
+			CHECK_EQ(msg.bfar, 0xB2ED2863);
+			CHECK_EQ(msg.trail[0], 0x9ED9);
+			CHECK_EQ(msg.trail[1], 0x144F);
+			CHECK_EQ(msg.trail[2], 0x8AC5);
+			CHECK_EQ(msg.trail[3], 0x003B);
+			CHECK_EQ(msg.trail[4], 0x76B1);
+			CHECK_EQ(msg.trail[5], 0xEC27);
+			CHECK_EQ(msg.trail[6], 0x629D);
+			CHECK_EQ(msg.trail[7], 0xD813);
+			CHECK_EQ(msg.trail[8], 0x4E89);
+			CHECK_EQ(msg.trail[9], 0xC4FF);
+			CHECK_EQ(msg.trail[10], 0x3A75);
+			CHECK_EQ(msg.trail[11], 0xB0EB);
+			CHECK_EQ(msg.trail[12], 0x2661);
+			CHECK_EQ(msg.trail[13], 0x9CD7);
+			CHECK_EQ(msg.trail[14], 0x124D);
+			CHECK_EQ(msg.trail[15], 0x88C3);
+		} else {
+			CHECK_EQ(msg.cause, 0x49);
+			CHECK_EQ(msg.dcmode, 0x0E);
+			CHECK_EQ(msg.brt_state, 0xD3);
+			CHECK_EQ(msg.brt_step, 0x98);
+			CHECK_EQ(msg.uptime_ms, 0x5D22E7AC);
+			CHECK_EQ(msg.frame[0], 0x7136FBC0);
+			CHECK_EQ(msg.frame[1], 0x854A0FD4);
+			CHECK_EQ(msg.frame[2], 0x995E23E8);
+			CHECK_EQ(msg.frame[3], 0xAD7237FC);
+			CHECK_EQ(msg.frame[4], 0xC1864B10);
+			CHECK_EQ(msg.frame[5], 0xD59A5F24);
+			CHECK_EQ(msg.frame[6], 0xE9AE7338);
+			CHECK_EQ(msg.frame[7], 0xFDC2874C);
+			CHECK_EQ(msg.cfsr, 0x11D69B60);
+			CHECK_EQ(msg.hfsr, 0x25EAAF74);
+			CHECK_EQ(msg.mmfar, 0x39FEC388);
+			CHECK_EQ(msg.bfar, 0x4D12D79C);
+			CHECK_EQ(msg.trail[0], 0x6126);
+			CHECK_EQ(msg.trail[1], 0xEBB0);
+			CHECK_EQ(msg.trail[2], 0x753A);
+			CHECK_EQ(msg.trail[3], 0xFFC4);
+			CHECK_EQ(msg.trail[4], 0x894E);
+			CHECK_EQ(msg.trail[5], 0x13D8);
+			CHECK_EQ(msg.trail[6], 0x9D62);
+			CHECK_EQ(msg.trail[7], 0x27EC);
+			CHECK_EQ(msg.trail[8], 0xB176);
+			CHECK_EQ(msg.trail[9], 0x3B00);
+			CHECK_EQ(msg.trail[10], 0xC58A);
+			CHECK_EQ(msg.trail[11], 0x4F14);
+			CHECK_EQ(msg.trail[12], 0xD99E);
+			CHECK_EQ(msg.trail[13], 0x6328);
+			CHECK_EQ(msg.trail[14], 0xEDB2);
+			CHECK_EQ(msg.trail[15], 0x773C);
+		}
+
+		memset(buf, 0xA5, sizeof(buf));
+		CHECK_EQ(dc01_encode_crash_report(buf, &msg), DC01_CRASH_REPORT_SIZE);
+		CHECK(memcmp(buf, data[p], DC01_CRASH_REPORT_SIZE) == 0);
+		CHECK_EQ(buf[DC01_CRASH_REPORT_SIZE], 0xA5);
+	}
+}
+
+void _test_hb_stats_report(void) {
+	static const uint8_t data[2][DC01_HB_STATS_REPORT_SIZE+1] = {
+		{0xB7, 0xF2, 0x2D, 0x68, 0xA3, 0xDE, 0x19, 0x54, 0x8F, 0xCA, 0x05, 0x40,
+		 0x7B, 0xB6, 0xF1, 0x2C, 0x67, 0xA2, 0xDD, 0x18, 0x53, 0x8E, 0xC9, 0x04,
+		 0x3F, 0x7A, 0xB5, 0xF0, 0x2B, 0x66, 0xA1, 0xDC, 0x17, 0x52, 0x8D, 0xC8,
+		 0x03, 0x3E, 0x79, 0xB4, 0xEF, 0x2A, 0x65, 0xA0, 0xDB, 0x16, 0x51, 0x8C,
+		 0xC7, 0x02, 0x3D, 0x78, 0xB3, 0xEE, 0x29, 0x64, 0x9F, 0xDA, 0x15, 0x50,
+		 0x8B, 0xC6, 0x01, 0x3C, 0x77, 0xB2, 0xED, 0x28, 0x63, 0x9E, 0xD9},
+		{0x48, 0x0D, 0xD2, 0x97, 0x5C, 0x21, 0xE6, 0xAB, 0x70, 0x35, 0xFA, 0xBF,
+		 0x84, 0x49, 0x0E, 0xD3, 0x98, 0x5D, 0x22, 0xE7, 0xAC, 0x71, 0x36, 0xFB,
+		 0xC0, 0x85, 0x4A, 0x0F, 0xD4, 0x99, 0x5E, 0x23, 0xE8, 0xAD, 0x72, 0x37,
+		 0xFC, 0xC1, 0x86, 0x4B, 0x10, 0xD5, 0x9A, 0x5F, 0x24, 0xE9, 0xAE, 0x73,
+		 0x38, 0xFD, 0xC2, 0x87, 0x4C, 0x11, 0xD6, 0x9B, 0x60, 0x25, 0xEA, 0xAF,
+		 0x74, 0x39, 0xFE, 0xC3, 0x88, 0x4D, 0x12, 0xD7, 0x9C, 0x61, 0x26},
+	};
+	Dc01HbStatsReport msg;
+	uint8_t buf[DC01_HB_STATS_REPORT_SIZE+1];
+
+	for (size_t p = 0; p < 2; p++) {
+		CHECK(!dc01_decode_hb_stats_report(data[p], DC01_HB_STATS_REPORT_SIZE-1, &msg));
+		memset(&msg, 0, sizeof(msg));
+		CHECK(dc01_decode_hb_stats_report(data[p], sizeof(data[p]), &msg));
+		if (p == 0) {
+			CHECK_EQ(msg.heartbeats, 0xB7F22D68);
+			CHECK_EQ(msg.worst_gap_ms, 0xA3DE1954);
+			CHECK_EQ(msg.min_margin_ms, 0x8FCA);
+			CHECK_EQ(msg.warnings, 0x05407BB6);
+			CHECK_EQ(msg.timeouts, 0xF12C67A2);
+			CHECK_EQ(msg.period_ms, 0xDD18538E);
+			CHECK_EQ(msg.gaps[0], 0xC9043F7A);
+			CHECK_EQ(msg.gaps[1], 0xB5F02B66);
+			CHECK_EQ(msg.gaps[2], 0xA1DC1752);
+			CHECK_EQ(msg.gaps[3], 0x8DC8033E);
+			CHECK_EQ(msg.gaps[4], 0x79B4EF2A);
+			CHECK_EQ(msg.gaps[5], 0x65A0DB16);
+			CHECK_EQ(msg.gaps[6], 0x518CC702);
+			CHECK_EQ(msg.gaps[7], 0x3D78B3EE);
+			CHECK_EQ(msg.gaps[8], 0x29649FDA);
+			CHECK_EQ(msg.gaps[9], 0x15508BC6);
+			CHECK_EQ(msg.gaps[10], 0x013C77B2);
+			CHECK_EQ(msg.gaps[11], 0xED28639E);
+		} else {
+			CHECK_EQ(msg.heartbeats, 0x480DD297);
+			CHECK_EQ(msg.worst_gap_ms, 0x5C21E6AB);
+			CHECK_EQ(msg.min_margin_ms, 0x7035);
+			CHECK_EQ(msg.warnings, 0xFABF8449);
+			CHECK_EQ(msg.timeouts, 0x0ED3985D);
+			CHECK_EQ(msg.period_ms, 0x22E7AC71);
+			CHECK_EQ(msg.gaps[0], 0x36FBC085);
+			CHECK_EQ(msg.gaps[1], 0x4A0FD499);
+			CHECK_EQ(msg.gaps[2], 0x5E23E8AD);
+			CHECK_EQ(msg.gaps[3], 0x7237FCC1);
+			CHECK_EQ(msg.gaps[4], 0x864B10D5);
+			CHECK_EQ(msg.gaps[5], 0x9A5F24E9);
+			CHECK_EQ(msg.gaps[6], 0xAE7338FD);
+			CHECK_EQ(msg.gaps[7], 0xC2874C11);
+			CHECK_EQ(msg.gaps[8], 0xD69B6025);
+			CHECK_EQ(msg.gaps[9], 0xEAAF7439);
+			CHECK_EQ(msg.gaps[10], 0xFEC3884D);
+			CHECK_EQ(msg.gaps[11], 0x12D79C61);
+		}
+
+		memset(buf, 0xA5, sizeof(buf));
+		CHECK_EQ(dc01_encode_hb_stats_report(buf, &msg), DC01_HB_STATS_REPORT_SIZE);
+		CHECK(memcmp(buf, data[p], DC01_HB_STATS_REPORT_SIZE) == 0);
+		CHECK_EQ(buf[DC01_HB_STATS_REPORT_SIZE], 0xA5);
+	}
+}
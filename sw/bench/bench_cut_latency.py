@@ -0,0 +1,273 @@
+#!/usr/bin/env python3
+
+"""
+End-to-end benchmark of DCC cut latency: hJOP failure → DC-01 relay off
+
+Local hJOP stand-in fails (emergency flipped or silent), hjop_watchdog.py
+detects it and cuts DCC, latency ends when the watchdog logs DC-01 state
+report confirming DCC is disconnected. Each iteration restores hJOP, waits
+for DCC to be connected again and for a random phase of the refresh period,
+so triggers are not synchronized with health check rounds.
+
+Runs against DC-01 simulator (default) or real device (-c, DCC input must be
+present). Scenarios:
+  emergency   trakce.emergency set in /status
+  silent      server accepts requests, but never responds
+Loads:
+  none        no induced load
+  slow-http   every /status response delayed (--http-delay)
+  noisy-serial  garbage, split & delayed frames from DC-01 (simulator only)
+  cpu         busy loop on every CPU
+
+Latency is split into detection (failure → cut sent, includes health check
+rounds) and confirmation (cut sent → state report, logged by watchdog).
+Times of log lines include asynchronous logging of the watchdog (< 1 ms).
+
+Usage:
+  bench_cut_latency.py [options]
+  bench_cut_latency.py --help
+
+Options:
+  -c <port>          Real DC-01 serial port instead of simulator
+  -n <count>         Iterations per scenario & load [default: 20]
+  -s <scenarios>     Comma-separated scenarios [default: emergency,silent]
+  --load <loads>     Comma-separated loads [default: none,slow-http,noisy-serial,cpu]
+  --lease <ms>       Passed to watchdog (0 = SET_STATE heartbeat) [default: 2000]
+  --cut-after <n>    Passed to watchdog [default: 3]
+  --http-delay <s>   Response delay of slow-http load [default: 0.15]
+  --budget <ms>      Fail when p99 of any scenario exceeds <ms> (DC-01 own timeout is 2000 ms) [default: 1500]
+  --seed <seed>      Random seed [default: 1]
+  -h --help          Show this screen
+"""
+
+import multiprocessing
+import os
+import random
+import re
+import select
+import statistics
+import subprocess
+import sys
+import tempfile
+import time
+from typing import Dict, IO, List, Optional, Tuple
+from docopt import docopt
+
+SW_DIR = os.path.join(os.path.dirname(os.path.abspath(__file__)), '..')
+sys.path.insert(0, SW_DIR)
+from hjop_standin import StandinServer  # noqa: E402
+
+REFRESH_PERIOD = 0.25  # seconds, of watchdog
+ITERATION_TIMEOUT = 5  # seconds
+START_TIMEOUT = 15  # seconds, includes Big relay test
+SCENARIOS = ('emergency', 'silent')
+LOADS = ('none', 'slow-http', 'noisy-serial', 'cpu')
+NOISY_SERIAL = ['garbage 0.1', 'split 0.3', 'delay 0.002 0.004']  # dc01_sim.py commands
+CONNECTED = b'dcc_connected=True'
+CONFIRMED = re.compile(rb'DCC cut confirmed by DC-01 in (\d+) ms')
+
+
+class Simulator:
+    """dc01_sim.py commanded via stdin."""
+
+    def __init__(self, link: str):
+        self.proc = subprocess.Popen([sys.executable, os.path.join(SW_DIR, 'dc01_sim.py'), '--link', link],
+                                     stdin=subprocess.PIPE, stdout=subprocess.DEVNULL, stderr=subprocess.DEVNULL)
+        end = time.monotonic() + START_TIMEOUT
+        while not os.path.exists(link):
+            if time.monotonic() > end:
+                raise TimeoutError('simulator did not start')
+            time.sleep(0.05)
+
+    def close(self) -> None:
+        self.proc.terminate()
+        self.proc.wait()
+
+    def command(self, line: str) -> None:
+        stdin: IO[bytes] = self.proc.stdin
+        stdin.write(line.encode() + b'\n')
+        stdin.flush()
+
+
+class Process:
+    """Subprocess with stdout read line by line."""
+
+    def __init__(self, cmd: List[str]):
+        self.proc = subprocess.Popen(cmd, stdin=subprocess.DEVNULL, stdout=subprocess.PIPE, stderr=subprocess.STDOUT)
+        self.out = self.proc.stdout.fileno()
+        self.out_buf = b''
+
+    def close(self) -> None:
+        self.proc.terminate()
+        self.proc.wait()
+
+    def wait_line(self, pattern: re.Pattern, timeout: float) -> Tuple[float, re.Match]:
+        """Waits for line matching ‹pattern›, returns (monotonic time of its arrival, match)."""
+        end = time.monotonic() + timeout
+        while True:
+            while b'\n' in self.out_buf:
+                line, self.out_buf = self.out_buf.split(b'\n', 1)
+                match = pattern.search(line)
+                if match:
+                    return time.monotonic(), match
+            remaining = end - time.monotonic()
+            if remaining <= 0:
+                raise TimeoutError(pattern.pattern.decode())
+            r, _, _ = select.select([self.out], [], [], remaining)
+            if r:
+                data = os.read(self.out, 0x1000)
+                if not data:
+                    raise EOFError('process exited')
+                self.out_buf += data
+
+    def drain(self) -> None:
+        while select.select([self.out], [], [], 0)[0]:
+            data = os.read(self.out, 0x1000)
+            if not data:
+                return
+            self.out_buf += data
+        self.out_buf = b''
+
+
+def busy() -> None:
+    while True:
+        pass
+
+
+class Bench:
+    def __init__(self, args):
+        self.rnd = random.Random(int(args['--seed']))
+        self.http_delay = float(args['--http-delay'])
+        self.server = StandinServer('127.0.0.1', 0)
+        self.server.start()
+
+        self.tmp = tempfile.TemporaryDirectory()
+        self.sim: Optional[Simulator] = None
+        port = args['-c']
+        if port is None:
+            port = os.path.join(self.tmp.name, 'dc01')
+            self.sim = Simulator(port)
+
+        self.watchdog = Process([
+            sys.executable, os.path.join(SW_DIR, 'hjop_watchdog.py'), '--nocolor', '-c', port,
+            '-p', str(self.server.server_address[1]), '--lease', args['--lease'], '--cut-after', args['--cut-after'],
+        ])
+        self.watchdog.wait_line(re.compile(CONNECTED), START_TIMEOUT)
+
+    def close(self) -> None:
+        self.watchdog.close()
+        if self.sim:
+            self.sim.close()
+        self.server.shutdown()
+        self.tmp.cleanup()
+
+    def fail(self, scenario: str, failed: bool) -> None:
+        if scenario == 'emergency':
+            self.server.state.update({'emergency': str(int(failed))})
+        else:
+            self.server.state.update({'silent': str(int(failed))})
+
+    def iteration(self, scenario: str) -> Optional[Tuple[float, float]]:
+        """Returns (total, confirmation) latency in seconds, None when DCC was not cut in time."""
+        self.watchdog.drain()
+        start = time.monotonic()
+        self.fail(scenario, True)
+        try:
+            end, match = self.watchdog.wait_line(CONFIRMED, ITERATION_TIMEOUT)
+            result: Optional[Tuple[float, float]] = (end - start, int(match[1]) / 1000)
+        except TimeoutError:
+            result = None
+        self.fail(scenario, False)
+        self.watchdog.wait_line(re.compile(CONNECTED), START_TIMEOUT)
+        time.sleep(REFRESH_PERIOD + self.rnd.uniform(0, REFRESH_PERIOD))  # random phase to health check rounds
+        return result
+
+    def run(self, scenario: str, load: str, count: int) -> Optional[Tuple[List[float], List[float], int]]:
+        """Returns (total latencies, confirmation latencies, missed cuts), None when load is not applicable."""
+        workers: List[multiprocessing.Process] = []
+        if load == 'noisy-serial':
+            if self.sim is None:
+                return None
+            for command in NOISY_SERIAL:
+                self.sim.command(command)
+        elif load == 'slow-http':
+            self.server.state.update({'delay': str(self.http_delay)})
+        elif load == 'cpu':
+            workers = [multiprocessing.Process(target=busy, daemon=True) for _ in range(os.cpu_count() or 1)]
+            for worker in workers:
+                worker.start()
+
+        totals: List[float] = []
+        confirmations: List[float] = []
+        missed = 0
+        try:
+            for _ in range(count):
+                result = self.iteration(scenario)
+                if result is None:
+                    missed += 1
+                else:
+                    totals.append(result[0])
+                    confirmations.append(result[1])
+        finally:
+            for worker in workers:
+                worker.terminate()
+            self.server.state.update({'delay': '0'})
+            if self.sim:
+                self.sim.command('clear')
+        return totals, confirmations, missed
+
+
+def percentiles(values: List[float]) -> Dict[str, float]:
+    ms = sorted(x*1000 for x in values)
+    if len(ms) < 2:
+        return {'p50': ms[0], 'p90': ms[0], 'p99': ms[0], 'max': ms[0]}
+    q = statistics.quantiles(ms, n=100, method='inclusive')
+    return {'p50': q[49], 'p90': q[89], 'p99': q[98], 'max': ms[-1]}
+
+
+def report(name: str, values: List[float]) -> str:
+    return f'{name}: ' + ', '.join(f'{k}={v:.0f}' for k, v in percentiles(values).items()) + ' ms'
+
+
+def main() -> None:
+    args = docopt(__doc__)
+    scenarios = args['-s'].split(',')
+    loads = args['--load'].split(',')
+    for name in scenarios:
+        if name not in SCENARIOS:
+            sys.exit(f'Unknown scenario: {name}')
+    for name in loads:
+        if name not in LOADS:
+            sys.exit(f'Unknown load: {name}')
+    count = int(args['-n'])
+    budget = float(args['--budget'])
+
+    bench = Bench(args)
+    over_budget = False
+    try:
+        for scenario in scenarios:
+            for load in loads:
+                result = bench.run(scenario, load, count)
+                if result is None:
+                    print(f'{scenario}, load {load}: skipped (simulator only)')
+                    continue
+                totals, confirmations, missed = result
+                print(f'{scenario}, load {load}: {len(totals)} cuts, {missed} missed')
+                if not totals:
+                    over_budget = True
+                    continue
+                detections = [t-c for t, c in zip(totals, confirmations)]
+                print(f'  {report("total", totals)}')
+                print(f'  {report("detection", detections)}')
+                print(f'  {report("confirmation", confirmations)}')
+                p99 = percentiles(totals)['p99']
+                if missed or p99 > budget:
+                    print(f'  OVER BUDGET ({budget:.0f} ms)')
+                    over_budget = True
+    finally:
+        bench.close()
+    sys.exit(1 if over_budget else 0)
+
+
+if __name__ == '__main__':
+    main()
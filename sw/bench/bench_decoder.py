@@ -0,0 +1,98 @@
+#!/usr/bin/env python3
+
+"""
+Benchmark of DC-01 packet decoding: FrameDecoder vs. original list-based loop
+
+Usage:
+  bench_decoder.py [options]
+  bench_decoder.py --help
+
+Options:
+  -i <file>          Read raw captured stream from <file> instead of generating it
+  -s <megabytes>     Size of generated stream [default: 2]
+  -n <ratio>         Ratio of garbage bytes in generated stream [default: 0.1]
+  -c <chunks>        Comma-separated sizes of chunks data are fed in [default: 64,1024]
+  --seed <seed>      Random seed [default: 1]
+  -h --help          Show this screen
+"""
+
+import os
+import sys
+import random
+import time
+from typing import List
+from docopt import docopt
+
+sys.path.insert(0, os.path.join(os.path.dirname(os.path.abspath(__file__)), '..'))
+from dc01_link import FrameDecoder, encode_frame, DC_CMD_MP_STATE, DC_CMD_MP_BRSTATE, DC_CMD_MP_INFO  # noqa: E402
+
+MAGIC = [0x37, 0xE2]
+
+
+def generate(size: int, garbage_ratio: float, rnd: random.Random) -> bytes:
+    frames = [
+        encode_frame(DC_CMD_MP_STATE, bytes([0x11, 0, 0])),
+        encode_frame(DC_CMD_MP_STATE, bytes([0x13, 0, 2])),
+        encode_frame(DC_CMD_MP_BRSTATE, bytes([1, 3, 0])),
+        encode_frame(DC_CMD_MP_INFO, bytes([1, 0])),
+    ]
+    out = bytearray()
+    while len(out) < size:
+        if rnd.random() < garbage_ratio:
+            out += bytes(rnd.choice([0x37, 0x00, 0xFF, 0x55]) for _ in range(rnd.randint(1, 16)))
+        out += rnd.choice(frames)
+    return bytes(out)
+
+
+def legacy(chunks: List[bytes]) -> int:
+    """Receive loop of hjop_watchdog.py up to v1.0."""
+    frames = 0
+    receive_buf: List[int] = []
+    for received in chunks:
+        receive_buf += received
+        while len(receive_buf) >= len(MAGIC) and receive_buf[0:len(MAGIC)] != MAGIC:
+            receive_buf.pop(0)
+
+        while len(receive_buf) >= 3 and len(receive_buf) >= receive_buf[2]+3:
+            packet_length = receive_buf[len(MAGIC)]+3
+            if receive_buf[3:packet_length]:
+                frames += 1
+            receive_buf = receive_buf[packet_length:]
+            while len(receive_buf) >= len(MAGIC) and receive_buf[0:len(MAGIC)] != MAGIC:
+                receive_buf.pop(0)
+    return frames
+
+
+def decoder(chunks: List[bytes]) -> int:
+    dec = FrameDecoder()
+    for received in chunks:
+        for frame in dec.feed(received):
+            pass
+    print(f'    resyncs={dec.resyncs}, garbage_bytes={dec.garbage_bytes}')
+    return dec.frames
+
+
+def main() -> None:
+    args = docopt(__doc__)
+    rnd = random.Random(int(args['--seed']))
+
+    if args['-i']:
+        with open(args['-i'], 'rb') as f:
+            stream = f.read()
+    else:
+        stream = generate(int(float(args['-s'])*1024*1024), float(args['-n']), rnd)
+    print(f'Stream: {len(stream)} bytes')
+
+    for chunk_size in map(int, args['-c'].split(',')):
+        chunks = [stream[i:i+chunk_size] for i in range(0, len(stream), chunk_size)]
+        print(f'Chunk size {chunk_size} B:')
+        for name, func in (('legacy', legacy), ('FrameDecoder', decoder)):
+            start = time.perf_counter()
+            frames = func(chunks)
+            duration = time.perf_counter() - start
+            print(f'  {name:>12}: {frames} frames in {duration:.3f} s '
+                  f'({len(stream)/duration/1e6:.2f} MB/s, {duration/frames*1e9:.0f} ns/frame)')
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,179 @@
+#!/usr/bin/env python3
+
+"""
+Benchmark of native libdc01 vs. Python implementation
+
+Measures (1) heartbeat period jitter and (2) latency of handling a STATE
+report of dc01d vs. hjop_watchdog.py (both in --mock mode on a pty) and
+(3) throughput of NativeFrameDecoder vs. FrameDecoder. Frames of
+native_encode_frame are checked against encode_frame & decoded back by both
+decoders first. Build libdc01 first (make -C libdc01).
+
+Usage:
+  bench_native.py [options]
+  bench_native.py --help
+
+Options:
+  -t <seconds>       Duration of heartbeat measurement per implementation [default: 10]
+  -n <reports>       Number of STATE reports to measure handling latency on [default: 50]
+  -s <megabytes>     Size of generated stream for decoder benchmark [default: 2]
+  -h --help          Show this screen
+"""
+
+import os
+import pty
+import random
+import select
+import statistics
+import subprocess
+import sys
+import time
+import tty
+from typing import Dict, List
+from docopt import docopt
+
+SW_DIR = os.path.join(os.path.dirname(os.path.abspath(__file__)), '..')
+sys.path.insert(0, SW_DIR)
+from dc01_link import FrameDecoder, encode_frame, DC_CMD_MP_STATE  # noqa: E402
+from dc01_native import NativeFrameDecoder, native_encode_frame, DC01_LIB_DEFAULT  # noqa: E402
+from bench_decoder import generate  # noqa: E402
+
+IMPLEMENTATIONS = {
+    'python': [sys.executable, os.path.join(SW_DIR, 'hjop_watchdog.py'), '--nocolor'],
+    'native': [os.path.join(os.path.dirname(DC01_LIB_DEFAULT), 'dc01d')],
+}
+# Alternating states: hjop_watchdog.py logs only changes of state
+STATE_FRAMES = [encode_frame(DC_CMD_MP_STATE, bytes([0x11, 0, 0])), encode_frame(DC_CMD_MP_STATE, bytes([0x11, 0, 2]))]
+HEARTBEAT_FRAME = encode_frame(0x11, bytes([1]))
+
+
+def percentiles(values: List[float]) -> str:
+    values = sorted(values)
+    p = [values[min(len(values)-1, int(len(values)*q))] for q in (0.5, 0.99)]
+    return f'p50={p[0]*1e3:.3f} ms, p99={p[1]*1e3:.3f} ms, max={values[-1]*1e3:.3f} ms'
+
+
+class Watchdog:
+    """Watchdog process connected to a pty, stdout read line by line."""
+
+    def __init__(self, cmd: List[str]):
+        self.master, slave = pty.openpty()
+        tty.setraw(self.master)
+        tty.setraw(slave)
+        self.proc = subprocess.Popen(cmd + ['-c', os.ttyname(slave), '--mock'],
+                                     stdout=subprocess.PIPE, stderr=subprocess.DEVNULL)
+        os.close(slave)
+        self.out = self.proc.stdout.fileno()
+        self.out_buf = b''
+
+    def close(self) -> None:
+        self.proc.terminate()
+        self.proc.wait()
+        os.close(self.master)
+
+    def heartbeats(self, duration: float) -> List[float]:
+        """Returns monotonic times of received heartbeats."""
+        times = []
+        buf = b''
+        while select.select([self.master], [], [], 0)[0]:  # drop heartbeats queued so far
+            os.read(self.master, 0x1000)
+        end = time.monotonic() + duration
+        while time.monotonic() < end:
+            r, _, _ = select.select([self.master], [], [], 0.05)
+            if r:
+                buf += os.read(self.master, 0x100)
+                now = time.monotonic()
+                while HEARTBEAT_FRAME in buf:
+                    buf = buf[buf.index(HEARTBEAT_FRAME)+len(HEARTBEAT_FRAME):]
+                    times.append(now)
+        return times
+
+    def wait_line(self, text: bytes, timeout: float = 1) -> float:
+        """Waits for line with ‹text› on stdout, returns monotonic time of its arrival."""
+        end = time.monotonic() + timeout
+        while time.monotonic() < end:
+            while b'\n' in self.out_buf:
+                line, self.out_buf = self.out_buf.split(b'\n', 1)
+                if text in line:
+                    return time.monotonic()
+            r, _, _ = select.select([self.out], [], [], 0.05)
+            if r:
+                self.out_buf += os.read(self.out, 0x1000)
+        raise TimeoutError(text.decode())
+
+    def report_latencies(self, count: int) -> List[float]:
+        self.wait_line(b'Connecting to', 5)
+        time.sleep(0.3)
+        self.out_buf = b''
+        result = []
+        for i in range(count):
+            start = time.monotonic()
+            os.write(self.master, STATE_FRAMES[i % 2])
+            result.append(self.wait_line(b'Received: mode=') - start)
+            time.sleep(0.02)
+        return result
+
+
+def bench_watchdogs(duration: float, reports: int) -> None:
+    for name, cmd in IMPLEMENTATIONS.items():
+        wd = Watchdog(cmd)
+        try:
+            latencies = wd.report_latencies(reports)
+            times = wd.heartbeats(duration)
+        finally:
+            wd.close()
+        periods = [b-a for a, b in zip(times, times[1:])]
+        jitter = [abs(p-0.25) for p in periods]
+        print(f'{name}:')
+        print(f'  heartbeat: {len(periods)} periods, mean={statistics.mean(periods)*1e3:.3f} ms, '
+              f'jitter {percentiles(jitter)}')
+        print(f'  STATE report handling latency: {percentiles(latencies)}')
+
+
+def check_encoder() -> bool:
+    rng = random.Random(2)
+    messages = [(code, bytes(rng.randrange(0x100) for _ in range(size)))
+                for code in (0x00, 0x11, DC_CMD_MP_STATE, 0xFF) for size in (0, 1, 2, 17, 0xFE)]
+    stream = b''.join(native_encode_frame(code, data) for code, data in messages)
+    equal = (stream == b''.join(encode_frame(code, data) for code, data in messages))
+    for cls in (FrameDecoder, NativeFrameDecoder):
+        decoded = [(f.command_code, bytes(f.data)) for f in cls().feed(stream)]
+        equal = equal and (decoded == messages)
+    try:
+        native_encode_frame(0x11, bytes(0xFF))
+        equal = False
+    except ValueError:
+        pass
+    print(f'Encoder, {len(messages)} frames: native equal to Python & decoded back: {equal}')
+    return equal
+
+
+def bench_decoders(size: int) -> None:
+    stream = generate(size, 0.1, random.Random(1))
+    chunks = [stream[i:i+1024] for i in range(0, len(stream), 1024)]
+    results: Dict[str, List[bytes]] = {}
+    print(f'Decoder, {len(stream)} bytes in 1024 B chunks:')
+    for name, cls in (('FrameDecoder', FrameDecoder), ('NativeFrameDecoder', NativeFrameDecoder)):
+        dec = cls()
+        start = time.perf_counter()
+        for chunk in chunks:
+            for frame in dec.feed(chunk):
+                pass
+        duration = time.perf_counter() - start
+        check = cls()
+        results[name] = [bytes([f.command_code]) + bytes(f.data) for c in chunks for f in check.feed(c)]
+        print(f'  {name:>18}: {dec.frames} frames in {duration:.3f} s ({len(stream)/duration/1e6:.2f} MB/s, '
+              f'resyncs={dec.resyncs}, garbage_bytes={dec.garbage_bytes})')
+    print(f'  Decoded frames equal: {results["FrameDecoder"] == results["NativeFrameDecoder"]}')
+
+
+def main() -> None:
+    args = docopt(__doc__)
+    if not check_encoder():
+        sys.exit(1)
+    bench_decoders(int(float(args['-s'])*1024*1024))
+    bench_watchdogs(float(args['-t']), int(args['-n']))
+
+
+if __name__ == '__main__':
+    main()
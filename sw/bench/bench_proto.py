@@ -0,0 +1,165 @@
+#!/usr/bin/env python3
+
+"""
+Round-trip check & benchmark of generated DC-01 protocol codecs (dc01_proto.py)
+
+Each message of the schema (fw/doc/protocol.json) is filled with random
+values, encoded, checked to have size of the schema and decoded back by
+the dispatch table (decode_report/decode_request) from a memoryview, as the
+decoders are used behind FrameDecoder. Longer packets must decode the same,
+shorter must be rejected. Then decoding of reports is timed against the
+hand-written decoder of dc01_link.py up to v1.2 (reports added later are
+timed by generated decoder only).
+
+Usage:
+  bench_proto.py [options]
+  bench_proto.py --help
+
+Options:
+  -n <count>         Random samples per message in round-trip check [default: 200]
+  -b <count>         Decoded reports per message in benchmark [default: 200000]
+  --seed <seed>      Random seed [default: 1]
+  -h --help          Show this screen
+"""
+
+import os
+import sys
+import random
+import struct
+import time
+from typing import Any, Callable, Dict, List, Optional
+from docopt import docopt
+
+SW_DIR = os.path.join(os.path.dirname(os.path.abspath(__file__)), '..')
+sys.path.insert(0, SW_DIR)
+import dc01_proto  # noqa: E402
+from dc01_protogen import SCHEMA, TYPES, Field, Message, load_schema  # noqa: E402
+from dc01_proto import (  # noqa: E402
+    InfoReport, StateReport, BrtReport, LeaseReport, ScopeReport, DccInputStats, DccStatsReport, DccWaveReport,
+    DC_CMD_MP_INFO, DC_CMD_MP_STATE, DC_CMD_MP_BRSTATE, DC_CMD_MP_LEASE, DC_CMD_MP_SCOPE, DC_CMD_MP_DCC_STATS,
+    DC_CMD_MP_DCC_WAVE,
+)
+
+
+def sample_values(field: Field, rnd: random.Random) -> List[Any]:
+    """Returns random values of class attributes of ‹field›."""
+    if field.bits:
+        values = []
+        for b in field.bits:
+            items = [bool(rnd.getrandbits(1)) if b.width == 1 else rnd.getrandbits(b.width) for _ in range(b.count)]
+            values.append(tuple(items) if b.count > 1 else items[0])
+        return values
+    if field.type == 'bytes':
+        return [rnd.randbytes(field.size)]
+    if field.type == 'group':
+        cls = getattr(dc01_proto, field.cls)  # type: ignore
+        return [tuple(cls(*(v for sub in field.fields for v in sample_values(sub, rnd)))
+                      for _ in range(field.count))]  # type: ignore
+    bits = TYPES[field.type][0] * 8
+    if field.count:
+        return [tuple(rnd.getrandbits(bits) for _ in range(field.count))]
+    return [rnd.getrandbits(bits)]
+
+
+def sample(msg: Message, rnd: random.Random) -> Any:
+    cls = getattr(dc01_proto, msg.cls)
+    return cls(*(v for field in msg.fields for v in sample_values(field, rnd)))
+
+
+def roundtrip(messages: List[Message], count: int, rnd: random.Random) -> int:
+    """Returns number of failures."""
+    failures = 0
+    for msg in messages:
+        decode = dc01_proto.decode_request if msg.direction == 'PM' else dc01_proto.decode_report
+        for _ in range(count):
+            value = sample(msg, rnd)
+            code, data = dc01_proto.encode(value)
+            errors = []
+            if code != msg.code:
+                errors.append(f'code 0x{code:02X}')
+            if len(data) != msg.size:
+                errors.append(f'{len(data)} bytes')
+            if decode(code, memoryview(data)) != value:
+                errors.append('decoded differs')
+            if decode(code, memoryview(data + b'\xAA\x55')) != value:
+                errors.append('longer packet decoded differently')
+            if msg.size and decode(code, memoryview(data[:-1])) is not None:
+                errors.append('short packet accepted')
+            if errors:
+                print(f'  {msg.cls}: {", ".join(errors)}: {value}')
+                failures += 1
+                break
+        else:
+            print(f'  {msg.cls}: {count} samples OK ({msg.size} B)')
+    return failures
+
+
+###############################################################################
+# Hand-written decoder (dc01_link.py up to v1.2)
+
+DCC_INPUT_STATS = struct.Struct('>HIII')
+DCC_WAVE = struct.Struct('>BBHHHIIIII')
+DCC_WAVE_BINS = 8
+
+
+def legacy_decode(code: int, data: memoryview) -> Optional[Any]:
+    if code == DC_CMD_MP_STATE and len(data) >= 3:
+        return StateReport(data[0] >> 4, bool(data[0] & 1), bool((data[0] >> 1) & 1), data[1], data[2])
+    if code == DC_CMD_MP_INFO and len(data) >= 2:
+        return InfoReport(data[0], data[1])
+    if code == DC_CMD_MP_BRSTATE and len(data) >= 3:
+        return BrtReport(data[0], data[1], data[2])
+    if code == DC_CMD_MP_LEASE and len(data) >= 3:
+        return LeaseReport((data[0] << 8) | data[1], data[2])
+    if code == DC_CMD_MP_SCOPE and len(data) >= 4:
+        return ScopeReport((data[0] << 8) | data[1], data[2], data[3], bytes(data[4:]))
+    if code == DC_CMD_MP_DCC_STATS and len(data) >= 1 + 2*DCC_INPUT_STATS.size:
+        size = DCC_INPUT_STATS.size
+        inputs = tuple(DccInputStats(*DCC_INPUT_STATS.unpack_from(data, 1 + i*size)) for i in range(2))
+        return DccStatsReport((bool(data[0] & 1), bool(data[0] & 2)), bool(data[0] & 0x80), inputs)
+    if code == DC_CMD_MP_DCC_WAVE and len(data) >= DCC_WAVE.size + 4*DCC_WAVE_BINS:
+        input, flags, *values = DCC_WAVE.unpack_from(data)
+        bins = struct.unpack_from(f'>{DCC_WAVE_BINS}I', data, DCC_WAVE.size)
+        return DccWaveReport(input, bool(flags & 1), *values, bins)
+    return None
+
+
+def benchmark(messages: List[Message], count: int, rnd: random.Random) -> None:
+    decoders: Dict[str, Callable[[int, memoryview], Optional[Any]]] = {
+        'legacy': legacy_decode,
+        'generated': dc01_proto.decode_report,
+    }
+    for msg in messages:
+        if msg.direction != 'MP':
+            continue
+        value = sample(msg, rnd)
+        data = memoryview(dc01_proto.encode(value)[1])
+        line = f'  {msg.cls:>16}:'
+        for name, decode in decoders.items():
+            decoded = decode(msg.code, data)
+            if decoded is None and decode is legacy_decode:
+                line += f' {name} {"-":>5}   '  # report added after v1.2
+                continue
+            assert decoded == value, name
+            start = time.perf_counter()
+            for _ in range(count):
+                decode(msg.code, data)
+            duration = time.perf_counter() - start
+            line += f' {name} {duration/count*1e9:5.0f} ns'
+        print(line)
+
+
+def main() -> None:
+    args = docopt(__doc__)
+    rnd = random.Random(int(args['--seed']))
+    _, messages = load_schema(SCHEMA)
+
+    print('Round trip:')
+    failures = roundtrip(messages, int(args['-n']), rnd)
+    print('Decoding of reports (per packet):')
+    benchmark(messages, int(args['-b']), rnd)
+    sys.exit(1 if failures else 0)
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,132 @@
+#!/usr/bin/env python3
+
+"""
+Benchmark of hJOP /status check: urllib + json (watchdog up to v1.0) vs.
+keep-alive PTClient with fast-path extraction, against local hJOP stand-in.
+Fast-path extraction is checked against full parse first (nested & decoy
+"trakce" objects must not decide).
+
+Usage:
+  bench_pt.py [options]
+  bench_pt.py --help
+
+Options:
+  -n <count>         Number of checks per implementation [default: 1000]
+  -d <seconds>       Server response delay [default: 0]
+  -h --help          Show this screen
+"""
+
+import asyncio
+import json
+import os
+import statistics
+import sys
+import time
+import urllib.request
+from typing import List, Optional
+from docopt import docopt
+
+sys.path.insert(0, os.path.join(os.path.dirname(os.path.abspath(__file__)), '..'))
+from hjop_standin import StandinServer  # noqa: E402
+from pt_client import PTClient, PTError, status_emergency  # noqa: E402
+
+TIMEOUT = 0.25  # REFRESH_PERIOD of watchdog
+STATUS_BODIES = [
+    b'{"trakce": {"state": "connected", "emergency": false, "library": {"name": "XpressNET"}}}',
+    b'{"trakce":{"emergency":true}}',
+    b' {\n\t"server": {"version": "4.0"},\n\t"trakce": {"library": {}, "emergency": true}\n}\n',
+    b'{"rcs": {"trakce": {"emergency": true}}, "trakce": {"emergency": false}}',
+    b'{"areas": [{"trakce": {"emergency": false}}], "trakce": {"emergency": true}}',
+    b'{"trakce": {"emergency": false, "rcs": {"trakce": {"emergency": true}}}}',
+    b'{"trakce": {"library": {"emergency": true}, "emergency": false}}',
+    b'{"trakce": {"state": "\\"emergency\\": true", "emergency": false}}',
+    b'{"trakce": {"emergency": true}, "trakce": {"emergency": false}}',
+    b'{"trakce": {"emergency": false, "emergency": true}}',
+    b'{"rcs": {"trakce": {"emergency": true}}}',
+    b'{"trakce": {"library": {"emergency": true}}}',
+    b'[{"trakce": {"emergency": true}}]',
+    b'{"trakce": {"emergency": true',
+    b'',
+]
+
+
+def legacy_check(port: int) -> bool:
+    req = urllib.request.Request(
+        f'http://127.0.0.1:{port}/status',
+        headers={'Content-type': 'application/json'},
+        method='GET',
+    )
+    with urllib.request.urlopen(req, timeout=TIMEOUT) as response:
+        data = response.read().decode('utf-8')
+    return bool(json.loads(data)['trakce']['emergency'])
+
+
+def full_parse(body: bytes) -> Optional[bool]:
+    try:
+        return bool(json.loads(body)['trakce']['emergency'])
+    except (ValueError, KeyError, TypeError):
+        return None
+
+
+def check_status_emergency() -> bool:
+    ok = True
+    for body in STATUS_BODIES:
+        try:
+            result: Optional[bool] = status_emergency(body)
+        except PTError:
+            result = None
+        if result != full_parse(body):
+            print(f'  status_emergency({body!r}) == {result}, full parse: {full_parse(body)}')
+            ok = False
+    print(f'Fast path of {len(STATUS_BODIES)} /status bodies equal to full parse: {ok}')
+    return ok
+
+
+def bench_legacy(port: int, count: int) -> List[float]:
+    latencies = []
+    for _ in range(count):
+        start = time.perf_counter()
+        legacy_check(port)
+        latencies.append(time.perf_counter() - start)
+    return latencies
+
+
+async def bench_client(port: int, count: int) -> List[float]:
+    client = PTClient('127.0.0.1', port, TIMEOUT)
+    latencies = []
+    for _ in range(count):
+        start = time.perf_counter()
+        status_emergency(await client.get('/status'))
+        latencies.append(time.perf_counter() - start)
+    client.close()
+    print(f'  PTClient: {client.connects} connection(s) for {client.requests} requests')
+    return latencies
+
+
+def report(name: str, latencies: List[float]) -> None:
+    ms = sorted(x*1000 for x in latencies)
+    q = statistics.quantiles(ms, n=100)
+    print(f'  {name:>8}: p50={q[49]:.3f} ms, p90={q[89]:.3f} ms, p99={q[98]:.3f} ms, max={ms[-1]:.3f} ms')
+
+
+def main() -> None:
+    args = docopt(__doc__)
+    count = int(args['-n'])
+    if not check_status_emergency():
+        sys.exit(1)
+
+    server = StandinServer('127.0.0.1', 0)
+    server.state.delay = float(args['-d'])
+    server.start()
+    port = server.server_address[1]
+
+    print(f'{count} checks of /status ({len(json.dumps(server.state.status()))} B):')
+    legacy = bench_legacy(port, count)
+    client = asyncio.run(bench_client(port, count))
+    report('legacy', legacy)
+    report('PTClient', client)
+    server.shutdown()
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,208 @@
+"""
+Binary capture of DC-01 serial traffic.
+
+Capture file is append-only sequence of records, each has monotonic
+timestamp (time.monotonic, same clock as asyncio loop.time()), type and raw
+data:
+
+  file header: b'DC01CAP' + version (1 B)
+  record:      '<dBH' time, type, data length + data
+
+RX records hold raw chunks as read from the port (including garbage and
+split packets), so replay exercises the decoder exactly as the watchdog did.
+CLOCK record (wall-clock time as '<d') is written at the beginning of each
+file, so monotonic times could be mapped to wall-clock.
+
+CaptureWriter never blocks the caller: records are put to bounded queue and
+written by a background thread. When the queue is full, records are dropped
+and DROPPED record with their count is queued before the next record. Files
+are rotated by size like logging.handlers.RotatingFileHandler:
+<path> → <path>.1 → …
+"""
+
+import logging
+import os
+import queue
+import struct
+import threading
+import time
+from typing import Any, Iterator, List, NamedTuple, Optional
+
+FILE_MAGIC = b'DC01CAP'
+FILE_VERSION = 1
+FILE_HEADER = FILE_MAGIC + bytes([FILE_VERSION])
+RECORD = struct.Struct('<dBH')
+CLOCK = struct.Struct('<d')
+DROPPED = struct.Struct('<I')
+
+REC_RX = 0  # data received from DC-01
+REC_TX = 1  # data sent to DC-01
+REC_OPEN = 2  # port opened, data = port name
+REC_CLOSE = 3  # port closed
+REC_CLOCK = 4  # data = wall-clock time of record
+REC_DROPPED = 5  # data = number of records dropped due to full queue
+REC_NAMES = ['RX', 'TX', 'OPEN', 'CLOSE', 'CLOCK', 'DROPPED']
+
+CAPTURE_MAX_BYTES = 16*1024*1024
+CAPTURE_BACKUPS = 5
+QUEUE_SIZE = 4096  # records
+
+
+class Record(NamedTuple):
+    time: float  # monotonic
+    type: int
+    data: bytes
+
+
+class CaptureWriter:
+    def __init__(self, path: str, max_bytes: int = CAPTURE_MAX_BYTES, backup_count: int = CAPTURE_BACKUPS,
+                 queue_size: int = QUEUE_SIZE):
+        self.path = path
+        self.max_bytes = max_bytes
+        self.backup_count = backup_count
+        self.dropped = 0  # records dropped so far
+        self._unreported = 0  # dropped records not reported by DROPPED record yet
+        self._queue: queue.Queue = queue.Queue(queue_size)
+        self._file: Optional[Any] = None
+        self._size = 0
+        self._open()  # in caller's thread → invalid path is reported immediately
+        self._thread = threading.Thread(target=self._run, name='capture', daemon=True)
+        self._thread.start()
+
+    def rx(self, data: bytes, now: Optional[float] = None) -> None:
+        self.record(REC_RX, data, now)
+
+    def tx(self, data: bytes, now: Optional[float] = None) -> None:
+        self.record(REC_TX, data, now)
+
+    def opened(self, port: str) -> None:
+        self.record(REC_OPEN, port.encode('utf-8'))
+
+    def closed(self) -> None:
+        self.record(REC_CLOSE, b'')
+
+    def record(self, type_: int, data: bytes, now: Optional[float] = None) -> None:
+        now = time.monotonic() if now is None else now
+        try:
+            if self._unreported:
+                self._queue.put_nowait(Record(now, REC_DROPPED, DROPPED.pack(self._unreported)))
+                self._unreported = 0
+            self._queue.put_nowait(Record(now, type_, bytes(data)))
+        except queue.Full:
+            self.dropped += 1
+            self._unreported += 1
+
+    def close(self) -> None:
+        """Writes all queued records and closes the file."""
+        if self._thread.is_alive():
+            if self._unreported:
+                self._queue.put(Record(time.monotonic(), REC_DROPPED, DROPPED.pack(self._unreported)))
+                self._unreported = 0
+            self._queue.put(None)
+            self._thread.join()
+
+    def _open(self) -> None:
+        self._file = open(self.path, 'ab')
+        self._size = self._file.tell()
+        if self._size == 0:
+            self._file.write(FILE_HEADER)
+            self._size = len(FILE_HEADER)
+        self._write_record(Record(time.monotonic(), REC_CLOCK, CLOCK.pack(time.time())))
+
+    def _rotate(self) -> None:
+        self._file.close()
+        if self.backup_count > 0:
+            for i in range(self.backup_count-1, 0, -1):
+                if os.path.exists(f'{self.path}.{i}'):
+                    os.replace(f'{self.path}.{i}', f'{self.path}.{i+1}')
+            os.replace(self.path, f'{self.path}.1')
+        else:
+            os.remove(self.path)
+        self._open()
+
+    def _write_record(self, record: Record) -> None:
+        self._file.write(RECORD.pack(record.time, record.type, len(record.data)))
+        self._file.write(record.data)
+        self._size += RECORD.size + len(record.data)
+
+    def _write(self, record: Record) -> None:
+        if self._size >= self.max_bytes:
+            self._rotate()
+        self._write_record(record)
+
+    def _run(self) -> None:
+        record = self._queue.get()
+        while record is not None:
+            if self._file is not None:
+                try:
+                    self._write(record)
+                except OSError as e:
+                    logging.error(f'Capture stopped: {e}')
+                    self._file = None
+            try:
+                record = self._queue.get_nowait()
+            except queue.Empty:
+                if self._file is not None:
+                    self._file.flush()  # only when there is nothing to write
+                record = self._queue.get()
+        if self._file is not None:
+            self._file.close()
+
+
+class CapturedPort:
+    """Proxy of port-like object, which records everything written to the port."""
+
+    def __init__(self, port: Any, capture: CaptureWriter):
+        self._port = port
+        self._capture = capture
+
+    def write(self, data: bytes) -> Optional[int]:
+        self._capture.tx(data)
+        return self._port.write(data)
+
+    def __getattr__(self, name: str) -> Any:
+        return getattr(self._port, name)
+
+    def __setattr__(self, name: str, value: Any) -> None:
+        # Settings (e.g. timeout of reader thread on Windows) belong to the port
+        if name in ('_port', '_capture'):
+            super().__setattr__(name, value)
+        else:
+            setattr(self._port, name, value)
+
+
+###############################################################################
+# Reading
+
+def read_capture(path: str) -> Iterator[Record]:
+    """Truncated last record (process killed during write) is ignored."""
+    with open(path, 'rb') as f:
+        buf = f.read()
+    if buf[:len(FILE_MAGIC)] != FILE_MAGIC:
+        raise ValueError(f'{path}: not a DC-01 capture')
+    if buf[len(FILE_MAGIC)] != FILE_VERSION:
+        raise ValueError(f'{path}: unsupported capture version {buf[len(FILE_MAGIC)]}')
+    view = memoryview(buf)
+    pos = len(FILE_HEADER)
+    while pos + RECORD.size <= len(buf):
+        t, type_, size = RECORD.unpack_from(buf, pos)
+        pos += RECORD.size
+        if pos + size > len(buf):
+            return
+        yield Record(t, type_, bytes(view[pos:pos+size]))
+        pos += size
+
+
+def capture_files(path: str) -> List[str]:
+    """Returns ‹path› with its rotated files, oldest first."""
+    result = [path] if os.path.exists(path) else []
+    i = 1
+    while os.path.exists(f'{path}.{i}'):
+        result.insert(0, f'{path}.{i}')
+        i += 1
+    return result
+
+
+def read_series(path: str) -> Iterator[Record]:
+    for filename in capture_files(path):
+        yield from read_capture(filename)
@@ -0,0 +1,298 @@
+#!/usr/bin/env python3
+
+"""
+Offline tools for DC-01 serial captures (hjop_watchdog.py --capture)
+
+<capture> is the capture path given to the watchdog, rotated files
+(<capture>.1, <capture>.2, …) are read too, oldest first.
+
+  dump      print all records
+  replay    feed received data through the watchdog's decoder & parser at full
+            speed (throughput is reported, useful as a benchmark) or with
+            original timing (--realtime)
+  analyze   heartbeat gaps, timeline of DC-01 state transitions & DCC cuts
+
+Heartbeat gap is an interval between heartbeats (SET_STATE s=1 or lease
+renewal) long enough for DC-01 to raise timeout warning: --gap for
+SET_STATE (DCCON_WARNING_MS), 3/4 of granted lease for lease.
+
+Usage:
+  dc01_capture.py dump [options] <capture>
+  dc01_capture.py replay [options] <capture>
+  dc01_capture.py analyze [options] <capture>
+  dc01_capture.py --help
+
+Options:
+  --realtime         Replay with original timing
+  --speed <x>        Speed-up of real-time replay [default: 1]
+  --gap <s>          SET_STATE heartbeat gap threshold [default: 0.5]
+  -l <loglevel>      Loglevel of the parser during replay [default: warning]
+  -h --help          Show this screen
+"""
+
+import datetime
+import logging
+import sys
+import time
+from typing import Iterator, List, Optional, Tuple
+from docopt import docopt
+from capture import (
+    Record, read_series, capture_files, CLOCK, DROPPED,
+    REC_RX, REC_TX, REC_OPEN, REC_CLOSE, REC_CLOCK, REC_DROPPED, REC_NAMES,
+)
+from dc01_link import (
+    FrameDecoder, Frame, decode_report, StateReport, InfoReport, BrtReport, LeaseReport,
+    DC_CMD_PM_SET_STATE, DC_CMD_PM_LEASE,
+)
+from hjop_watchdog import dc01_parse, dc01_brtest_state, dc01_mode, Lease, FastCut, REFRESH_PERIOD, DC01_RECEIVE_TIMEOUT
+from metrics import WatchdogMetrics, DCCON_TIMEOUT
+
+STATE_PERIOD = 0.5  # seconds, DC-01 sends STATE each 500 ms
+WARN_TIMEOUT = 0x02  # Warnings.sep.timeout in fw/inc/main.h
+
+
+class Clock:
+    """Maps monotonic times of records to wall-clock by last CLOCK record."""
+
+    def __init__(self) -> None:
+        self.offset: Optional[float] = None
+
+    def update(self, record: Record) -> None:
+        if record.type == REC_CLOCK:
+            self.offset = CLOCK.unpack(record.data)[0] - record.time
+
+    def format(self, t: float) -> str:
+        if self.offset is None:
+            return f'{t:.3f}'
+        return datetime.datetime.fromtimestamp(t + self.offset).strftime('%Y-%m-%d %H:%M:%S.%f')[:-3]
+
+
+class RxDecoder(FrameDecoder):
+    """Drops unfinished packet after a pause in receiving like the watchdog does."""
+
+    def __init__(self) -> None:
+        super().__init__()
+        self.last_time = 0.0
+
+    def feed_record(self, record: Record) -> Iterator[Frame]:
+        if self.pending() and record.time - self.last_time > DC01_RECEIVE_TIMEOUT:
+            self.reset()
+        self.last_time = record.time
+        return self.feed(record.data)
+
+
+###############################################################################
+# dump
+
+def dump(records: Iterator[Record]) -> None:
+    clock = Clock()
+    for record in records:
+        clock.update(record)
+        if record.type in (REC_RX, REC_TX):
+            data = ' '.join(f'{b:02X}' for b in record.data)
+        elif record.type == REC_OPEN:
+            data = record.data.decode('utf-8', 'replace')
+        elif record.type == REC_DROPPED:
+            data = str(DROPPED.unpack(record.data)[0])
+        else:
+            data = ''
+        name = REC_NAMES[record.type] if record.type < len(REC_NAMES) else str(record.type)
+        print(f'{clock.format(record.time)} {name:>7} {data}')
+
+
+###############################################################################
+# replay
+
+def replay(records: Iterator[Record], realtime: bool, speed: float) -> None:
+    metrics = WatchdogMetrics(REFRESH_PERIOD)
+    lease = Lease(0)
+    fast_cut = FastCut(0)
+    decoder = RxDecoder()
+    count = size = frames = 0
+    first: Optional[float] = None  # record time
+    start = time.perf_counter()
+    for record in records:
+        if first is None:
+            first = record.time
+        if realtime:
+            delay = (record.time - first) / speed - (time.perf_counter() - start)
+            if delay > 0:
+                time.sleep(delay)
+        if record.type == REC_OPEN:
+            logging.info(f'Connecting to {record.data.decode("utf-8", "replace")}...')
+            frames += decoder.frames
+            decoder = RxDecoder()
+            lease = Lease(0)
+            fast_cut = FastCut(0)
+        elif record.type == REC_RX:
+            count += 1
+            size += len(record.data)
+            for frame in decoder.feed_record(record):
+                dc01_parse(frame, metrics, lease, fast_cut, record.time)
+        elif record.type == REC_DROPPED:
+            logging.warning(f'Capture: {DROPPED.unpack(record.data)[0]} records dropped')
+    duration = time.perf_counter() - start
+    frames += decoder.frames
+    print(f'Replayed {count} RX records, {size} bytes, {frames} frames in {duration:.3f} s '
+          f'({size/duration/1e6:.2f} MB/s, {frames/duration:.0f} frames/s)', file=sys.stderr)
+
+
+###############################################################################
+# analyze
+
+class Heartbeat:
+    """Tracks heartbeats sent to DC-01 and timeout which is in effect."""
+
+    def __init__(self, gap: float):
+        self.gap = gap
+        self.last: Optional[float] = None
+        self.timeout = DCCON_TIMEOUT
+        self.warning = gap
+        self.intervals: List[float] = []
+        self.gaps: List[Tuple[float, float, float]] = []  # (time, interval, threshold)
+        self.revoked: Optional[float] = None  # time of explicit SET_STATE s=0 or lease revoke
+
+    def sent(self, t: float, frame: Frame) -> None:
+        if frame.command_code == DC_CMD_PM_SET_STATE and len(frame.data) >= 1:
+            if frame.data[0] & 1:
+                self._renewed(t, DCCON_TIMEOUT, self.gap)
+            else:
+                self.revoked = t
+        elif frame.command_code == DC_CMD_PM_LEASE and len(frame.data) >= 3:
+            lease_ms = (frame.data[0] << 8) | frame.data[1]
+            if lease_ms > 0:
+                self._renewed(t, lease_ms / 1000, lease_ms * 3 / 4000)
+            else:
+                self.revoked = t
+
+    def _renewed(self, t: float, timeout: float, warning: float) -> None:
+        if self.last is not None:
+            interval = t - self.last
+            self.intervals.append(interval)
+            if interval > self.warning:
+                self.gaps.append((t, interval, self.warning))
+        self.last = t
+        self.timeout, self.warning = timeout, warning
+        self.revoked = None
+
+    def disconnected(self) -> None:
+        self.last = None
+        self.revoked = None
+
+
+def cut_cause(t: float, hb: Heartbeat, mode: int, warnings: int) -> str:
+    """‹warnings› are from the last report before the cut."""
+    if dc01_mode(mode) != 'mNormalOp':
+        return f'mode {dc01_mode(mode)}'
+    if hb.revoked is not None:
+        return f'revoked by PC {t - hb.revoked:.3f} s before report'
+    if hb.last is None:
+        return 'no heartbeat since connection'
+    age = t - hb.last
+    if warnings & WARN_TIMEOUT and age < hb.timeout - STATE_PERIOD:
+        return f'heartbeats sent, but not received by DC-01 (last sent {age:.3f} s before report)'
+    # STATE report arrives up to STATE_PERIOD after the cut
+    if age >= hb.timeout:
+        return f'heartbeat timeout (age {age:.3f} s, timeout {hb.timeout:.3f} s)'
+    if age >= hb.timeout - STATE_PERIOD:
+        return f'probably heartbeat timeout (age {age:.3f} s, timeout {hb.timeout:.3f} s)'
+    return f'DCC input or relay (heartbeat age {age:.3f} s)'
+
+
+def percentile(values: List[float], q: float) -> float:
+    return sorted(values)[min(len(values)-1, int(len(values)*q))]
+
+
+def analyze(records: Iterator[Record], gap: float) -> None:
+    clock = Clock()
+    hb = Heartbeat(gap)
+    tx_decoder, rx_decoder = FrameDecoder(), RxDecoder()
+    last_state: Optional[StateReport] = None
+    cuts: List[str] = []
+    first = last = None
+    connections = dropped = resyncs = garbage_bytes = 0
+
+    for record in records:
+        clock.update(record)
+        first = record.time if first is None else first
+        last = record.time
+        when = clock.format(record.time)
+
+        if record.type == REC_OPEN:
+            connections += 1
+            resyncs += rx_decoder.resyncs
+            garbage_bytes += rx_decoder.garbage_bytes
+            tx_decoder, rx_decoder = FrameDecoder(), RxDecoder()
+            hb.disconnected()
+            last_state = None
+            print(f'{when} connected to {record.data.decode("utf-8", "replace")}')
+        elif record.type == REC_CLOSE:
+            print(f'{when} disconnected')
+        elif record.type == REC_DROPPED:
+            count = DROPPED.unpack(record.data)[0]
+            dropped += count
+            print(f'{when} capture dropped {count} records')
+        elif record.type == REC_TX:
+            for frame in tx_decoder.feed(record.data):
+                hb.sent(record.time, frame)
+        elif record.type == REC_RX:
+            for frame in rx_decoder.feed_record(record):
+                report = decode_report(frame)
+                if isinstance(report, StateReport):
+                    if last_state is None or (report.mode, report.dcc_connected, report.failure_code,
+                                              report.warnings) != (last_state.mode, last_state.dcc_connected,
+                                                                   last_state.failure_code, last_state.warnings):
+                        print(f'{when} mode={dc01_mode(report.mode)} dcc_connected={report.dcc_connected} '
+                              f'failure_code={report.failure_code} warnings={report.warnings}')
+                    if last_state is not None and last_state.dcc_connected and not report.dcc_connected:
+                        cause = cut_cause(record.time, hb, report.mode, last_state.warnings)
+                        cuts.append(f'{when} {cause}')
+                        print(f'{when} DCC CUT: {cause}')
+                    last_state = report
+                elif isinstance(report, InfoReport):
+                    print(f'{when} FW v{report.fw_major}.{report.fw_minor}')
+                elif isinstance(report, BrtReport):
+                    print(f'{when} BRTest {dc01_brtest_state(report.state)}, step={report.step}, '
+                          f'error={report.error}')
+                elif isinstance(report, LeaseReport) and report.granted_ms == 0:
+                    print(f'{when} lease revoked')
+
+    if first is None:
+        print('Empty capture')
+        return
+    print()
+    print(f'Duration: {last - first:.3f} s, connections: {connections}, dropped records: {dropped}, '
+          f'RX resyncs: {resyncs + rx_decoder.resyncs}, garbage bytes: {garbage_bytes + rx_decoder.garbage_bytes}')
+    if hb.intervals:
+        print(f'Heartbeat intervals: {len(hb.intervals)}, p50={percentile(hb.intervals, 0.5):.3f} s, '
+              f'p99={percentile(hb.intervals, 0.99):.3f} s, max={max(hb.intervals):.3f} s')
+    print(f'Heartbeat gaps: {len(hb.gaps)}')
+    for t, interval, threshold in hb.gaps:
+        print(f'  {clock.format(t)} {interval:.3f} s (threshold {threshold:.3f} s)')
+    print(f'DCC cuts: {len(cuts)}')
+    for cut in cuts:
+        print(f'  {cut}')
+
+
+def main() -> None:
+    args = docopt(__doc__)
+    if not capture_files(args['<capture>']):
+        sys.exit(f'No capture {args["<capture>"]}')
+    records = read_series(args['<capture>'])
+
+    if args['dump']:
+        dump(records)
+    elif args['replay']:
+        logging.basicConfig(format='[%(asctime)s] %(levelname)s %(message)s', level={
+            'debug': logging.DEBUG,
+            'info': logging.INFO,
+            'warning': logging.WARNING,
+            'error': logging.ERROR,
+        }.get(args['-l'], logging.WARNING))
+        replay(records, args['--realtime'], float(args['--speed']))
+    elif args['analyze']:
+        analyze(records, float(args['--gap']))
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,205 @@
+"""
+DC-01 ↔ PC link layer: packet framing & decoding of DC-01 reports.
+See fw/doc/protocol.md for protocol description. Messages & their codecs are
+generated to dc01_proto.py from fw/doc/protocol.json (dc01_protogen.py).
+
+FrameDecoder is an incremental decoder: received bytes are copied once into
+a fixed-size buffer, packets are returned as memoryviews into this buffer.
+No per-packet copies are made, resynchronization (garbage between packets)
+is done with ‹bytes.find› in O(n).
+"""
+
+import functools
+from typing import Any, Iterator, List, NamedTuple, Optional, Union
+from dc01_proto import (  # noqa: F401 (re-exported, generated from fw/doc/protocol.json)
+    MAGIC, DC_CMD_PM_INFO_REQ, DC_CMD_PM_SET_STATE, DC_CMD_PM_PING, DC_CMD_PM_LEASE, DC_CMD_PM_SCOPE,
+    DC_CMD_PM_DCC_STATS, DC_CMD_PM_DCC_WAVE, DC_CMD_PM_BOOT_INFO, DC_CMD_PM_CRASH, DC_CMD_PM_HB_STATS, DC_CMD_MP_INFO,
+    DC_CMD_MP_STATE, DC_CMD_MP_BRSTATE, DC_CMD_MP_LEASE, DC_CMD_MP_SCOPE, DC_CMD_MP_DCC_STATS, DC_CMD_MP_DCC_WAVE,
+    DC_CMD_MP_BOOT_INFO, DC_CMD_MP_CRASH, DC_CMD_MP_HB_STATS,
+    InfoRequest, SetStateRequest, PingRequest, LeaseRequest, ScopeRequest, DccStatsRequest, DccWaveRequest,
+    BootInfoRequest, InfoReport, StateReport, BrtReport, LeaseReport, ScopeReport, DccInputStats, DccStatsReport,
+    DccWaveReport, BootInfoReport, CrashRequest, CrashReport, HbStatsRequest, HbStatsReport,
+    encode, decode_request,
+)
+import dc01_proto
+
+HEADER_SIZE = 3  # magic + length
+MAX_PACKET_SIZE = HEADER_SIZE + 0xFF
+
+SCOPE_RUN = 0x01  # ScopeReport.flags (ScopeRequest bits)
+SCOPE_RELAYS = 0x02  # 4 bits per sample (DCC1, DCC2, relay1, relay2), 2 bits otherwise
+SCOPE_SAMPLE_PERIOD = 100e-6  # seconds
+SCOPE_SAMPLES_SIZE = 56
+
+SERIAL_STATE_VERSION = (1, 2)  # first FW sending CDC SERIAL_STATE notifications
+
+BOOT_INFO_VERSION = (1, 2)  # first FW reporting reset cause & boot timing
+RESET_CAUSES = ('power', 'pin', 'iwdg', 'software', 'wwdg', 'low_power')  # BootInfoReport.reset_cause bits
+BOOT_NO_BRT = 0xFFFFFFFF  # BootInfoReport.brt_age_s
+
+CRASH_CAUSES = ('none', 'error', 'nmi', 'hardfault', 'memmanage', 'busfault', 'usagefault')  # CrashReport.cause
+CRASH_TRAIL_EVENTS = ('', 'mode', 'relays', 'brt', 'command', 'timeout', 'pc_died')  # CrashReport.trail >> 8
+CRASH_FRAME = ('r0', 'r1', 'r2', 'r3', 'r12', 'lr', 'pc', 'xpsr')
+
+HB_GAP_BINS = ('0-7', '8-15', '16-31', '32-63', '64-127', '128-255', '256-511', '512-1023', '1024-2047',
+               '2048-4095', '4096-8191', '8192-')  # HbStatsReport.gaps [ms]
+HB_NO_MARGIN = 0xFFFF  # HbStatsReport.min_margin_ms
+
+DCC_INPUTS = ('dcc1', 'dcc2')
+DCC_WAVE_BINS = ('0-51', '52-54', '55-61', '62-64', '65-89', '90-94', '95-9900', '9901-')  # half-period [us]
+
+
+def encode_frame(command_code: int, data: bytes = b'') -> bytes:
+    return MAGIC + bytes([len(data)+1, command_code]) + data
+
+
+def encode_message(msg: NamedTuple) -> bytes:
+    """Encodes message of dc01_proto to frame."""
+    return encode_frame(*encode(msg))
+
+
+def encode_lease(duration_ms: int, seq: int) -> bytes:
+    """Duration 0 = revoke."""
+    return encode_message(LeaseRequest(duration_ms, seq & 0xFF))
+
+
+def encode_scope(run: bool, relays: bool = False) -> bytes:
+    return encode_message(ScopeRequest(run, relays))
+
+
+class Frame(NamedTuple):
+    command_code: int
+    data: memoryview  # valid only until next frame is requested from decoder
+
+
+class FrameDecoder:
+    def __init__(self, capacity: int = 0x1000):
+        assert capacity >= MAX_PACKET_SIZE
+        self._buf = bytearray(capacity)
+        self._view = memoryview(self._buf)
+        self._start = 0  # first unprocessed byte
+        self._end = 0  # end of received data
+        self.frames = 0
+        self.resyncs = 0
+        self.garbage_bytes = 0
+
+    def pending(self) -> int:
+        """Returns number of bytes of unfinished packet."""
+        return self._end - self._start
+
+    def reset(self) -> None:
+        """Drops unfinished packet."""
+        self._drop(self._end - self._start)
+        self._start = self._end = 0
+
+    def feed(self, data: bytes) -> Iterator[Frame]:
+        """
+        Generator: must be iterated to the end, otherwise not all ‹data› are
+        processed.
+        """
+        data_view = memoryview(data)
+        while data_view:
+            if self._start == self._end:
+                self._start = self._end = 0
+            elif self._end == len(self._buf):
+                # Move unfinished packet to the beginning of the buffer
+                pending = self._end - self._start
+                self._view[:pending] = self._view[self._start:self._end]
+                self._start, self._end = 0, pending
+
+            count = min(len(data_view), len(self._buf) - self._end)
+            self._view[self._end:self._end+count] = data_view[:count]
+            self._end += count
+            data_view = data_view[count:]
+            yield from self._frames()
+
+    def _drop(self, count: int) -> None:
+        if count > 0:
+            self.resyncs += 1
+            self.garbage_bytes += count
+            self._start += count
+
+    def _frames(self) -> Iterator[Frame]:
+        buf, view = self._buf, self._view
+        start, end = self._start, self._end
+        while end-start >= HEADER_SIZE:
+            if buf[start] != MAGIC[0] or buf[start+1] != MAGIC[1]:
+                pos = buf.find(MAGIC, start+1, end)
+                if pos < 0:  # keep last byte, it could be start of next magic
+                    pos = end-1 if buf[end-1] == MAGIC[0] else end
+                self._drop(pos-start)
+                start = self._start
+                continue
+
+            length = buf[start+2]
+            next_start = start+HEADER_SIZE+length
+            if next_start > end:
+                break  # wait for more data
+            if length == 0:  # no command code → invalid packet
+                self._drop(HEADER_SIZE)
+                start = self._start
+                continue
+
+            self._start = next_start
+            self.frames += 1
+            yield _new_frame((buf[start+HEADER_SIZE], view[start+HEADER_SIZE+1:next_start]))
+            start = next_start
+
+
+_new_frame = functools.partial(tuple.__new__, Frame)  # avoids slow Python-level Frame.__new__
+
+
+###############################################################################
+# DC-01 reports
+
+Report = Union[InfoReport, StateReport, BrtReport, LeaseReport, ScopeReport, DccStatsReport, DccWaveReport,
+               BootInfoReport, CrashReport, HbStatsReport]
+
+
+def decode_report(frame: Frame) -> Optional[Report]:
+    """Returns None for unknown or too short packets."""
+    return dc01_proto.decode_report(frame[0], frame[1])
+
+
+def reset_causes(report: BootInfoReport) -> List[str]:
+    """NRST pin flag is set by any reset, so it is listed only when alone."""
+    causes = [name for bit, name in enumerate(RESET_CAUSES) if report.reset_cause & (1 << bit)]
+    return [c for c in causes if c != 'pin'] or causes
+
+
+def crash_trail(report: CrashReport) -> List[str]:
+    """Events before the crash, oldest first, as ‹event:value›."""
+    return [f'{CRASH_TRAIL_EVENTS[e >> 8] if e >> 8 < len(CRASH_TRAIL_EVENTS) else e >> 8}:0x{e & 0xFF:02X}'
+            for e in report.trail if e]
+
+
+###############################################################################
+# Serial state (CDC SERIAL_STATE notification seen as modem status lines)
+
+class SerialState(NamedTuple):
+    dcc_connected: bool  # DCD
+    ok: bool  # DSR: mode is not mFailure
+    timeout_warning: bool  # RI: DCC is cut soon unless heartbeat (lease) is renewed
+
+
+def read_serial_state(port: Any) -> SerialState:
+    """
+    Reads modem status lines of pyserial port, data stream is not touched.
+    Raises OSError or SerialException when the port has no lines (e.g. pty).
+    """
+    return SerialState(port.cd, port.dsr, port.ri)
+
+
+###############################################################################
+# Scope
+
+def scope_bits(report: ScopeReport) -> int:
+    """Returns bits per sample."""
+    return 4 if report.flags & SCOPE_RELAYS else 2
+
+
+def scope_unpack(report: ScopeReport) -> List[int]:
+    """Returns samples: bit 0 = DCC1, 1 = DCC2, 2 = relay1, 3 = relay2."""
+    bits = scope_bits(report)
+    mask = (1 << bits) - 1
+    return [(byte >> shift) & mask for byte in report.samples for shift in range(0, 8, bits)]
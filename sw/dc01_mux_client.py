@@ -0,0 +1,63 @@
+#!/usr/bin/env python3
+
+"""
+DC-01 multiplexer client: prints messages of hjop_watchdog.py --mux socket
+
+Messages (JSON lines, see mux.py) are printed to stdout as they come, so
+the output could be piped to a logger or filtered (e.g. jq). With
+<command>, the command is sent and the client exits after its reply
+(exit code 1 when refused), unless --follow is given.
+
+Usage:
+  dc01_mux_client.py [options] [<command>]
+  dc01_mux_client.py --help
+
+Options:
+  -s <socket>        Multiplexer socket [default: /run/dc01/mux.sock]
+  -i <input>         DCC input of dcc_wave command (0 = DCC1, 1 = DCC2) [default: 0]
+  -r --reset         Reset statistics once reported (hb_stats command)
+  -f --follow        Keep printing messages after reply to <command>
+  -h --help          Show this screen
+
+Commands: dcc_stats, dcc_wave, boot_info, crash, hb_stats, cut, release
+"""
+
+import json
+import socket
+import sys
+from docopt import docopt
+
+COMMAND_ID = 1
+
+
+def main() -> None:
+    args = docopt(__doc__)
+    command = args['<command>']
+    sock = socket.socket(socket.AF_UNIX, socket.SOCK_STREAM)
+    try:
+        sock.connect(args['-s'])
+    except OSError as e:
+        sys.exit(f'Unable to connect to {args["-s"]}: {e}')
+
+    if command:
+        request = {'cmd': command, 'id': COMMAND_ID}
+        if command == 'dcc_wave':
+            request['input'] = int(args['-i'])
+        if command == 'hb_stats':
+            request['reset'] = args['--reset']
+        sock.sendall(json.dumps(request).encode('utf-8') + b'\n')
+
+    try:
+        for line in sock.makefile('r', encoding='utf-8'):
+            print(line, end='', flush=True)
+            message = json.loads(line)
+            if command and not args['--follow'] and message.get('type') == 'reply' \
+                    and message.get('id') == COMMAND_ID:
+                sys.exit(0 if message['ok'] else 1)
+    except KeyboardInterrupt:
+        return
+    sys.exit('Disconnected by watchdog' if not command or args['--follow'] else 'No reply')
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,125 @@
+"""
+Python bindings of native libdc01 (see libdc01/README.md).
+
+NativeFrameDecoder is a drop-in replacement of dc01_link.FrameDecoder,
+native_encode_frame of dc01_link.encode_frame.
+Library is loaded from path in DC01_LIB environment variable or from
+libdc01/build/libdc01.so next to this file.
+"""
+
+import ctypes
+import os
+import struct
+from typing import Iterator
+from dc01_link import Frame, _new_frame
+
+DC01_LIB_DEFAULT = os.path.join(os.path.dirname(os.path.abspath(__file__)), 'libdc01', 'build', 'libdc01.so')
+MAX_FRAMES = 64  # per one native call
+MAX_PACKET_SIZE = 3 + 0xFF  # dc01::MAX_PACKET_SIZE: magic, length, command & data
+
+
+class _CFrame(ctypes.Structure):
+    _fields_ = [
+        ('command_code', ctypes.c_uint8),
+        ('size', ctypes.c_uint8),
+        ('offset', ctypes.c_uint16),
+    ]
+
+
+_FRAME_SIZE = ctypes.sizeof(_CFrame)
+_iter_frames = struct.Struct('=BBH').iter_unpack  # faster than access to _CFrame fields
+
+
+def _load(path: str) -> ctypes.CDLL:
+    lib = ctypes.CDLL(path)
+    lib.dc01_decoder_new.restype = ctypes.c_void_p
+    lib.dc01_decoder_new.argtypes = []
+    lib.dc01_decoder_free.argtypes = [ctypes.c_void_p]
+    lib.dc01_decoder_reset.argtypes = [ctypes.c_void_p]
+    lib.dc01_decoder_pending.restype = ctypes.c_size_t
+    lib.dc01_decoder_pending.argtypes = [ctypes.c_void_p]
+    lib.dc01_decoder_buffer.restype = ctypes.POINTER(ctypes.c_uint8)
+    lib.dc01_decoder_buffer.argtypes = [ctypes.c_void_p, ctypes.POINTER(ctypes.c_size_t)]
+    lib.dc01_decoder_feed.restype = ctypes.c_size_t
+    lib.dc01_decoder_feed.argtypes = [
+        ctypes.c_void_p, ctypes.c_char_p, ctypes.c_size_t,
+        ctypes.POINTER(_CFrame), ctypes.c_size_t, ctypes.POINTER(ctypes.c_size_t),
+    ]
+    lib.dc01_decoder_stats.argtypes = [ctypes.c_void_p] + [ctypes.POINTER(ctypes.c_uint64)]*3
+    lib.dc01_encode.restype = ctypes.c_size_t
+    lib.dc01_encode.argtypes = [ctypes.c_uint8, ctypes.c_char_p, ctypes.c_size_t, ctypes.c_char_p, ctypes.c_size_t]
+    return lib
+
+
+_lib = _load(os.environ.get('DC01_LIB', DC01_LIB_DEFAULT))
+_encode_buf = ctypes.create_string_buffer(MAX_PACKET_SIZE)
+
+
+def native_encode_frame(command_code: int, data: bytes = b'') -> bytes:
+    data = bytes(data)
+    size = _lib.dc01_encode(command_code, data, len(data), _encode_buf, MAX_PACKET_SIZE)
+    if size == 0:
+        raise ValueError(f'Frame data too long: {len(data)} B')
+    return _encode_buf.raw[:size]
+
+
+class NativeFrameDecoder:
+    def __init__(self):
+        self._dec = _lib.dc01_decoder_new()
+        if not self._dec:
+            raise MemoryError('dc01_decoder_new')
+        size = ctypes.c_size_t()
+        buf = _lib.dc01_decoder_buffer(self._dec, ctypes.byref(size))
+        # Decoder's buffer never moves → wrap it once, frames are its slices
+        self._view = memoryview((ctypes.c_uint8 * size.value).from_address(ctypes.addressof(buf.contents))).cast('B')
+        self._frames = (_CFrame * MAX_FRAMES)()
+        self._frames_view = memoryview(self._frames).cast('B')
+        self._consumed = ctypes.c_size_t()
+
+    def __del__(self):
+        if getattr(self, '_dec', None):
+            _lib.dc01_decoder_free(self._dec)
+            self._dec = None
+
+    def pending(self) -> int:
+        """Returns number of bytes of unfinished packet."""
+        return _lib.dc01_decoder_pending(self._dec)
+
+    def reset(self) -> None:
+        """Drops unfinished packet."""
+        _lib.dc01_decoder_reset(self._dec)
+
+    def feed(self, data: bytes) -> Iterator[Frame]:
+        """
+        Generator: must be iterated to the end, otherwise not all ‹data› are
+        processed. Frame data are valid only until next frame is requested.
+        """
+        data = bytes(data)
+        feed, dec, frames, frames_view, view = (
+            _lib.dc01_decoder_feed, self._dec, self._frames, self._frames_view, self._view)
+        consumed = self._consumed
+        consumed_ref = ctypes.byref(consumed)
+        while True:
+            count = feed(dec, data, len(data), frames, MAX_FRAMES, consumed_ref)
+            if count == 0:
+                return
+            data = data[consumed.value:]
+            for command_code, size, offset in _iter_frames(frames_view[:count*_FRAME_SIZE]):
+                yield _new_frame((command_code, view[offset:offset+size]))
+
+    def _stats(self) -> tuple:
+        values = [ctypes.c_uint64() for _ in range(3)]
+        _lib.dc01_decoder_stats(self._dec, *[ctypes.byref(value) for value in values])
+        return tuple(value.value for value in values)
+
+    @property
+    def frames(self) -> int:
+        return self._stats()[0]
+
+    @property
+    def resyncs(self) -> int:
+        return self._stats()[1]
+
+    @property
+    def garbage_bytes(self) -> int:
+        return self._stats()[2]
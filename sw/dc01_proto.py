@@ -0,0 +1,489 @@
+# Generated by dc01_protogen.py from fw/doc/protocol.json, do not edit.
+
+"""
+DC-01 ↔ PC protocol messages & codecs (see fw/doc/protocol.md).
+
+Decoders unpack packet data in place (struct.unpack_from on memoryview
+of decoder buffer, no copies) and are looked up in tables by command
+code. Packets could be longer than in schema (newer firmware appends
+fields), only the minimal size is checked.
+"""
+
+import struct
+from typing import Any, Callable, Dict, NamedTuple, Optional, Tuple, Union
+
+MAGIC = b'\x37\xE2'
+MAX_DATA_SIZE = 122
+
+DC_CMD_PM_INFO_REQ = 0x10
+DC_CMD_PM_SET_STATE = 0x11
+DC_CMD_PM_PING = 0x02
+DC_CMD_PM_LEASE = 0x20
+DC_CMD_PM_SCOPE = 0x21
+DC_CMD_PM_DCC_STATS = 0x22
+DC_CMD_PM_DCC_WAVE = 0x23
+DC_CMD_PM_BOOT_INFO = 0x24
+DC_CMD_PM_CRASH = 0x25
+DC_CMD_PM_HB_STATS = 0x26
+
+DC_CMD_MP_INFO = 0x10
+DC_CMD_MP_STATE = 0x11
+DC_CMD_MP_BRSTATE = 0x12
+DC_CMD_MP_LEASE = 0x20
+DC_CMD_MP_SCOPE = 0x21
+DC_CMD_MP_DCC_STATS = 0x22
+DC_CMD_MP_DCC_WAVE = 0x23
+DC_CMD_MP_BOOT_INFO = 0x24
+DC_CMD_MP_CRASH = 0x25
+DC_CMD_MP_HB_STATS = 0x26
+
+Buffer = Union[bytes, bytearray, memoryview]
+_new = tuple.__new__  # avoids slow Python-level __new__
+
+
+class InfoRequest(NamedTuple):
+    pass
+
+
+class SetStateRequest(NamedTuple):
+    on: bool
+
+
+class PingRequest(NamedTuple):
+    pass
+
+
+class LeaseRequest(NamedTuple):
+    duration_ms: int  # 0 = revoke
+    seq: int
+
+
+class ScopeRequest(NamedTuple):
+    run: bool
+    relays: bool
+
+
+class DccStatsRequest(NamedTuple):
+    pass
+
+
+class DccWaveRequest(NamedTuple):
+    input: int  # 0 = DCC1, 1 = DCC2
+
+
+class BootInfoRequest(NamedTuple):
+    pass
+
+
+class CrashRequest(NamedTuple):
+    pass
+
+
+class HbStatsRequest(NamedTuple):
+    reset: bool  # reset statistics once reported
+
+
+class InfoReport(NamedTuple):
+    fw_major: int
+    fw_minor: int
+
+
+class StateReport(NamedTuple):
+    mode: int  # see operation.md
+    dcc_connected: bool
+    dcc_at_least_one: bool
+    failure_code: int
+    warnings: int
+
+
+class BrtReport(NamedTuple):
+    state: int
+    step: int
+    error: int
+
+
+class LeaseReport(NamedTuple):
+    granted_ms: int  # 0 = revoked
+    seq: int
+
+
+class ScopeReport(NamedTuple):
+    seq: int
+    flags: int
+    dropped: int  # packets dropped by DC-01 just before this one
+    samples: bytes  # packed, 2 or 4 bits per sample
+
+
+class DccInputStats(NamedTuple):
+    rate: int  # valid packets in last second
+    packets: int  # counters wrap around (32 bits)
+    bit_errors: int
+    checksum_errors: int
+
+
+class DccStatsReport(NamedTuple):
+    present: Tuple[bool, ...]  # DCC1, DCC2
+    require_packets: bool
+    inputs: Tuple[DccInputStats, ...]
+
+
+class DccWaveReport(NamedTuple):
+    input: int  # 0 = DCC1, 1 = DCC2
+    present: bool  # edges are coming
+    frequency: int  # falling edges in last second [Hz]
+    low_permille: int
+    cutout_us: int  # last RailCom cutout
+    cutouts: int  # counters wrap around (32 bits)
+    losses: int
+    lost_ms: int
+    loss_ms: int  # current or last loss
+    edge_overruns: int
+    half_periods: Tuple[int, ...]  # histogram of half-periods, bins in protocol.md
+
+
+class BootInfoReport(NamedTuple):
+    reset_cause: int  # flags, see protocol.md
+    brt_honoured: bool  # cached Big Relay Test pass honoured at boot
+    rtc_started: bool  # backup domain was lost
+    resets: int  # since power-on
+    ready_ms: int
+    dcc_on_ms: int  # 0 = DCC not yet on
+    brt_age_s: int  # 0xFFFFFFFF = no pass cached
+
+
+class CrashReport(NamedTuple):
+    cause: int  # 0 = no crash before the last reset
+    dcmode: int
+    brt_state: int
+    brt_step: int
+    uptime_ms: int
+    frame: Tuple[int, ...]  # stacked r0, r1, r2, r3, r12, lr, pc, xPSR
+    cfsr: int
+    hfsr: int
+    mmfar: int
+    bfar: int
+    trail: Tuple[int, ...]  # event << 8 | value, oldest first, 0 = empty
+
+
+class HbStatsReport(NamedTuple):
+    heartbeats: int
+    worst_gap_ms: int
+    min_margin_ms: int  # 0 = timed out, 0xFFFF = no gap yet
+    warnings: int  # timeout warnings raised
+    timeouts: int
+    period_ms: int  # since reset of statistics
+    gaps: Tuple[int, ...]  # histogram of heartbeat gaps, bins in protocol.md
+
+
+_INFO_REQUEST_INSTANCE = InfoRequest()
+_SET_STATE_REQUEST = struct.Struct('>B')
+_PING_REQUEST_INSTANCE = PingRequest()
+_LEASE_REQUEST = struct.Struct('>HB')
+_SCOPE_REQUEST = struct.Struct('>B')
+_DCC_STATS_REQUEST_INSTANCE = DccStatsRequest()
+_DCC_WAVE_REQUEST = struct.Struct('>B')
+_BOOT_INFO_REQUEST_INSTANCE = BootInfoRequest()
+_CRASH_REQUEST_INSTANCE = CrashRequest()
+_HB_STATS_REQUEST = struct.Struct('>B')
+_INFO_REPORT = struct.Struct('>BB')
+_STATE_REPORT = struct.Struct('>BBB')
+_BRT_REPORT = struct.Struct('>BBB')
+_LEASE_REPORT = struct.Struct('>HB')
+_SCOPE_REPORT = struct.Struct('>HBB56s')
+_DCC_STATS_REPORT = struct.Struct('>BHIIIHIII')
+_DCC_WAVE_REPORT = struct.Struct('>BBHHHIIIII8I')
+_BOOT_INFO_REPORT = struct.Struct('>BBHHII')
+_CRASH_REPORT = struct.Struct('>BBBBI8IIIII16H')
+_HB_STATS_REPORT = struct.Struct('>IIHIII12I')
+
+
+def decode_info_request(data: Buffer) -> InfoRequest:
+    return _INFO_REQUEST_INSTANCE
+
+
+def encode_info_request(msg: InfoRequest) -> bytes:
+    return b''
+
+
+def decode_set_state_request(data: Buffer) -> SetStateRequest:
+    v = _SET_STATE_REQUEST.unpack_from(data)
+    return _new(SetStateRequest, (bool(v[0] & 0x01),))
+
+
+def encode_set_state_request(msg: SetStateRequest) -> bytes:
+    return _SET_STATE_REQUEST.pack(msg.on)
+
+
+def decode_ping_request(data: Buffer) -> PingRequest:
+    return _PING_REQUEST_INSTANCE
+
+
+def encode_ping_request(msg: PingRequest) -> bytes:
+    return b''
+
+
+def decode_lease_request(data: Buffer) -> LeaseRequest:
+    return _new(LeaseRequest, _LEASE_REQUEST.unpack_from(data))
+
+
+def encode_lease_request(msg: LeaseRequest) -> bytes:
+    return _LEASE_REQUEST.pack(msg.duration_ms, msg.seq)
+
+
+def decode_scope_request(data: Buffer) -> ScopeRequest:
+    v = _SCOPE_REQUEST.unpack_from(data)
+    return _new(ScopeRequest, (bool(v[0] & 0x01), bool(v[0] & 0x02)))
+
+
+def encode_scope_request(msg: ScopeRequest) -> bytes:
+    return _SCOPE_REQUEST.pack(msg.run | msg.relays << 1)
+
+
+def decode_dcc_stats_request(data: Buffer) -> DccStatsRequest:
+    return _DCC_STATS_REQUEST_INSTANCE
+
+
+def encode_dcc_stats_request(msg: DccStatsRequest) -> bytes:
+    return b''
+
+
+def decode_dcc_wave_request(data: Buffer) -> DccWaveRequest:
+    return _new(DccWaveRequest, _DCC_WAVE_REQUEST.unpack_from(data))
+
+
+def encode_dcc_wave_request(msg: DccWaveRequest) -> bytes:
+    return _DCC_WAVE_REQUEST.pack(msg.input)
+
+
+def decode_boot_info_request(data: Buffer) -> BootInfoRequest:
+    return _BOOT_INFO_REQUEST_INSTANCE
+
+
+def encode_boot_info_request(msg: BootInfoRequest) -> bytes:
+    return b''
+
+
+def decode_crash_request(data: Buffer) -> CrashRequest:
+    return _CRASH_REQUEST_INSTANCE
+
+
+def encode_crash_request(msg: CrashRequest) -> bytes:
+    return b''
+
+
+def decode_hb_stats_request(data: Buffer) -> HbStatsRequest:
+    v = _HB_STATS_REQUEST.unpack_from(data)
+    return _new(HbStatsRequest, (bool(v[0] & 0x01),))
+
+
+def encode_hb_stats_request(msg: HbStatsRequest) -> bytes:
+    return _HB_STATS_REQUEST.pack(msg.reset)
+
+
+def decode_info_report(data: Buffer) -> InfoReport:
+    return _new(InfoReport, _INFO_REPORT.unpack_from(data))
+
+
+def encode_info_report(msg: InfoReport) -> bytes:
+    return _INFO_REPORT.pack(msg.fw_major, msg.fw_minor)
+
+
+def decode_state_report(data: Buffer) -> StateReport:
+    v = _STATE_REPORT.unpack_from(data)
+    return _new(StateReport, (v[0] >> 4 & 0x07, bool(v[0] & 0x01), bool(v[0] & 0x02), v[1], v[2]))
+
+
+def encode_state_report(msg: StateReport) -> bytes:
+    return _STATE_REPORT.pack(
+        (msg.mode & 0x07) << 4 | msg.dcc_connected | msg.dcc_at_least_one << 1,
+        msg.failure_code,
+        msg.warnings,
+    )
+
+
+def decode_brt_report(data: Buffer) -> BrtReport:
+    return _new(BrtReport, _BRT_REPORT.unpack_from(data))
+
+
+def encode_brt_report(msg: BrtReport) -> bytes:
+    return _BRT_REPORT.pack(msg.state, msg.step, msg.error)
+
+
+def decode_lease_report(data: Buffer) -> LeaseReport:
+    return _new(LeaseReport, _LEASE_REPORT.unpack_from(data))
+
+
+def encode_lease_report(msg: LeaseReport) -> bytes:
+    return _LEASE_REPORT.pack(msg.granted_ms, msg.seq)
+
+
+def decode_scope_report(data: Buffer) -> ScopeReport:
+    return _new(ScopeReport, _SCOPE_REPORT.unpack_from(data))
+
+
+def encode_scope_report(msg: ScopeReport) -> bytes:
+    return _SCOPE_REPORT.pack(msg.seq, msg.flags, msg.dropped, msg.samples)
+
+
+def decode_dcc_stats_report(data: Buffer) -> DccStatsReport:
+    v = _DCC_STATS_REPORT.unpack_from(data)
+    return _new(DccStatsReport, (
+        (bool(v[0] & 0x01), bool(v[0] & 0x02)),
+        bool(v[0] & 0x80),
+        (_new(DccInputStats, v[1:5]), _new(DccInputStats, v[5:9])),
+    ))
+
+
+def encode_dcc_stats_report(msg: DccStatsReport) -> bytes:
+    return _DCC_STATS_REPORT.pack(
+        msg.present[0] | msg.present[1] << 1 | msg.require_packets << 7,
+        *msg.inputs[0],
+        *msg.inputs[1],
+    )
+
+
+def decode_dcc_wave_report(data: Buffer) -> DccWaveReport:
+    v = _DCC_WAVE_REPORT.unpack_from(data)
+    return _new(DccWaveReport, (v[0], bool(v[1] & 0x01), v[2], v[3], v[4], v[5], v[6], v[7], v[8], v[9], v[10:18]))
+
+
+def encode_dcc_wave_report(msg: DccWaveReport) -> bytes:
+    return _DCC_WAVE_REPORT.pack(
+        msg.input,
+        msg.present,
+        msg.frequency,
+        msg.low_permille,
+        msg.cutout_us,
+        msg.cutouts,
+        msg.losses,
+        msg.lost_ms,
+        msg.loss_ms,
+        msg.edge_overruns,
+        *msg.half_periods,
+    )
+
+
+def decode_boot_info_report(data: Buffer) -> BootInfoReport:
+    v = _BOOT_INFO_REPORT.unpack_from(data)
+    return _new(BootInfoReport, (v[0], bool(v[1] & 0x01), bool(v[1] & 0x02), v[2], v[3], v[4], v[5]))
+
+
+def encode_boot_info_report(msg: BootInfoReport) -> bytes:
+    return _BOOT_INFO_REPORT.pack(
+        msg.reset_cause,
+        msg.brt_honoured | msg.rtc_started << 1,
+        msg.resets,
+        msg.ready_ms,
+        msg.dcc_on_ms,
+        msg.brt_age_s,
+    )
+
+
+def decode_crash_report(data: Buffer) -> CrashReport:
+    v = _CRASH_REPORT.unpack_from(data)
+    return _new(CrashReport, (v[0], v[1], v[2], v[3], v[4], v[5:13], v[13], v[14], v[15], v[16], v[17:33]))
+
+
+def encode_crash_report(msg: CrashReport) -> bytes:
+    return _CRASH_REPORT.pack(
+        msg.cause,
+        msg.dcmode,
+        msg.brt_state,
+        msg.brt_step,
+        msg.uptime_ms,
+        *msg.frame,
+        msg.cfsr,
+        msg.hfsr,
+        msg.mmfar,
+        msg.bfar,
+        *msg.trail,
+    )
+
+
+def decode_hb_stats_report(data: Buffer) -> HbStatsReport:
+    v = _HB_STATS_REPORT.unpack_from(data)
+    return _new(HbStatsReport, (v[0], v[1], v[2], v[3], v[4], v[5], v[6:18]))
+
+
+def encode_hb_stats_report(msg: HbStatsReport) -> bytes:
+    return _HB_STATS_REPORT.pack(
+        msg.heartbeats,
+        msg.worst_gap_ms,
+        msg.min_margin_ms,
+        msg.warnings,
+        msg.timeouts,
+        msg.period_ms,
+        *msg.gaps,
+    )
+
+
+REQUEST_DECODERS: Dict[int, Tuple[int, Callable[[Buffer], Any]]] = {
+    DC_CMD_PM_INFO_REQ: (0, decode_info_request),
+    DC_CMD_PM_SET_STATE: (1, decode_set_state_request),
+    DC_CMD_PM_PING: (0, decode_ping_request),
+    DC_CMD_PM_LEASE: (3, decode_lease_request),
+    DC_CMD_PM_SCOPE: (1, decode_scope_request),
+    DC_CMD_PM_DCC_STATS: (0, decode_dcc_stats_request),
+    DC_CMD_PM_DCC_WAVE: (1, decode_dcc_wave_request),
+    DC_CMD_PM_BOOT_INFO: (0, decode_boot_info_request),
+    DC_CMD_PM_CRASH: (0, decode_crash_request),
+    DC_CMD_PM_HB_STATS: (1, decode_hb_stats_request),
+}
+
+REPORT_DECODERS: Dict[int, Tuple[int, Callable[[Buffer], Any]]] = {
+    DC_CMD_MP_INFO: (2, decode_info_report),
+    DC_CMD_MP_STATE: (3, decode_state_report),
+    DC_CMD_MP_BRSTATE: (3, decode_brt_report),
+    DC_CMD_MP_LEASE: (3, decode_lease_report),
+    DC_CMD_MP_SCOPE: (60, decode_scope_report),
+    DC_CMD_MP_DCC_STATS: (29, decode_dcc_stats_report),
+    DC_CMD_MP_DCC_WAVE: (60, decode_dcc_wave_report),
+    DC_CMD_MP_BOOT_INFO: (14, decode_boot_info_report),
+    DC_CMD_MP_CRASH: (88, decode_crash_report),
+    DC_CMD_MP_HB_STATS: (70, decode_hb_stats_report),
+}
+
+ENCODERS: Dict[type, Tuple[int, Callable[[Any], bytes]]] = {
+    InfoRequest: (DC_CMD_PM_INFO_REQ, encode_info_request),
+    SetStateRequest: (DC_CMD_PM_SET_STATE, encode_set_state_request),
+    PingRequest: (DC_CMD_PM_PING, encode_ping_request),
+    LeaseRequest: (DC_CMD_PM_LEASE, encode_lease_request),
+    ScopeRequest: (DC_CMD_PM_SCOPE, encode_scope_request),
+    DccStatsRequest: (DC_CMD_PM_DCC_STATS, encode_dcc_stats_request),
+    DccWaveRequest: (DC_CMD_PM_DCC_WAVE, encode_dcc_wave_request),
+    BootInfoRequest: (DC_CMD_PM_BOOT_INFO, encode_boot_info_request),
+    CrashRequest: (DC_CMD_PM_CRASH, encode_crash_request),
+    HbStatsRequest: (DC_CMD_PM_HB_STATS, encode_hb_stats_request),
+    InfoReport: (DC_CMD_MP_INFO, encode_info_report),
+    StateReport: (DC_CMD_MP_STATE, encode_state_report),
+    BrtReport: (DC_CMD_MP_BRSTATE, encode_brt_report),
+    LeaseReport: (DC_CMD_MP_LEASE, encode_lease_report),
+    ScopeReport: (DC_CMD_MP_SCOPE, encode_scope_report),
+    DccStatsReport: (DC_CMD_MP_DCC_STATS, encode_dcc_stats_report),
+    DccWaveReport: (DC_CMD_MP_DCC_WAVE, encode_dcc_wave_report),
+    BootInfoReport: (DC_CMD_MP_BOOT_INFO, encode_boot_info_report),
+    CrashReport: (DC_CMD_MP_CRASH, encode_crash_report),
+    HbStatsReport: (DC_CMD_MP_HB_STATS, encode_hb_stats_report),
+}
+
+
+def decode_request(code: int, data: Buffer) -> Optional[Any]:
+    """Decodes PC → DC-01 packet, returns None for unknown or too short packets."""
+    entry = REQUEST_DECODERS.get(code)
+    if entry is None or len(data) < entry[0]:
+        return None
+    return entry[1](data)
+
+
+def decode_report(code: int, data: Buffer) -> Optional[Any]:
+    """Decodes DC-01 → PC packet, returns None for unknown or too short packets."""
+    entry = REPORT_DECODERS.get(code)
+    if entry is None or len(data) < entry[0]:
+        return None
+    return entry[1](data)
+
+
+def encode(msg: Any) -> Tuple[int, bytes]:
+    """Returns (command code, data) of message."""
+    code, encoder = ENCODERS[type(msg)]
+    return code, encoder(msg)
@@ -0,0 +1,712 @@
+#!/usr/bin/env python3
+
+"""
+DC-01 protocol code generator
+
+Generates from the protocol schema (fw/doc/protocol.json):
+  fw/inc/dc01_proto.h   command codes, message structs, packed encoders &
+                        decoders for firmware (header only, no allocation)
+  fw/test/test_proto.c  host test of the C codecs: values decoded from a test
+                        pattern are checked against the schema layout, then
+                        encoded back to the same bytes
+  sw/dc01_proto.py      message classes, encoders & table-driven decoders
+                        for PC tools
+and the packet overview in fw/doc/protocol.md. Each packet section of
+protocol.md (found by its anchor) is checked to state the command code &
+number of data bytes of the schema.
+
+Schema: packets ‹to_device› (PC → DC-01, DC_CMD_PM_*) & ‹from_device›
+(DC-01 → PC, DC_CMD_MP_*), each with ‹code›, ‹name›, ‹class› & ‹fields›.
+Field is one of:
+  {"name", "type": "u8"|"u16"|"u32"}          value (MSB first)
+  {"name", "type", "count"}                   array of values
+  {"name", "type": "bytes", "size"}           raw bytes
+  {"name", "class", "count", "fields"}        array of groups of values
+  {"type": "u8", "bits": [{"name", "bit", "width", "count"}]}
+                                              bits of a byte, width 1 = bool,
+                                              count = consecutive bits
+Optional ‹doc› of field or bits is emitted as comment.
+Packets could be longer than in schema (newer firmware appends fields),
+decoders check the minimal size only.
+
+Usage:
+  dc01_protogen.py [options]
+  dc01_protogen.py --help
+
+Options:
+  --check            Write nothing, fail when generated files are out of date
+  -h --help          Show this screen
+"""
+
+import json
+import os
+import re
+import sys
+from typing import Any, Dict, List, NamedTuple, Optional, Tuple
+from docopt import docopt
+
+ROOT = os.path.join(os.path.dirname(os.path.abspath(__file__)), '..')
+SCHEMA = os.path.join(ROOT, 'fw', 'doc', 'protocol.json')
+C_HEADER = os.path.join(ROOT, 'fw', 'inc', 'dc01_proto.h')
+C_TEST = os.path.join(ROOT, 'fw', 'test', 'test_proto.c')
+PY_MODULE = os.path.join(ROOT, 'sw', 'dc01_proto.py')
+DOC = os.path.join(ROOT, 'fw', 'doc', 'protocol.md')
+
+TYPES = {  # size, struct format, C type
+    'u8': (1, 'B', 'uint8_t'),
+    'u16': (2, 'H', 'uint16_t'),
+    'u32': (4, 'I', 'uint32_t'),
+}
+DOC_BEGIN = '<!-- Packet overview generated by sw/dc01_protogen.py from protocol.json, do not edit. -->'
+DOC_END = '<!-- End of generated packet overview. -->'
+
+
+###############################################################################
+# Schema
+
+class Bits(NamedTuple):
+    name: str
+    bit: int
+    width: int
+    count: int  # > 1 = tuple of consecutive bits
+    doc: Optional[str]
+
+    @property
+    def mask(self) -> int:
+        return (1 << self.width) - 1
+
+
+class Field(NamedTuple):
+    name: Optional[str]  # None for byte of bits
+    type: str  # u8, u16, u32, bytes, group
+    count: Optional[int]  # None = scalar
+    size: int  # of single item
+    bits: Tuple[Bits, ...]
+    cls: Optional[str]  # group
+    fields: Tuple['Field', ...]  # group
+    doc: Optional[str]
+
+    @property
+    def wire_size(self) -> int:
+        return self.size * (self.count or 1)
+
+
+class Message(NamedTuple):
+    direction: str  # PM (PC → DC-01) or MP
+    code: int
+    name: str
+    cls: str
+    anchor: Optional[str]
+    since: Optional[str]
+    fields: Tuple[Field, ...]
+
+    @property
+    def size(self) -> int:
+        return sum(f.wire_size for f in self.fields)
+
+    @property
+    def define(self) -> str:
+        return f'DC_CMD_{self.direction}_{self.name}'
+
+    @property
+    def snake(self) -> str:
+        return snake(self.cls)
+
+
+def snake(name: str) -> str:
+    return re.sub(r'(?<!^)(?=[A-Z])', '_', name).lower()
+
+
+def parse_field(spec: Dict[str, Any], where: str) -> Field:
+    name = spec.get('name')
+    if 'bits' in spec:
+        if spec.get('type') != 'u8':
+            raise ValueError(f'{where}: bits are supported in u8 only')
+        bits = tuple(Bits(b['name'], b['bit'], b.get('width', 1), b.get('count', 1), b.get('doc'))
+                     for b in spec['bits'])
+        for b in bits:
+            if b.bit + b.width*b.count > 8:
+                raise ValueError(f'{where}.{b.name}: out of byte')
+        return Field(None, 'u8', None, 1, bits, None, (), None)
+    if name is None:
+        raise ValueError(f'{where}: field without name')
+    if 'fields' in spec:
+        fields = tuple(parse_field(f, f'{where}.{name}') for f in spec['fields'])
+        if any(f.type not in TYPES or f.count or f.bits for f in fields):
+            raise ValueError(f'{where}.{name}: groups support plain values only')
+        return Field(name, 'group', spec['count'], sum(f.size for f in fields), (), spec['class'], fields,
+                     spec.get('doc'))
+    if spec['type'] == 'bytes':
+        return Field(name, 'bytes', None, spec['size'], (), None, (), spec.get('doc'))
+    return Field(name, spec['type'], spec.get('count'), TYPES[spec['type']][0], (), None, (), spec.get('doc'))
+
+
+def load_schema(path: str) -> Tuple[Dict[str, Any], List[Message]]:
+    with open(path, encoding='utf-8') as f:
+        schema = json.load(f)
+    messages = []
+    for direction, key in (('PM', 'to_device'), ('MP', 'from_device')):
+        for spec in schema[key]:
+            where = f'{key}.{spec["name"]}'
+            fields = tuple(parse_field(f, where) for f in spec['fields'])
+            msg = Message(direction, int(spec['code'], 16), spec['name'], spec['class'], spec.get('anchor'),
+                          spec.get('since'), fields)
+            if msg.size > schema['max_data_size']:
+                raise ValueError(f'{where}: {msg.size} data bytes do not fit packet')
+            messages.append(msg)
+    return schema, messages
+
+
+###############################################################################
+# C
+
+def c_comment(doc: Optional[str]) -> str:
+    return f' // {doc}' if doc else ''
+
+
+def c_field_decl(field: Field) -> List[str]:
+    """Returns member declarations (with semicolon) of ‹field›."""
+    if field.bits:
+        return [f'{"bool" if b.width == 1 else "uint8_t"} {b.name}' + (f'[{b.count}]' if b.count > 1 else '') +
+                ';' + c_comment(b.doc) for b in field.bits]
+    if field.type == 'bytes':
+        return [f'uint8_t {field.name}[{field.size}];' + c_comment(field.doc)]
+    ctype = f'Dc01{field.cls}' if field.type == 'group' else TYPES[field.type][2]
+    return [f'{ctype} {field.name}' + (f'[{field.count}]' if field.count else '') + ';' + c_comment(field.doc)]
+
+
+def c_put(ftype: str, dst: str, value: str) -> str:
+    if ftype == 'u8':
+        return f'{dst} = {value};'
+    return f'dc01_put_{ftype}(&{dst}, {value});'
+
+
+def c_get(ftype: str, src: str) -> str:
+    return src if ftype == 'u8' else f'dc01_get_{ftype}(&{src})'
+
+
+def c_bits_encode(field: Field) -> str:
+    parts = []
+    for b in field.bits:
+        for i in range(b.count):
+            value = f'msg->{b.name}' + (f'[{i}]' if b.count > 1 else '')
+            shift = b.bit + i*b.width
+            if b.width == 1:
+                parts.append(f'({value} ? 0x{1 << shift:02X} : 0)')
+            else:
+                parts.append(f'(({value} & 0x{b.mask:02X}) << {shift})')
+    return ' | '.join(parts)
+
+
+def c_bits_decode(field: Field, src: str) -> List[str]:
+    lines = []
+    for b in field.bits:
+        for i in range(b.count):
+            target = f'msg->{b.name}' + (f'[{i}]' if b.count > 1 else '')
+            shift = b.bit + i*b.width
+            if b.width == 1:
+                lines.append(f'{target} = ({src} & 0x{1 << shift:02X}) != 0;')
+            else:
+                lines.append(f'{target} = ({src} >> {shift}) & 0x{b.mask:02X};')
+    return lines
+
+
+def c_codec(msg: Message) -> List[str]:
+    enc, dec = [], []
+    offset = 0
+    for field in msg.fields:
+        if field.bits:
+            enc.append(f'buf[{offset}] = {c_bits_encode(field)};')
+            dec += c_bits_decode(field, f'data[{offset}]')
+        elif field.type == 'bytes':
+            enc += [f'for (size_t i = 0; i < {field.size}; i++)', f'\tbuf[{offset}+i] = msg->{field.name}[i];']
+            dec += [f'for (size_t i = 0; i < {field.size}; i++)', f'\tmsg->{field.name}[i] = data[{offset}+i];']
+        elif field.type == 'group':
+            enc.append(f'for (size_t i = 0; i < {field.count}; i++) {{')
+            dec.append(f'for (size_t i = 0; i < {field.count}; i++) {{')
+            inner = 0
+            for sub in field.fields:
+                at = f'{offset}+{field.size}*i+{inner}'
+                enc.append('\t' + c_put(sub.type, f'buf[{at}]', f'msg->{field.name}[i].{sub.name}'))
+                dec.append(f'\tmsg->{field.name}[i].{sub.name} = {c_get(sub.type, f"data[{at}]")};')
+                inner += sub.size
+            enc.append('}')
+            dec.append('}')
+        elif field.count:
+            at = f'{offset}+{field.size}*i'
+            enc += [f'for (size_t i = 0; i < {field.count}; i++)',
+                    '\t' + c_put(field.type, f'buf[{at}]', f'msg->{field.name}[i]')]
+            dec += [f'for (size_t i = 0; i < {field.count}; i++)',
+                    f'\tmsg->{field.name}[i] = {c_get(field.type, f"data[{at}]")};']
+        else:
+            enc.append(c_put(field.type, f'buf[{offset}]', f'msg->{field.name}'))
+            dec.append(f'msg->{field.name} = {c_get(field.type, f"data[{offset}]")};')
+        offset += field.wire_size
+
+    size = f'DC01_{msg.snake.upper()}_SIZE'
+    ctype = f'Dc01{msg.cls}'
+    out = [f'static inline size_t dc01_encode_{msg.snake}(uint8_t *buf, const {ctype} *msg) {{']
+    out += ['\t' + line for line in enc]
+    out += [f'\treturn {size};', '}', '']
+    out += [f'static inline bool dc01_decode_{msg.snake}(const uint8_t *data, size_t size, {ctype} *msg) {{',
+            f'\tif (size < {size})', '\t\treturn false;']
+    out += ['\t' + line for line in dec]
+    out += ['\treturn true;', '}', '']
+    return out
+
+
+def generate_c(messages: List[Message]) -> str:
+    out = [
+        '/* DC-01 ↔ PC protocol: command codes, messages & their packed encoding.',
+        ' *',
+        ' * Generated by sw/dc01_protogen.py from doc/protocol.json, do not edit.',
+        ' * Encoders write message to ‹buf› & return number of bytes written,',
+        ' * decoders return false when ‹data› are too short (longer are accepted).',
+        ' * Multi-byte values are MSB first. Messages without data have no struct.',
+        ' */',
+        '',
+        '#pragma once',
+        '',
+        '#include <stdbool.h>',
+        '#include <stddef.h>',
+        '#include <stdint.h>',
+        '',
+    ]
+    for direction in ('PM', 'MP'):
+        out += [f'#define {m.define} 0x{m.code:02X}' for m in messages if m.direction == direction]
+        out.append('')
+    out += [f'#define DC01_{m.snake.upper()}_SIZE {m.size}' for m in messages]
+    out += [
+        '',
+        'static inline void dc01_put_u16(uint8_t *buf, uint16_t value) {',
+        '\tbuf[0] = value >> 8;',
+        '\tbuf[1] = value & 0xFF;',
+        '}',
+        '',
+        'static inline void dc01_put_u32(uint8_t *buf, uint32_t value) {',
+        '\tbuf[0] = value >> 24;',
+        '\tbuf[1] = (value >> 16) & 0xFF;',
+        '\tbuf[2] = (value >> 8) & 0xFF;',
+        '\tbuf[3] = value & 0xFF;',
+        '}',
+        '',
+        'static inline uint16_t dc01_get_u16(const uint8_t *buf) {',
+        '\treturn (buf[0] << 8) | buf[1];',
+        '}',
+        '',
+        'static inline uint32_t dc01_get_u32(const uint8_t *buf) {',
+        '\treturn ((uint32_t)buf[0] << 24) | ((uint32_t)buf[1] << 16) | (buf[2] << 8) | buf[3];',
+        '}',
+        '',
+    ]
+
+    groups: Dict[str, Field] = {}
+    for msg in messages:
+        for field in msg.fields:
+            if field.type == 'group':
+                groups[field.cls] = field  # type: ignore
+    for cls, group in groups.items():
+        out.append('typedef struct {')
+        out += [f'\t{decl}' for sub in group.fields for decl in c_field_decl(sub)]
+        out += [f'}} Dc01{cls};', '']
+
+    for msg in messages:
+        if not msg.fields:
+            continue
+        out.append(f'// {msg.define}')
+        out.append('typedef struct {')
+        out += [f'\t{decl}' for field in msg.fields for decl in c_field_decl(field)]
+        out += [f'}} Dc01{msg.cls};', '']
+        out += c_codec(msg)
+    return '\n'.join(out).rstrip('\n') + '\n'
+
+
+def test_patterns(msg: Message) -> Tuple[bytes, bytes]:
+    """
+    Data of ‹msg› for test_proto.c with a byte of newer firmware appended:
+    pattern (neighbouring bytes differ, high bits used) & its complement, so
+    each bit is tested both ways.
+    """
+    salt = msg.code + (0x80 if msg.direction == 'MP' else 0)
+    data = bytes((salt + 0x3B*i + 0x11) & 0xFF for i in range(msg.size + 1))
+    return data, bytes(b ^ 0xFF for b in data)
+
+
+def c_test_checks(msg: Message, data: bytes, src: str) -> Tuple[List[str], bytes]:
+    """Returns checks of values decoded from ‹data› (named ‹src› in C) & bytes expected from encoder."""
+    checks = []
+    encoded = bytearray(data[:msg.size])
+    offset = 0
+    for field in msg.fields:
+        if field.bits:
+            used = 0
+            for b in field.bits:
+                for i in range(b.count):
+                    shift = b.bit + i*b.width
+                    target = f'msg.{b.name}' + (f'[{i}]' if b.count > 1 else '')
+                    checks.append(f'CHECK_EQ({target}, {(data[offset] >> shift) & b.mask});')
+                    used |= b.mask << shift
+            encoded[offset] &= used
+        elif field.type == 'bytes':
+            checks.append(f'CHECK(memcmp(msg.{field.name}, &{src}[{offset}], {field.size}) == 0);')
+        elif field.type == 'group':
+            for i in range(field.count):  # type: ignore
+                inner = offset + i*field.size
+                for sub in field.fields:
+                    value = int.from_bytes(data[inner:inner+sub.size], 'big')
+                    checks.append(f'CHECK_EQ(msg.{field.name}[{i}].{sub.name}, 0x{value:0{2*sub.size}X});')
+                    inner += sub.size
+        else:
+            for i in range(field.count or 1):
+                at = offset + i*field.size
+                value = int.from_bytes(data[at:at+field.size], 'big')
+                target = f'msg.{field.name}' + (f'[{i}]' if field.count else '')
+                checks.append(f'CHECK_EQ({target}, 0x{value:0{2*field.size}X});')
+        offset += field.wire_size
+    return checks, bytes(encoded)
+
+
+def c_byte_rows(rows: Tuple[bytes, ...]) -> List[str]:
+    """Returns initializer of two-dimensional byte array, 12 bytes per line."""
+    out = []
+    for row in rows:
+        lines = [', '.join(f'0x{b:02X}' for b in row[i:i+12]) for i in range(0, len(row), 12)]
+        out.append('\t{' + ',\n\t\t '.join(lines) + '},')  # caller indents the first line
+    return out
+
+
+def generate_c_test(messages: List[Message]) -> str:
+    tested = [m for m in messages if m.fields]
+    out = [
+        '/* Host test of protocol codecs (dc01_proto.h): each message is decoded',
+        ' * from a test pattern & its complement, values are checked against the',
+        ' * schema layout (offsets, MSB first, bits) & the message is encoded back',
+        ' * to the pattern (unused bits cleared), nothing is written behind it.',
+        ' *',
+        ' * Generated by sw/dc01_protogen.py from doc/protocol.json, do not edit.',
+        ' */',
+        '',
+        '#include <string.h>',
+        '#include "dc01_proto.h"',
+        '#include "test.h"',
+        '',
+        '/* Private function prototypes -----------------------------------------------*/',
+        '',
+    ]
+    out += [f'static void _test_{m.snake}(void);' for m in tested]
+    out += [
+        '',
+        '/* Code ----------------------------------------------------------------------*/',
+        '',
+        'int main(void) {',
+    ]
+    out += [f'\t_test_{m.snake}();' for m in tested]
+    out += ['\treturn test_result("test_proto");', '}']
+
+    for msg in tested:
+        size = f'DC01_{msg.snake.upper()}_SIZE'
+        patterns = test_patterns(msg)
+        checks, encoded = zip(*(c_test_checks(msg, data, f'data[{p}]') for p, data in enumerate(patterns)))
+        out += ['', f'void _test_{msg.snake}(void) {{', f'\tstatic const uint8_t data[2][{size}+1] = {{']
+        out += ['\t' + line for line in c_byte_rows(patterns)]
+        out.append('\t};')
+        expected = 'data[p]'
+        if any(enc != data[:msg.size] for enc, data in zip(encoded, patterns)):
+            expected = 'encoded[p]'
+            out.append(f'\tstatic const uint8_t encoded[2][{size}] = {{')
+            out += ['\t' + line for line in c_byte_rows(encoded)]
+            out.append('\t};')
+        out += [
+            f'\tDc01{msg.cls} msg;',
+            f'\tuint8_t buf[{size}+1];',
+            '',
+            '\tfor (size_t p = 0; p < 2; p++) {',
+            f'\t\tCHECK(!dc01_decode_{msg.snake}(data[p], {size}-1, &msg));',
+            '\t\tmemset(&msg, 0, sizeof(msg));',
+            f'\t\tCHECK(dc01_decode_{msg.snake}(data[p], sizeof(data[p]), &msg));',
+            '\t\tif (p == 0) {',
+        ]
+        out += ['\t\t\t' + line for line in checks[0]]
+        out.append('\t\t} else {')
+        out += ['\t\t\t' + line for line in checks[1]]
+        out += [
+            '\t\t}',
+            '',
+            '\t\tmemset(buf, 0xA5, sizeof(buf));',
+            f'\t\tCHECK_EQ(dc01_encode_{msg.snake}(buf, &msg), {size});',
+            f'\t\tCHECK(memcmp(buf, {expected}, {size}) == 0);',
+            f'\t\tCHECK_EQ(buf[{size}], 0xA5);',
+            '\t}',
+            '}',
+        ]
+    return '\n'.join(out) + '\n'
+
+
+###############################################################################
+# Python
+
+def py_comment(doc: Optional[str]) -> str:
+    return f'  # {doc}' if doc else ''
+
+
+def py_attrs(field: Field) -> List[str]:
+    """Returns class attributes (with type hint & comment) of ‹field›."""
+    if field.bits:
+        attrs = []
+        for b in field.bits:
+            t = 'bool' if b.width == 1 else 'int'
+            attrs.append(f'{b.name}: ' + (f'Tuple[{t}, ...]' if b.count > 1 else t) + py_comment(b.doc))
+        return attrs
+    if field.type == 'bytes':
+        t = 'bytes'
+    elif field.type == 'group':
+        t = f'Tuple[{field.cls}, ...]'
+    else:
+        t = 'Tuple[int, ...]' if field.count else 'int'
+    return [f'{field.name}: {t}' + py_comment(field.doc)]
+
+
+def py_format(field: Field) -> str:
+    if field.type == 'bytes':
+        return f'{field.size}s'
+    if field.type == 'group':
+        return ''.join(TYPES[f.type][1] for f in field.fields) * field.count  # type: ignore
+    fmt = TYPES[field.type][1]
+    return f'{field.count}{fmt}' if field.count else fmt
+
+
+def py_values(field: Field) -> int:
+    """Number of values unpacked by struct for ‹field›."""
+    if field.type == 'group':
+        return len(field.fields) * field.count  # type: ignore
+    return field.count or 1
+
+
+def py_bit(src: str, b: Bits, i: int) -> str:
+    shift = b.bit + i*b.width
+    if b.width == 1:
+        return f'bool({src} & 0x{1 << shift:02X})'
+    return f'{src} >> {shift} & 0x{b.mask:02X}' if shift else f'{src} & 0x{b.mask:02X}'
+
+
+def py_wrap(head: str, items: List[str], tail: str, tuple_: bool = False) -> List[str]:
+    """Returns statement ‹head›‹items›‹tail› in function body, item per line when too long."""
+    line = f'    {head}{", ".join(items)}{"," if tuple_ and len(items) == 1 else ""}{tail}'
+    if len(line) <= 120:
+        return [line]
+    return [f'    {head}'] + [f'        {item},' for item in items] + [f'    {tail}']
+
+
+def py_codec(msg: Message) -> List[str]:
+    args, packed = [], []
+    index = 0
+    for field in msg.fields:
+        n = py_values(field)
+        if field.bits:
+            src = f'v[{index}]'
+            parts = []
+            for b in field.bits:
+                bits = [py_bit(src, b, i) for i in range(b.count)]
+                args.append(f'({", ".join(bits)})' if b.count > 1 else bits[0])
+                for i in range(b.count):
+                    value = f'msg.{b.name}' + (f'[{i}]' if b.count > 1 else '')
+                    shift = b.bit + i*b.width
+                    value = f'{value}' if b.width == 1 else f'({value} & 0x{b.mask:02X})'
+                    parts.append(f'{value} << {shift}' if shift else value)
+            packed.append(' | '.join(parts))
+        elif field.type == 'group':
+            k = len(field.fields)
+            args.append('(' + ', '.join(f'_new({field.cls}, v[{index + i*k}:{index + (i+1)*k}])'
+                                        for i in range(field.count)) + ')')  # type: ignore
+            packed += [f'*msg.{field.name}[{i}]' for i in range(field.count)]  # type: ignore
+        elif field.count:
+            args.append(f'v[{index}:{index + n}]')
+            packed.append(f'*msg.{field.name}')
+        else:
+            args.append(f'v[{index}]')
+            packed.append(f'msg.{field.name}')
+        index += n
+
+    struct_name = f'_{msg.snake.upper()}'
+    plain = all(not f.bits and f.type != 'group' and not f.count for f in msg.fields)
+    out = [f'def decode_{msg.snake}(data: Buffer) -> {msg.cls}:']
+    if not msg.fields:
+        out.append(f'    return _{msg.snake.upper()}_INSTANCE')
+    elif plain:
+        out.append(f'    return _new({msg.cls}, {struct_name}.unpack_from(data))')
+    else:
+        out.append(f'    v = {struct_name}.unpack_from(data)')
+        out += py_wrap(f'return _new({msg.cls}, (', args, '))', tuple_=True)
+    out += ['', '']
+    out.append(f'def encode_{msg.snake}(msg: {msg.cls}) -> bytes:')
+    if not msg.fields:
+        out.append("    return b''")
+    else:
+        out += py_wrap(f'return {struct_name}.pack(', packed, ')')
+    out += ['', '']
+    return out
+
+
+def generate_py(schema: Dict[str, Any], messages: List[Message]) -> str:
+    magic = ''.join(f'\\x{int(b, 16):02X}' for b in schema['magic'])
+    out = [
+        '# Generated by dc01_protogen.py from fw/doc/protocol.json, do not edit.',
+        '',
+        '"""',
+        'DC-01 ↔ PC protocol messages & codecs (see fw/doc/protocol.md).',
+        '',
+        'Decoders unpack packet data in place (struct.unpack_from on memoryview',
+        'of decoder buffer, no copies) and are looked up in tables by command',
+        'code. Packets could be longer than in schema (newer firmware appends',
+        'fields), only the minimal size is checked.',
+        '"""',
+        '',
+        'import struct',
+        'from typing import Any, Callable, Dict, NamedTuple, Optional, Tuple, Union',
+        '',
+        f"MAGIC = b'{magic}'",
+        f'MAX_DATA_SIZE = {schema["max_data_size"]}',
+        '',
+    ]
+    for direction in ('PM', 'MP'):
+        out += [f'{m.define} = 0x{m.code:02X}' for m in messages if m.direction == direction]
+        out.append('')
+    out += ['Buffer = Union[bytes, bytearray, memoryview]', '_new = tuple.__new__  # avoids slow Python-level __new__',
+            '', '']
+
+    classes: List[Tuple[str, List[str]]] = []
+    for msg in messages:
+        for field in msg.fields:
+            if field.type == 'group' and field.cls not in [c for c, _ in classes]:
+                classes.append((field.cls, [a for f in field.fields for a in py_attrs(f)]))  # type: ignore
+        classes.append((msg.cls, [a for f in msg.fields for a in py_attrs(f)]))
+    for cls, attrs in classes:
+        out.append(f'class {cls}(NamedTuple):')
+        out += [f'    {attr}' for attr in attrs] or ['    pass']
+        out += ['', '']
+
+    for msg in messages:
+        fmt = ''.join(py_format(f) for f in msg.fields)
+        if msg.fields:
+            out.append(f"_{msg.snake.upper()} = struct.Struct('>{fmt}')")
+        else:
+            out.append(f'_{msg.snake.upper()}_INSTANCE = {msg.cls}()')
+    out += ['', '']
+    for msg in messages:
+        out += py_codec(msg)
+
+    for direction, kind in (('PM', 'request'), ('MP', 'report')):
+        out.append(f'{kind.upper()}_DECODERS: Dict[int, Tuple[int, Callable[[Buffer], Any]]] = {{')
+        out += [f'    {m.define}: ({m.size}, decode_{m.snake}),' for m in messages if m.direction == direction]
+        out += ['}', '']
+    out.append('ENCODERS: Dict[type, Tuple[int, Callable[[Any], bytes]]] = {')
+    out += [f'    {m.cls}: ({m.define}, encode_{m.snake}),' for m in messages]
+    out += ['}', '', '']
+    out += [
+        'def decode_request(code: int, data: Buffer) -> Optional[Any]:',
+        '    """Decodes PC → DC-01 packet, returns None for unknown or too short packets."""',
+        '    entry = REQUEST_DECODERS.get(code)',
+        '    if entry is None or len(data) < entry[0]:',
+        '        return None',
+        '    return entry[1](data)',
+        '',
+        '',
+        'def decode_report(code: int, data: Buffer) -> Optional[Any]:',
+        '    """Decodes DC-01 → PC packet, returns None for unknown or too short packets."""',
+        '    entry = REPORT_DECODERS.get(code)',
+        '    if entry is None or len(data) < entry[0]:',
+        '        return None',
+        '    return entry[1](data)',
+        '',
+        '',
+        'def encode(msg: Any) -> Tuple[int, bytes]:',
+        '    """Returns (command code, data) of message."""',
+        '    code, encoder = ENCODERS[type(msg)]',
+        '    return code, encoder(msg)',
+    ]
+    return '\n'.join(out) + '\n'
+
+
+###############################################################################
+# Documentation
+
+def generate_doc(doc: str, messages: List[Message]) -> str:
+    """Returns ‹doc› with regenerated overview, raises ValueError on mismatch with schema."""
+    rows = [
+        DOC_BEGIN,
+        '',
+        '| Code | Direction | Abbreviation | Data bytes | Since FW |',
+        '|------|-----------|--------------|-----------:|----------|',
+    ]
+    for msg in messages:
+        direction = 'PC → DC-01' if msg.direction == 'PM' else 'DC-01 → PC'
+        name = f'`DC_{msg.direction}_{msg.name}`'
+        if msg.anchor:
+            name = f'[{name}](#{msg.anchor})'
+        rows.append(f'| `0x{msg.code:02X}` | {direction} | {name} | {msg.size} | {msg.since or "1.0"} |')
+    rows += ['', DOC_END]
+
+    begin, end = doc.find(DOC_BEGIN), doc.find(DOC_END)
+    if begin < 0 or end < 0:
+        raise ValueError('protocol.md: markers of generated overview not found')
+    doc = doc[:begin] + '\n'.join(rows) + doc[end+len(DOC_END):]
+
+    errors = []
+    for msg in messages:
+        if not msg.anchor:
+            continue
+        pos = doc.find(f'<a name="{msg.anchor}">')
+        if pos < 0:
+            errors.append(f'{msg.anchor}: section not found')
+            continue
+        heading = doc.rfind('### ', 0, pos)
+        section_end = doc.find('\n### ', pos)
+        section = doc[heading:section_end if section_end >= 0 else len(doc)]
+        codes = re.findall(r'`0x([0-9A-Fa-f]{2})`', section.split('\n', 1)[0]) + \
+            re.findall(r'Command Code byte: `0x([0-9A-Fa-f]{2})`', section)
+        if any(int(code, 16) != msg.code for code in codes) or len(codes) < 2:
+            errors.append(f'{msg.anchor}: command code 0x{msg.code:02X} expected')
+        sizes = re.findall(r'N\.o\. data bytes: (\d+)', section)
+        if sizes != [str(msg.size)]:
+            errors.append(f'{msg.anchor}: {msg.size} data bytes expected')
+    if errors:
+        raise ValueError('protocol.md does not match schema:\n  ' + '\n  '.join(errors))
+    return doc
+
+
+###############################################################################
+
+def main() -> None:
+    args = docopt(__doc__)
+    try:
+        schema, messages = load_schema(SCHEMA)
+        with open(DOC, encoding='utf-8') as f:
+            outputs = {
+                C_HEADER: generate_c(messages),
+                C_TEST: generate_c_test(messages),
+                PY_MODULE: generate_py(schema, messages),
+                DOC: generate_doc(f.read(), messages),
+            }
+    except (ValueError, KeyError) as e:
+        sys.exit(f'Error: {e}')
+
+    stale = []
+    for path, content in outputs.items():
+        current = None
+        if os.path.exists(path):
+            with open(path, encoding='utf-8') as f:
+                current = f.read()
+        if current == content:
+            continue
+        stale.append(os.path.relpath(path, ROOT))
+        if not args['--check']:
+            with open(path, 'w', encoding='utf-8') as f:
+                f.write(content)
+    if args['--check'] and stale:
+        sys.exit('Out of date (run dc01_protogen.py): ' + ', '.join(stale))
+    for path in stale:
+        print(f'Generated {path}')
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,156 @@
+#!/usr/bin/env python3
+
+"""
+DC-01 scope: records raw samples of DCC inputs (FW >= 1.2) to VCD file
+
+Samples are taken by DC-01 each 100 us, resulting file could be viewed as
+a waveform (e.g. GTKWave). Samples of packets lost on the way (sequence
+number gap) are written as 'x'. Statistics of packets dropped by DC-01 and
+lost on PC side are printed at the end.
+
+The port is used exclusively: stop hjop_watchdog.py first. Without the
+watchdog's heartbeat, DC-01 cuts DCC at its output (DCC2), DCC1 input is
+still sampled.
+
+Usage:
+  dc01_scope.py [options] <output.vcd>
+  dc01_scope.py --help
+
+Options:
+  -p <port>          Serial port (DC-01 is looked up by default)
+  -d <s>             Recording duration in seconds (until Ctrl+C by default)
+  --relays           Record relay states too (halves samples per packet)
+  -l <loglevel>      Specify loglevel (python logging package) [default: info]
+  -h --help          Show this screen
+"""
+
+import datetime
+import logging
+import sys
+import time
+from typing import List, Optional, TextIO
+import serial
+from docopt import docopt
+from dc01_link import (
+    FrameDecoder, ScopeReport, decode_report, encode_scope, scope_unpack,
+    SCOPE_SAMPLE_PERIOD, SCOPE_SAMPLES_SIZE,
+)
+from hjop_watchdog import dc01_ports
+
+SIGNALS = ['dcc1', 'dcc2', 'relay1', 'relay2']  # bit order in sample
+READ_TIMEOUT = 0.1  # seconds
+
+
+class VcdWriter:
+    """Writes samples as value changes, time unit = sample period."""
+
+    def __init__(self, file: TextIO, signals: List[str]):
+        self.file = file
+        self.signals = signals
+        self.time = 0  # index of next sample
+        self.last: Optional[List[str]] = None
+        ids = [chr(ord('!') + i) for i in range(len(signals))]
+        self.ids = ids
+        file.write(f'$date {datetime.datetime.now().isoformat(" ", "seconds")} $end\n')
+        file.write('$version dc01_scope.py $end\n')
+        file.write(f'$timescale {SCOPE_SAMPLE_PERIOD*1e6:.0f} us $end\n')
+        file.write('$scope module dc01 $end\n')
+        for id_, name in zip(ids, signals):
+            file.write(f'$var wire 1 {id_} {name} $end\n')
+        file.write('$upscope $end\n$enddefinitions $end\n')
+
+    def _change(self, values: List[str]) -> None:
+        changed = [f'{v}{id_}' for v, id_, last in zip(values, self.ids, self.last or [None]*len(values))
+                   if v != last]
+        if changed:
+            self.file.write(f'#{self.time}\n' + '\n'.join(changed) + '\n')
+        self.last = values
+
+    def samples(self, samples: List[int]) -> None:
+        for sample in samples:
+            self._change([str((sample >> i) & 1) for i in range(len(self.signals))])
+            self.time += 1
+
+    def unknown(self, count: int) -> None:
+        """‹count› samples were lost."""
+        self._change(['x'] * len(self.signals))
+        self.time += count
+
+    def close(self) -> None:
+        self.file.write(f'#{self.time}\n')
+        self.file.close()
+
+
+class ScopeStats:
+    def __init__(self) -> None:
+        self.packets = 0
+        self.dropped = 0  # by DC-01 (USB not fast enough)
+        self.lost = 0  # on the way to us
+        self._next_seq: Optional[int] = None
+
+    def packet(self, report: ScopeReport) -> int:
+        """Returns number of packets missing before ‹report›."""
+        self.packets += 1
+        missing = 0 if self._next_seq is None else (report.seq - self._next_seq) & 0xFFFF
+        self._next_seq = (report.seq + 1) & 0xFFFF
+        if missing:
+            self.dropped += min(report.dropped, missing)
+            self.lost += max(missing - report.dropped, 0)
+            logging.warning(f'{missing} packet(s) missing before #{report.seq} '
+                            f'({report.dropped} dropped by DC-01)')
+        return missing
+
+
+def record(port: serial.Serial, vcd: VcdWriter, relays: bool, duration: Optional[float]) -> ScopeStats:
+    stats = ScopeStats()
+    decoder = FrameDecoder()
+    samples_per_packet = SCOPE_SAMPLES_SIZE * 8 // (4 if relays else 2)
+    port.write(encode_scope(True, relays))
+    end = None if duration is None else time.monotonic() + duration
+    try:
+        while end is None or time.monotonic() < end:
+            for frame in decoder.feed(port.read(max(port.in_waiting, 1))):
+                report = decode_report(frame)
+                if not isinstance(report, ScopeReport):
+                    continue
+                missing = stats.packet(report)
+                if missing:
+                    vcd.unknown(missing * samples_per_packet)
+                vcd.samples(scope_unpack(report))
+    except KeyboardInterrupt:
+        pass
+    finally:
+        port.write(encode_scope(False))
+    return stats
+
+
+def main() -> None:
+    args = docopt(__doc__)
+    logging.basicConfig(
+        format='[%(asctime)s] %(levelname)s %(message)s',
+        level=getattr(logging, args['-l'].upper(), logging.INFO),
+    )
+
+    port_name = args['-p']
+    if port_name is None:
+        found = dc01_ports()
+        if len(found) != 1:
+            sys.exit(f'{len(found)} DC-01 found, specify port by -p')
+        port_name = found[0]
+
+    relays = args['--relays']
+    duration = float(args['-d']) if args['-d'] else None
+    with serial.Serial(port=port_name, timeout=READ_TIMEOUT) as port:
+        vcd = VcdWriter(open(args['<output.vcd>'], 'w'), SIGNALS if relays else SIGNALS[:2])
+        logging.info(f'Recording {port_name} to {args["<output.vcd>"]}')
+        try:
+            stats = record(port, vcd, relays, duration)
+        finally:
+            vcd.close()
+
+    logging.info(f'{stats.packets} packets ({vcd.time*SCOPE_SAMPLE_PERIOD:.1f} s), '
+                 f'{stats.dropped} dropped by DC-01, {stats.lost} lost on PC side')
+
+
+if __name__ == '__main__':
+    main()
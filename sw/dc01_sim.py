@@ -0,0 +1,788 @@
+#!/usr/bin/env python3
+
+"""
+DC-01 simulator: exposes pseudo-terminal(s) behaving like DC-01
+
+Implements protocol from fw/doc/protocol.md & behavior of the firmware:
+INFO, STATE & BRSTATE reports, DCC cut on SET_STATE timeout
+(DCCON_TIMEOUT_MS), lease (FW >= 1.1), scope stream, DCC statistics
+& waveform, boot information, crash record and heartbeat statistics
+(FW >= 1.2), Big relay test and mode transitions, reset with Big relay test pass cached in backup domain.
+Closing the port by the host is handled as DTR drop (DCC is cut immediately).
+
+Faults could be injected from command line or at runtime by commands on
+stdin (prefix command with '<index>:' to address single device):
+  delay <s> [<jitter>]   delay each frame sent to host
+  drop <p>               drop frame sent to host with probability p
+  droprx <p>             drop frame received from host with probability p
+  garbage <p>            insert random bytes before frame with probability p
+  split <p>              split frame sent to host into more writes with probability p
+  merge <s>              merge frames sent to host within <s> into single write (0 = off)
+  stall <s>              send no reports for <s> seconds (requests are still processed)
+  dtr <s>                behave as if host dropped DTR, for <s> seconds
+  mode normal|override|failure
+  dcc on|off             presence of DCC on input
+  brtfail                next Big relay test fails
+  reset [iwdg|power]     reset of DC-01 (USB re-enumeration is not simulated) [default: iwdg]
+  crash [<cause>]        crash of firmware (error, hardfault, ...) followed by IWDG reset [default: hardfault]
+  clear                  clear all faults
+  stats                  print statistics
+
+Usage:
+  dc01_sim.py [options]
+  dc01_sim.py --help
+
+Options:
+  -n <count>         Number of simulated devices [default: 1]
+  --link <path>      Create symlink <path> to pty (suffixed with index when -n > 1)
+  -f <version>       Reported firmware version (lease since 1.1, scope & DCC stats since 1.2) [default: 1.2]
+  --delay <s>        Initial fault: delay of frames sent to host [default: 0]
+  --drop <p>         Initial fault: drop probability of frames sent to host [default: 0]
+  --droprx <p>       Initial fault: drop probability of frames received from host [default: 0]
+  --garbage <p>      Initial fault: garbage probability [default: 0]
+  --split <p>        Initial fault: split probability [default: 0]
+  --merge <s>        Initial fault: merge window [default: 0]
+  --seed <seed>      Random seed
+  -l <loglevel>      Specify loglevel (python logging package) [default: info]
+  -h --help          Show this screen
+"""
+
+import errno
+import heapq
+import logging
+import os
+import random
+import select
+import sys
+import time
+import tty
+from typing import Dict, List, NamedTuple, Optional, Tuple
+from docopt import docopt
+from dc01_link import (
+    FrameDecoder, encode_frame, encode, decode_request,
+    InfoRequest, SetStateRequest, LeaseRequest, ScopeRequest, DccStatsRequest, DccWaveRequest, BootInfoRequest,
+    CrashRequest, CrashReport, CRASH_CAUSES, HbStatsRequest, HbStatsReport, HB_GAP_BINS, HB_NO_MARGIN,
+    InfoReport, StateReport, BrtReport, LeaseReport, ScopeReport, DccInputStats, DccStatsReport, DccWaveReport,
+    BootInfoReport, DCC_WAVE_BINS, SCOPE_RUN, SCOPE_RELAYS, SCOPE_SAMPLE_PERIOD, SCOPE_SAMPLES_SIZE,
+)
+
+# Firmware constants (fw/inc/main.h, fw/src/main.c)
+DCCON_WARNING = 0.5  # seconds
+DCCON_TIMEOUT = 2.0  # seconds
+LEASE_MIN_MS = 200
+LEASE_MAX_MS = 5000
+LEASE_VERSION = (1, 1)
+SCOPE_VERSION = (1, 2)
+DCC_STATS_VERSION = (1, 2)
+BOOT_INFO_VERSION = (1, 2)
+CRASH_VERSION = (1, 2)
+HB_STATS_VERSION = (1, 2)
+DCC_PACKET_RATE = 100  # packets/s of simulated DCC
+# Simulated packet: idle packet (62 '1' halves of 58 us, 22 '0' halves of 100 us) followed by RailCom cutout
+DCC_PACKET_HALVES = {'55-61': 62, '95-9900': 22}
+DCC_CUTOUT_US = 460
+STATE_PERIOD = 0.5  # seconds
+INIT_TIME = 0.01  # seconds, debounce of inputs after reset (DEBOUNCE_SETTLE_UPDATES)
+BRTEST_STEP_PERIOD = 0.1  # seconds
+BRTEST_NOTEST_MAX_TIME = 10  # seconds
+
+M_INITIALIZING, M_NORMAL_OP, M_OVERRIDE, M_FAILURE = range(4)
+MODES = {'normal': M_NORMAL_OP, 'override': M_OVERRIDE, 'failure': M_FAILURE}
+MODE_NAMES = ['mInitializing', 'mNormalOp', 'mOverride', 'mFailure']
+DCFAIL_NOFAILURE, DCFAIL_BRT = 0, 1
+WARN_TIMEOUT = 0x02
+
+BRTS_NOT_YET_RUN, BRTS_IN_PROGRESS, BRTS_FINISHED, BRTS_FAIL, BRTS_INTERRUPTED = range(5)
+BRTT_FINISHED = 8
+BRTE_DCC_NOT_APPEARED = 1
+RESET_POWER, RESET_PIN, RESET_IWDG = 0x01, 0x02, 0x04
+RESET_CAUSES = {'iwdg': RESET_PIN | RESET_IWDG, 'power': RESET_POWER | RESET_PIN}
+BOOT_NO_BRT = 0xFFFFFFFF
+CRASH_NONE = CrashReport(0, 0, 0, 0, 0, (0,)*8, 0, 0, 0, 0, (0,)*16)
+CRASH_PC = 0x08001234  # simulated address of faulting instruction
+TRAIL_MODE, TRAIL_RELAYS = 1, 2
+
+HOST_PROBE_PERIOD = 0.02  # seconds, polling of pty while host has the port closed
+
+
+class Faults:
+    def __init__(self) -> None:
+        self.delay = 0.0
+        self.jitter = 0.0
+        self.drop = 0.0
+        self.drop_rx = 0.0
+        self.garbage = 0.0
+        self.split = 0.0
+        self.merge = 0.0
+        self.stall_until = 0.0
+        self.dtr_until = 0.0
+
+
+class SimHbStats:
+    """Heartbeat statistics (fw/src/hbstats.c)."""
+
+    def __init__(self, now: float):
+        self.last: Optional[float] = None  # previous heartbeat, None = stopped
+        self.reset(now)
+
+    def reset(self, now: float) -> None:
+        self.heartbeats = 0
+        self.worst_gap_ms = 0
+        self.min_margin_ms = HB_NO_MARGIN
+        self.warnings = 0
+        self.timeouts = 0
+        self.since = now
+        self.gaps = [0] * len(HB_GAP_BINS)
+
+    def heartbeat(self, timeout: float, now: float) -> None:
+        """‹timeout› of the previous heartbeat."""
+        self.heartbeats += 1
+        if self.last is not None:
+            gap_ms = int((now - self.last) * 1000)
+            self.gaps[min(max(gap_ms.bit_length() - 3, 0), len(HB_GAP_BINS) - 1)] += 1
+            self.worst_gap_ms = max(self.worst_gap_ms, gap_ms)
+            self.min_margin_ms = min(self.min_margin_ms, max(round(timeout * 1000) - gap_ms, 0))
+        self.last = now
+
+    def report(self, now: float) -> HbStatsReport:
+        return HbStatsReport(self.heartbeats, self.worst_gap_ms, self.min_margin_ms, self.warnings, self.timeouts,
+                             round((now - self.since) * 1000) & 0xFFFFFFFF, tuple(self.gaps))
+
+
+class SimDccInput:
+    """Synthetic DCC at input: DCC_PACKET_RATE valid packets/s while present, no errors.
+    Presence is sampled at requests only."""
+
+    def __init__(self, now: float):
+        self.present = False
+        self.updated = now
+        self.packets = 0.0
+        self.losses = 0
+        self.lost = 0.0  # seconds, total
+        self.loss = 0.0  # seconds, current or last
+
+    def update(self, present: bool, now: float) -> None:
+        elapsed, self.updated = now - self.updated, now
+        if self.present:
+            self.packets += DCC_PACKET_RATE * elapsed
+        elif self.losses:
+            self.lost += elapsed
+            self.loss += elapsed
+        if self.present and not present:
+            self.losses += 1
+            self.loss = 0.0
+        self.present = present
+
+    def wave(self, index: int) -> DccWaveReport:
+        packets = int(self.packets)
+        halves = {range_: count*packets & 0xFFFFFFFF for range_, count in DCC_PACKET_HALVES.items()}
+        rate = DCC_PACKET_RATE if self.present else 0
+        return DccWaveReport(
+            index, self.present, rate * sum(DCC_PACKET_HALVES.values()) // 2,
+            480 if self.present else 0, DCC_CUTOUT_US if packets else 0, packets & 0xFFFFFFFF, self.losses,
+            int(self.lost*1000) & 0xFFFFFFFF, int(self.loss*1000) & 0xFFFFFFFF, 0,
+            tuple(halves.get(range_, 0) for range_ in DCC_WAVE_BINS),
+        )
+
+
+class SimDevice:
+    def __init__(self, index: int, fw_version: Tuple[int, int], faults: Faults, rnd: random.Random,
+                 link: Optional[str]):
+        self.index = index
+        self.fw_version = fw_version
+        self.faults = faults
+        self.rnd = rnd
+
+        self.master, slave = os.openpty()
+        tty.setraw(slave)  # settings persist after close, host could open it in raw mode
+        self.slave_name = os.ttyname(slave)
+        os.close(slave)  # host closing the port must be detectable
+        os.set_blocking(self.master, False)
+        self.link = link
+        if link:
+            if os.path.lexists(link):
+                os.unlink(link)
+            os.symlink(self.slave_name, link)
+
+        now = time.monotonic()
+        self.decoder = FrameDecoder()
+        self.host_connected = False
+        self.next_probe = now
+        self.out_queue: List[Tuple[float, int, bytes]] = []  # heap of (time, seq, data)
+        self.out_seq = 0
+        self.out_last = 0.0  # USB keeps order of frames even when delayed
+        self.merge_buf = b''
+        self.merge_until = 0.0
+        self.brt_last: Optional[float] = None  # backup domain: last pass of Big relay test
+        self.resets = 0
+        self.crash_record: Optional[CrashReport] = None  # no-init RAM: survives reset, lost at power-on
+        self.reset(RESET_CAUSES['power'], now)
+
+        self.stats: Dict[str, int] = {
+            'rx_frames': 0, 'heartbeats': 0, 'tx_frames': 0, 'dropped_tx': 0, 'dropped_rx': 0,
+            'garbage': 0, 'cuts': 0, 'host_connects': 0,
+        }
+
+    def reset(self, cause: int, now: float) -> None:
+        """Firmware state after reset, backup domain survives unless power-on."""
+        self.mode = M_INITIALIZING
+        self.mode_until = now + INIT_TIME
+        self.relays = False
+        self.dcc_input = True
+        self.failure_code = DCFAIL_NOFAILURE
+        self.heartbeat_time: Optional[float] = None  # last SET_STATE s=1 or lease
+        self.dccon_timeout = DCCON_TIMEOUT  # or lease
+        self.dccon_warning = DCCON_WARNING
+        self.lease_ack: Optional[LeaseReport] = None
+        self.tx_req = {'info': False, 'state': False, 'brt': False, 'dcc_stats': False, 'boot_info': False,
+                       'crash': False}
+        self.hb_stats = SimHbStats(now)
+        self.hb_report: Optional[HbStatsReport] = None  # taken at request, pending until sent
+        self.hb_warned = False
+        self.dcc_wave_req: List[int] = []  # inputs
+        self.next_state = now + STATE_PERIOD
+
+        self.brt_state = BRTS_NOT_YET_RUN
+        self.brt_step = 0
+        self.brt_error = 0
+        self.brt_next = 0.0
+        self.brt_fail_next = False
+
+        self.scope_flags = 0
+        self.scope_seq = 0
+        self.scope_sample = 0  # index of next sample
+        self.scope_next = 0.0  # time of next packet
+
+        self.dcc_inputs = [SimDccInput(now), SimDccInput(now)]  # DCC1, DCC2
+
+        if cause & RESET_POWER:
+            self.brt_last = None
+            self.resets = 0
+            self.crash_record = None
+        else:
+            self.resets += 1
+        self.crash_last = self.crash_record or CRASH_NONE  # crash_init: taken & cleared
+        self.crash_record = None
+        self.reset_cause = cause
+        self.boot_time = now
+        self.dcc_on_time: Optional[float] = None
+        self.brt_honoured = self.brt_last is not None and now - self.brt_last < BRTEST_NOTEST_MAX_TIME
+
+    def close(self) -> None:
+        os.close(self.master)
+        if self.link and os.path.islink(self.link):
+            os.unlink(self.link)
+
+    def log(self, level: int, msg: str) -> None:
+        logging.log(level, f'[{self.index}] {msg}')
+
+    ###########################################################################
+    # Firmware behavior
+
+    def alive(self, now: float) -> bool:
+        return (self.heartbeat_time is not None) and (now - self.heartbeat_time < self.dccon_timeout)
+
+    def dtr(self, now: float) -> bool:
+        return self.host_connected and now >= self.faults.dtr_until
+
+    def set_relays(self, state: bool, reason: str) -> None:
+        if state == self.relays:
+            return
+        self.relays = state
+        self.tx_req['state'] = True
+        if not state:
+            self.stats['cuts'] += 1
+        self.log(logging.INFO, f'DCC {"connected" if state else "cut"} ({reason})')
+
+    def set_mode(self, mode: int, now: float) -> None:
+        if mode == self.mode:
+            return
+        self.mode = mode
+        self.tx_req['state'] = True
+        self.brt_interrupt()
+        if mode == M_NORMAL_OP:
+            self.set_relays(self.alive(now), 'normal operation')
+        elif mode == M_FAILURE:
+            self.set_relays(False, 'failure')
+        self.log(logging.INFO, f'Mode {MODE_NAMES[mode]}')
+
+    def dcc_on_timeout(self, reason: str) -> None:
+        self.heartbeat_time = None
+        self.brt_interrupt()
+        if self.mode == M_NORMAL_OP:
+            self.set_relays(False, reason)
+
+    def brt_running(self) -> bool:
+        return self.brt_state == BRTS_IN_PROGRESS
+
+    def brt_interrupt(self) -> None:
+        if self.brt_running():
+            self.brt_state = BRTS_INTERRUPTED
+            self.tx_req['brt'] = True
+
+    def brt_start(self, now: float) -> None:
+        self.brt_state = BRTS_IN_PROGRESS
+        self.brt_step = 1
+        self.brt_error = 0
+        self.brt_next = now + BRTEST_STEP_PERIOD
+        self.tx_req['brt'] = True
+        self.log(logging.INFO, 'Big relay test started')
+
+    def brt_update(self, now: float) -> None:
+        if not self.dcc_input:
+            self.brt_interrupt()
+            return
+        if self.brt_fail_next and self.brt_step == 3:
+            self.brt_fail_next = False
+            self.brt_state = BRTS_FAIL
+            self.brt_error = BRTE_DCC_NOT_APPEARED
+            self.brt_last = None
+            self.tx_req['brt'] = True
+            self.failure_code = DCFAIL_BRT
+            self.set_mode(M_FAILURE, now)
+            return
+        self.brt_step += 1
+        self.tx_req['brt'] = True
+        if self.brt_step < BRTT_FINISHED:
+            self.brt_next = now + BRTEST_STEP_PERIOD
+            return
+        self.brt_state = BRTS_FINISHED
+        self.brt_last = now
+        self.log(logging.INFO, 'Big relay test finished')
+        if self.mode == M_NORMAL_OP:
+            self.set_relays(self.alive(now), 'Big relay test finished')
+        elif self.mode == M_OVERRIDE:
+            self.set_relays(True, 'Big relay test finished')
+
+    def received(self, command_code: int, data: memoryview, now: float) -> None:
+        self.stats['rx_frames'] += 1
+        msg = decode_request(command_code, data)
+        if isinstance(msg, SetStateRequest):
+            state = msg.on
+            if state:
+                self.renew(DCCON_TIMEOUT, DCCON_WARNING, now)
+            else:
+                self.dccon_stop()
+            self.pc_set_state(state, 'SET_STATE' if state else 'SET_STATE s=0', now)
+        elif isinstance(msg, LeaseRequest) and self.fw_version >= LEASE_VERSION:
+            lease_ms = msg.duration_ms
+            if lease_ms > 0:
+                lease_ms = min(max(lease_ms, LEASE_MIN_MS), LEASE_MAX_MS)
+                self.renew(lease_ms / 1000, (lease_ms - lease_ms//4) / 1000, now)
+            else:
+                self.dccon_stop()
+            self.lease_ack = LeaseReport(lease_ms, msg.seq)
+            self.pc_set_state(lease_ms > 0, 'lease' if lease_ms else 'lease revoked', now)
+        elif isinstance(msg, ScopeRequest) and self.fw_version >= SCOPE_VERSION:
+            self.scope_flags = (SCOPE_RUN if msg.run else 0) | (SCOPE_RELAYS if msg.relays else 0)
+            self.scope_seq = 0
+            self.scope_next = now + self.scope_packet_period()
+        elif isinstance(msg, DccStatsRequest) and self.fw_version >= DCC_STATS_VERSION:
+            self.tx_req['dcc_stats'] = True
+        elif isinstance(msg, DccWaveRequest) and msg.input < len(self.dcc_inputs) and \
+                self.fw_version >= DCC_STATS_VERSION:
+            if msg.input not in self.dcc_wave_req:
+                self.dcc_wave_req.append(msg.input)
+        elif isinstance(msg, BootInfoRequest) and self.fw_version >= BOOT_INFO_VERSION:
+            self.tx_req['boot_info'] = True
+        elif isinstance(msg, CrashRequest) and self.fw_version >= CRASH_VERSION:
+            self.tx_req['crash'] = True
+        elif isinstance(msg, HbStatsRequest) and self.fw_version >= HB_STATS_VERSION:
+            if self.hb_report is None:  # ignored while previous report is pending
+                self.hb_report = self.hb_stats.report(now)
+                if msg.reset:
+                    self.hb_stats.reset(now)
+        elif isinstance(msg, InfoRequest):
+            self.tx_req['info'] = True
+
+    def renew(self, timeout: float, warning: float, now: float) -> None:
+        self.stats['heartbeats'] += 1
+        self.hb_stats.heartbeat(self.dccon_timeout, now)
+        self.hb_warned = False
+        self.heartbeat_time = now
+        self.dccon_timeout = timeout
+        self.dccon_warning = warning
+
+    def dccon_stop(self) -> None:
+        self.heartbeat_time = None
+        self.hb_stats.last = None
+
+    def pc_set_state(self, state: bool, reason: str, now: float) -> None:
+        if self.mode != M_NORMAL_OP:
+            return
+        if state and not self.relays and not self.brt_running() and self.dcc_input and \
+                (self.brt_last is None or now - self.brt_last >= BRTEST_NOTEST_MAX_TIME):
+            self.brt_start(now)
+        if not self.brt_running() or not state:
+            self.brt_interrupt()
+            self.set_relays(state, reason)
+
+    def dcc_present(self) -> Tuple[bool, bool]:
+        return (self.dcc_input, self.dcc_input and self.relays)
+
+    def dcc_update(self, now: float) -> None:
+        for dcc_input, present in zip(self.dcc_inputs, self.dcc_present()):
+            dcc_input.update(present, now)
+
+    def dcc_stats(self, now: float) -> DccStatsReport:
+        self.dcc_update(now)
+        return DccStatsReport(self.dcc_present(), False, tuple(
+            DccInputStats(DCC_PACKET_RATE if dcc_input.present else 0, int(dcc_input.packets) & 0xFFFFFFFF, 0, 0)
+            for dcc_input in self.dcc_inputs
+        ))
+
+    def crash(self, cause: int, now: float) -> None:
+        """Record of crash_record (fw/src/crash.c), trail has only the last mode & relays."""
+        frame = (0, 0, 0, 0, 0, 0, CRASH_PC, 0x01000000) if cause != 1 else (0,)*6 + (CRASH_PC, 0)
+        trail = (0,)*14 + ((TRAIL_MODE << 8) | self.mode, (TRAIL_RELAYS << 8) | self.relays)
+        self.crash_record = CrashReport(cause, self.mode, self.brt_state, self.brt_step,
+                                        round((now - self.boot_time) * 1000), frame, 0, 0, 0, 0, trail)
+
+    def boot_info(self, now: float) -> BootInfoReport:
+        def ms(t: Optional[float]) -> int:
+            return round((t - self.boot_time) * 1000) if t is not None else 0
+        return BootInfoReport(self.reset_cause, self.brt_honoured, False, self.resets, ms(self.boot_time + INIT_TIME),
+                              ms(self.dcc_on_time),
+                              int(now - self.brt_last) if self.brt_last is not None else BOOT_NO_BRT)
+
+    def scope_packet_period(self) -> float:
+        samples_per_byte = 2 if self.scope_flags & SCOPE_RELAYS else 4
+        return SCOPE_SAMPLES_SIZE * samples_per_byte * SCOPE_SAMPLE_PERIOD
+
+    def scope_packet(self) -> ScopeReport:
+        """Synthetic samples: DCC input toggles at each sample, DCC2 follows relays."""
+        relays = bool(self.scope_flags & SCOPE_RELAYS)
+        bits = 4 if relays else 2
+        data = bytearray()
+        byte = 0
+        for i in range(SCOPE_SAMPLES_SIZE * 8 // bits):
+            level = (self.scope_sample + self.scope_sample // 7) & 1 if self.dcc_input else 1
+            sample = level | ((level if self.relays else 1) << 1)  # inputs pulled up
+            if relays:
+                sample |= 0xC if self.relays else 0
+            byte |= sample << ((i*bits) % 8)
+            if (i+1)*bits % 8 == 0:
+                data.append(byte)
+                byte = 0
+            self.scope_sample += 1
+        report = ScopeReport(self.scope_seq, self.scope_flags, 0, bytes(data))
+        self.scope_seq = (self.scope_seq + 1) & 0xFFFF
+        return report
+
+    def step(self, now: float) -> float:
+        """Advances device to ‹now›, returns time of next event."""
+        if self.mode == M_INITIALIZING and now >= self.mode_until:
+            self.set_mode(M_NORMAL_OP, now)
+        if self.heartbeat_time is not None and self.mode == M_NORMAL_OP and not self.hb_warned and \
+                now - self.heartbeat_time >= self.dccon_warning:
+            self.hb_warned = True
+            self.hb_stats.warnings += 1
+        if self.heartbeat_time is not None and now - self.heartbeat_time >= self.dccon_timeout:
+            if self.mode == M_NORMAL_OP:
+                self.hb_stats.timeouts += 1
+            self.dcc_on_timeout(f'timeout {self.dccon_timeout*1000:.0f} ms')
+        if self.brt_running() and now >= self.brt_next:
+            self.brt_update(now)
+        if self.dcc_on_time is None and self.relays and not self.brt_running():
+            self.dcc_on_time = now
+        if now >= self.next_state:
+            self.tx_req['state'] = True
+            self.next_state += STATE_PERIOD
+            if self.next_state <= now:
+                self.next_state = now + STATE_PERIOD
+
+        self.poll_tx(now)
+        self.flush(now)
+
+        deadline = self.next_state
+        if self.mode == M_INITIALIZING:
+            deadline = min(deadline, self.mode_until)
+        if self.heartbeat_time is not None:
+            deadline = min(deadline, self.heartbeat_time + self.dccon_timeout)
+            if not self.hb_warned:
+                deadline = min(deadline, self.heartbeat_time + self.dccon_warning)
+        if self.brt_running():
+            deadline = min(deadline, self.brt_next)
+        if self.scope_flags & SCOPE_RUN:
+            deadline = min(deadline, self.scope_next)
+        if self.out_queue:
+            deadline = min(deadline, self.out_queue[0][0])
+        if self.merge_buf:
+            deadline = min(deadline, self.merge_until)
+        if not self.host_connected:
+            deadline = min(deadline, self.next_probe)
+        return deadline
+
+    def poll_tx(self, now: float) -> None:
+        if not self.dtr(now):
+            self.tx_req = dict.fromkeys(self.tx_req, False)  # computer does not listen
+            self.dcc_wave_req.clear()
+            self.lease_ack = None
+            self.hb_report = None
+            self.scope_flags = 0
+            return
+        if now < self.faults.stall_until:
+            return
+        if self.tx_req['info']:
+            self.send_msg(InfoReport(*self.fw_version), now)
+            self.tx_req['info'] = False
+        if self.lease_ack is not None:
+            self.send_msg(self.lease_ack, now)
+            self.lease_ack = None
+        if self.tx_req['state']:
+            warnings = 0
+            if self.heartbeat_time is not None and \
+                    self.dccon_warning <= now - self.heartbeat_time < self.dccon_timeout:
+                warnings |= WARN_TIMEOUT
+            self.send_msg(StateReport(self.mode, self.relays, self.dcc_input, self.failure_code, warnings), now)
+            self.tx_req['state'] = False
+        if self.tx_req['brt']:
+            self.send_msg(BrtReport(self.brt_state, self.brt_step, self.brt_error), now)
+            self.tx_req['brt'] = False
+        if self.tx_req['dcc_stats']:
+            self.send_msg(self.dcc_stats(now), now)
+            self.tx_req['dcc_stats'] = False
+        if self.tx_req['boot_info']:
+            self.send_msg(self.boot_info(now), now)
+            self.tx_req['boot_info'] = False
+        if self.tx_req['crash']:
+            self.send_msg(self.crash_last, now)
+            self.tx_req['crash'] = False
+        if self.hb_report:
+            self.send_msg(self.hb_report, now)
+            self.hb_report = None
+        if self.dcc_wave_req:
+            self.dcc_update(now)
+            for index in self.dcc_wave_req:
+                self.send_msg(self.dcc_inputs[index].wave(index), now)
+            self.dcc_wave_req.clear()
+        while self.scope_flags & SCOPE_RUN and now >= self.scope_next:
+            self.send_msg(self.scope_packet(), now)
+            self.scope_next += self.scope_packet_period()
+
+    ###########################################################################
+    # Transport & faults
+
+    def send_msg(self, msg: NamedTuple, now: float) -> None:
+        self.send(*encode(msg), now)
+
+    def send(self, command_code: int, data: bytes, now: float) -> None:
+        f = self.faults
+        if self.rnd.random() < f.drop:
+            self.stats['dropped_tx'] += 1
+            return
+        self.stats['tx_frames'] += 1
+        frame = encode_frame(command_code, data)
+        if self.rnd.random() < f.garbage:
+            self.stats['garbage'] += 1
+            frame = bytes(self.rnd.choice([0x37, 0xE2, 0x00, 0xFF]) for _ in range(self.rnd.randint(1, 8))) + frame
+        at = max(now + f.delay + (self.rnd.uniform(0, f.jitter) if f.jitter else 0), self.out_last)
+        self.out_last = at
+
+        if f.merge > 0:
+            if not self.merge_buf:
+                self.merge_until = at + f.merge
+            self.merge_buf += frame
+            return
+        if self.rnd.random() < f.split and len(frame) > 1:
+            cut = sorted(self.rnd.sample(range(1, len(frame)), min(2, len(frame)-1)))
+            parts = [frame[i:j] for i, j in zip([0] + cut, cut + [len(frame)])]
+            for i, part in enumerate(parts):
+                self.enqueue(at + i*0.001, part)  # next USB frame
+            return
+        self.enqueue(at, frame)
+
+    def enqueue(self, at: float, data: bytes) -> None:
+        self.out_seq += 1
+        heapq.heappush(self.out_queue, (at, self.out_seq, data))
+
+    def flush(self, now: float) -> None:
+        if self.merge_buf and now >= self.merge_until:
+            self.enqueue(now, self.merge_buf)
+            self.merge_buf = b''
+        while self.out_queue and self.out_queue[0][0] <= now:
+            _, _, data = heapq.heappop(self.out_queue)
+            if self.dtr(now):
+                self.write(data)
+
+    def write(self, data: bytes) -> None:
+        try:
+            os.write(self.master, data)
+        except BlockingIOError:
+            self.stats['dropped_tx'] += 1  # host does not read
+        except OSError as e:
+            if e.errno != errno.EIO:
+                raise
+            self.host_closed(time.monotonic())
+
+    def host_closed(self, now: float) -> None:
+        self.host_connected = False
+        self.next_probe = now + HOST_PROBE_PERIOD
+        self.decoder.reset()
+        self.out_queue.clear()
+        self.merge_buf = b''
+        self.scope_flags = 0
+        self.log(logging.INFO, 'Host closed port (DTR drop)')
+        self.hb_stats.last = None
+        self.hb_report = None
+        if self.mode == M_NORMAL_OP:
+            self.dcc_on_timeout('DTR drop')
+
+    def read(self, now: float) -> None:
+        """Reads from host, detects opening/closing of port by host."""
+        try:
+            data = os.read(self.master, 0x1000)
+        except BlockingIOError:
+            data = None
+        except OSError as e:
+            if e.errno != errno.EIO:
+                raise
+            if self.host_connected:
+                self.host_closed(now)
+            else:
+                self.next_probe = now + HOST_PROBE_PERIOD
+            return
+
+        if not self.host_connected:
+            self.host_connected = True
+            self.stats['host_connects'] += 1
+            self.log(logging.INFO, 'Host opened port')
+        if not data:
+            return
+        if now < self.faults.dtr_until:
+            return
+        for frame in self.decoder.feed(data):
+            if self.rnd.random() < self.faults.drop_rx:
+                self.stats['dropped_rx'] += 1
+                continue
+            self.received(frame.command_code, frame.data, now)
+
+    def fault_dtr(self, duration: float, now: float) -> None:
+        self.faults.dtr_until = now + duration
+        self.log(logging.INFO, f'Simulated DTR drop for {duration} s')
+        self.hb_stats.last = None
+        if self.mode == M_NORMAL_OP:
+            self.dcc_on_timeout('DTR drop')
+
+
+###############################################################################
+# Control
+
+def command(devices: List[SimDevice], line: str, now: float) -> None:
+    line = line.strip()
+    if not line:
+        return
+    targets = devices
+    if ':' in line.split()[0]:
+        index, line = line.split(':', 1)
+        targets = [devices[int(index)]]
+    cmd, *args = line.split()
+
+    for dev in targets:
+        f = dev.faults
+        if cmd == 'delay':
+            f.delay = float(args[0])
+            f.jitter = float(args[1]) if len(args) > 1 else 0.0
+        elif cmd in ('drop', 'droprx', 'garbage', 'split', 'merge'):
+            setattr(f, {'droprx': 'drop_rx'}.get(cmd, cmd), float(args[0]))
+        elif cmd == 'stall':
+            f.stall_until = now + float(args[0])
+        elif cmd == 'dtr':
+            dev.fault_dtr(float(args[0]), now)
+        elif cmd == 'mode':
+            if MODES[args[0]] != M_FAILURE:
+                dev.failure_code = DCFAIL_NOFAILURE
+            dev.set_mode(MODES[args[0]], now)
+        elif cmd == 'dcc':
+            dev.dcc_input = args[0] == 'on'
+            dev.tx_req['state'] = True
+        elif cmd == 'brtfail':
+            dev.brt_fail_next = True
+        elif cmd == 'reset':
+            cause = args[0] if args else 'iwdg'
+            dev.set_relays(False, f'reset ({cause})')
+            dev.reset(RESET_CAUSES[cause], now)
+            dev.log(logging.INFO, f'Reset ({cause}), cached Big relay test pass '
+                    f'{"honoured" if dev.brt_honoured else "not honoured"}')
+        elif cmd == 'crash':
+            cause = args[0] if args else 'hardfault'
+            dev.crash(CRASH_CAUSES.index(cause), now)
+            dev.set_relays(False, f'crash ({cause})')
+            dev.reset(RESET_CAUSES['iwdg'], now)
+            dev.log(logging.INFO, f'Crash ({cause}) & IWDG reset')
+        elif cmd == 'clear':
+            dev.faults = Faults()
+        elif cmd == 'stats':
+            dev.log(logging.INFO, ', '.join(f'{k}={v}' for k, v in dev.stats.items()))
+        else:
+            raise ValueError(f'Unknown command: {cmd}')
+
+
+def main() -> None:
+    args = docopt(__doc__)
+    logging.basicConfig(
+        format='[%(asctime)s] %(levelname)s %(message)s',
+        level=getattr(logging, args['-l'].upper(), logging.INFO),
+        stream=sys.stdout,
+    )
+    rnd = random.Random(args['--seed'])
+    count = int(args['-n'])
+    fw_version = tuple(int(x) for x in args['-f'].split('.'))
+
+    devices = []
+    for i in range(count):
+        faults = Faults()
+        faults.delay = float(args['--delay'])
+        faults.drop = float(args['--drop'])
+        faults.drop_rx = float(args['--droprx'])
+        faults.garbage = float(args['--garbage'])
+        faults.split = float(args['--split'])
+        faults.merge = float(args['--merge'])
+        link = args['--link']
+        if link and count > 1:
+            link += str(i)
+        dev = SimDevice(i, fw_version, faults, rnd, link)
+        devices.append(dev)
+        logging.info(f'[{i}] DC-01 simulated on {dev.slave_name}' + (f' ({link})' if link else ''))
+
+    stdin_open = True
+    stdin_buf = b''
+    try:
+        while True:
+            now = time.monotonic()
+            for dev in devices:
+                if not dev.host_connected and now >= dev.next_probe:
+                    dev.read(now)
+            deadline = min(dev.step(now) for dev in devices)
+
+            rlist = [dev.master for dev in devices if dev.host_connected]
+            if stdin_open:
+                rlist.append(sys.stdin.fileno())
+            readable, _, _ = select.select(rlist, [], [], max(0.0, deadline - time.monotonic()))
+
+            now = time.monotonic()
+            for dev in devices:
+                if dev.master in readable:
+                    dev.read(now)
+            if sys.stdin.fileno() in readable:
+                # Not readline(): lines buffered by sys.stdin would not wake up select
+                received = os.read(sys.stdin.fileno(), 0x1000)
+                if not received:
+                    stdin_open = False
+                    continue
+                *lines, stdin_buf = (stdin_buf + received).split(b'\n')
+                for line in lines:
+                    try:
+                        command(devices, line.decode(), now)
+                    except (ValueError, IndexError, KeyError, UnicodeDecodeError) as e:
+                        logging.error(f'Invalid command: {line.decode(errors="replace").strip()} ({e})')
+    except KeyboardInterrupt:
+        pass
+    finally:
+        for dev in devices:
+            command([dev], 'stats', time.monotonic())
+            dev.close()
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,185 @@
+"""
+Health of control software combined from several sources probed concurrently.
+
+Sources (comma separated), each optionally suffixed by '@<timeout>' in
+seconds:
+  hjop:<host>:<port>       hJOPserver /status is ok (or reports emergency)
+  tcp:<host>:<port>        TCP port accepts connections
+  unix:<path>              Unix socket accepts connections
+  file:<path>:<max_age>    file was modified within <max_age> seconds
+                           (heartbeat touched by other control software)
+
+All sources are probed at once in each round. The round is decided as soon
+as its result cannot change: emergency reported by any hJOP source, quorum
+of sources ok while no hJOP source is pending (it could still report
+emergency, which vetoes the quorum), or too many sources failed. Pending
+probes are cancelled then, so the decision takes as long as the fastest
+decisive answer, at most the longest timeout.
+"""
+
+import asyncio
+import enum
+import os
+import time
+from typing import List, NamedTuple, Optional, Tuple
+from pt_client import PTClient, status_emergency
+
+
+class HealthError(Exception):
+    pass
+
+
+class Result(enum.Enum):
+    OK = 'OK'
+    FAILED = 'failed'
+    EMERGENCY = 'EMERGENCY'
+
+
+class Source:
+    def __init__(self, name: str, timeout: float):
+        self.name = name
+        self.timeout = timeout
+
+    async def probe(self) -> Result:
+        """Raises exception (reported as failure) when the source is not reachable."""
+        raise NotImplementedError
+
+    def close(self) -> None:
+        pass
+
+
+class HjopSource(Source):
+    def __init__(self, name: str, timeout: float, host: str, port: int):
+        super().__init__(name, timeout)
+        self.client = PTClient(host, port, timeout)  # keep-alive connection outlives rounds
+
+    async def probe(self) -> Result:
+        return Result.EMERGENCY if status_emergency(await self.client.get('/status')) else Result.OK
+
+    def close(self) -> None:
+        self.client.close()
+
+
+class TcpSource(Source):
+    def __init__(self, name: str, timeout: float, host: str, port: int):
+        super().__init__(name, timeout)
+        self.host = host
+        self.port = port
+
+    async def probe(self) -> Result:
+        _, writer = await asyncio.open_connection(self.host, self.port)
+        writer.close()
+        return Result.OK
+
+
+class UnixSource(Source):
+    def __init__(self, name: str, timeout: float, path: str):
+        super().__init__(name, timeout)
+        self.path = path
+
+    async def probe(self) -> Result:
+        _, writer = await asyncio.open_unix_connection(self.path)
+        writer.close()
+        return Result.OK
+
+
+class FileSource(Source):
+    def __init__(self, name: str, timeout: float, path: str, max_age: float):
+        super().__init__(name, timeout)
+        self.path = path
+        self.max_age = max_age
+
+    async def probe(self) -> Result:
+        age = time.time() - os.stat(self.path).st_mtime  # mtime is wall clock
+        if age > self.max_age:
+            raise HealthError(f'not modified for {age:.1f} s')
+        return Result.OK
+
+
+def parse_sources(spec: str, default_timeout: float) -> List[Source]:
+    """Raises ValueError for invalid ‹spec›."""
+    sources: List[Source] = []
+    for name in filter(None, (s.strip() for s in spec.split(','))):
+        kind, _, rest = name.partition(':')
+        rest, _, timeout_str = rest.partition('@')
+        timeout = float(timeout_str) if timeout_str else default_timeout
+        if kind in ('hjop', 'tcp'):
+            host, _, port = rest.rpartition(':')
+            if not host:
+                raise ValueError(f'{name}: <host>:<port> expected')
+            sources.append((HjopSource if kind == 'hjop' else TcpSource)(name, timeout, host, int(port)))
+        elif kind == 'unix' and rest:
+            sources.append(UnixSource(name, timeout, rest))
+        elif kind == 'file':
+            path, _, max_age = rest.rpartition(':')
+            if not path:
+                raise ValueError(f'{name}: <path>:<max_age> expected')
+            sources.append(FileSource(name, timeout, path, float(max_age)))
+        else:
+            raise ValueError(f'{name}: unknown health source')
+    if not sources:
+        raise ValueError('no health source')
+    return sources
+
+
+class Probe(NamedTuple):
+    source: Source
+    result: Result
+    latency: float  # seconds
+    error: Optional[str]  # reason of failure
+
+
+class Health:
+    def __init__(self, sources: List[Source], quorum: Optional[int] = None):
+        """‹quorum›: number of sources which must be ok, None = all."""
+        self.sources = sources
+        self.quorum = len(sources) if quorum is None else quorum
+        if not 1 <= self.quorum <= len(sources):
+            raise ValueError(f'quorum must be 1–{len(sources)}')
+
+    async def check(self) -> Tuple[Optional[bool], List[Probe]]:
+        """
+        Returns (emergency, finished probes) as hjopserver_emergency does:
+        False = ok, True = emergency, None = health could not be confirmed.
+        """
+        tasks = {asyncio.create_task(self._probe(source)): source for source in self.sources}
+        pending = set(tasks)
+        probes: List[Probe] = []
+        ok = failed = 0
+        try:
+            while pending:
+                done, pending = await asyncio.wait(pending, return_when=asyncio.FIRST_COMPLETED)
+                for task in done:
+                    probe = task.result()
+                    probes.append(probe)
+                    if probe.result == Result.OK:
+                        ok += 1
+                    else:
+                        failed += 1
+                if any(probe.result == Result.EMERGENCY for probe in probes):
+                    return True, probes
+                if ok >= self.quorum and not any(isinstance(tasks[task], HjopSource) for task in pending):
+                    return False, probes
+                if len(self.sources) - failed < self.quorum:
+                    return None, probes
+            return None, probes
+        finally:
+            for task in pending:
+                task.cancel()
+            if pending:
+                await asyncio.wait(pending)
+
+    @staticmethod
+    async def _probe(source: Source) -> Probe:
+        start = time.monotonic()
+        try:
+            result = await asyncio.wait_for(source.probe(), source.timeout)
+            return Probe(source, result, time.monotonic() - start, None)
+        except asyncio.TimeoutError:
+            return Probe(source, Result.FAILED, time.monotonic() - start, 'timeout')
+        except Exception as e:
+            return Probe(source, Result.FAILED, time.monotonic() - start, str(e) or repr(e))
+
+    def close(self) -> None:
+        for source in self.sources:
+            source.close()
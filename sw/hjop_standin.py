@@ -0,0 +1,123 @@
+#!/usr/bin/env python3
+
+"""
+Local stand-in for hJOPserver PT server (for testing & benchmarking)
+
+Serves /status in the same shape as hJOPserver does. Behavior could be
+changed at runtime via GET /standin?<key>=<value>&..., keys:
+  emergency=0|1     value of trakce.emergency
+  delay=<seconds>   delay of each response
+  silent=0|1        accept requests, but never respond
+
+Usage:
+  hjop_standin.py [options]
+  hjop_standin.py --help
+
+Options:
+  -a <address>       Listen address [default: 127.0.0.1]
+  -p <port>          Listen port [default: 5823]
+  -e --emergency     Start in emergency state
+  -h --help          Show this screen
+"""
+
+import json
+import threading
+import time
+import urllib.parse
+from http.server import ThreadingHTTPServer, BaseHTTPRequestHandler
+from typing import Any, Dict
+from docopt import docopt
+
+
+class StandinState:
+    def __init__(self) -> None:
+        self.emergency = False
+        self.delay = 0.0
+        self.silent = False
+        self.requests = 0
+        self.changed = threading.Event()  # released when silent mode ends
+
+    def status(self) -> Dict[str, Any]:
+        return {
+            'trakce': {
+                'state': 'connected',
+                'emergency': self.emergency,
+                'library': {'name': 'XpressNET', 'version': '2.0'},
+            },
+            'rcs': {'state': 'started', 'modules': [{'addr': i, 'failure': False} for i in range(32)]},
+            'areas': [{'id': f'OR{i}', 'name': f'Area {i}', 'state': 'ok'} for i in range(16)],
+            'server': {'version': '4.0', 'uptime': int(time.monotonic())},
+        }
+
+    def update(self, query: Dict[str, str]) -> None:
+        if 'emergency' in query:
+            self.emergency = query['emergency'] == '1'
+        if 'delay' in query:
+            self.delay = float(query['delay'])
+        if 'silent' in query:
+            self.silent = query['silent'] == '1'
+            if not self.silent:
+                self.changed.set()
+                self.changed = threading.Event()
+
+
+class StandinHandler(BaseHTTPRequestHandler):
+    protocol_version = 'HTTP/1.1'  # keep-alive
+    disable_nagle_algorithm = True  # headers & body are written separately
+    server: 'StandinServer'
+
+    def do_GET(self) -> None:
+        url = urllib.parse.urlsplit(self.path)
+        state = self.server.state
+
+        if url.path == '/standin':
+            state.update(dict(urllib.parse.parse_qsl(url.query)))
+            self._respond(200, {'emergency': state.emergency, 'delay': state.delay, 'silent': state.silent})
+            return
+
+        state.requests += 1
+        if state.silent:
+            state.changed.wait()
+            self.close_connection = True
+            return
+        if state.delay > 0:
+            time.sleep(state.delay)
+        if url.path == '/status':
+            self._respond(200, state.status())
+        else:
+            self._respond(404, {'error': 'not found'})
+
+    def _respond(self, code: int, data: Dict[str, Any]) -> None:
+        body = json.dumps(data).encode('utf-8')
+        self.send_response(code)
+        self.send_header('Content-Type', 'application/json')
+        self.send_header('Content-Length', str(len(body)))
+        self.end_headers()
+        self.wfile.write(body)
+
+    def log_message(self, format: str, *args: Any) -> None:
+        pass
+
+
+class StandinServer(ThreadingHTTPServer):
+    daemon_threads = True
+
+    def __init__(self, address: str, port: int) -> None:
+        super().__init__((address, port), StandinHandler)
+        self.state = StandinState()
+
+    def start(self) -> None:
+        """Serve in background thread."""
+        threading.Thread(target=self.serve_forever, name='hjop-standin', daemon=True).start()
+
+
+def main() -> None:
+    args = docopt(__doc__)
+    server = StandinServer(args['-a'], int(args['-p']))
+    server.state.emergency = args['--emergency']
+    print(f'Serving on {args["-a"]}:{server.server_address[1]}', flush=True)
+    server.serve_forever()
+
+
+if __name__ == '__main__':
+    main()
@@ -12,6 +12,7 @@ Options:
   -s <servername>    hJOPserver address [default: 127.0.0.1]
   -p <port>          hJOPserver PT server port [default: 5823]
   -c <port>          DC-01 serial port
+  --serial <sn>      Use DC-01 with USB serial number <sn> (when more DC-01s are connected)
   -l <loglevel>      Specify loglevel (python logging package) [default: info]
   -m --mock          Mock server - keep output always on
   -h --help          Show this screen
@@ -19,20 +20,51 @@ Options:
   -r --resume        Always try to resume operations, never die (suitable for production deployment)
   --nocolor          Do not print colors to terminal
   -d <dir>           Set logging directory to <dir>
+  --metrics <addr>   Serve Prometheus metrics on http://<addr>/metrics, <addr> = [address:]port
+  --lease <ms>       Lease DCC for <ms> per renewal (FW >= 1.1), 0 = SET_STATE every refresh [default: 2000]
+                     Lease is not renewed while health is not confirmed, DCC stays on until it expires: lease
+                     longer than DC-01 SET_STATE timeout (2000 ms) widens this window
+  --capture <file>   Record serial traffic to binary capture <file> (rotated, analyze by dc01_capture.py)
+  --health <sources> Comma-separated health sources probed concurrently, see health.py (hJOPserver by -s & -p
+                     by default), e.g. hjop:10.0.0.1:5823,hjop:10.0.0.2:5823@0.1,file:/run/hjop.alive:2
+  --quorum <n>       Number of health sources which must be ok, or 'all' [default: all]
+                     (emergency reported by any hJOP source vetoes it, round waits for all of them)
+  --cut-after <n>    Cut DCC after <n> consecutive rounds health was not confirmed [default: 3]
+                     (emergency cuts immediately), 0 = leave it to DC-01 timeout (lease expiry, see --lease)
+  --mux <socket>     Publish DC-01 reports & watchdog events to local clients on Unix <socket>, see mux.py
+  --mux-control <users>  Comma-separated users (names or uids) allowed to cut DCC over --mux socket
+                     (user running watchdog & root by default)
+  --standby <lock>   Hot standby: instances with the same <lock> file elect primary (owns DC-01) by flock,
+                     standby takes over on primary failure without DCC cut, see standby.py
 """
 
 import os
 import sys
+import socket
 from docopt import docopt
 import logging
-from typing import List, Tuple, Dict, Any
+import logging.handlers
+import queue
+from typing import Any, Dict, List, Optional, Tuple, Callable
 import serial
 import datetime
-import urllib.request
-import urllib.error
-import json
 import time
-import socket
+import asyncio
+import threading
+from dc01_link import (
+    FrameDecoder, Frame, encode_frame, encode_lease, decode_report, InfoReport, StateReport, BrtReport,
+    LeaseReport, DccStatsReport, DccWaveReport, BootInfoReport, Report, SerialState, read_serial_state,
+    reset_causes, DC_CMD_PM_INFO_REQ, DC_CMD_PM_SET_STATE, DC_CMD_PM_DCC_STATS, DC_CMD_PM_DCC_WAVE,
+    DC_CMD_PM_BOOT_INFO, DCC_INPUTS, DCC_WAVE_BINS, SERIAL_STATE_VERSION, BOOT_INFO_VERSION, RESET_CAUSES,
+    BOOT_NO_BRT, CrashReport, DC_CMD_PM_CRASH, CRASH_CAUSES, CRASH_FRAME, crash_trail, HbStatsReport,
+    DC_CMD_PM_HB_STATS, HB_GAP_BINS, HB_NO_MARGIN,
+)
+from health import Health, HjopSource, Result, parse_sources
+from metrics import WatchdogMetrics, MetricsServer, parse_address
+from capture import CaptureWriter, CapturedPort
+from hotplug import DeviceWatcher, Reconnect, device_watcher
+from mux import MuxServer, parse_users
+from standby import Standby
 
 if os.name == 'nt':
     import list_ports_windows as list_ports
@@ -46,19 +78,17 @@ APP_VERSION = '1.0'
 DC01_DESCRIPTION = 'DC-01'
 DC01_BAUDRATE = 115200
 REFRESH_PERIOD = 0.25  # seconds
-WHILE_PERIOD = REFRESH_PERIOD/5
-DC01_RECEIVE_TIMEOUT = datetime.timedelta(milliseconds=3*WHILE_PERIOD)
-DC01_RECEIVE_MAGIC = [0x37, 0xE2]
-DC01_SEND_MAGIC = [0x37, 0xE2]
-DC01_OK_VERSIONS = ['1.0']
-
-DC_CMD_PM_INFO_REQ = 0x10
-DC_CMD_PM_SET_STATE = 0x11
-DC_CMD_PM_PING = 0x02
-
-DC_CMD_MP_INFO = 0x10
-DC_CMD_MP_STATE = 0x11
-DC_CMD_MP_BRSTATE = 0x12
+DC01_RECEIVE_TIMEOUT = 0.15  # seconds
+RTT_PROBE_PERIOD = 5  # seconds, only when metrics are served
+DCC_STATS_PERIOD = 5  # seconds, only when metrics are served (FW >= 1.2, ignored by older FW)
+SERIAL_STATE_PERIOD = 0.02  # seconds, reading of modem lines (kept by OS driver, no traffic to DC-01)
+DC01_OK_VERSIONS = ['1.0', '1.1', '1.2']
+DC01_LEASE_VERSION = (1, 1)  # first FW version supporting lease
+RECONNECT_BACKOFF_MIN = 0.05  # seconds
+RECONNECT_BACKOFF_MAX = 3  # seconds
+CONNECTION_STABLE_TIME = 5  # seconds, shorter connection is a failed attempt for backoff
+LOG_QUEUE_SIZE = 1000  # records
+LOG_SUMMARY_PERIOD = 300  # seconds
 
 DC01_MODE = ['mInitializing', 'mNormalOp', 'mOverride', 'mFailure']
 
@@ -84,6 +114,71 @@ class ColorFormatter(logging.Formatter):
         return formatter.format(record)
 
 
+class DeltaFilter(logging.Filter):
+    """
+    Suppresses repeated messages of periodic events (DC-01 state, hJOP
+    status). Such records have ‹delta› key (logging extra): a record is
+    passed only when its message differs from the last one with the same key,
+    or as a summary with repetition count once per ‹summary_period›. Any
+    other record interrupts the sequences, so the next message of each key is
+    passed again.
+    """
+
+    def __init__(self, summary_period: float):
+        super().__init__()
+        self.summary_period = summary_period
+        self._last: Dict[str, str] = {}
+        self._repeated: Dict[str, int] = {}
+        self._next_summary: Dict[str, float] = {}
+
+    def filter(self, record: logging.LogRecord) -> bool:
+        key = getattr(record, 'delta', None)
+        if key is None:
+            if record.levelno > logging.DEBUG:
+                self._last.clear()
+            return True
+
+        message = record.getMessage()
+        if self._last.get(key) != message:
+            self._last[key] = message
+            self._repeated[key] = 0
+            self._next_summary[key] = record.created + self.summary_period
+            return True
+
+        self._repeated[key] += 1
+        if record.created < self._next_summary[key]:
+            return False
+        record.msg, record.args = f'{message} (repeated {self._repeated[key]}x)', None
+        self._repeated[key] = 0
+        self._next_summary[key] = record.created + self.summary_period
+        return True
+
+
+class DroppingQueueHandler(logging.handlers.QueueHandler):
+    """
+    Never blocks: when the queue is full, records are dropped and a warning
+    with their count is queued before the next record.
+    """
+
+    def __init__(self, queue_: queue.Queue):
+        super().__init__(queue_)
+        self.dropped = 0
+        self._unreported = 0
+
+    def enqueue(self, record: logging.LogRecord) -> None:
+        try:
+            if self._unreported:
+                self.queue.put_nowait(logging.makeLogRecord({
+                    'msg': f'{self._unreported} log records dropped (log queue full)',
+                    'levelno': logging.WARNING, 'levelname': 'WARNING',
+                }))
+                self._unreported = 0
+            self.queue.put_nowait(record)
+        except queue.Full:
+            self.dropped += 1
+            self._unreported += 1
+
+
 def supports_color() -> bool:
     """
     Returns True if the running system's terminal supports color, and False
@@ -98,17 +193,18 @@ def supports_color() -> bool:
 ###############################################################################
 # Communication with DC-01
 
-def ports() -> List[Tuple[str, str]]:
-    return [(port.device, port.product) for port in list_ports.comports()]
+def ports() -> List[Tuple[str, str, Optional[str]]]:
+    return [(port.device, port.product, port.serial_number) for port in list_ports.comports()]
 
 
-def dc01_ports() -> List[str]:
-    return [device for device, product in ports() if product == DC01_DESCRIPTION]
+def dc01_ports(serial_number: Optional[str] = None) -> List[str]:
+    return [device for device, product, sn in ports()
+            if product == DC01_DESCRIPTION and serial_number in (None, sn)]
 
 
 def dc01_send(data: List[int], port: serial.Serial) -> None:
-    to_send = DC01_SEND_MAGIC + [len(data)] + data
-    logging.debug(f'< Send: {to_send}')
+    to_send = encode_frame(data[0], bytes(data[1:]))
+    logging.debug(f'< Send: {list(to_send)}')
     port.write(to_send)
 
 
@@ -116,6 +212,11 @@ def dc01_send_relay(state: bool, port: serial.Serial) -> None:
     dc01_send([DC_CMD_PM_SET_STATE, int(state)], port)
 
 
+def dc01_mode(mode: int) -> str:
+    """Mode unknown to this version (newer FW, corrupted report) must not break parsing."""
+    return DC01_MODE[mode] if mode < len(DC01_MODE) else str(mode)
+
+
 def dc01_brtest_state(state: int) -> str:
     match state:
         case 0: return 'not yet run'
@@ -126,113 +227,488 @@ def dc01_brtest_state(state: int) -> str:
         case _: return 'unknown'
 
 
-def dc01_parse(data: List[int]) -> None:
-    logging.debug(f'> Received: {data}')
-    useful_data = data[3:]
+class Lease:
+    """
+    Lease-based heartbeat: DC-01 is asked to keep DCC on for ‹duration_ms›
+    instead of receiving SET_STATE each REFRESH_PERIOD. Lease is renewed
+    ahead of its expiry, only while health is ok: when health gives no result,
+    DCC is cut at expiry (or by FastCut), so lease should not be longer than
+    DC-01 SET_STATE timeout. Expiry is computed conservatively from the time the
+    renewal was sent and the duration granted (clamped) by DC-01.
+    """
 
-    if not useful_data:
-        return
+    def __init__(self, duration_ms: int):
+        self.duration_ms = duration_ms
+        self.supported = False  # DC-01 FW supports lease
+        self.granted_ms = 0
+        self.expiry = 0.0  # loop time
+        self._seq = 0
+        self._pending: Optional[Tuple[int, float]] = None  # (seq, send time) of unconfirmed request
+
+    def active(self) -> bool:
+        return self.supported and self.duration_ms > 0
+
+    def renewal_due(self, now: float) -> bool:
+        remaining = self.expiry - now
+        return remaining <= max((self.granted_ms or self.duration_ms) / 3000, 2*REFRESH_PERIOD)
+
+    def send(self, duration_ms: int, port: serial.Serial, now: float) -> None:
+        """Duration 0 = revoke."""
+        self._seq = (self._seq + 1) & 0xFF
+        self._pending = (self._seq, now)
+        to_send = encode_lease(duration_ms, self._seq)
+        logging.debug(f'< Send: {list(to_send)}')
+        port.write(to_send)
+
+    def confirmed(self, report: LeaseReport) -> None:
+        if self._pending is None or self._pending[0] != report.seq:
+            return  # response to older request
+        sent = self._pending[1]
+        self._pending = None
+        if report.granted_ms == 0:
+            logging.info('Lease revoked')
+        elif report.granted_ms != self.granted_ms:
+            logging.info(f'Lease granted: {report.granted_ms} ms (requested {self.duration_ms} ms)')
+        self.granted_ms = report.granted_ms
+        self.expiry = sent + report.granted_ms / 1000
+
+
+class FastCut:
+    """
+    Explicit cut of DCC when health fails instead of waiting for DC-01 timeout
+    (heartbeat or lease expiry). Emergency cuts immediately, health which could
+    not be confirmed cuts after ‹after› consecutive rounds (hysteresis for
+    transient errors, 0 = never). Cut is resent each round until the next
+    DC-01 state report with DCC disconnected confirms it; latency from the
+    trigger to the confirmation is logged.
+    """
 
-    if useful_data[0] == DC_CMD_MP_STATE and len(useful_data) >= 4:
-        mode = (useful_data[1] >> 4)
-        dcc_connected = bool(useful_data[1] & 1)
-        dcc_at_least_one = bool((useful_data[1] >> 1) & 1)
-        failure_code = useful_data[2]
-        warnings = useful_data[3]
+    def __init__(self, after: int):
+        self.after = after
+        self.cut = False  # cut triggered, health has not recovered since
+        self._unknown = 0  # consecutive rounds health was not confirmed
+        self._trigger: Optional[Tuple[float, str]] = None  # (time, reason) of unconfirmed cut
+
+    def update(self, emergency: Optional[bool], now: float, reason: str = 'emergency') -> bool:
+        """Returns True when SET_STATE 0 (or lease revoke) should be sent. ‹reason› of emergency is logged."""
+        if emergency is False:
+            self.cut = False
+            self._unknown = 0
+            self._trigger = None
+            return False
+        if not emergency:
+            self._unknown += 1
+        if not self.cut:
+            if not emergency:
+                if self.after <= 0 or self._unknown < self.after:
+                    return False
+                reason = f'health not confirmed {self._unknown}x'
+            self.cut = True
+            self._trigger = (now, reason)
+            logging.warning(f'Cutting DCC: {reason}')
+        return self._trigger is not None
+
+    def confirmed(self, dcc_connected: bool, now: float, metrics: WatchdogMetrics) -> None:
+        """DCC state reported by DC-01 (state report or serial state notification)."""
+        if self._trigger is None or dcc_connected:
+            return
+        trigger, reason = self._trigger
+        self._trigger = None
+        logging.warning(f'DCC cut confirmed by DC-01 in {(now-trigger)*1000:.0f} ms ({reason})')
+        metrics.fast_cut(now - trigger)
+
+
+class SerialStateWatch:
+    """
+    Urgent DC-01 state signalled by CDC SERIAL_STATE notifications (see
+    protocol.md). Notifications travel over the USB interrupt endpoint in
+    parallel with reports, OS driver keeps the last one as modem status
+    lines. Lines are valid only when DC-01 FW sends notifications.
+    """
 
-        level = logging.INFO if failure_code == 0 and warnings == 0 and mode == 1 \
+    def __init__(self) -> None:
+        self.supported = False
+        self.state: Optional[SerialState] = None
+
+    def info(self, report: InfoReport) -> None:
+        self.supported = (report.fw_major, report.fw_minor) >= SERIAL_STATE_VERSION
+
+    def update(self, state: SerialState, now: float, metrics: WatchdogMetrics, fast_cut: FastCut,
+               mux: Optional[MuxServer]) -> None:
+        previous, self.state = self.state, state
+        if previous == state:
+            return
+        level = logging.INFO if state.ok and not state.timeout_warning else logging.WARNING
+        logging.log(level, f'Serial state: dcc_connected={state.dcc_connected}, ok={state.ok}, '
+                           f'timeout_warning={state.timeout_warning}')
+        if previous is not None:
+            for line, value, last in zip(state._fields, state, previous):
+                if value != last:
+                    metrics.serial_state_changes.inc(line=line)
+        fast_cut.confirmed(state.dcc_connected, now, metrics)
+        if mux:
+            mux.event('serial_state', state=True, **state._asdict())
+
+
+def dc01_parse(frame: Frame, metrics: WatchdogMetrics, lease: Lease, fast_cut: FastCut,
+               now: float) -> Optional[Report]:
+    if logging.getLogger().isEnabledFor(logging.DEBUG):
+        logging.debug(f'> Received: {frame.command_code:#x} {list(frame.data)}')
+    report = decode_report(frame)
+
+    if isinstance(report, StateReport):
+        metrics.state_report(now, dc01_mode(report.mode), report.mode, report.dcc_connected,
+                             report.failure_code, report.warnings)
+        level = logging.INFO if report.failure_code == 0 and report.warnings == 0 and report.mode == 1 \
             else logging.WARNING
         logging.log(
             level,
-            f'Received: mode={DC01_MODE[mode]}, {dcc_connected=}, '
-            f'{dcc_at_least_one=}, {failure_code=}, {warnings=}'
+            f'Received: mode={dc01_mode(report.mode)}, dcc_connected={report.dcc_connected}, '
+            f'dcc_at_least_one={report.dcc_at_least_one}, failure_code={report.failure_code}, '
+            f'warnings={report.warnings}',
+            extra={'delta': 'dc01_state'}
         )
+        fast_cut.confirmed(report.dcc_connected, now, metrics)
 
-    elif useful_data[0] == DC_CMD_MP_INFO and len(useful_data) >= 3:
-        fw_major, fw_minor = useful_data[1], useful_data[2]
-        fw_version_str = f'{fw_major}.{fw_minor}'
+    elif isinstance(report, InfoReport):
+        if metrics.info_report(now):
+            return report  # response to RTT probe
+        fw_version_str = f'{report.fw_major}.{report.fw_minor}'
         logging.info(f'Received: DC-01 FW=v{fw_version_str}')
         if fw_version_str not in DC01_OK_VERSIONS:
             logging.warning('DC-01 FW version is not supported (outdated version?)!')
+        lease.supported = (report.fw_major, report.fw_minor) >= DC01_LEASE_VERSION
+        if lease.active():
+            logging.info(f'Using lease-based heartbeat: {lease.duration_ms} ms')
+
+    elif isinstance(report, LeaseReport):
+        lease.confirmed(report)
+        metrics.lease_granted(report.granted_ms)
+
+    elif isinstance(report, DccStatsReport):
+        for name, present, stats in zip(DCC_INPUTS, report.present, report.inputs):
+            metrics.dcc_input_stats(name, present, stats.rate, stats.packets, stats.bit_errors,
+                                    stats.checksum_errors)
+        logging.debug(f'Received: DCC stats {report}')
+
+    elif isinstance(report, DccWaveReport) and report.input < len(DCC_INPUTS):
+        metrics.dcc_wave(DCC_INPUTS[report.input], report.present, report.frequency, report.low_permille,
+                         report.cutout_us, report.cutouts, report.losses, report.lost_ms, report.loss_ms,
+                         report.edge_overruns, dict(zip(DCC_WAVE_BINS, report.half_periods)))
+        logging.debug(f'Received: DCC waveform {report}')
+
+    elif isinstance(report, BootInfoReport):
+        causes = reset_causes(report)
+        metrics.boot_info({name: bool(report.reset_cause & (1 << bit)) for bit, name in enumerate(RESET_CAUSES)},
+                          report.resets, report.ready_ms, report.dcc_on_ms)
+        brt = 'none cached' if report.brt_age_s == BOOT_NO_BRT else \
+            f'passed {report.brt_age_s} s ago{" (honoured at boot)" if report.brt_honoured else ""}'
+        logging.log(
+            logging.WARNING if 'iwdg' in causes else logging.INFO,
+            f'Received: DC-01 boot: reset={",".join(causes)}, resets since power-on={report.resets}, '
+            f'ready in {report.ready_ms} ms, DCC on '
+            f'{f"in {report.dcc_on_ms} ms" if report.dcc_on_ms else "not yet"}, Big relay test {brt}'
+        )
+
+    elif isinstance(report, CrashReport):
+        metrics.crash.set(report.cause)
+        if report.cause:
+            cause = CRASH_CAUSES[report.cause] if report.cause < len(CRASH_CAUSES) else report.cause
+            mode = dc01_mode(report.dcmode)
+            frame = ' '.join(f'{name}=0x{value:08X}' for name, value in zip(CRASH_FRAME, report.frame))
+            logging.warning(
+                f'Received: DC-01 crashed before the last reset: {cause} after {report.uptime_ms} ms, mode={mode}, '
+                f'BRTest state={report.brt_state} step={report.brt_step}, {frame}, CFSR=0x{report.cfsr:08X} '
+                f'HFSR=0x{report.hfsr:08X} MMFAR=0x{report.mmfar:08X} BFAR=0x{report.bfar:08X}, '
+                f'trail: {" ".join(crash_trail(report))}'
+            )
+        else:
+            logging.debug('Received: DC-01 did not crash before the last reset')
+
+    elif isinstance(report, HbStatsReport):
+        margin = report.min_margin_ms if report.min_margin_ms != HB_NO_MARGIN else None
+        metrics.hb_stats(report.worst_gap_ms, margin, report.warnings, report.timeouts, report.period_ms,
+                         dict(zip(HB_GAP_BINS, report.gaps)))
+        logging.debug(f'Received: DC-01 heartbeat stats {report}')
 
-    elif useful_data[0] == DC_CMD_MP_BRSTATE and len(useful_data) >= 4:
-        state, step, error = useful_data[1:4]
-        logging.info(f'Received: BRTest state: {dc01_brtest_state(state)}, {step=}, {error=}')
+    elif isinstance(report, BrtReport):
+        logging.info(f'Received: BRTest state: {dc01_brtest_state(report.state)}, step={report.step}, '
+                     f'error={report.error}')
+
+    return report
 
 
 ###############################################################################
 # Communication with hJOP
 
 
-def pt_get(path: str, server: str, port: int) -> Dict[str, Any]:
-    logging.debug(f'PT GET {path}')
-    logging.debug(f'{server=}, {port=}')
-    if not path.startswith('/'):
-        path = '/' + path
+def health_from_args(args) -> Health:
+    """Raises ValueError for invalid sources or quorum."""
+    spec = args['--health'] or f'hjop:{args["-s"]}:{args["-p"]}'
+    quorum = None if args['--quorum'] == 'all' else int(args['--quorum'])
+    return Health(parse_sources(spec, REFRESH_PERIOD), quorum)
+
+
+async def health_emergency(health: Health, metrics: WatchdogMetrics) -> Optional[bool]:
+    """Returns None when health of control software could not be confirmed."""
+    start = time.monotonic()
+    emergency, probes = await health.check()
+    metrics.health_decision.observe(time.monotonic() - start)
+    metrics.health_verdicts.inc(verdict={False: 'ok', True: 'emergency', None: 'unknown'}[emergency])
+
+    for probe in probes:
+        name = probe.source.name
+        hjop = isinstance(probe.source, HjopSource)
+        if probe.error is not None:
+            logging.info(f'Unable to check {name}: {probe.error}', extra={'delta': f'health {name}'})
+            metrics.health_failures.inc(source=name)
+            if hjop:
+                metrics.hjop_failures.inc()
+            continue
+        logging.debug(f'{name} check latency: {probe.latency*1000:.1f} ms')
+        logging.info(f'{name} {probe.result.value}', extra={'delta': f'health {name}'})
+        if hjop:
+            metrics.hjop_latency.observe(probe.latency)
+            if probe.result == Result.EMERGENCY:
+                metrics.hjop_emergency.inc()
+    return emergency
+
+
+###############################################################################
+# main
+
+def dc01_add_reader(ser: serial.Serial, on_data: Callable[[bytes], None],
+                    on_error: Callable[[Exception], None]) -> Callable[[], None]:
+    """
+    Calls ‹on_data› from the running event loop as soon as any data arrive
+    to ‹ser›. Returns function which stops reading.
+
+    On POSIX, serial port fd is watched by the loop directly. On Windows,
+    serial port cannot be waited for by selectors, so blocking reader thread
+    hands received data over to the loop.
+    """
+    loop = asyncio.get_running_loop()
+
+    if os.name != 'nt':
+        def readable() -> None:
+            try:
+                received = ser.read(0x100)  # timeout=0 = opened in non-blocking mode
+            except serial.serialutil.SerialException as e:
+                loop.remove_reader(ser.fileno())
+                on_error(e)
+                return
+            if received:
+                on_data(received)
+
+        fd = ser.fileno()
+        loop.add_reader(fd, readable)
+        return lambda: loop.remove_reader(fd)
+
+    stop = threading.Event()
+    ser.timeout = REFRESH_PERIOD  # only to check ‹stop› periodically
+
+    def reader() -> None:
+        while not stop.is_set():
+            try:
+                received = ser.read(1)
+                if received and ser.in_waiting:
+                    received += ser.read(ser.in_waiting)
+            except serial.serialutil.SerialException as e:
+                if not stop.is_set():
+                    loop.call_soon_threadsafe(on_error, e)
+                return
+            if received:
+                loop.call_soon_threadsafe(on_data, received)
 
-    req = urllib.request.Request(
-        f'http://{server}:{port}{path}',
-        headers={
-            'Content-type': 'application/json',
-        },
-        method='GET',
-    )
-    with urllib.request.urlopen(req, timeout=REFRESH_PERIOD) as response:
-        data = response.read().decode('utf-8')
-    return json.loads(data)  # type: ignore
+    thread = threading.Thread(target=reader, name='dc01-reader', daemon=True)
+    thread.start()
+    return stop.set
 
 
-def hjopserver_ok(server: str, port: int) -> bool:
+async def heartbeat(ser: serial.Serial, args, metrics: WatchdogMetrics, lease: Lease, fast_cut: FastCut,
+                    mux: Optional[MuxServer], standby: Optional[Standby]) -> None:
+    """
+    Sends SET_STATE each REFRESH_PERIOD when hJOP is ok. When DC-01 supports
+    lease, the lease is renewed only when its expiry approaches. DCC is cut
+    explicitly (lease revoked) on emergency or persistent health failure, see
+    FastCut. Cut requested by a control client of multiplexer is handled as
+    emergency until released. Primary of hot standby stamps each heartbeat
+    to the lock file. Timing is based on monotonic loop clock, so it is immune to
+    wall-clock changes. Health sources are probed concurrently, each hJOP
+    over single keep-alive connection.
+    """
+    loop = asyncio.get_running_loop()
+    health = health_from_args(args)
+    next_poll = loop.time()
+    verdict = None
     try:
-        response = pt_get('/status', server, port)
-        emergency = response['trakce']['emergency']
-        logging.info('hJOP EMERGENCY' if emergency else 'hJOP OK')
-        return not emergency
-    except (urllib.error.URLError, urllib.error.HTTPError, socket.error) as e:
-        logging.info(f'Unable to read hJOPserver status: {e}')
-        return False
+        while True:
+            emergency = False if args['--mock'] else await health_emergency(health, metrics)
+            now = loop.time()
+            reason = 'emergency'
+            if mux:
+                if verdict != (verdict := {False: 'ok', True: 'emergency', None: 'unknown'}[emergency]):
+                    mux.event('health', state=True, verdict=verdict)
+                if mux.cut_by is not None:
+                    emergency = True
+                    reason = f'cut by {mux.cut_by} over multiplexer'
+            if emergency is False:
+                if not lease.active():
+                    dc01_send_relay(True, ser)
+                    metrics.heartbeat_sent(now)
+                    if standby:
+                        standby.heartbeat(now, metrics)
+                elif lease.renewal_due(now):
+                    lease.send(lease.duration_ms, ser, now)
+                    metrics.lease_renewed(now)
+                    if standby:
+                        standby.heartbeat(now, metrics)
+            if fast_cut.update(emergency, now, reason):
+                if lease.active():
+                    lease.send(0, ser, now)  # revoke
+                else:
+                    dc01_send_relay(False, ser)
 
+            # Check could take long, do not try to catch up missed periods
+            next_poll = max(next_poll + REFRESH_PERIOD, loop.time())
+            await asyncio.sleep(next_poll - loop.time())
+    finally:
+        health.close()
 
-###############################################################################
-# main
 
-def run(dc01_port: str, args) -> None:
-    logging.info(f'Connecting to {dc01_port}...')
-    ser = serial.Serial(port=dc01_port, baudrate=DC01_BAUDRATE, timeout=0)
-    dc01_send([DC_CMD_PM_INFO_REQ], ser)  # Get DC-01 info
+async def rtt_probe(ser: serial.Serial, metrics: WatchdogMetrics) -> None:
+    """Measures serial RTT by periodic information request."""
+    loop = asyncio.get_running_loop()
+    while True:
+        await asyncio.sleep(RTT_PROBE_PERIOD)
+        metrics.rtt_probe_sent(loop.time())
+        dc01_send([DC_CMD_PM_INFO_REQ], ser)
+
 
-    receive_buf: List[int] = []
-    next_poll = datetime.datetime.now()
-    last_receive_time = datetime.datetime.now()
+async def dcc_stats_poll(ser: serial.Serial) -> None:
+    """Requests statistics of DC-01 DCC decoders, waveform metrics of inputs & heartbeat statistics
+    for metrics (heartbeat statistics are never reset, mux clients could read them)."""
     while True:
-        received = ser.read(0x100)  # timeout=0 = opened in non-blocking mode
-
-        if datetime.datetime.now() >= next_poll:
-            next_poll = datetime.datetime.now() + datetime.timedelta(seconds=REFRESH_PERIOD)
-            if args['--mock'] or hjopserver_ok(args['-s'], int(args['-p'])):
-                dc01_send_relay(True, ser)
-
-        if received:
-            if receive_buf and datetime.datetime.now()-last_receive_time > DC01_RECEIVE_TIMEOUT:
-                logging.debug('Clearing data, timeout!')
-                receive_buf.clear()
-            last_receive_time = datetime.datetime.now()
-            receive_buf += received
-            while (len(receive_buf) >= len(DC01_RECEIVE_MAGIC) and
-                   receive_buf[0:len(DC01_RECEIVE_MAGIC)] != DC01_RECEIVE_MAGIC):
-                logging.debug(f'Popping packet: {receive_buf[0]}')
-                receive_buf.pop(0)
-
-            while len(receive_buf) >= 3 and len(receive_buf) >= receive_buf[2]+3:
-                packet_length = receive_buf[len(DC01_RECEIVE_MAGIC)]+3
-                dc01_parse(receive_buf[0:packet_length])
-                receive_buf = receive_buf[packet_length:]
-                while (len(receive_buf) >= len(DC01_RECEIVE_MAGIC) and
-                       receive_buf[0:len(DC01_RECEIVE_MAGIC)] != DC01_RECEIVE_MAGIC):
-                    logging.debug(f'Popping packet: {receive_buf[0]}')
-                    receive_buf.pop(0)
-
-        time.sleep(WHILE_PERIOD)
+        await asyncio.sleep(DCC_STATS_PERIOD)
+        dc01_send([DC_CMD_PM_DCC_STATS], ser)
+        for input in range(len(DCC_INPUTS)):
+            dc01_send([DC_CMD_PM_DCC_WAVE, input], ser)
+        dc01_send([DC_CMD_PM_HB_STATS, 0], ser)
+
+
+async def serial_state_poll(ser: serial.Serial, watch: SerialStateWatch, metrics: WatchdogMetrics,
+                            fast_cut: FastCut, mux: Optional[MuxServer]) -> None:
+    """Reads modem status lines, so urgent changes are not queued behind reports."""
+    loop = asyncio.get_running_loop()
+    while True:
+        await asyncio.sleep(SERIAL_STATE_PERIOD)
+        if not watch.supported:
+            continue
+        try:
+            state = read_serial_state(ser)
+        except (OSError, serial.SerialException) as e:
+            logging.info(f'Serial state not available ({e}), using reports only')
+            await loop.create_future()  # task must not finish, see run
+        watch.update(state, loop.time(), metrics, fast_cut, mux)
+
+
+async def run(dc01_port: str, args, metrics: WatchdogMetrics, capture: Optional[CaptureWriter],
+              reconnect: Reconnect, mux: Optional[MuxServer], standby: Optional[Standby]) -> None:
+    logging.info(f'Connecting to {dc01_port}...', extra={'delta': 'discovery'})
+    ser = serial.Serial(port=dc01_port, baudrate=DC01_BAUDRATE, timeout=0)
+    metrics.connected()  # failed open is not a connection, disconnected() would not follow
+    reconnected = reconnect.connected(time.monotonic())
+    if reconnected:
+        logging.info(f'Reconnected in {reconnected[0]*1000:.0f} ms ({reconnected[1]} failed attempts)')
+        metrics.reconnect_time.observe(reconnected[0])
+    if capture:
+        capture.opened(dc01_port)
+        ser = CapturedPort(ser, capture)
+    loop = asyncio.get_running_loop()
+    failed: asyncio.Future = loop.create_future()
+
+    decoder = FrameDecoder()
+    lease = Lease(int(args['--lease']))
+    fast_cut = FastCut(int(args['--cut-after']))
+    serial_state = SerialStateWatch()
+    boot_info_requested = False
+    last_receive_time = loop.time()
+
+    def on_data(received: bytes) -> None:
+        nonlocal last_receive_time, boot_info_requested
+        if decoder.pending() and loop.time()-last_receive_time > DC01_RECEIVE_TIMEOUT:
+            logging.debug('Clearing data, timeout!')
+            decoder.reset()
+        last_receive_time = loop.time()
+        if capture:
+            capture.rx(received, last_receive_time)
+        resyncs, garbage_bytes = decoder.resyncs, decoder.garbage_bytes
+        for frame in decoder.feed(received):
+            report = dc01_parse(frame, metrics, lease, fast_cut, last_receive_time)
+            if isinstance(report, InfoReport):
+                serial_state.info(report)
+                if not boot_info_requested and (report.fw_major, report.fw_minor) >= BOOT_INFO_VERSION:
+                    boot_info_requested = True
+                    try:
+                        dc01_send([DC_CMD_PM_BOOT_INFO], ser)
+                        dc01_send([DC_CMD_PM_CRASH], ser)
+                    except serial.serialutil.SerialException as e:
+                        on_error(e)
+            if mux and report is not None:
+                mux.report(report)
+        if decoder.resyncs != resyncs:
+            logging.debug(f'Resynchronized, garbage bytes total: {decoder.garbage_bytes}')
+            metrics.resyncs.inc(decoder.resyncs - resyncs)
+            metrics.garbage_bytes.inc(decoder.garbage_bytes - garbage_bytes)
+
+    def on_error(e: Exception) -> None:
+        if not failed.done():
+            failed.set_exception(e)
+
+    def mux_request(cmd: str, message: Dict[str, Any]) -> None:
+        """Report request of multiplexer client (validated by MuxServer), reports are published."""
+        try:
+            if cmd == 'dcc_stats':
+                dc01_send([DC_CMD_PM_DCC_STATS], ser)
+            elif cmd == 'dcc_wave':
+                dc01_send([DC_CMD_PM_DCC_WAVE, message['input']], ser)
+            elif cmd == 'boot_info':
+                dc01_send([DC_CMD_PM_BOOT_INFO], ser)
+            elif cmd == 'crash':
+                dc01_send([DC_CMD_PM_CRASH], ser)
+            elif cmd == 'hb_stats':
+                dc01_send([DC_CMD_PM_HB_STATS, int(message.get('reset', False))], ser)
+        except serial.serialutil.SerialException as e:
+            on_error(e)
+
+    stop_reading = dc01_add_reader(ser, on_data, on_error)
+    tasks = [
+        asyncio.create_task(heartbeat(ser, args, metrics, lease, fast_cut, mux, standby)),
+        asyncio.create_task(serial_state_poll(ser, serial_state, metrics, fast_cut, mux)),
+    ]
+    if mux:
+        mux.attach(loop, mux_request)
+        mux.event('connected', state=True, port=dc01_port)
+    if args['--metrics']:
+        tasks.append(asyncio.create_task(rtt_probe(ser, metrics)))
+        tasks.append(asyncio.create_task(dcc_stats_poll(ser)))
+    try:
+        metrics.info_requested()
+        dc01_send([DC_CMD_PM_INFO_REQ], ser)  # Get DC-01 info
+        done, _ = await asyncio.wait([failed, *tasks], return_when=asyncio.FIRST_COMPLETED)
+        for future in done:
+            future.result()  # raise exception
+    finally:
+        stop_reading()
+        for task in tasks:
+            task.cancel()
+        ser.close()
+        metrics.disconnected()
+        if mux:
+            mux.detach()
+            mux.event('disconnected', state=True)
+        if capture:
+            capture.closed()
 
 
 def main() -> None:
@@ -256,7 +732,7 @@ def main() -> None:
     color = not args['--nocolor'] and supports_color()
     formatter = ColorFormatter if color else logging.Formatter
     streamHandler.setFormatter(formatter(logformat))
-    logging.getLogger().addHandler(streamHandler)
+    handlers: List[logging.Handler] = [streamHandler]
 
     if args['-d']:
         # Add file handler
@@ -265,29 +741,104 @@ def main() -> None:
         filename = os.path.join(args['-d'], datetime.datetime.now().strftime('%Y-%m-%d')+'.log')
         fileHandler = logging.FileHandler(filename)
         fileHandler.setFormatter(logging.Formatter(logformat))
-        logging.getLogger().addHandler(fileHandler)
+        handlers.append(fileHandler)
+
+    # Terminal & file are written from listener thread, so slow disk does not delay heartbeat
+    queueHandler = DroppingQueueHandler(queue.Queue(LOG_QUEUE_SIZE))
+    if loglevel > logging.DEBUG:
+        queueHandler.addFilter(DeltaFilter(LOG_SUMMARY_PERIOD))
+    logging.getLogger().addHandler(queueHandler)
+    listener = logging.handlers.QueueListener(queueHandler.queue, *handlers)
+    listener.start()
+    try:
+        watchdog_main(args)
+    finally:
+        listener.stop()
 
-    while True:
-        if not args['-c']:
-            logging.info('Looking for DC-01...')
-        _ports = [args['-c']] if args['-c'] else dc01_ports()
-
-        if len(_ports) < 1:
-            logging.error('No DC-01 found!')
-        elif len(_ports) > 1:
-            logging.error('Multiple DC-01s found!')
-        else:
-            try:
-                run(_ports[0], args)
-            except serial.serialutil.SerialException as e:
-                logging.error(f'SerialException: {e}')
-            except Exception as e:
-                if args['-r']:
-                    logging.error(f'Exception: {e}')
-                else:
-                    raise
 
-        time.sleep(3)  # sleep before reconnect
+def watchdog_main(args) -> None:
+    try:
+        health_from_args(args).close()
+    except ValueError as e:
+        sys.exit(f'Invalid health sources: {e}')
+    if not args['--cut-after'].isdigit():
+        sys.exit('--cut-after must be a non-negative integer')
+
+    metrics = WatchdogMetrics(REFRESH_PERIOD)
+    if args['--metrics']:
+        address, port = parse_address(args['--metrics'])
+        MetricsServer(address, port, metrics.registry).start()
+        logging.info(f'Serving metrics on http://{address}:{port}/metrics')
+
+    standby = None
+    if args['--standby']:
+        if os.name == 'nt':
+            sys.exit('--standby is not supported on this platform')
+        standby = Standby(args['--standby'])
+        metrics.standby.set(1)
+        standby.wait_primary(lambda: [args['-c']] if args['-c'] else dc01_ports(args['--serial']))
+        metrics.standby.set(0)
+        logging.info(f'Primary (lock {args["--standby"]})')
+
+    mux = None
+    if args['--mux']:
+        if not hasattr(socket, 'AF_UNIX'):
+            sys.exit('--mux is not supported on this platform (Unix sockets required)')
+        try:
+            control = parse_users(args['--mux-control']) if args['--mux-control'] else {os.getuid(), 0}
+            mux = MuxServer(args['--mux'], control, metrics)
+        except (ValueError, OSError) as e:
+            sys.exit(f'Unable to serve multiplexer: {e}')
+        mux.start()
+        logging.info(f'Serving multiplexer on {args["--mux"]}')
+
+    capture = CaptureWriter(args['--capture']) if args['--capture'] else None
+    try:
+        watchdog_loop(args, metrics, capture, mux, standby)
+    finally:
+        if capture:
+            capture.close()
+        if mux:
+            mux.close()
+        if standby:
+            standby.close()
+
+
+def watchdog_loop(args, metrics: WatchdogMetrics, capture: Optional[CaptureWriter],
+                  mux: Optional[MuxServer], standby: Optional[Standby]) -> None:
+    """
+    Lost DC-01 is reopened immediately, repeated failures are retried with
+    exponential backoff, but as soon as a device appears (hotplug), it is
+    tried without waiting for the rest of the backoff.
+    """
+    watcher: DeviceWatcher = device_watcher(args['-c'])
+    reconnect = Reconnect(RECONNECT_BACKOFF_MIN, RECONNECT_BACKOFF_MAX, CONNECTION_STABLE_TIME)
+    try:
+        while True:
+            if not args['-c']:
+                logging.info('Looking for DC-01...', extra={'delta': 'discovery'})
+            _ports = [args['-c']] if args['-c'] else dc01_ports(args['--serial'])
+
+            if len(_ports) < 1:
+                logging.error('No DC-01 found!', extra={'delta': 'discovery_result'})
+            elif len(_ports) > 1:
+                logging.error('Multiple DC-01s found!', extra={'delta': 'discovery_result'})
+            else:
+                try:
+                    asyncio.run(run(_ports[0], args, metrics, capture, reconnect, mux, standby))
+                except serial.serialutil.SerialException as e:
+                    logging.error(f'SerialException: {e}', extra={'delta': 'discovery_result'})
+                except Exception as e:
+                    if args['-r']:
+                        logging.error(f'Exception: {e}')
+                    else:
+                        raise
+
+            delay = reconnect.failed(time.monotonic())
+            if delay > 0:
+                watcher.wait(delay)  # sleep before reconnect
+    finally:
+        watcher.close()
 
 
 if __name__ == '__main__':
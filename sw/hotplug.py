@@ -0,0 +1,123 @@
+"""
+Waiting for (re)appearance of DC-01 and reconnect timing.
+
+DeviceWatcher.wait() returns as soon as something changes in watched
+directories (/dev, directory of the port given explicitly...), so DC-01 is
+reopened right after udev creates its device node. On Linux, inotify is used
+(via libc, no dependency), elsewhere or when inotify is not available,
+wait() just sleeps for POLL_PERIOD and the caller re-enumerates ports.
+
+Reconnect implements the retry policy: when a working connection is lost,
+the port is reopened immediately. Only repeated failures are delayed by
+exponential backoff. Time from the loss to the next successful open is
+reported.
+"""
+
+import ctypes
+import os
+import select
+import time
+from typing import List, Optional, Tuple
+
+POLL_PERIOD = 0.5  # seconds
+
+IN_ATTRIB = 0x00000004  # udev changes permissions after the node is created
+IN_MOVED_TO = 0x00000080
+IN_CREATE = 0x00000100
+IN_DELETE = 0x00000200
+IN_NONBLOCK = 0o4000
+IN_CLOEXEC = 0o2000000
+IN_MASK = IN_ATTRIB | IN_MOVED_TO | IN_CREATE | IN_DELETE
+
+
+class DeviceWatcher:
+    """Polling fallback."""
+
+    def wait(self, timeout: float) -> bool:
+        """Returns True if there might be a change in devices."""
+        time.sleep(min(timeout, POLL_PERIOD))
+        return True
+
+    def close(self) -> None:
+        pass
+
+
+class InotifyWatcher(DeviceWatcher):
+    def __init__(self, dirs: List[str]):
+        libc = ctypes.CDLL(None, use_errno=True)
+        self._fd = libc.inotify_init1(IN_NONBLOCK | IN_CLOEXEC)
+        if self._fd < 0:
+            raise OSError(ctypes.get_errno(), 'inotify_init1')
+        watched = 0
+        for path in dirs:
+            if libc.inotify_add_watch(self._fd, os.fsencode(path), IN_MASK) >= 0:
+                watched += 1
+        if watched == 0:
+            os.close(self._fd)
+            raise OSError(ctypes.get_errno(), 'inotify_add_watch')
+
+    def wait(self, timeout: float) -> bool:
+        readable, _, _ = select.select([self._fd], [], [], timeout)
+        if not readable:
+            return False
+        try:
+            while os.read(self._fd, 0x1000):  # drop events, caller re-enumerates anyway
+                pass
+        except BlockingIOError:
+            pass
+        return True
+
+    def close(self) -> None:
+        os.close(self._fd)
+
+
+def device_watcher(port: Optional[str]) -> DeviceWatcher:
+    """Watches /dev, /dev/serial/by-id and directory of ‹port›."""
+    if not hasattr(os, 'uname') or os.uname().sysname != 'Linux':
+        return DeviceWatcher()
+    dirs = ['/dev', '/dev/serial/by-id']
+    if port:
+        dirs.append(os.path.dirname(os.path.abspath(port)))
+    try:
+        return InotifyWatcher([path for path in dirs if os.path.isdir(path)])
+    except (OSError, AttributeError):
+        return DeviceWatcher()
+
+
+class Reconnect:
+    def __init__(self, backoff_min: float, backoff_max: float, stable_time: float):
+        """
+        Connection is considered working when it lasted at least
+        ‹stable_time›, otherwise its loss counts as failed attempt.
+        """
+        self.backoff_min = backoff_min
+        self.backoff_max = backoff_max
+        self.stable_time = stable_time
+        self.delay = 0.0
+        self.attempts = 0  # failed since the loss
+        self._lost: Optional[float] = None
+        self._connected: Optional[float] = None
+
+    def failed(self, now: float) -> float:
+        """
+        Connection attempt failed or connection was lost. Returns delay before
+        next attempt.
+        """
+        if self._connected is not None:
+            stable = now - self._connected >= self.stable_time
+            self._connected = None
+            self._lost = now
+            self.attempts = 0
+            if stable:
+                self.delay = 0.0
+                return self.delay
+        self.attempts += 1
+        self.delay = min(max(2*self.delay, self.backoff_min), self.backoff_max)
+        return self.delay
+
+    def connected(self, now: float) -> Optional[Tuple[float, int]]:
+        """Returns (time to reconnect, failed attempts) if connection was lost before."""
+        result = None if self._lost is None else (now - self._lost, self.attempts)
+        self._lost = None
+        self._connected = now
+        return result
@@ -0,0 +1,44 @@
+/* C interface of libdc01 (used by Python bindings, see sw/dc01_native.py). */
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct dc01_decoder dc01_decoder;
+
+typedef struct {
+	uint8_t command_code;
+	uint8_t size; // number of data bytes
+	uint16_t offset; // offset of data in decoder's buffer
+} dc01_frame;
+
+dc01_decoder *dc01_decoder_new(void);
+void dc01_decoder_free(dc01_decoder *decoder);
+void dc01_decoder_reset(dc01_decoder *decoder);
+size_t dc01_decoder_pending(const dc01_decoder *decoder);
+
+/* Decoder's buffer is fixed: data of returned frames are located at
+ * buffer+offset and are valid until next call of dc01_decoder_feed. */
+const uint8_t *dc01_decoder_buffer(const dc01_decoder *decoder, size_t *size);
+
+/* Decodes at most ‹max_frames› frames into ‹frames›, returns number of
+ * decoded frames. Data are consumed only until first frame is decoded
+ * (‹*consumed› is set): call it repeatedly with the rest of ‹data› until it
+ * returns 0. */
+size_t dc01_decoder_feed(dc01_decoder *decoder, const uint8_t *data, size_t size,
+                         dc01_frame *frames, size_t max_frames, size_t *consumed);
+
+void dc01_decoder_stats(const dc01_decoder *decoder, uint64_t *frames, uint64_t *resyncs,
+                        uint64_t *garbage_bytes);
+
+/* Returns number of bytes written to ‹out›, 0 if it does not fit. */
+size_t dc01_encode(uint8_t command_code, const uint8_t *data, size_t size, uint8_t *out, size_t out_size);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,58 @@
+/* Incremental decoder of DC-01 packets.
+ *
+ * Received bytes are copied once into a fixed-size buffer, frames point into
+ * this buffer. Garbage between packets is skipped with memchr.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include "dc01_proto.hpp"
+
+namespace dc01 {
+
+struct DecoderStats {
+	uint64_t frames = 0;
+	uint64_t resyncs = 0;
+	uint64_t garbage_bytes = 0;
+};
+
+class Decoder {
+public:
+	static constexpr size_t CAPACITY = 0x1000;
+
+	// Calls ‹on_frame(const Frame&)› for each complete packet in ‹data›.
+	template <typename F>
+	void feed(const uint8_t *data, size_t size, F &&on_frame) {
+		while (size > 0) {
+			size_t count = append(data, size);
+			data += count;
+			size -= count;
+			Frame frame;
+			while (next(frame))
+				on_frame(frame);
+		}
+	}
+
+	// Low-level interface: ‹append› copies as much data as fits to the buffer
+	// (returns number of bytes copied), ‹next› extracts single frame.
+	size_t append(const uint8_t *data, size_t size);
+	bool next(Frame &frame);
+
+	void reset(); // drop unfinished packet
+	size_t pending() const { return m_end - m_start; }
+	const DecoderStats &stats() const { return m_stats; }
+	const uint8_t *buffer() const { return m_buf.data(); }
+
+private:
+	std::array<uint8_t, CAPACITY> m_buf;
+	size_t m_start = 0; // first unprocessed byte
+	size_t m_end = 0; // end of received data
+	DecoderStats m_stats;
+
+	void drop(size_t count);
+};
+
+} // namespace dc01
@@ -0,0 +1,23 @@
+/* Minimal logging in the same format as hjop_watchdog.py. */
+
+#pragma once
+
+#include <string>
+
+namespace dc01 {
+
+enum class LogLevel {
+	Debug = 10,
+	Info = 20,
+	Warning = 30,
+	Error = 40,
+	Critical = 50,
+};
+
+extern LogLevel log_level;
+
+void log(LogLevel level, const std::string &message);
+bool log_enabled(LogLevel level);
+bool log_level_from_str(const std::string &name, LogLevel &level);
+
+} // namespace dc01
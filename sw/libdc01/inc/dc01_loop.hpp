@@ -0,0 +1,48 @@
+/* Single-threaded event loop based on epoll & timerfd.
+ *
+ * All timers use CLOCK_MONOTONIC, so they are immune to wall-clock changes.
+ * Exception thrown from a callback is propagated out of ‹run›.
+ */
+
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <unordered_map>
+
+namespace dc01 {
+
+using Clock = std::chrono::steady_clock;
+
+class EventLoop {
+public:
+	using FdCallback = std::function<void(uint32_t events)>;
+	using TimerCallback = std::function<void()>;
+
+	EventLoop();
+	~EventLoop();
+	EventLoop(const EventLoop &) = delete;
+	EventLoop &operator=(const EventLoop &) = delete;
+
+	void add(int fd, uint32_t events, FdCallback callback);
+	void modify(int fd, uint32_t events);
+	void remove(int fd);
+
+	// Returns timer id. Zero ‹period› = one-shot timer.
+	int add_timer(Clock::duration first, Clock::duration period, TimerCallback callback);
+	void set_timer(int id, Clock::duration first, Clock::duration period);
+	void stop_timer(int id) { set_timer(id, Clock::duration::zero(), Clock::duration::zero()); }
+	void remove_timer(int id);
+
+	void run();
+	void stop() { m_running = false; }
+
+private:
+	int m_epfd;
+	bool m_running = false;
+	std::unordered_map<int, std::shared_ptr<FdCallback>> m_callbacks;
+};
+
+} // namespace dc01
@@ -0,0 +1,52 @@
+/* DC-01 ↔ PC protocol definitions & packet encoding/decoding.
+ * See fw/doc/protocol.md for protocol description. Command codes (DC_CMD_*)
+ * & message codecs come from fw/inc/dc01_proto.h generated from the schema,
+ * only framing is implemented here.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <optional>
+#include <vector>
+#include "dc01_proto.h"
+
+namespace dc01 {
+
+constexpr uint8_t MAGIC1 = 0x37;
+constexpr uint8_t MAGIC2 = 0xE2;
+constexpr size_t HEADER_SIZE = 3; // magic + length
+constexpr size_t MAX_PACKET_SIZE = HEADER_SIZE + 0xFF;
+
+enum class Mode : uint8_t {
+	Initializing = 0,
+	NormalOp = 1,
+	Override = 2,
+	Failure = 3,
+};
+
+// Data of frame point to decoder's buffer, valid only until next frame is decoded.
+struct Frame {
+	uint8_t command_code;
+	const uint8_t *data;
+	size_t size;
+};
+
+using InfoReport = Dc01InfoReport;
+using StateReport = Dc01StateReport;
+using BrtReport = Dc01BrtReport;
+
+std::optional<InfoReport> decode_info(const Frame &frame);
+std::optional<StateReport> decode_state(const Frame &frame);
+std::optional<BrtReport> decode_brt(const Frame &frame);
+
+const char *mode_name(uint8_t mode);
+const char *brtest_state_name(uint8_t state);
+
+// Returns number of bytes written to ‹out›, 0 if it does not fit.
+size_t encode(uint8_t command_code, const uint8_t *data, size_t size, uint8_t *out, size_t out_size);
+std::vector<uint8_t> encode(uint8_t command_code, std::initializer_list<uint8_t> data = {});
+
+} // namespace dc01
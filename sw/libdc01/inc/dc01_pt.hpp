@@ -0,0 +1,68 @@
+/* Non-blocking client of hJOPserver PT server.
+ *
+ * Single HTTP/1.1 keep-alive connection is reused for all requests. Only
+ * trakce.emergency is extracted from /status response.
+ */
+
+#pragma once
+
+#include <functional>
+#include <optional>
+#include <string>
+#include "dc01_loop.hpp"
+
+namespace dc01 {
+
+class PtClient {
+public:
+	// ‹emergency› is empty on failure, ‹error› describes the failure then.
+	using StatusCallback = std::function<void(std::optional<bool> emergency, const std::string &error)>;
+
+	PtClient(EventLoop &loop, std::string server, uint16_t port, Clock::duration timeout);
+	~PtClient();
+	PtClient(const PtClient &) = delete;
+	PtClient &operator=(const PtClient &) = delete;
+
+	// Only single request could be pending at a time.
+	bool busy() const { return m_state != State::Idle; }
+	void check_status(StatusCallback callback);
+	void close();
+
+	double last_latency_ms() const { return m_last_latency_ms; }
+	bool last_reused() const { return m_reused; }
+	unsigned connects() const { return m_connects; }
+
+private:
+	enum class State { Idle, Connecting, Sending, Receiving };
+
+	EventLoop &m_loop;
+	std::string m_server;
+	uint16_t m_port;
+	Clock::duration m_timeout;
+	int m_timer;
+	int m_fd = -1;
+	State m_state = State::Idle;
+	bool m_reused = false;
+	unsigned m_connects = 0;
+	std::string m_request;
+	size_t m_sent = 0;
+	std::string m_response;
+	Clock::time_point m_start;
+	double m_last_latency_ms = 0;
+	StatusCallback m_callback;
+
+	void connect();
+	void reconnect();
+	void on_event(uint32_t events);
+	void on_writable();
+	void on_readable();
+	bool response_complete(std::string &body, bool &keep_alive);
+	void finish(std::optional<bool> emergency, const std::string &error);
+	void fail(const std::string &error);
+};
+
+// Returns trakce.emergency from /status response body, empty if not found.
+// Only member of the top-level object counts, nested "trakce" objects do not.
+std::optional<bool> status_emergency(const std::string &body);
+
+} // namespace dc01
@@ -0,0 +1,61 @@
+/* DC-01 serial port on Linux (termios).
+ *
+ * Port is opened in raw non-blocking mode with DTR asserted; DTR is dropped
+ * on close, which makes DC-01 cut DCC immediately.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace dc01 {
+
+constexpr const char *DC01_PRODUCT = "DC-01";
+
+// Urgent state signalled by DC-01 (FW >= 1.2) by CDC SERIAL_STATE notification,
+// seen as modem status lines, see fw/doc/protocol.md.
+struct SerialState {
+	bool dcc_connected; // DCD
+	bool ok; // DSR: mode is not mFailure
+	bool timeout_warning; // RI: DCC is cut soon unless heartbeat is renewed
+
+	bool operator==(const SerialState &other) const {
+		return (dcc_connected == other.dcc_connected) && (ok == other.ok) &&
+		       (timeout_warning == other.timeout_warning);
+	}
+	bool operator!=(const SerialState &other) const { return !(*this == other); }
+};
+
+class Serial {
+public:
+	explicit Serial(const std::string &path); // throws std::system_error
+	~Serial();
+	Serial(const Serial &) = delete;
+	Serial &operator=(const Serial &) = delete;
+
+	int fd() const { return m_fd; }
+	const std::string &path() const { return m_path; }
+
+	// Non-blocking read, returns 0 when no data are available.
+	// Throws std::system_error when device is gone.
+	size_t read(uint8_t *buf, size_t size);
+	void write(const uint8_t *data, size_t size);
+	void write(const std::vector<uint8_t> &data) { write(data.data(), data.size()); }
+
+	// Reads modem status lines (kept by the driver, data stream is not touched),
+	// std::nullopt when the port has no lines (e.g. pty).
+	std::optional<SerialState> serial_state() const;
+
+private:
+	int m_fd;
+	std::string m_path;
+};
+
+// Returns device paths of all serial ports with USB product string ‹DC01_PRODUCT›.
+std::vector<std::string> find_ports();
+
+} // namespace dc01
@@ -0,0 +1,68 @@
+/* DC-01 watchdog state machine: keeps DCC on while hJOP is ok.
+ *
+ * Each ‹refresh› period hJOP is checked and SET_STATE s=1 is sent to DC-01
+ * when the check succeeds. When check fails, heartbeat is not sent and
+ * DC-01 cuts DCC after its timeout. Reports from DC-01 are logged.
+ *
+ * Serial state (CDC notifications of FW >= 1.2) is read each
+ * ‹serial_state_period› in parallel with reports and logged on change.
+ */
+
+#pragma once
+
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <string>
+#include "dc01_decoder.hpp"
+#include "dc01_loop.hpp"
+#include "dc01_pt.hpp"
+#include "dc01_serial.hpp"
+
+namespace dc01 {
+
+struct WatchdogConfig {
+	std::string port;
+	std::string server = "127.0.0.1";
+	uint16_t pt_port = 5823;
+	bool mock = false; // keep DCC always on
+	Clock::duration refresh = std::chrono::milliseconds(250);
+	Clock::duration receive_timeout = std::chrono::milliseconds(150);
+	Clock::duration serial_state_period = std::chrono::milliseconds(20);
+};
+
+class Watchdog {
+public:
+	Watchdog(EventLoop &loop, const WatchdogConfig &config);
+	~Watchdog();
+	Watchdog(const Watchdog &) = delete;
+	Watchdog &operator=(const Watchdog &) = delete;
+
+	// Called for each received frame (after it is logged).
+	std::function<void(const Frame &)> on_frame;
+	// Called when serial state changes (after it is logged).
+	std::function<void(const SerialState &)> on_serial_state;
+
+	const DecoderStats &decoder_stats() const { return m_decoder.stats(); }
+
+private:
+	EventLoop &m_loop;
+	WatchdogConfig m_config;
+	Serial m_serial;
+	Decoder m_decoder;
+	PtClient m_pt;
+	int m_heartbeat_timer;
+	int m_serial_state_timer;
+	bool m_serial_state_supported = false; // by DC-01 FW
+	std::optional<SerialState> m_serial_state;
+	Clock::time_point m_last_receive;
+
+	void send(uint8_t command_code, std::initializer_list<uint8_t> data = {});
+	void on_serial(uint32_t events);
+	void on_heartbeat();
+	void poll_serial_state();
+	void parse(const Frame &frame);
+};
+
+} // namespace dc01
@@ -0,0 +1,62 @@
+#include "dc01.h"
+#include "dc01_decoder.hpp"
+
+struct dc01_decoder {
+	dc01::Decoder decoder;
+};
+
+dc01_decoder *dc01_decoder_new(void) {
+	return new (std::nothrow) dc01_decoder();
+}
+
+void dc01_decoder_free(dc01_decoder *decoder) {
+	delete decoder;
+}
+
+void dc01_decoder_reset(dc01_decoder *decoder) {
+	decoder->decoder.reset();
+}
+
+size_t dc01_decoder_pending(const dc01_decoder *decoder) {
+	return decoder->decoder.pending();
+}
+
+const uint8_t *dc01_decoder_buffer(const dc01_decoder *decoder, size_t *size) {
+	*size = dc01::Decoder::CAPACITY;
+	return decoder->decoder.buffer();
+}
+
+static size_t extract(dc01::Decoder &decoder, dc01_frame *frames, size_t max_frames) {
+	const uint8_t *buffer = decoder.buffer();
+	size_t count = 0;
+	dc01::Frame frame;
+	while ((count < max_frames) && (decoder.next(frame)))
+		frames[count++] = {frame.command_code, static_cast<uint8_t>(frame.size),
+		                   static_cast<uint16_t>(frame.data-buffer)};
+	return count;
+}
+
+size_t dc01_decoder_feed(dc01_decoder *decoder, const uint8_t *data, size_t size,
+                         dc01_frame *frames, size_t max_frames, size_t *consumed) {
+	// Appending could move data in the buffer, so no data are appended once
+	// any frame is returned from this call.
+	*consumed = 0;
+	size_t count = extract(decoder->decoder, frames, max_frames);
+	while ((count == 0) && (*consumed < size)) {
+		*consumed += decoder->decoder.append(data+*consumed, size-*consumed);
+		count = extract(decoder->decoder, frames, max_frames);
+	}
+	return count;
+}
+
+void dc01_decoder_stats(const dc01_decoder *decoder, uint64_t *frames, uint64_t *resyncs,
+                        uint64_t *garbage_bytes) {
+	const dc01::DecoderStats &stats = decoder->decoder.stats();
+	*frames = stats.frames;
+	*resyncs = stats.resyncs;
+	*garbage_bytes = stats.garbage_bytes;
+}
+
+size_t dc01_encode(uint8_t command_code, const uint8_t *data, size_t size, uint8_t *out, size_t out_size) {
+	return dc01::encode(command_code, data, size, out, out_size);
+}
@@ -0,0 +1,97 @@
+/* dc01d: native DC-01 watchdog for hJOP.
+ *
+ * Same behavior & log format as hjop_watchdog.py, intended for deployments
+ * where Python interpreter is too heavy or its timing jitter is an issue.
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <exception>
+#include <getopt.h>
+#include <string>
+#include <system_error>
+#include <thread>
+#include "dc01_log.hpp"
+#include "dc01_loop.hpp"
+#include "dc01_serial.hpp"
+#include "dc01_watchdog.hpp"
+
+static const char *APP_VERSION = "1.0";
+
+static const char *USAGE =
+	"DC-01 watchdog for hJOP (native)\n"
+	"\n"
+	"Usage:\n"
+	"  dc01d [options]\n"
+	"  dc01d --help\n"
+	"  dc01d --version\n"
+	"\n"
+	"Options:\n"
+	"  -s <servername>    hJOPserver address [default: 127.0.0.1]\n"
+	"  -p <port>          hJOPserver PT server port [default: 5823]\n"
+	"  -c <port>          DC-01 serial port\n"
+	"  -l <loglevel>      Specify loglevel [default: info]\n"
+	"  -m --mock          Mock server - keep output always on\n"
+	"  -h --help          Show this screen\n"
+	"  -v --version       Show version\n"
+	"  -r --resume        Always try to resume operations, never die (suitable for production deployment)\n";
+
+int main(int argc, char *argv[]) {
+	dc01::WatchdogConfig config;
+	std::string port;
+	bool resume = false;
+
+	static const struct option long_options[] = {
+		{"mock", no_argument, nullptr, 'm'},
+		{"help", no_argument, nullptr, 'h'},
+		{"version", no_argument, nullptr, 'v'},
+		{"resume", no_argument, nullptr, 'r'},
+		{nullptr, 0, nullptr, 0},
+	};
+
+	int opt;
+	while ((opt = getopt_long(argc, argv, "s:p:c:l:mhvr", long_options, nullptr)) != -1) {
+		switch (opt) {
+		case 's': config.server = optarg; break;
+		case 'p': config.pt_port = static_cast<uint16_t>(std::atoi(optarg)); break;
+		case 'c': port = optarg; break;
+		case 'l':
+			if (!dc01::log_level_from_str(optarg, dc01::log_level))
+				dc01::log_level = dc01::LogLevel::Info;
+			break;
+		case 'm': config.mock = true; break;
+		case 'r': resume = true; break;
+		case 'v': std::printf("%s\n", APP_VERSION); return 0;
+		case 'h': std::fputs(USAGE, stdout); return 0;
+		default: std::fputs(USAGE, stderr); return 1;
+		}
+	}
+
+	while (true) {
+		if (port.empty())
+			dc01::log(dc01::LogLevel::Info, "Looking for DC-01...");
+		std::vector<std::string> ports = port.empty() ? dc01::find_ports() : std::vector<std::string>{port};
+
+		if (ports.empty()) {
+			dc01::log(dc01::LogLevel::Error, "No DC-01 found!");
+		} else if (ports.size() > 1) {
+			dc01::log(dc01::LogLevel::Error, "Multiple DC-01s found!");
+		} else {
+			try {
+				config.port = ports[0];
+				dc01::log(dc01::LogLevel::Info, "Connecting to " + config.port + "...");
+				dc01::EventLoop loop;
+				dc01::Watchdog watchdog(loop, config);
+				loop.run();
+			} catch (const std::system_error &e) {
+				dc01::log(dc01::LogLevel::Error, std::string("SerialException: ") + e.what());
+			} catch (const std::exception &e) {
+				if (!resume)
+					throw;
+				dc01::log(dc01::LogLevel::Error, std::string("Exception: ") + e.what());
+			}
+		}
+
+		std::this_thread::sleep_for(std::chrono::seconds(3)); // sleep before reconnect
+	}
+}
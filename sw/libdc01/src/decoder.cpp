@@ -0,0 +1,72 @@
+#include "dc01_decoder.hpp"
+
+namespace dc01 {
+
+size_t Decoder::append(const uint8_t *data, size_t size) {
+	if (m_start == m_end) {
+		m_start = m_end = 0;
+	} else if (m_end == CAPACITY) {
+		// move unfinished packet to the beginning of the buffer
+		std::memmove(m_buf.data(), &m_buf[m_start], m_end-m_start);
+		m_end -= m_start;
+		m_start = 0;
+	}
+
+	size_t count = std::min(size, CAPACITY-m_end);
+	std::memcpy(&m_buf[m_end], data, count);
+	m_end += count;
+	return count;
+}
+
+bool Decoder::next(Frame &frame) {
+	while (m_end-m_start >= HEADER_SIZE) {
+		if ((m_buf[m_start] != MAGIC1) || (m_buf[m_start+1] != MAGIC2)) {
+			size_t pos = m_start+1;
+			while (true) {
+				const void *found = std::memchr(&m_buf[pos], MAGIC1, m_end-pos);
+				if (found == nullptr) {
+					pos = m_end;
+					break;
+				}
+				pos = static_cast<const uint8_t*>(found) - m_buf.data();
+				if ((pos+1 == m_end) || (m_buf[pos+1] == MAGIC2))
+					break; // keep last MAGIC1, it could be start of next packet
+				pos++;
+			}
+			drop(pos-m_start);
+			continue;
+		}
+
+		size_t length = m_buf[m_start+2];
+		size_t next_start = m_start+HEADER_SIZE+length;
+		if (next_start > m_end)
+			return false; // wait for more data
+		if (length == 0) { // no command code → invalid packet
+			drop(HEADER_SIZE);
+			continue;
+		}
+
+		frame.command_code = m_buf[m_start+HEADER_SIZE];
+		frame.data = &m_buf[m_start+HEADER_SIZE+1];
+		frame.size = length-1;
+		m_start = next_start;
+		m_stats.frames++;
+		return true;
+	}
+	return false;
+}
+
+void Decoder::reset() {
+	drop(m_end-m_start);
+	m_start = m_end = 0;
+}
+
+void Decoder::drop(size_t count) {
+	if (count == 0)
+		return;
+	m_stats.resyncs++;
+	m_stats.garbage_bytes += count;
+	m_start += count;
+}
+
+} // namespace dc01
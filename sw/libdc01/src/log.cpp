@@ -0,0 +1,52 @@
+#include <chrono>
+#include <cstdio>
+#include <ctime>
+#include "dc01_log.hpp"
+
+namespace dc01 {
+
+LogLevel log_level = LogLevel::Info;
+
+static const char *level_name(LogLevel level) {
+	switch (level) {
+	case LogLevel::Debug: return "DEBUG";
+	case LogLevel::Info: return "INFO";
+	case LogLevel::Warning: return "WARNING";
+	case LogLevel::Error: return "ERROR";
+	case LogLevel::Critical: return "CRITICAL";
+	}
+	return "";
+}
+
+bool log_enabled(LogLevel level) {
+	return level >= log_level;
+}
+
+void log(LogLevel level, const std::string &message) {
+	if (!log_enabled(level))
+		return;
+
+	auto now = std::chrono::system_clock::now();
+	std::time_t secs = std::chrono::system_clock::to_time_t(now);
+	auto millis = std::chrono::duration_cast<std::chrono::milliseconds>(now.time_since_epoch()).count() % 1000;
+	std::tm tm;
+	localtime_r(&secs, &tm);
+	char timestr[32];
+	std::strftime(timestr, sizeof(timestr), "%Y-%m-%d %H:%M:%S", &tm);
+
+	// Single write per line & flush: output is often piped to other process
+	std::fprintf(stdout, "[%s,%03d] %s %s\n", timestr, static_cast<int>(millis), level_name(level), message.c_str());
+	std::fflush(stdout);
+}
+
+bool log_level_from_str(const std::string &name, LogLevel &level) {
+	if (name == "debug") level = LogLevel::Debug;
+	else if (name == "info") level = LogLevel::Info;
+	else if (name == "warning") level = LogLevel::Warning;
+	else if (name == "error") level = LogLevel::Error;
+	else if (name == "critical") level = LogLevel::Critical;
+	else return false;
+	return true;
+}
+
+} // namespace dc01
@@ -0,0 +1,101 @@
+#include <cerrno>
+#include <sys/epoll.h>
+#include <sys/timerfd.h>
+#include <system_error>
+#include <unistd.h>
+#include "dc01_loop.hpp"
+
+namespace dc01 {
+
+static std::system_error errno_error(const char *what) {
+	return std::system_error(errno, std::generic_category(), what);
+}
+
+static struct timespec to_timespec(Clock::duration d) {
+	auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(d).count();
+	return {static_cast<time_t>(ns / 1000000000), static_cast<long>(ns % 1000000000)};
+}
+
+EventLoop::EventLoop() {
+	m_epfd = ::epoll_create1(EPOLL_CLOEXEC);
+	if (m_epfd < 0)
+		throw errno_error("epoll_create1");
+}
+
+EventLoop::~EventLoop() {
+	::close(m_epfd);
+}
+
+void EventLoop::add(int fd, uint32_t events, FdCallback callback) {
+	struct epoll_event ev = {};
+	ev.events = events;
+	ev.data.fd = fd;
+	if (::epoll_ctl(m_epfd, EPOLL_CTL_ADD, fd, &ev) < 0)
+		throw errno_error("epoll_ctl ADD");
+	m_callbacks[fd] = std::make_shared<FdCallback>(std::move(callback));
+}
+
+void EventLoop::modify(int fd, uint32_t events) {
+	struct epoll_event ev = {};
+	ev.events = events;
+	ev.data.fd = fd;
+	if (::epoll_ctl(m_epfd, EPOLL_CTL_MOD, fd, &ev) < 0)
+		throw errno_error("epoll_ctl MOD");
+}
+
+void EventLoop::remove(int fd) {
+	::epoll_ctl(m_epfd, EPOLL_CTL_DEL, fd, nullptr);
+	m_callbacks.erase(fd);
+}
+
+int EventLoop::add_timer(Clock::duration first, Clock::duration period, TimerCallback callback) {
+	int fd = ::timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+	if (fd < 0)
+		throw errno_error("timerfd_create");
+	add(fd, EPOLLIN, [fd, callback = std::move(callback)](uint32_t) {
+		uint64_t expirations;
+		if (::read(fd, &expirations, sizeof(expirations)) == sizeof(expirations))
+			callback();
+	});
+	set_timer(fd, first, period);
+	return fd;
+}
+
+void EventLoop::set_timer(int id, Clock::duration first, Clock::duration period) {
+	struct itimerspec spec;
+	spec.it_value = to_timespec(first);
+	spec.it_interval = to_timespec(period);
+	if ((first == Clock::duration::zero()) && (period != Clock::duration::zero()))
+		spec.it_value.tv_nsec = 1; // zero it_value would disarm the timer
+	if (::timerfd_settime(id, 0, &spec, nullptr) < 0)
+		throw errno_error("timerfd_settime");
+}
+
+void EventLoop::remove_timer(int id) {
+	remove(id);
+	::close(id);
+}
+
+void EventLoop::run() {
+	constexpr int MAX_EVENTS = 16;
+	struct epoll_event events[MAX_EVENTS];
+	m_running = true;
+
+	while (m_running) {
+		int count = ::epoll_wait(m_epfd, events, MAX_EVENTS, -1);
+		if (count < 0) {
+			if (errno == EINTR)
+				continue;
+			throw errno_error("epoll_wait");
+		}
+		for (int i = 0; (i < count) && (m_running); i++) {
+			auto it = m_callbacks.find(events[i].data.fd);
+			if (it == m_callbacks.end())
+				continue; // removed by previous callback
+			auto callback = it->second; // callback may remove itself
+			(*callback)(events[i].events);
+		}
+	}
+}
+
+} // namespace dc01
@@ -0,0 +1,66 @@
+#include <cstring>
+#include "dc01_proto.hpp"
+
+namespace dc01 {
+
+template <typename Report>
+static std::optional<Report> decode(const Frame &frame, uint8_t command_code,
+                                    bool (*decoder)(const uint8_t *, size_t, Report *)) {
+	Report report;
+	if ((frame.command_code != command_code) || (!decoder(frame.data, frame.size, &report)))
+		return std::nullopt;
+	return report;
+}
+
+std::optional<InfoReport> decode_info(const Frame &frame) {
+	return decode(frame, DC_CMD_MP_INFO, dc01_decode_info_report);
+}
+
+std::optional<StateReport> decode_state(const Frame &frame) {
+	return decode(frame, DC_CMD_MP_STATE, dc01_decode_state_report);
+}
+
+std::optional<BrtReport> decode_brt(const Frame &frame) {
+	return decode(frame, DC_CMD_MP_BRSTATE, dc01_decode_brt_report);
+}
+
+const char *mode_name(uint8_t mode) {
+	switch (mode) {
+	case static_cast<uint8_t>(Mode::Initializing): return "mInitializing";
+	case static_cast<uint8_t>(Mode::NormalOp): return "mNormalOp";
+	case static_cast<uint8_t>(Mode::Override): return "mOverride";
+	case static_cast<uint8_t>(Mode::Failure): return "mFailure";
+	default: return "unknown";
+	}
+}
+
+const char *brtest_state_name(uint8_t state) {
+	switch (state) {
+	case 0: return "not yet run";
+	case 1: return "in progress";
+	case 2: return "succesfully completed";
+	case 3: return "failed";
+	case 4: return "interrupted due to DCC absence";
+	default: return "unknown";
+	}
+}
+
+size_t encode(uint8_t command_code, const uint8_t *data, size_t size, uint8_t *out, size_t out_size) {
+	if ((size >= 0xFF) || (out_size < HEADER_SIZE+1+size))
+		return 0;
+	out[0] = MAGIC1;
+	out[1] = MAGIC2;
+	out[2] = static_cast<uint8_t>(size+1);
+	out[3] = command_code;
+	if (size > 0)
+		std::memcpy(&out[4], data, size);
+	return HEADER_SIZE+1+size;
+}
+
+std::vector<uint8_t> encode(uint8_t command_code, std::initializer_list<uint8_t> data) {
+	std::vector<uint8_t> out(HEADER_SIZE+1+data.size());
+	out.resize(encode(command_code, data.begin(), data.size(), out.data(), out.size()));
+	return out;
+}
+
+} // namespace dc01
@@ -0,0 +1,358 @@
+#include <algorithm>
+#include <cctype>
+#include <cerrno>
+#include <cstring>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include "dc01_pt.hpp"
+
+namespace dc01 {
+
+PtClient::PtClient(EventLoop &loop, std::string server, uint16_t port, Clock::duration timeout)
+	: m_loop(loop), m_server(std::move(server)), m_port(port), m_timeout(timeout) {
+	m_timer = m_loop.add_timer(Clock::duration::zero(), Clock::duration::zero(), [this]() {
+		if (busy())
+			fail("timeout");
+	});
+}
+
+PtClient::~PtClient() {
+	close();
+	m_loop.remove_timer(m_timer);
+}
+
+void PtClient::close() {
+	if (m_fd >= 0) {
+		m_loop.remove(m_fd);
+		::close(m_fd);
+		m_fd = -1;
+	}
+	m_state = State::Idle;
+}
+
+void PtClient::check_status(StatusCallback callback) {
+	if (busy()) {
+		callback(std::nullopt, "previous request still pending");
+		return;
+	}
+
+	m_callback = std::move(callback);
+	m_start = Clock::now();
+	m_request = "GET /status HTTP/1.1\r\nHost: " + m_server + ":" + std::to_string(m_port) +
+	            "\r\nAccept: application/json\r\nConnection: keep-alive\r\n\r\n";
+	m_sent = 0;
+	m_response.clear();
+	m_loop.set_timer(m_timer, m_timeout, Clock::duration::zero());
+
+	m_reused = (m_fd >= 0);
+	if (m_reused) {
+		m_state = State::Sending;
+		on_writable();
+	} else {
+		connect();
+	}
+}
+
+void PtClient::connect() {
+	struct addrinfo hints = {};
+	hints.ai_family = AF_UNSPEC;
+	hints.ai_socktype = SOCK_STREAM;
+	struct addrinfo *res;
+	int err = ::getaddrinfo(m_server.c_str(), std::to_string(m_port).c_str(), &hints, &res);
+	if (err != 0) {
+		fail(std::string("getaddrinfo: ") + ::gai_strerror(err));
+		return;
+	}
+
+	m_fd = ::socket(res->ai_family, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+	if (m_fd < 0) {
+		::freeaddrinfo(res);
+		fail(std::string("socket: ") + std::strerror(errno));
+		return;
+	}
+	int one = 1;
+	::setsockopt(m_fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+
+	int result = ::connect(m_fd, res->ai_addr, res->ai_addrlen);
+	::freeaddrinfo(res);
+	if ((result < 0) && (errno != EINPROGRESS)) {
+		int connect_errno = errno;
+		::close(m_fd);
+		m_fd = -1;
+		fail(std::string("connect: ") + std::strerror(connect_errno));
+		return;
+	}
+
+	m_connects++;
+	m_state = State::Connecting;
+	m_loop.add(m_fd, EPOLLOUT, [this](uint32_t events) { on_event(events); });
+}
+
+void PtClient::reconnect() {
+	// Stale keep-alive connection → send the request again on a new one
+	close();
+	m_reused = false;
+	m_sent = 0;
+	m_response.clear();
+	connect();
+}
+
+void PtClient::on_event(uint32_t) {
+	switch (m_state) {
+	case State::Connecting: {
+		int err = 0;
+		socklen_t len = sizeof(err);
+		::getsockopt(m_fd, SOL_SOCKET, SO_ERROR, &err, &len);
+		if (err != 0) {
+			fail(std::string("connect: ") + std::strerror(err));
+			return;
+		}
+		m_state = State::Sending;
+		on_writable();
+		break;
+	}
+	case State::Sending:
+		on_writable();
+		break;
+	case State::Receiving:
+		on_readable();
+		break;
+	case State::Idle:
+		// Idle keep-alive connection: server closed it or sent garbage
+		close();
+		break;
+	}
+}
+
+void PtClient::on_writable() {
+	while (m_sent < m_request.size()) {
+		ssize_t count = ::send(m_fd, &m_request[m_sent], m_request.size()-m_sent, MSG_NOSIGNAL);
+		if (count < 0) {
+			if (errno == EAGAIN) {
+				m_loop.modify(m_fd, EPOLLOUT);
+				return;
+			}
+			if (m_reused) {
+				reconnect();
+				return;
+			}
+			fail(std::string("send: ") + std::strerror(errno));
+			return;
+		}
+		m_sent += count;
+	}
+	m_state = State::Receiving;
+	m_loop.modify(m_fd, EPOLLIN);
+}
+
+void PtClient::on_readable() {
+	char buf[4096];
+	while (true) {
+		ssize_t count = ::recv(m_fd, buf, sizeof(buf), 0);
+		if ((count < 0) && (errno == EAGAIN))
+			return;
+		// Server closed (or reset) idle keep-alive connection meanwhile
+		bool closed = (count == 0) || ((count < 0) && (errno == ECONNRESET));
+		if ((closed) && (m_reused) && (m_response.empty())) {
+			reconnect();
+			return;
+		}
+		if (count < 0) {
+			fail(std::string("recv: ") + std::strerror(errno));
+			return;
+		}
+		if (count == 0) {
+			fail("connection closed by server");
+			return;
+		}
+		m_response.append(buf, count);
+
+		std::string body;
+		bool keep_alive;
+		if (response_complete(body, keep_alive)) {
+			if (!keep_alive)
+				close();
+			if (m_response.compare(9, 3, "200") != 0) {
+				finish(std::nullopt, "HTTP status " + m_response.substr(9, 3));
+				return;
+			}
+			std::optional<bool> emergency = status_emergency(body);
+			finish(emergency, emergency ? "" : "invalid /status response");
+			return;
+		}
+	}
+}
+
+static std::string lower(std::string str) {
+	std::transform(str.begin(), str.end(), str.begin(), [](unsigned char c) { return std::tolower(c); });
+	return str;
+}
+
+bool PtClient::response_complete(std::string &body, bool &keep_alive) {
+	size_t headers_end = m_response.find("\r\n\r\n");
+	if (headers_end == std::string::npos)
+		return false;
+	if (m_response.size() < 12)
+		return false;
+
+	std::string headers = lower(m_response.substr(0, headers_end+2));
+	keep_alive = (headers.compare(0, 8, "http/1.1") == 0);
+	if (headers.find("\r\nconnection: close\r\n") != std::string::npos)
+		keep_alive = false;
+	size_t body_start = headers_end+4;
+
+	if (headers.find("\r\ntransfer-encoding: chunked\r\n") != std::string::npos) {
+		body.clear();
+		size_t pos = body_start;
+		while (true) {
+			size_t line_end = m_response.find("\r\n", pos);
+			if (line_end == std::string::npos)
+				return false;
+			size_t size = std::strtoul(m_response.c_str()+pos, nullptr, 16);
+			if (size == 0)
+				return (m_response.find("\r\n", line_end+2) != std::string::npos);
+			if (m_response.size() < line_end+2+size+2)
+				return false;
+			body.append(m_response, line_end+2, size);
+			pos = line_end+2+size+2;
+		}
+	}
+
+	size_t cl = headers.find("\r\ncontent-length:");
+	if (cl == std::string::npos)
+		return false; // body ends by closing connection, handled as failure
+	size_t length = std::strtoul(headers.c_str()+cl+17, nullptr, 10);
+	if (m_response.size() < body_start+length)
+		return false;
+	body = m_response.substr(body_start, length);
+	return true;
+}
+
+void PtClient::finish(std::optional<bool> emergency, const std::string &error) {
+	m_loop.stop_timer(m_timer);
+	if (m_fd >= 0) {
+		m_state = State::Idle;
+		m_loop.modify(m_fd, EPOLLIN); // to detect closing of idle connection
+	}
+	m_last_latency_ms = std::chrono::duration<double, std::milli>(Clock::now()-m_start).count();
+	StatusCallback callback = std::move(m_callback);
+	m_callback = nullptr;
+	if (callback)
+		callback(emergency, error);
+}
+
+void PtClient::fail(const std::string &error) {
+	close();
+	finish(std::nullopt, error);
+}
+
+// Minimal JSON scanner of status_emergency: members of objects are walked,
+// other values are only skipped (strings, nesting), never stored.
+
+static void skip_ws(const std::string &s, size_t &pos) {
+	while ((pos < s.size()) && (std::isspace(static_cast<unsigned char>(s[pos]))))
+		pos++;
+}
+
+// ‹pos› points to opening quote, it is moved behind closing one.
+static bool skip_string(const std::string &s, size_t &pos) {
+	for (pos++; pos < s.size(); pos++) {
+		if (s[pos] == '\\')
+			pos++;
+		else if (s[pos] == '"') {
+			pos++;
+			return true;
+		}
+	}
+	return false;
+}
+
+static bool skip_value(const std::string &s, size_t &pos) {
+	static const char DELIMITERS[] = ",:{}[]\" \t\r\n";
+	size_t depth = 0;
+	do {
+		skip_ws(s, pos);
+		if (pos >= s.size())
+			return false;
+		char c = s[pos];
+		if (c == '"') {
+			if (!skip_string(s, pos))
+				return false;
+		} else if ((c == '{') || (c == '[')) {
+			depth++;
+			pos++;
+		} else if ((c == '}') || (c == ']')) {
+			if (depth == 0)
+				return false;
+			depth--;
+			pos++;
+		} else if ((c == ',') || (c == ':')) {
+			if (depth == 0)
+				return false;
+			pos++;
+		} else {
+			while ((pos < s.size()) && (std::memchr(DELIMITERS, s[pos], sizeof(DELIMITERS)-1) == nullptr))
+				pos++;
+		}
+	} while (depth > 0);
+	return true;
+}
+
+// ‹pos› points to an object; returns position of value of its member ‹key›
+// (the last one when repeated, as json.loads does) or npos. Keys are compared
+// without unescaping.
+static size_t find_member(const std::string &s, size_t pos, const char *key) {
+	size_t found = std::string::npos;
+	pos++;
+	skip_ws(s, pos);
+	if ((pos < s.size()) && (s[pos] == '}'))
+		return std::string::npos;
+	while (true) {
+		skip_ws(s, pos);
+		if ((pos >= s.size()) || (s[pos] != '"'))
+			return std::string::npos;
+		size_t key_start = pos+1;
+		if (!skip_string(s, pos))
+			return std::string::npos;
+		bool match = (s.compare(key_start, pos-1-key_start, key) == 0);
+		skip_ws(s, pos);
+		if ((pos >= s.size()) || (s[pos] != ':'))
+			return std::string::npos;
+		pos++;
+		skip_ws(s, pos);
+		if (match)
+			found = pos;
+		if (!skip_value(s, pos))
+			return std::string::npos;
+		skip_ws(s, pos);
+		if ((pos < s.size()) && (s[pos] == '}'))
+			return found;
+		if ((pos >= s.size()) || (s[pos] != ','))
+			return std::string::npos;
+		pos++;
+	}
+}
+
+std::optional<bool> status_emergency(const std::string &body) {
+	size_t pos = 0;
+	skip_ws(body, pos);
+	if ((pos >= body.size()) || (body[pos] != '{'))
+		return std::nullopt;
+	pos = find_member(body, pos, "trakce");
+	if ((pos == std::string::npos) || (body[pos] != '{'))
+		return std::nullopt;
+	pos = find_member(body, pos, "emergency");
+	if (pos == std::string::npos)
+		return std::nullopt;
+	if (body.compare(pos, 4, "true") == 0)
+		return true;
+	if (body.compare(pos, 5, "false") == 0)
+		return false;
+	return std::nullopt;
+}
+
+} // namespace dc01
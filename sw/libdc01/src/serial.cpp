@@ -0,0 +1,103 @@
+#include <cerrno>
+#include <dirent.h>
+#include <fcntl.h>
+#include <fstream>
+#include <sys/ioctl.h>
+#include <system_error>
+#include <termios.h>
+#include <unistd.h>
+#include "dc01_serial.hpp"
+
+namespace dc01 {
+
+static std::system_error errno_error(const std::string &what) {
+	return std::system_error(errno, std::generic_category(), what);
+}
+
+Serial::Serial(const std::string &path) : m_path(path) {
+	m_fd = ::open(path.c_str(), O_RDWR | O_NOCTTY | O_NONBLOCK | O_CLOEXEC);
+	if (m_fd < 0)
+		throw errno_error("open " + path);
+
+	struct termios tio;
+	if (::tcgetattr(m_fd, &tio) < 0) {
+		int err = errno;
+		::close(m_fd);
+		throw std::system_error(err, std::generic_category(), "tcgetattr " + path);
+	}
+	::cfmakeraw(&tio);
+	tio.c_cflag |= CLOCAL | CREAD | HUPCL;
+	tio.c_cc[VMIN] = 0;
+	tio.c_cc[VTIME] = 0;
+	::cfsetispeed(&tio, B115200);
+	::cfsetospeed(&tio, B115200);
+	if (::tcsetattr(m_fd, TCSANOW, &tio) < 0) {
+		int err = errno;
+		::close(m_fd);
+		throw std::system_error(err, std::generic_category(), "tcsetattr " + path);
+	}
+
+	int lines = TIOCM_DTR | TIOCM_RTS;
+	::ioctl(m_fd, TIOCMBIS, &lines); // not supported on pty, ignore errors
+	::tcflush(m_fd, TCIFLUSH);
+}
+
+Serial::~Serial() {
+	::close(m_fd);
+}
+
+size_t Serial::read(uint8_t *buf, size_t size) {
+	ssize_t count = ::read(m_fd, buf, size);
+	if (count < 0) {
+		if ((errno == EAGAIN) || (errno == EINTR))
+			return 0;
+		throw errno_error("read " + m_path);
+	}
+	if (count == 0) // non-blocking tty returns EOF only when hung up
+		throw std::system_error(EIO, std::generic_category(), "device disconnected: " + m_path);
+	return static_cast<size_t>(count);
+}
+
+void Serial::write(const uint8_t *data, size_t size) {
+	while (size > 0) {
+		ssize_t count = ::write(m_fd, data, size);
+		if (count < 0) {
+			if (errno == EINTR)
+				continue;
+			// EAGAIN: tx buffer of the tty is full → device does not read
+			// data at all; losing heartbeat is the right thing then.
+			throw errno_error("write " + m_path);
+		}
+		data += count;
+		size -= count;
+	}
+}
+
+std::optional<SerialState> Serial::serial_state() const {
+	int lines;
+	if (::ioctl(m_fd, TIOCMGET, &lines) < 0)
+		return std::nullopt;
+	return SerialState{(lines & TIOCM_CD) != 0, (lines & TIOCM_DSR) != 0, (lines & TIOCM_RI) != 0};
+}
+
+std::vector<std::string> find_ports() {
+	std::vector<std::string> result;
+	DIR *dir = ::opendir("/sys/class/tty");
+	if (dir == nullptr)
+		return result;
+
+	while (struct dirent *entry = ::readdir(dir)) {
+		std::string name = entry->d_name;
+		if (name.rfind("ttyACM", 0) != 0)
+			continue;
+		// /sys/class/tty/ttyACMx/device → USB interface, product is in the USB device
+		std::ifstream product("/sys/class/tty/" + name + "/device/../product");
+		std::string line;
+		if (std::getline(product, line) && (line == DC01_PRODUCT))
+			result.push_back("/dev/" + name);
+	}
+	::closedir(dir);
+	return result;
+}
+
+} // namespace dc01
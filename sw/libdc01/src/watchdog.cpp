@@ -0,0 +1,152 @@
+#include <cstdio>
+#include <sys/epoll.h>
+#include "dc01_log.hpp"
+#include "dc01_watchdog.hpp"
+
+namespace dc01 {
+
+static const char *DC01_OK_VERSIONS[] = {"1.0", "1.1", "1.2"}; // SET_STATE is kept, lease & scope are optional
+
+static bool serial_state_supported(const InfoReport &info) {
+	return (info.fw_major > 1) || ((info.fw_major == 1) && (info.fw_minor >= 2));
+}
+
+static const char *bool_str(bool value) {
+	return value ? "True" : "False";
+}
+
+static std::string byte_list(const uint8_t *data, size_t size) {
+	std::string result = "[";
+	for (size_t i = 0; i < size; i++) {
+		if (i > 0)
+			result += ", ";
+		result += std::to_string(data[i]);
+	}
+	return result + "]";
+}
+
+Watchdog::Watchdog(EventLoop &loop, const WatchdogConfig &config)
+	: m_loop(loop), m_config(config), m_serial(config.port),
+	  m_pt(loop, config.server, config.pt_port, config.refresh) {
+	m_last_receive = Clock::now();
+	m_loop.add(m_serial.fd(), EPOLLIN, [this](uint32_t events) { on_serial(events); });
+	send(DC_CMD_PM_INFO_REQ); // Get DC-01 info
+	m_heartbeat_timer = m_loop.add_timer(Clock::duration::zero(), config.refresh, [this]() { on_heartbeat(); });
+	m_serial_state_timer = m_loop.add_timer(config.serial_state_period, config.serial_state_period,
+	                                        [this]() { poll_serial_state(); });
+}
+
+Watchdog::~Watchdog() {
+	m_loop.remove_timer(m_serial_state_timer);
+	m_loop.remove_timer(m_heartbeat_timer);
+	m_loop.remove(m_serial.fd());
+}
+
+void Watchdog::send(uint8_t command_code, std::initializer_list<uint8_t> data) {
+	std::vector<uint8_t> packet = encode(command_code, data);
+	if (log_enabled(LogLevel::Debug))
+		log(LogLevel::Debug, "< Send: " + byte_list(packet.data(), packet.size()));
+	m_serial.write(packet);
+}
+
+void Watchdog::on_heartbeat() {
+	if (m_config.mock) {
+		send(DC_CMD_PM_SET_STATE, {1});
+		return;
+	}
+	if (m_pt.busy())
+		return; // previous check still pending → skip this period
+
+	m_pt.check_status([this](std::optional<bool> emergency, const std::string &error) {
+		if (!emergency) {
+			log(LogLevel::Info, "Unable to read hJOPserver status: " + error);
+			return;
+		}
+		if (log_enabled(LogLevel::Debug)) {
+			char msg[80];
+			std::snprintf(msg, sizeof(msg), "hJOP check latency: %.1f ms (%s connection)",
+			              m_pt.last_latency_ms(), m_pt.last_reused() ? "reused" : "new");
+			log(LogLevel::Debug, msg);
+		}
+		log(LogLevel::Info, *emergency ? "hJOP EMERGENCY" : "hJOP OK");
+		if (!*emergency)
+			send(DC_CMD_PM_SET_STATE, {1});
+	});
+}
+
+void Watchdog::poll_serial_state() {
+	if (!m_serial_state_supported)
+		return;
+	std::optional<SerialState> state = m_serial.serial_state();
+	if (!state) {
+		log(LogLevel::Info, "Serial state not available, using reports only");
+		m_loop.stop_timer(m_serial_state_timer);
+		return;
+	}
+	if (m_serial_state == state)
+		return;
+	m_serial_state = state;
+
+	char msg[100];
+	std::snprintf(msg, sizeof(msg), "Serial state: dcc_connected=%s, ok=%s, timeout_warning=%s",
+	              bool_str(state->dcc_connected), bool_str(state->ok), bool_str(state->timeout_warning));
+	log((state->ok && !state->timeout_warning) ? LogLevel::Info : LogLevel::Warning, msg);
+	if (on_serial_state)
+		on_serial_state(*state);
+}
+
+void Watchdog::on_serial(uint32_t) {
+	uint8_t buf[0x100];
+	size_t count = m_serial.read(buf, sizeof(buf));
+	if (count == 0)
+		return;
+
+	Clock::time_point now = Clock::now();
+	if ((m_decoder.pending() > 0) && (now-m_last_receive > m_config.receive_timeout)) {
+		log(LogLevel::Debug, "Clearing data, timeout!");
+		m_decoder.reset();
+	}
+	m_last_receive = now;
+
+	m_decoder.feed(buf, count, [this](const Frame &frame) {
+		parse(frame);
+		if (on_frame)
+			on_frame(frame);
+	});
+}
+
+void Watchdog::parse(const Frame &frame) {
+	if (log_enabled(LogLevel::Debug)) {
+		char code[8];
+		std::snprintf(code, sizeof(code), "%#x", frame.command_code);
+		log(LogLevel::Debug, std::string("> Received: ") + code + " " + byte_list(frame.data, frame.size));
+	}
+
+	char msg[160];
+	if (auto state = decode_state(frame)) {
+		std::snprintf(msg, sizeof(msg),
+		              "Received: mode=%s, dcc_connected=%s, dcc_at_least_one=%s, failure_code=%u, warnings=%u",
+		              mode_name(state->mode), bool_str(state->dcc_connected),
+		              bool_str(state->dcc_at_least_one), state->failure_code, state->warnings);
+		bool ok = (state->failure_code == 0) && (state->warnings == 0) &&
+		          (state->mode == static_cast<uint8_t>(Mode::NormalOp));
+		log(ok ? LogLevel::Info : LogLevel::Warning, msg);
+
+	} else if (auto info = decode_info(frame)) {
+		std::string version = std::to_string(info->fw_major) + "." + std::to_string(info->fw_minor);
+		log(LogLevel::Info, "Received: DC-01 FW=v" + version);
+		bool supported = false;
+		for (const char *ok_version : DC01_OK_VERSIONS)
+			supported |= (version == ok_version);
+		if (!supported)
+			log(LogLevel::Warning, "DC-01 FW version is not supported (outdated version?)!");
+		m_serial_state_supported = serial_state_supported(*info);
+
+	} else if (auto brt = decode_brt(frame)) {
+		std::snprintf(msg, sizeof(msg), "Received: BRTest state: %s, step=%u, error=%u",
+		              brtest_state_name(brt->state), brt->step, brt->error);
+		log(LogLevel::Info, msg);
+	}
+}
+
+} // namespace dc01
@@ -0,0 +1,55 @@
+/* Host test of /status extraction (status_emergency in pt.cpp): only
+ * trakce.emergency of the top-level object counts, nested or decoy "trakce"
+ * & "emergency" must not decide.
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <optional>
+#include <string>
+#include "dc01_pt.hpp"
+
+static int failures;
+
+static void check(const std::string &body, std::optional<bool> expected) {
+	std::optional<bool> actual = dc01::status_emergency(body);
+	if (actual != expected) {
+		auto str = [](std::optional<bool> v) { return v ? (*v ? "true" : "false") : "empty"; };
+		std::fprintf(stderr, "status_emergency(%s) == %s, expected %s\n", body.c_str(), str(actual), str(expected));
+		failures++;
+	}
+}
+
+int main() {
+	// hJOPserver & hjop_standin.py
+	check("{\"trakce\": {\"state\": \"connected\", \"emergency\": false, \"library\": {\"name\": \"XpressNET\"}}}", false);
+	check("{\"trakce\":{\"emergency\":true}}", true);
+	check(" {\n\t\"server\": {\"version\": \"4.0\"},\n\t\"trakce\": {\"library\": {}, \"emergency\": true}\n}\n", true);
+
+	// nested & decoy trakce / emergency
+	check("{\"rcs\": {\"trakce\": {\"emergency\": true}}, \"trakce\": {\"emergency\": false}}", false);
+	check("{\"areas\": [{\"trakce\": {\"emergency\": false}}], \"trakce\": {\"emergency\": true}}", true);
+	check("{\"trakce\": {\"library\": {\"emergency\": true}, \"emergency\": false}}", false);
+	check("{\"trakce\": {\"state\": \"\\\"emergency\\\": true\", \"emergency\": false}}", false);
+	check("{\"note\": \"\\\"trakce\\\": {\\\"emergency\\\": true}\", \"trakce\": {\"emergency\": false}}", false);
+	check("{\"trakce\": {\"state\": \"}{\", \"emergency\": true}}", true);
+	check("{\"rcs\": {\"trakce\": {\"emergency\": true}}}", std::nullopt);
+	check("{\"trakce\": {\"library\": {\"emergency\": true}}}", std::nullopt);
+	check("[{\"trakce\": {\"emergency\": true}}]", std::nullopt);
+	check("{\"trakce\": [{\"emergency\": true}]}", std::nullopt);
+
+	// repeated members: the last one, as json.loads
+	check("{\"trakce\": {\"emergency\": true}, \"trakce\": {\"emergency\": false}}", false);
+	check("{\"trakce\": {\"emergency\": false, \"emergency\": true}}", true);
+
+	// invalid & truncated
+	check("", std::nullopt);
+	check("{\"trakce\": {\"emergency\": 1}}", std::nullopt);
+	check("{\"trakce\": {\"emergency\": tru", std::nullopt);
+	check("{\"trakce\": {\"emergency\": true", std::nullopt);
+	check("{\"rcs\": {\"x\": \"unterminated}, \"trakce\": {\"emergency\": true}}", std::nullopt);
+	check("{\"rcs\": ]], \"trakce\": {\"emergency\": true}}", std::nullopt);
+
+	std::printf("test_pt: %s\n", failures ? "FAILED" : "ok");
+	return failures ? EXIT_FAILURE : EXIT_SUCCESS;
+}
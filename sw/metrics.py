@@ -0,0 +1,437 @@
+"""
+Metrics of DC-01 watchdog in Prometheus text exposition format.
+
+Metrics are updated from the watchdog event loop and rendered from the HTTP
+server thread, one lock guards all of them. Registry outlives reconnections
+of DC-01, so counters are monotonic for the whole life of the process.
+"""
+
+import threading
+import time
+from http.server import ThreadingHTTPServer, BaseHTTPRequestHandler
+from typing import Any, Callable, Dict, List, Optional, Sequence, Tuple
+
+# Firmware cuts DCC when no SET_STATE s=1 arrives for this long (DCCON_TIMEOUT_MS in fw/inc/main.h)
+DCCON_TIMEOUT = 2.0  # seconds
+
+Labels = Tuple[Tuple[str, str], ...]
+
+
+def _labels_str(labels: Labels) -> str:
+    if not labels:
+        return ''
+    return '{' + ','.join(f'{k}="{v}"' for k, v in labels) + '}'
+
+
+def _value_str(value: float) -> str:
+    if value == float('inf'):
+        return '+Inf'
+    return repr(float(value)) if isinstance(value, float) else str(value)
+
+
+class _Metric:
+    TYPE = ''
+
+    def __init__(self, registry: 'Registry', name: str, help: str):
+        self.name = name
+        self.help = help
+        self._lock = registry.lock
+        registry.metrics.append(self)
+
+    def render(self) -> List[str]:
+        return [f'# HELP {self.name} {self.help}', f'# TYPE {self.name} {self.TYPE}'] + self._samples()
+
+    def _samples(self) -> List[str]:
+        raise NotImplementedError
+
+
+class Counter(_Metric):
+    TYPE = 'counter'
+
+    def __init__(self, registry: 'Registry', name: str, help: str):
+        super().__init__(registry, name, help)
+        self._values: Dict[Labels, float] = {}
+
+    def inc(self, amount: float = 1, **labels: Any) -> None:
+        key = tuple((k, str(v)) for k, v in labels.items())
+        with self._lock:
+            self._values[key] = self._values.get(key, 0) + amount
+
+    def _samples(self) -> List[str]:
+        if not self._values:
+            return [f'{self.name} 0']
+        return [f'{self.name}{_labels_str(k)} {_value_str(v)}' for k, v in self._values.items()]
+
+
+class Gauge(_Metric):
+    TYPE = 'gauge'
+
+    def __init__(self, registry: 'Registry', name: str, help: str,
+                 func: Optional[Callable[[], Optional[float]]] = None):
+        """‹func› computes value at scrape time, None = no sample."""
+        super().__init__(registry, name, help)
+        self._values: Dict[Labels, float] = {}
+        self._func = func
+
+    @property
+    def value(self) -> Optional[float]:
+        return self._values.get(())
+
+    def set(self, value: Optional[float], **labels: Any) -> None:
+        key = tuple((k, str(v)) for k, v in labels.items())
+        with self._lock:
+            if value is None:
+                self._values.pop(key, None)
+            else:
+                self._values[key] = value
+
+    def _samples(self) -> List[str]:
+        if self._func:
+            value = self._func()
+            return [] if value is None else [f'{self.name} {_value_str(value)}']
+        return [f'{self.name}{_labels_str(k)} {_value_str(v)}' for k, v in self._values.items()]
+
+
+class Histogram(_Metric):
+    TYPE = 'histogram'
+
+    def __init__(self, registry: 'Registry', name: str, help: str, buckets: Sequence[float]):
+        super().__init__(registry, name, help)
+        self._bounds = sorted(buckets) + [float('inf')]
+        self._counts = [0] * len(self._bounds)  # not cumulative
+        self._sum = 0.0
+
+    def observe(self, value: float) -> None:
+        i = 0
+        while value > self._bounds[i]:
+            i += 1
+        with self._lock:
+            self._counts[i] += 1
+            self._sum += value
+
+    def _samples(self) -> List[str]:
+        result = []
+        cumulative = 0
+        for bound, count in zip(self._bounds, self._counts):
+            cumulative += count
+            result.append(f'{self.name}_bucket{{le="{_value_str(bound)}"}} {cumulative}')
+        result.append(f'{self.name}_sum {_value_str(self._sum)}')
+        result.append(f'{self.name}_count {cumulative}')
+        return result
+
+
+class Registry:
+    def __init__(self) -> None:
+        self.lock = threading.Lock()
+        self.metrics: List[_Metric] = []
+
+    def render(self) -> str:
+        with self.lock:
+            return '\n'.join(line for metric in self.metrics for line in metric.render()) + '\n'
+
+
+###############################################################################
+# HTTP endpoint
+
+class MetricsHandler(BaseHTTPRequestHandler):
+    protocol_version = 'HTTP/1.1'
+    disable_nagle_algorithm = True
+    server: 'MetricsServer'
+
+    def do_GET(self) -> None:
+        if self.path.split('?')[0] != '/metrics':
+            self._respond(404, 'text/plain', b'not found\n')
+            return
+        self._respond(200, 'text/plain; version=0.0.4; charset=utf-8', self.server.registry.render().encode('utf-8'))
+
+    def _respond(self, code: int, content_type: str, body: bytes) -> None:
+        self.send_response(code)
+        self.send_header('Content-Type', content_type)
+        self.send_header('Content-Length', str(len(body)))
+        self.end_headers()
+        self.wfile.write(body)
+
+    def log_message(self, format: str, *args: Any) -> None:
+        pass
+
+
+class MetricsServer(ThreadingHTTPServer):
+    daemon_threads = True
+
+    def __init__(self, address: str, port: int, registry: Registry) -> None:
+        super().__init__((address, port), MetricsHandler)
+        self.registry = registry
+
+    def start(self) -> None:
+        """Serve in background thread."""
+        threading.Thread(target=self.serve_forever, name='metrics', daemon=True).start()
+
+
+def parse_address(value: str) -> Tuple[str, int]:
+    """'[address:]port' → (address, port), address defaults to localhost."""
+    address, _, port = value.rpartition(':')
+    return (address or '127.0.0.1', int(port))
+
+
+###############################################################################
+# Watchdog metrics
+
+LATENCY_BUCKETS = [0.0005, 0.001, 0.0025, 0.005, 0.01, 0.025, 0.05, 0.1, 0.25, 0.5, 1]
+HEARTBEAT_BUCKETS = [0.2, 0.24, 0.25, 0.26, 0.3, 0.5, 0.75, 1, 1.5, 2]
+JITTER_BUCKETS = [0.001, 0.0025, 0.005, 0.01, 0.025, 0.05, 0.1, 0.25, 0.5, 1, 1.75]
+REPORT_BUCKETS = [0.25, 0.45, 0.5, 0.55, 0.75, 1, 2, 5]
+CUT_BUCKETS = [0.005, 0.01, 0.025, 0.05, 0.1, 0.25, 0.5, 0.75, 1, 2]
+RECONNECT_BUCKETS = [0.01, 0.025, 0.05, 0.1, 0.25, 0.5, 1, 2.5, 5, 10, 30]
+
+
+class WatchdogMetrics:
+    """
+    All the instrumentation of hjop_watchdog.py. Times are monotonic
+    (time.monotonic, same clock as asyncio loop.time()).
+    """
+
+    def __init__(self, heartbeat_period: float) -> None:
+        self.registry = Registry()
+        self.heartbeat_period = heartbeat_period
+        r = self.registry
+
+        self.hjop_latency = Histogram(r, 'dc01_hjop_check_latency_seconds',
+                                      'Latency of successful hJOP /status checks.', LATENCY_BUCKETS)
+        self.hjop_failures = Counter(r, 'dc01_hjop_check_failures_total', 'hJOP checks which failed.')
+        self.hjop_emergency = Counter(r, 'dc01_hjop_emergency_total', 'hJOP checks which reported emergency.')
+        self.health_decision = Histogram(r, 'dc01_health_decision_seconds',
+                                         'Time to decide health of control software from all sources.',
+                                         LATENCY_BUCKETS)
+        self.health_verdicts = Counter(r, 'dc01_health_verdicts_total', 'Health decisions by verdict.')
+        self.health_failures = Counter(r, 'dc01_health_probe_failures_total', 'Failed health probes by source.')
+
+        self.heartbeats = Counter(r, 'dc01_heartbeats_total', 'SET_STATE s=1 packets sent to DC-01.')
+        self.heartbeat_interval = Histogram(r, 'dc01_heartbeat_interval_seconds',
+                                            'Interval between consecutive SET_STATE s=1 packets.', HEARTBEAT_BUCKETS)
+        self.heartbeat_jitter = Histogram(r, 'dc01_heartbeat_jitter_seconds',
+                                          'Deviation of heartbeat interval from the refresh period.', JITTER_BUCKETS)
+        self._last_heartbeat: Optional[float] = None
+        self._interval_start: Optional[float] = None
+        Gauge(r, 'dc01_heartbeat_age_seconds', 'Time since last SET_STATE s=1 packet (at scrape).',
+              lambda: None if self._last_heartbeat is None else time.monotonic() - self._last_heartbeat)
+        self.dccon_timeout = DCCON_TIMEOUT
+        Gauge(r, 'dc01_dccon_timeout_seconds', 'DC-01 cuts DCC when heartbeat age exceeds this (lease when granted).',
+              lambda: self.dccon_timeout)
+        self.lease_renewals = Counter(r, 'dc01_lease_renewals_total', 'Lease renewals sent to DC-01.')
+
+        self.report_interarrival = Histogram(r, 'dc01_state_report_interarrival_seconds',
+                                             'Time between consecutive DC-01 state reports.', REPORT_BUCKETS)
+        self._last_report: Optional[float] = None
+        self.serial_rtt = Histogram(r, 'dc01_serial_rtt_seconds',
+                                    'Round-trip time of DC-01 information request.', LATENCY_BUCKETS)
+        self.serial_rtt_lost = Counter(r, 'dc01_serial_rtt_probes_lost_total',
+                                       'Information requests not answered before next one.')
+        self._rtt_probe: Optional[float] = None
+        self._info_requests = 0  # INFO requests other than RTT probe not answered yet
+
+        self.resyncs = Counter(r, 'dc01_resyncs_total', 'Resynchronizations of DC-01 packet stream.')
+        self.garbage_bytes = Counter(r, 'dc01_garbage_bytes_total', 'Bytes dropped during resynchronization.')
+        self.connects = Counter(r, 'dc01_connects_total', 'Attempts to connect to DC-01.')
+        self.disconnects = Counter(r, 'dc01_disconnects_total', 'Lost connections to DC-01.')
+        self.reconnect_time = Histogram(r, 'dc01_reconnect_seconds',
+                                        'Time from loss of connection to DC-01 to its reopening.', RECONNECT_BUCKETS)
+        self.standby = Gauge(r, 'dc01_standby', 'Instance waits as hot standby (1) or is primary (0).')
+        self.failovers = Counter(r, 'dc01_failovers_total', 'Takeovers of DC-01 by this instance as standby.')
+        self.failover_gap = Histogram(r, 'dc01_failover_heartbeat_gap_seconds',
+                                      'Last heartbeat of failed primary to the first one of this instance.',
+                                      HEARTBEAT_BUCKETS)
+        self.cuts = Counter(r, 'dc01_cuts_total', 'Transitions of DCC from connected to disconnected.')
+        self.fast_cuts = Counter(r, 'dc01_fast_cuts_total', 'DCC cuts sent by watchdog & confirmed by DC-01.')
+        self.fast_cut_latency = Histogram(r, 'dc01_fast_cut_latency_seconds',
+                                          'Time from health failure to DC-01 report of DCC disconnected.', CUT_BUCKETS)
+        self.state_reports = Counter(r, 'dc01_state_reports_total', 'DC-01 state reports by mode & failure code.')
+        self.mode = Gauge(r, 'dc01_mode', 'Last reported DC-01 mode (0=init, 1=normal, 2=override, 3=failure).')
+        self.failure_code = Gauge(r, 'dc01_failure_code', 'Last reported DC-01 failure code.')
+        self.warnings = Gauge(r, 'dc01_warnings', 'Last reported DC-01 warnings bitmask.')
+        self.dcc_connected = Gauge(r, 'dc01_dcc_connected', 'Last reported DCC state (1=connected).')
+        self.serial_state_changes = Counter(r, 'dc01_serial_state_changes_total',
+                                            'Changes of DC-01 serial state (CDC notification) by line.')
+        self.resets = Gauge(r, 'dc01_resets', 'DC-01 resets since its power-on.')
+        self.reset_cause = Gauge(r, 'dc01_reset_cause', 'Cause of the last DC-01 reset (1=set, more could be set).')
+        self.boot_ready = Gauge(r, 'dc01_boot_ready_seconds', 'DC-01 boot to ready (inputs debounced, mode set).')
+        self.boot_dcc_on = Gauge(r, 'dc01_boot_dcc_on_seconds',
+                                 'DC-01 boot to first DCC on (after Big relay test, if any).')
+        self.device_hb_gaps = Counter(r, 'dc01_device_heartbeat_gaps_total',
+                                      'Gaps between heartbeats received by DC-01 by length range [ms].')
+        self.device_hb_worst_gap = Gauge(r, 'dc01_device_heartbeat_worst_gap_seconds',
+                                         'Worst gap between heartbeats received by DC-01 (since its statistics reset).')
+        self.device_hb_margin = Gauge(r, 'dc01_device_heartbeat_margin_seconds',
+                                      'Least time left to DC-01 timeout at heartbeat (since its statistics reset).')
+        self.device_timeout_warnings = Counter(r, 'dc01_device_timeout_warnings_total',
+                                               'Heartbeat timeout warnings raised by DC-01.')
+        self.device_timeouts = Counter(r, 'dc01_device_timeouts_total', 'DCC cut by DC-01 on heartbeat timeout.')
+        self._hb_period_ms = 0
+        self.crash = Gauge(r, 'dc01_crash', 'Cause of DC-01 crash before the last reset (0=none, 1=error, 2=nmi, '
+                           '3=hardfault, 4=memmanage, 5=busfault, 6=usagefault).')
+
+        self.dcc_present = Gauge(r, 'dc01_dcc_present', 'DCC present at DC-01 input (1=present).')
+        self.dcc_packet_rate = Gauge(r, 'dc01_dcc_packet_rate', 'Valid DCC packets per second at DC-01 input.')
+        self.dcc_packets = Counter(r, 'dc01_dcc_packets_total', 'Valid DCC packets decoded at DC-01 input.')
+        self.dcc_bit_errors = Counter(r, 'dc01_dcc_bit_errors_total',
+                                      'DCC half-periods out of spec & framing errors at DC-01 input.')
+        self.dcc_checksum_errors = Counter(r, 'dc01_dcc_checksum_errors_total',
+                                           'DCC packets with wrong checksum at DC-01 input.')
+
+        self.dcc_signal = Gauge(r, 'dc01_dcc_signal', 'Edges are coming to DC-01 input (1=yes).')
+        self.dcc_frequency = Gauge(r, 'dc01_dcc_frequency_hertz', 'Falling edges per second at DC-01 input.')
+        self.dcc_low_ratio = Gauge(r, 'dc01_dcc_low_ratio', 'Part of last second DC-01 input was low.')
+        self.dcc_cutout = Gauge(r, 'dc01_dcc_cutout_seconds', 'Length of last RailCom cutout at DC-01 input.')
+        self.dcc_cutouts = Counter(r, 'dc01_dcc_cutouts_total', 'RailCom cutouts at DC-01 input.')
+        self.dcc_losses = Counter(r, 'dc01_dcc_signal_losses_total', 'DCC signal losses at DC-01 input.')
+        self.dcc_lost = Counter(r, 'dc01_dcc_signal_lost_seconds_total', 'Time DCC signal was lost at DC-01 input.')
+        self.dcc_loss = Gauge(r, 'dc01_dcc_signal_loss_seconds',
+                              'Length of current or last DCC signal loss at DC-01 input.')
+        self.dcc_edge_overruns = Counter(r, 'dc01_dcc_edge_overruns_total',
+                                         'Events DC-01 did not keep up with edges of input.')
+        self.dcc_half_periods = Counter(r, 'dc01_dcc_half_periods_total',
+                                        'Half-periods at DC-01 input by length range [us].')
+        self._dcc_last: Dict[Tuple[str, str], Tuple[int, ...]] = {}  # DC-01 counters at last report
+
+        self.mux_clients = Gauge(r, 'dc01_mux_clients', 'Clients connected to local multiplexer socket.')
+        self.mux_dropped = Counter(r, 'dc01_mux_dropped_clients_total',
+                                   'Multiplexer clients dropped for not reading fast enough.')
+        self.mux_commands = Counter(r, 'dc01_mux_commands_total', 'Commands of multiplexer clients by result.')
+
+    def connected(self) -> None:
+        self.connects.inc()
+        self.dccon_timeout = DCCON_TIMEOUT
+        self._last_report = None
+        self._rtt_probe = None
+        self._info_requests = 0
+        self._dcc_last.clear()  # DC-01 could have been reset meanwhile
+        self._hb_period_ms = 0
+
+    def heartbeat_sent(self, now: float) -> None:
+        self.heartbeats.inc()
+        if self._interval_start is not None:
+            interval = now - self._interval_start
+            self.heartbeat_interval.observe(interval)
+            self.heartbeat_jitter.observe(abs(interval - self.heartbeat_period))
+        self._last_heartbeat = self._interval_start = now
+
+    def lease_renewed(self, now: float) -> None:
+        """Renewals are not periodic, so only heartbeat age is tracked."""
+        self.lease_renewals.inc()
+        self._last_heartbeat = now
+        self._interval_start = None
+
+    def lease_granted(self, granted_ms: int) -> None:
+        if granted_ms > 0:
+            self.dccon_timeout = granted_ms / 1000
+
+    def failover(self, gap: Optional[float]) -> None:
+        """‹gap› is None when failed primary sent no heartbeat."""
+        self.failovers.inc()
+        if gap is not None:
+            self.failover_gap.observe(gap)
+
+    def fast_cut(self, latency: float) -> None:
+        self.fast_cuts.inc()
+        self.fast_cut_latency.observe(latency)
+
+    def disconnected(self) -> None:
+        """Heartbeat sequence is interrupted, next interval is not measured."""
+        self.disconnects.inc()
+        self._interval_start = None
+
+    def state_report(self, now: float, mode: str, mode_value: int, dcc_connected: bool,
+                     failure_code: int, warnings: int) -> None:
+        if self._last_report is not None:
+            self.report_interarrival.observe(now - self._last_report)
+        self._last_report = now
+        self.state_reports.inc(mode=mode, failure_code=failure_code)
+        if self.dcc_connected.value == 1 and not dcc_connected:
+            self.cuts.inc()
+        self.mode.set(mode_value)
+        self.failure_code.set(failure_code)
+        self.warnings.set(warnings)
+        self.dcc_connected.set(int(dcc_connected))
+
+    def boot_info(self, causes: Dict[str, bool], resets: int, ready_ms: int, dcc_on_ms: int) -> None:
+        """‹dcc_on_ms› 0 = DCC not yet on."""
+        for cause, value in causes.items():
+            self.reset_cause.set(int(value), cause=cause)
+        self.resets.set(resets)
+        self.boot_ready.set(ready_ms / 1000)
+        self.boot_dcc_on.set(dcc_on_ms / 1000 if dcc_on_ms else None)
+
+    def dcc_input_stats(self, input: str, present: bool, rate: int, packets: int, bit_errors: int,
+                        checksum_errors: int) -> None:
+        """DC-01 counters wrap around (32 bits) and are reset by DC-01 reset."""
+        self.dcc_present.set(int(present), input=input)
+        self.dcc_packet_rate.set(rate, input=input)
+        deltas = self._dcc_deltas(('stats', input), (packets, bit_errors, checksum_errors))
+        for counter, delta in zip((self.dcc_packets, self.dcc_bit_errors, self.dcc_checksum_errors), deltas):
+            counter.inc(delta, input=input)
+
+    def dcc_wave(self, input: str, signal: bool, frequency: int, low_permille: int, cutout_us: int,
+                 cutouts: int, losses: int, lost_ms: int, loss_ms: int, edge_overruns: int,
+                 half_periods: Dict[str, int]) -> None:
+        """‹half_periods›: range → count. Counters as in dcc_input_stats."""
+        self.dcc_signal.set(int(signal), input=input)
+        self.dcc_frequency.set(frequency, input=input)
+        self.dcc_low_ratio.set(low_permille / 1000, input=input)
+        self.dcc_cutout.set(cutout_us / 1e6 if cutouts else None, input=input)
+        self.dcc_loss.set(loss_ms / 1000 if losses else None, input=input)
+
+        deltas = self._dcc_deltas(('wave', input), (cutouts, losses, lost_ms, edge_overruns))
+        self.dcc_cutouts.inc(deltas[0], input=input)
+        self.dcc_losses.inc(deltas[1], input=input)
+        self.dcc_lost.inc(deltas[2] / 1000, input=input)
+        self.dcc_edge_overruns.inc(deltas[3], input=input)
+        deltas = self._dcc_deltas(('halves', input), tuple(half_periods.values()))
+        for range_, delta in zip(half_periods, deltas):
+            self.dcc_half_periods.inc(delta, input=input, range=range_)
+
+    def hb_stats(self, worst_gap_ms: int, min_margin_ms: Optional[int], warnings: int, timeouts: int,
+                 period_ms: int, gaps: Dict[str, int]) -> None:
+        """DC-01 heartbeat statistics, ‹gaps›: range → count, ‹min_margin_ms› None = no gap yet."""
+        self.device_hb_worst_gap.set(worst_gap_ms / 1000 if min_margin_ms is not None else None)
+        self.device_hb_margin.set(min_margin_ms / 1000 if min_margin_ms is not None else None)
+        if period_ms < self._hb_period_ms:  # statistics reset by a client, counters start from 0
+            self._dcc_last[('hb', 'counters')] = (0, 0)
+            self._dcc_last[('hb', 'gaps')] = (0,) * len(gaps)
+        self._hb_period_ms = period_ms
+
+        deltas = self._dcc_deltas(('hb', 'counters'), (warnings, timeouts))
+        self.device_timeout_warnings.inc(deltas[0])
+        self.device_timeouts.inc(deltas[1])
+        deltas = self._dcc_deltas(('hb', 'gaps'), tuple(gaps.values()))
+        for range_, delta in zip(gaps, deltas):
+            self.device_hb_gaps.inc(delta, range=range_)
+
+    def _dcc_deltas(self, key: Tuple[str, str], current: Tuple[int, ...]) -> List[int]:
+        """Increments of DC-01 32-bit counters since last report, zeros for the first report
+        (counts since DC-01 reset are unknown to this process)."""
+        last = self._dcc_last.get(key, current)
+        self._dcc_last[key] = current
+        return [(c - l) & 0xFFFFFFFF for c, l in zip(current, last)]
+
+    def rtt_probe_sent(self, now: float) -> None:
+        if self._rtt_probe is not None:
+            self.serial_rtt_lost.inc()
+        self._rtt_probe = now
+
+    def info_requested(self) -> None:
+        """INFO request other than RTT probe was sent, its response is not a probe response."""
+        self._info_requests += 1
+
+    def info_report(self, now: float) -> bool:
+        """
+        Returns True if the report is a response to RTT probe. INFO has no tag: DC-01 answers in order
+        and coalesces requests pending at once, so the report answers other request sent earlier first
+        (the probe is then counted lost).
+        """
+        if self._info_requests > 0:
+            self._info_requests -= 1
+            return False
+        if self._rtt_probe is None:
+            return False
+        self.serial_rtt.observe(now - self._rtt_probe)
+        self._rtt_probe = None
+        return True
@@ -0,0 +1,389 @@
+"""
+Local multiplexer of DC-01: the watchdog owns the serial port and publishes
+decoded DC-01 reports & its own events to any number of local clients over
+a Unix socket, one JSON object per line.
+
+Fan-out never blocks the watchdog: its event loop only serializes a message
+once and appends it to output buffers of clients, sockets are written by
+the multiplexer thread. Client whose unsent data exceed CLIENT_BUFFER_MAX
+(does not read fast enough) is dropped, so a slow client delays neither
+heartbeat nor other clients.
+
+Server → client:
+  {"type": "hello", "version": 1, "role": "observer"|"control", "state": [...]}
+      state: last message of each kind (reports, connection, manual cut),
+      so a new client does not have to wait for periodic reports
+  {"type": "report", "time": <unix time>, "report": "StateReport", "data": {...}}
+      data: fields of dc01_proto message
+  {"type": "event", "time": <unix time>, "event": <name>, ...}
+      connected (port), disconnected, health (verdict: ok, emergency,
+      unknown; on change only), manual_cut (active, by), serial_state
+      (dcc_connected, ok, timeout_warning; CDC notification of DC-01)
+  {"type": "reply", "id": <id of command>, "ok": true|false, "error": <text>}
+Client → server:
+  {"cmd": <command>, "id": <anything, returned in reply>, ...}
+      dcc_stats             request DCC statistics (report is published)
+      dcc_wave, "input": n  request DCC waveform metrics of input n
+      boot_info             request reset cause & boot timing of DC-01
+      crash                 request crash record of DC-01 (crash before the last reset)
+      hb_stats, "reset": b  request heartbeat statistics measured by DC-01,
+                            reset them once reported when b is true (control)
+      cut                   cut DCC & hold it cut until release (control)
+      release               release the cut (control)
+
+Authorization is based on peer credentials of the socket (SO_PEERCRED):
+any client which can open the socket (mode 0660) observes and requests
+reports (rate limited to REQUEST_RATE), only users of the control policy
+cut DCC and reset statistics of DC-01. Nothing on the socket turns DCC on, that is left to health checks
+of the watchdog.
+"""
+
+import json
+import logging
+import os
+import selectors
+import socket
+import stat
+import struct
+import threading
+import time
+from typing import Any, Callable, Dict, List, Optional, Set, Tuple
+import asyncio
+try:
+    import pwd
+except ImportError:  # Windows, no Unix sockets
+    pass
+
+PROTOCOL_VERSION = 1
+CLIENT_BUFFER_MAX = 256 * 1024  # bytes of unsent messages
+LINE_MAX = 4096  # bytes, longer command drops the client
+REQUEST_RATE = 10  # report requests per second per client (token bucket)
+SOCKET_MODE = 0o660
+REQUESTS = ('dcc_stats', 'dcc_wave', 'boot_info', 'crash', 'hb_stats')
+CONTROLS = ('cut', 'release')
+
+Sender = Callable[[str, Dict[str, Any]], None]
+
+
+def peer_uid(sock: socket.socket) -> Optional[int]:
+    """Returns uid of process connected to Unix socket, None when unknown."""
+    if not hasattr(socket, 'SO_PEERCRED'):
+        return None
+    creds = sock.getsockopt(socket.SOL_SOCKET, socket.SO_PEERCRED, struct.calcsize('3i'))
+    return struct.unpack('3i', creds)[1]  # pid, uid, gid
+
+
+def parse_users(spec: str) -> Set[int]:
+    """'name,1000' → uids, raises ValueError for unknown user."""
+    uids = set()
+    for user in filter(None, (u.strip() for u in spec.split(','))):
+        if user.isdigit():
+            uids.add(int(user))
+            continue
+        try:
+            uids.add(pwd.getpwnam(user).pw_uid)
+        except KeyError:
+            raise ValueError(f'unknown user {user}')
+    return uids
+
+
+def user_name(uid: Optional[int]) -> str:
+    if uid is None:
+        return 'unknown'
+    try:
+        return pwd.getpwuid(uid).pw_name
+    except KeyError:
+        return str(uid)
+
+
+def to_json(value: Any) -> Any:
+    """Converts (nested) dc01_proto message to JSON-serializable value."""
+    if isinstance(value, tuple):
+        if hasattr(value, '_fields'):
+            return {name: to_json(v) for name, v in zip(value._fields, value)}  # type: ignore
+        return [to_json(v) for v in value]
+    if isinstance(value, bytes):
+        return value.hex()
+    return value
+
+
+class Client:
+    def __init__(self, sock: socket.socket, uid: Optional[int], control: bool):
+        self.sock = sock
+        self.uid = uid
+        self.control = control
+        self.out = bytearray()  # guarded by MuxServer._lock
+        self.closing: Optional[str] = None  # reason, closed by multiplexer thread
+        self.writing = False  # registered for EVENT_WRITE
+        self._in = bytearray()
+        self._tokens = float(REQUEST_RATE)
+        self._refilled = time.monotonic()
+
+    def lines(self, data: bytes) -> List[bytes]:
+        """Returns complete lines received, raises ValueError when line is too long."""
+        self._in += data
+        *lines, rest = self._in.split(b'\n')
+        if len(rest) > LINE_MAX:
+            raise ValueError('line too long')
+        self._in = bytearray(rest)
+        return lines
+
+    def rate_ok(self) -> bool:
+        now = time.monotonic()
+        self._tokens = min(REQUEST_RATE, self._tokens + (now - self._refilled) * REQUEST_RATE)
+        self._refilled = now
+        if self._tokens < 1:
+            return False
+        self._tokens -= 1
+        return True
+
+
+class MuxServer:
+    """
+    Publishing methods (report, event) & attach/detach are called from the
+    watchdog event loop, everything else runs in the multiplexer thread.
+    Server outlives reconnections of DC-01.
+    """
+
+    def __init__(self, path: str, control_uids: Set[int], metrics):
+        self.path = path
+        self.control_uids = control_uids
+        self.metrics = metrics
+        self.cut_by: Optional[str] = None  # manual cut requested by control client, read by heartbeat
+        self._lock = threading.Lock()
+        self._clients: Dict[int, Client] = {}
+        self._state: Dict[str, Dict[str, Any]] = {}  # last message by kind, for hello, guarded by _lock
+        self._sender: Optional[Tuple[asyncio.AbstractEventLoop, Sender]] = None
+        self._closed = False
+        self._sel = selectors.DefaultSelector()
+        self._wake_r, self._wake_w = socket.socketpair()
+        self._wake_r.setblocking(False)
+        self._wake_w.setblocking(False)
+        self._wake_pending = False
+        metrics.mux_clients.set(0)
+
+        self._remove_stale_socket()
+        self._sock = socket.socket(socket.AF_UNIX, socket.SOCK_STREAM)
+        self._sock.bind(path)
+        os.chmod(path, SOCKET_MODE)
+        self._sock.listen(16)
+        self._sock.setblocking(False)
+
+    def _remove_stale_socket(self) -> None:
+        """Raises OSError when another server listens on the path."""
+        try:
+            if not stat.S_ISSOCK(os.stat(self.path).st_mode):
+                raise OSError(f'{self.path} exists and is not a socket')
+        except FileNotFoundError:
+            return
+        probe = socket.socket(socket.AF_UNIX, socket.SOCK_STREAM)
+        try:
+            probe.connect(self.path)
+        except OSError:
+            os.unlink(self.path)  # left by a dead process
+            return
+        finally:
+            probe.close()
+        raise OSError(f'{self.path} is used by another process')
+
+    def start(self) -> None:
+        """Serve in background thread."""
+        threading.Thread(target=self._serve, name='mux', daemon=True).start()
+
+    def close(self) -> None:
+        self._closed = True
+        self._wake()
+        try:
+            os.unlink(self.path)
+        except OSError:
+            pass
+
+    ###########################################################################
+    # Watchdog event loop side
+
+    def attach(self, loop: asyncio.AbstractEventLoop, sender: Sender) -> None:
+        """Report requests of clients are passed to ‹sender› in ‹loop› (DC-01 connected)."""
+        self._sender = (loop, sender)
+
+    def detach(self) -> None:
+        self._sender = None
+
+    def report(self, report: Any) -> None:
+        name = type(report).__name__
+        self._publish({'type': 'report', 'time': time.time(), 'report': name, 'data': to_json(report)},
+                      f'report {name}')
+
+    def event(self, event: str, state: bool = False, **fields: Any) -> None:
+        """‹state›: message is kept & sent to new clients in hello."""
+        self._publish({'type': 'event', 'time': time.time(), 'event': event, **fields},
+                      f'event {event}' if state else None)
+
+    def _publish(self, message: Dict[str, Any], state_key: Optional[str]) -> None:
+        with self._lock:
+            if state_key:
+                self._state[state_key] = message
+            if not self._clients:
+                return
+            line = (json.dumps(message, separators=(',', ':')) + '\n').encode('utf-8')
+            for client in self._clients.values():
+                self._enqueue(client, line)
+            self._wake()
+
+    ###########################################################################
+    # Multiplexer thread side
+
+    def _enqueue(self, client: Client, line: bytes) -> None:
+        """Lock must be held."""
+        if client.closing:
+            return
+        if len(client.out) + len(line) > CLIENT_BUFFER_MAX:
+            client.closing = 'slow'
+            client.out.clear()
+            return
+        client.out += line
+
+    def _wake(self) -> None:
+        if self._wake_pending:
+            return
+        self._wake_pending = True
+        try:
+            self._wake_w.send(b'\0')
+        except BlockingIOError:
+            pass  # already full of wake-ups
+
+    def _serve(self) -> None:
+        self._sel.register(self._sock, selectors.EVENT_READ, None)
+        self._sel.register(self._wake_r, selectors.EVENT_READ, None)
+        while not self._closed:
+            for key, events in self._sel.select():
+                if key.fileobj is self._sock:
+                    self._accept()
+                elif key.fileobj is self._wake_r:
+                    with self._lock:
+                        self._wake_pending = False
+                    try:
+                        self._wake_r.recv(0x100)
+                    except BlockingIOError:
+                        pass
+                else:
+                    client: Client = key.data
+                    if events & selectors.EVENT_READ:
+                        self._read(client)
+                    if events & selectors.EVENT_WRITE and client.sock.fileno() >= 0:
+                        self._flush(client)
+            for client in list(self._clients.values()):
+                self._flush(client)
+        for client in list(self._clients.values()):
+            self._close(client)
+        self._sock.close()
+
+    def _accept(self) -> None:
+        try:
+            sock, _ = self._sock.accept()
+        except BlockingIOError:
+            return
+        sock.setblocking(False)
+        uid = peer_uid(sock)
+        client = Client(sock, uid, uid is not None and uid in self.control_uids)
+        with self._lock:
+            # state snapshot & registration at once: each message is in hello or sent after it, never both
+            hello = {
+                'type': 'hello', 'version': PROTOCOL_VERSION, 'role': 'control' if client.control else 'observer',
+                'state': list(self._state.values()),
+            }
+            self._clients[sock.fileno()] = client
+            self._enqueue(client, (json.dumps(hello, separators=(',', ':')) + '\n').encode('utf-8'))
+        self._sel.register(sock, selectors.EVENT_READ, client)
+        self.metrics.mux_clients.set(len(self._clients))
+        logging.debug(f'Multiplexer client of {user_name(uid)} connected ({hello["role"]})')
+
+    def _close(self, client: Client) -> None:
+        self._sel.unregister(client.sock)
+        with self._lock:
+            del self._clients[client.sock.fileno()]
+        client.sock.close()
+        self.metrics.mux_clients.set(len(self._clients))
+
+    def _flush(self, client: Client) -> None:
+        with self._lock:
+            if client.out and not client.closing:
+                try:
+                    sent = client.sock.send(client.out)
+                    del client.out[:sent]
+                except BlockingIOError:
+                    pass
+                except OSError:
+                    client.closing = 'closed'
+                    client.out.clear()
+            closing, writing = client.closing, bool(client.out)
+        if closing:
+            if closing == 'slow':
+                logging.warning(f'Multiplexer client of {user_name(client.uid)} dropped: not reading fast enough')
+                self.metrics.mux_dropped.inc()
+            self._close(client)
+        elif writing != client.writing:
+            client.writing = writing
+            self._sel.modify(client.sock, selectors.EVENT_READ | (selectors.EVENT_WRITE if writing else 0), client)
+
+    def _read(self, client: Client) -> None:
+        try:
+            data = client.sock.recv(0x1000)
+        except BlockingIOError:
+            return
+        except OSError:
+            data = b''
+        try:
+            if not data:
+                raise ValueError('closed')
+            for line in client.lines(data):
+                if line.strip():
+                    self._command(client, line)
+        except ValueError as e:
+            with self._lock:
+                client.closing = str(e)
+                client.out.clear()
+
+    def _command(self, client: Client, line: bytes) -> None:
+        try:
+            message = json.loads(line)
+            cmd = message['cmd']
+        except (ValueError, KeyError, TypeError):
+            self._reply(client, None, 'invalid', 'invalid command')
+            return
+        id_ = message.get('id')
+        if cmd in CONTROLS and not client.control:
+            self._reply(client, id_, cmd, 'not authorized')
+        elif cmd == 'cut':
+            self.cut_by = user_name(client.uid)
+            self.event('manual_cut', state=True, active=True, by=self.cut_by)
+            self._reply(client, id_, cmd, None)
+        elif cmd == 'release':
+            if self.cut_by is not None:
+                self.cut_by = None
+                self.event('manual_cut', state=True, active=False, by=user_name(client.uid))
+            self._reply(client, id_, cmd, None)
+        elif cmd in REQUESTS:
+            sender = self._sender
+            if cmd == 'dcc_wave' and message.get('input') not in (0, 1):
+                self._reply(client, id_, cmd, 'invalid input')
+            elif cmd == 'hb_stats' and message.get('reset', False) not in (False, True):
+                self._reply(client, id_, cmd, 'invalid reset')
+            elif cmd == 'hb_stats' and message.get('reset') and not client.control:
+                self._reply(client, id_, cmd, 'not authorized')
+            elif not client.rate_ok():
+                self._reply(client, id_, cmd, 'rate limited')
+            elif sender is None:
+                self._reply(client, id_, cmd, 'DC-01 not connected')
+            else:
+                sender[0].call_soon_threadsafe(sender[1], cmd, message)
+                self._reply(client, id_, cmd, None)
+        else:
+            self._reply(client, id_, 'unknown', 'unknown command')
+
+    def _reply(self, client: Client, id_: Any, cmd: str, error: Optional[str]) -> None:
+        self.metrics.mux_commands.inc(cmd=cmd, result=error or 'ok')
+        reply: Dict[str, Any] = {'type': 'reply', 'id': id_, 'ok': error is None}
+        if error:
+            reply['error'] = error
+        with self._lock:
+            self._enqueue(client, (json.dumps(reply, separators=(',', ':')) + '\n').encode('utf-8'))
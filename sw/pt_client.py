@@ -0,0 +1,160 @@
+"""
+Client of hJOPserver PT (HTTP JSON) server.
+
+Single HTTP/1.1 keep-alive connection is kept open and reused for all the
+requests, connection is reestablished transparently when server closes it.
+Only the values watchdog needs are extracted from /status response by a
+fast path; whole JSON document is parsed only when fast path fails.
+"""
+
+import asyncio
+import json
+import re
+import time
+from typing import Optional, Tuple
+
+
+class PTError(Exception):
+    pass
+
+
+class PTClient:
+    def __init__(self, server: str, port: int, timeout: float):
+        self.server = server
+        self.port = port
+        self.timeout = timeout
+        self._reader: Optional[asyncio.StreamReader] = None
+        self._writer: Optional[asyncio.StreamWriter] = None
+
+        self.requests = 0
+        self.connects = 0
+        self.last_latency: Optional[float] = None  # seconds
+        self.last_reused = False
+
+    def close(self) -> None:
+        if self._writer is not None:
+            self._writer.close()
+        self._reader = self._writer = None
+
+    async def get(self, path: str) -> bytes:
+        """Returns body of response, raises PTError, OSError or asyncio.TimeoutError."""
+        if not path.startswith('/'):
+            path = '/' + path
+
+        start = time.monotonic()
+        try:
+            body = await asyncio.wait_for(self._get(path), self.timeout)
+        except (asyncio.IncompleteReadError, ValueError) as e:
+            # Response truncated on a fresh connection or malformed (chunk size, Content-Length)
+            self.close()
+            raise PTError(f'Invalid HTTP response: {e!r}') from e
+        except BaseException:
+            self.close()  # state of connection is unknown
+            raise
+        self.last_latency = time.monotonic() - start
+        self.requests += 1
+        return body
+
+    async def _get(self, path: str) -> bytes:
+        self.last_reused = self._writer is not None
+        if self._writer is None:
+            await self._connect()
+        try:
+            return await self._request(path)
+        except (ConnectionError, asyncio.IncompleteReadError):
+            if not self.last_reused:
+                raise
+            # Server closed idle keep-alive connection → retry once on a new one
+            self.close()
+            self.last_reused = False
+            await self._connect()
+            return await self._request(path)
+
+    async def _connect(self) -> None:
+        self._reader, self._writer = await asyncio.open_connection(self.server, self.port)
+        self.connects += 1
+
+    async def _request(self, path: str) -> bytes:
+        assert self._reader is not None and self._writer is not None
+        request = (
+            f'GET {path} HTTP/1.1\r\n'
+            f'Host: {self.server}:{self.port}\r\n'
+            'Accept: application/json\r\n'
+            'Connection: keep-alive\r\n'
+            '\r\n'
+        )
+        self._writer.write(request.encode('ascii'))
+        await self._writer.drain()
+
+        status_line = await self._reader.readline()
+        if not status_line:
+            raise ConnectionResetError('Connection closed by server')
+        version, status = self._parse_status_line(status_line)
+
+        content_length = None
+        chunked = False
+        keep_alive = (version == b'HTTP/1.1')
+        while True:
+            line = await self._reader.readline()
+            if line in (b'\r\n', b'\n', b''):
+                break
+            name, _, value = line.partition(b':')
+            name, value = name.strip().lower(), value.strip().lower()
+            if name == b'content-length':
+                content_length = int(value)
+            elif name == b'transfer-encoding':
+                chunked = (value == b'chunked')
+            elif name == b'connection':
+                keep_alive = (value == b'keep-alive')
+
+        if chunked:
+            body = await self._read_chunked()
+        elif content_length is not None:
+            body = await self._reader.readexactly(content_length)
+        else:
+            body = await self._reader.read()
+            keep_alive = False
+
+        if not keep_alive:
+            self.close()
+        if status != 200:
+            raise PTError(f'HTTP status {status}')
+        return body
+
+    async def _read_chunked(self) -> bytes:
+        assert self._reader is not None
+        body = bytearray()
+        while True:
+            size = int((await self._reader.readline()).split(b';')[0], 16)
+            if size == 0:
+                await self._reader.readline()  # no trailers expected
+                return bytes(body)
+            body += await self._reader.readexactly(size)
+            await self._reader.readexactly(2)  # CRLF
+
+    @staticmethod
+    def _parse_status_line(line: bytes) -> Tuple[bytes, int]:
+        parts = line.split(None, 2)
+        if len(parts) < 2 or not parts[0].startswith(b'HTTP/') or not parts[1].isdigit():
+            raise PTError(f'Invalid HTTP response: {line!r}')
+        return parts[0], int(parts[1])
+
+
+# Fast path: trakce is the first member of the top-level object (as hJOPserver
+# sends it) & emergency its direct member. "trakce" & "emergency" must occur
+# only once, otherwise a nested or repeated one could decide, and the body must
+# not be truncated → full parse.
+_EMERGENCY_RE = re.compile(rb'\A\s*\{\s*"trakce"\s*:\s*\{[^{}]*?"emergency"\s*:\s*(true|false)')
+
+
+def status_emergency(body: bytes) -> bool:
+    """Returns trakce.emergency from /status response body."""
+    match = _EMERGENCY_RE.match(body)
+    if (match and body.count(b'"trakce"') == 1 and body.count(b'"emergency"') == 1
+            and body.rstrip().endswith(b'}')):
+        return match.group(1) == b'true'
+
+    try:
+        return bool(json.loads(body)['trakce']['emergency'])
+    except (ValueError, KeyError, TypeError) as e:
+        raise PTError(f'Invalid /status response: {e!r}')
@@ -0,0 +1,120 @@
+"""
+Hot standby of the watchdog: instances started with the same lock file
+coordinate by flock. The instance holding the lock is primary, it owns the
+DC-01 port and sends heartbeat. Others wait as standbys for the lock, which
+the kernel releases as soon as the primary exits or crashes.
+
+Standby keeps the DC-01 port open, but it never reads nor writes it: the
+tty is not closed with the primary's process, so DTR stays asserted (drop
+of DTR makes DC-01 cut DCC immediately, see cdc_main_died) and the standby
+takes over within a heartbeat period. Hung primary keeps the lock, DC-01
+cuts DCC after its heartbeat timeout then, as without standby.
+
+Primary stamps each heartbeat to the lock file (monotonic clock is
+system-wide), the new primary logs the heartbeat gap of the failover.
+"""
+
+import logging
+import os
+import struct
+import time
+from typing import Callable, List, Optional, Tuple
+try:
+    import fcntl
+    import termios
+except ImportError:  # Windows, standby is not supported
+    pass
+
+POLL_PERIOD = 0.01  # seconds, lock polling by standby
+HOLD_CHECK_PERIOD = 1  # seconds, check of the held port (device replugged)
+STAMP = struct.Struct('<dI')  # monotonic time of the last heartbeat, pid of primary
+
+
+class Standby:
+    def __init__(self, path: str):
+        self.path = path
+        self._fd = os.open(path, os.O_RDWR | os.O_CREAT | os.O_CLOEXEC, 0o644)
+        self._held: Optional[int] = None  # fd of DC-01 port held by standby
+        self._takeover: Optional[Tuple[float, float, int]] = None  # (lock acquired, last heartbeat, pid)
+
+    def wait_primary(self, ports: Callable[[], List[str]]) -> bool:
+        """
+        Blocks until this instance becomes primary, holds the DC-01 port
+        (discovered by ‹ports›) meanwhile. Returns True after failover.
+        """
+        if self._try_lock():
+            return False
+        logging.info(f'Standby: waiting for primary to fail (lock {self.path})')
+        next_check = 0.0
+        while not self._try_lock():
+            now = time.monotonic()
+            if now >= next_check:
+                self._hold(ports)
+                next_check = now + HOLD_CHECK_PERIOD
+            time.sleep(POLL_PERIOD)
+
+        acquired = time.monotonic()
+        last, pid = self._read_stamp()
+        self._takeover = (acquired, last, pid)
+        if last > 0:
+            logging.warning(f'Standby: primary (pid {pid}) failed, taking over '
+                            f'{(acquired-last)*1000:.0f} ms after its last heartbeat')
+        else:
+            logging.warning('Standby: primary failed before its first heartbeat, taking over')
+        return True
+
+    def heartbeat(self, now: float, metrics) -> None:
+        """Called by primary after each heartbeat sent (SET_STATE or lease renewal)."""
+        os.pwrite(self._fd, STAMP.pack(now, os.getpid()), 0)
+        if self._takeover is None:
+            return
+        acquired, last, _ = self._takeover
+        self._takeover = None
+        self._release_port()  # port is opened by the watchdog now
+        if last > 0:
+            logging.warning(f'Failover completed: heartbeat gap {(now-last)*1000:.0f} ms (lock acquired after '
+                            f'{(acquired-last)*1000:.0f} ms, first heartbeat {(now-acquired)*1000:.0f} ms later)')
+            metrics.failover(now - last)
+        else:
+            logging.warning(f'Failover completed: first heartbeat {(now-acquired)*1000:.0f} ms after lock acquired')
+            metrics.failover(None)
+
+    def close(self) -> None:
+        self._release_port()
+        os.close(self._fd)  # releases the lock
+
+    def _try_lock(self) -> bool:
+        try:
+            fcntl.flock(self._fd, fcntl.LOCK_EX | fcntl.LOCK_NB)
+            return True
+        except BlockingIOError:
+            return False
+
+    def _read_stamp(self) -> Tuple[float, int]:
+        data = os.pread(self._fd, STAMP.size, 0)
+        return STAMP.unpack(data) if len(data) == STAMP.size else (0.0, 0)
+
+    def _hold(self, ports: Callable[[], List[str]]) -> None:
+        """
+        Port is opened raw: no termios change & no flush of input, which
+        belongs to the primary.
+        """
+        if self._held is not None:
+            try:
+                termios.tcgetattr(self._held)  # EIO when the device is gone
+                return
+            except termios.error:
+                self._release_port()
+        found = ports()
+        if len(found) != 1:
+            return
+        try:
+            self._held = os.open(found[0], os.O_RDWR | os.O_NOCTTY | os.O_NONBLOCK | os.O_CLOEXEC)
+            logging.info(f'Standby: holding {found[0]}')
+        except OSError as e:
+            logging.info(f'Standby: unable to hold {found[0]}: {e}', extra={'delta': 'standby_hold'})
+
+    def _release_port(self) -> None:
+        if self._held is not None:
+            os.close(self._held)
+            self._held = None